@@ -0,0 +1,13 @@
+-- Added Command .debug packetlog flush and .debug packetlog replay
+
+DELETE FROM `rbac_permissions` WHERE `id` IN (1009, 1010, 1011);
+INSERT INTO `rbac_permissions` (`id`, `name`) VALUES
+(1009, 'Command: debug packetlog'),
+(1010, 'Command: debug packetlog flush'),
+(1011, 'Command: debug packetlog replay');
+
+DELETE FROM `rbac_linked_permissions` WHERE `id` = 196 AND `linkedId` IN (1009, 1010, 1011);
+INSERT INTO `rbac_linked_permissions` (`id`, `linkedId`) VALUES
+(196, 1009),
+(196, 1010),
+(196, 1011);
@@ -0,0 +1,9 @@
+-- Added Command .server tickstats
+
+DELETE FROM `rbac_permissions` WHERE `id` = 1012;
+INSERT INTO `rbac_permissions` (`id`, `name`) VALUES
+(1012, 'Command: server tickstats');
+
+DELETE FROM `rbac_linked_permissions` WHERE `id` = 196 AND `linkedId` = 1012;
+INSERT INTO `rbac_linked_permissions` (`id`, `linkedId`) VALUES
+(196, 1012);
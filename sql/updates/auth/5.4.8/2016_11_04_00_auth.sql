@@ -0,0 +1,9 @@
+-- Added Command .debug bgqueuesim
+
+DELETE FROM `rbac_permissions` WHERE `id` = 1013;
+INSERT INTO `rbac_permissions` (`id`, `name`) VALUES
+(1013, 'Command: debug bgqueuesim');
+
+DELETE FROM `rbac_linked_permissions` WHERE `id` = 196 AND `linkedId` = 1013;
+INSERT INTO `rbac_linked_permissions` (`id`, `linkedId`) VALUES
+(196, 1013);
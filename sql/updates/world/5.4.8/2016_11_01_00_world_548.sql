@@ -0,0 +1,5 @@
+-- Added Command .server slabs
+
+DELETE FROM `command` WHERE `name` = 'server slabs';
+INSERT INTO `command` (`name`, `permission`, `help`) VALUES
+('server slabs', 1008, 'Syntax: .server slabs\r\nShow live and peak object counts and reserved memory of the per class slab allocators.');
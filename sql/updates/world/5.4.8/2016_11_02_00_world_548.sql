@@ -0,0 +1,7 @@
+-- Added Command .debug packetlog flush and .debug packetlog replay
+
+DELETE FROM `command` WHERE `name` IN ('debug packetlog', 'debug packetlog flush', 'debug packetlog replay');
+INSERT INTO `command` (`name`, `permission`, `help`) VALUES
+('debug packetlog', 1009, 'Syntax: .debug packetlog $subcommand\r\nType .debug packetlog to see the list of possible subcommands or .help debug packetlog $subcommand to see info on subcommands'),
+('debug packetlog flush', 1010, 'Syntax: .debug packetlog flush [#accountId]\r\nWrite the packets captured in ring mode (PacketLog.Ring.Size) of all connections, or only of the given account, to a new capture file in the logs directory.'),
+('debug packetlog replay', 1011, 'Syntax: .debug packetlog replay $fileName [#accountId]\r\nFeed the client packets of a capture file from the logs directory, optionally only those of one account, through the handlers of your own session. Needs PacketLog.Replay.Enable.');
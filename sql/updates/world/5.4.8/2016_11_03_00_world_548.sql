@@ -0,0 +1,5 @@
+-- Added Command .server tickstats
+
+DELETE FROM `command` WHERE `name` = 'server tickstats';
+INSERT INTO `command` (`name`, `permission`, `help`) VALUES
+('server tickstats', 1012, 'Syntax: .server tickstats [reset]\r\nShow the world tick time distribution, the time spent per update subsystem, client packet rates and slab memory since the last reset. With reset the statistics are restarted afterwards.');
@@ -0,0 +1,5 @@
+-- Added Command .debug bgqueuesim
+
+DELETE FROM `command` WHERE `name` = 'debug bgqueuesim';
+INSERT INTO `command` (`name`, `permission`, `help`) VALUES
+('debug bgqueuesim', 1013, 'Syntax: .debug bgqueuesim [#groups] [#seed]\r\nQueue #groups generated groups (default 20000) in private battleground and 3v3 rated arena queues, let as many join while matching them, and compare the selections and selection times with the old queue walks. Blocks the world thread while it runs.');
@@ -39,6 +39,8 @@
 #include "SignalHandler.h"
 #include "RealmList.h"
 #include "RealmAcceptor.h"
+#include "AuthSocket.h"
+#include "AuthWorkerPool.h"
 
 #ifdef __linux__
 #include <sched.h>
@@ -73,6 +75,23 @@ public:
     }
 };
 
+/// Runs the reactor event loop on an additional network thread
+class AuthNetworkRunnable : public ACE_Based::Runnable
+{
+public:
+    void run()
+    {
+        while (!stopEvent)
+        {
+            // dont move this outside the loop, the reactor will modify it
+            ACE_Time_Value interval(0, 100000);
+
+            if (ACE_Reactor::instance()->run_reactor_event_loop(interval) == -1)
+                break;
+        }
+    }
+};
+
 /// Print out the usage string for this program on the console.
 void usage(const char* prog)
 {
@@ -160,6 +179,16 @@ extern int main(int argc, char** argv)
     if (!StartDB())
         return 1;
 
+    // Logon challenges and proofs are continued on these threads once their lookups returned
+    int32 logonThreads = sConfigMgr->GetIntDefault("Logon.WorkerThreads", 2);
+    if (logonThreads < 1)
+    {
+        TC_LOG_ERROR("server.authserver", "Logon.WorkerThreads is wrong in your config file, defaulting to 2.");
+        logonThreads = 2;
+    }
+
+    sAuthWorkerPool->Start(uint32(logonThreads));
+
     // Get the list of realms for the server
     sRealmList->Initialize(sConfigMgr->GetIntDefault("RealmsStateUpdateDelay", 20));
     if (sRealmList->size() == 0)
@@ -261,9 +290,29 @@ extern int main(int argc, char** argv)
 
 #endif
 
-    // maximum counter for next ping
-    uint32 numLoops = (sConfigMgr->GetIntDefault("MaxPingTime", 30) * (MINUTE * 1000000 / 100000));
-    uint32 loopCounter = 0;
+    // The main thread runs the event loop as well, every further network thread shares the same reactor.
+    // The network threads only parse and send, logon challenges and proofs wait for their lookups and
+    // run their SRP6 math on the logon workers.
+    int32 networkThreads = sConfigMgr->GetIntDefault("Network.Threads", 1);
+    if (networkThreads < 1)
+    {
+        TC_LOG_ERROR("server.authserver", "Network.Threads is wrong in your config file, defaulting to 1.");
+        networkThreads = 1;
+    }
+
+    std::vector<ACE_Based::Thread*> networkThreadPool;
+    for (int32 i = 1; i < networkThreads; ++i)
+        networkThreadPool.push_back(new ACE_Based::Thread(new AuthNetworkRunnable));
+
+    if (networkThreads > 1)
+        TC_LOG_INFO("server.authserver", "Using %d network threads.", networkThreads);
+
+    // maximum time until next ping
+    time_t pingInterval = time_t(sConfigMgr->GetIntDefault("MaxPingTime", 30) * MINUTE);
+    time_t nextPingTime = time(NULL) + pingInterval;
+
+    time_t statsInterval = time_t(sConfigMgr->GetIntDefault("PhaseStatsInterval", 0));
+    time_t nextStatsTime = time(NULL) + statsInterval;
 
     // Wait for termination signal
     while (!stopEvent)
@@ -274,14 +323,34 @@ extern int main(int argc, char** argv)
         if (ACE_Reactor::instance()->run_reactor_event_loop(interval) == -1)
             break;
 
-        if ((++loopCounter) == numLoops)
+        // Update realm list if need, network threads only read copies of it
+        sRealmList->UpdateIfNeed();
+
+        time_t now = time(NULL);
+        if (now >= nextPingTime)
         {
-            loopCounter = 0;
+            nextPingTime = now + pingInterval;
             TC_LOG_INFO("server.authserver", "Ping MySQL to keep connection alive");
             LoginDatabase.KeepAlive();
         }
+
+        if (statsInterval && now >= nextStatsTime)
+        {
+            nextStatsTime = now + statsInterval;
+            AuthSocket::LogPhaseStats();
+        }
+    }
+
+    // Also stops the loop of the other network threads if a failure ended this one
+    stopEvent = true;
+    for (std::vector<ACE_Based::Thread*>::iterator itr = networkThreadPool.begin(); itr != networkThreadPool.end(); ++itr)
+    {
+        (*itr)->wait();
+        delete *itr;
     }
 
+    sAuthWorkerPool->Stop();
+
     // Close the Database Pool and library
     StopDB();
 
@@ -316,7 +385,8 @@ bool StartDB()
         synch_threads = 1;
     }
 
-    // NOTE: While authserver is singlethreaded you should keep synch_threads == 1. Increasing it is just silly since only 1 will be used ever.
+    // NOTE: Each network thread uses at most one synchronous connection at a time, more than Network.Threads are never used.
+    // The asynchronous connections (worker threads) serve the lookups of logon challenges and proofs.
     if (!LoginDatabase.Open(dbstring, uint8(worker_threads), uint8(synch_threads)))
     {
         TC_LOG_ERROR("server.authserver", "Cannot connect to database");
@@ -19,7 +19,14 @@
 #include "RealmList.h"
 #include "Database/DatabaseEnv.h"
 
-RealmList::RealmList() : m_UpdateInterval(0), m_NextUpdateTime(time(NULL)) { }
+RealmList::RealmList() : m_version(0), m_UpdateInterval(0), m_NextUpdateTime(time(NULL)) { }
+
+static bool IsSameRealm(Realm const& a, Realm const& b)
+{
+    return a.m_ID == b.m_ID && a.name == b.name && a.icon == b.icon && a.flag == b.flag && a.timezone == b.timezone &&
+        a.allowedSecurityLevel == b.allowedSecurityLevel && a.populationLevel == b.populationLevel && a.gamebuild == b.gamebuild &&
+        a.ExternalAddress == b.ExternalAddress && a.LocalAddress == b.LocalAddress && a.LocalSubnetMask == b.LocalSubnetMask;
+}
 
 // Load the realm list from the database
 void RealmList::Initialize(uint32 updateInterval)
@@ -30,10 +37,38 @@ void RealmList::Initialize(uint32 updateInterval)
     UpdateRealms(true);
 }
 
-void RealmList::UpdateRealm(uint32 id, const std::string& name, ACE_INET_Addr const& address, ACE_INET_Addr const& localAddr, ACE_INET_Addr const& localSubmask, uint8 icon, RealmFlags flag, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, uint32 build)
+void RealmList::AddRealm(const Realm& NewRealm)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_realmsLock);
+    m_realms[NewRealm.name] = NewRealm;
+    ++m_version;
+}
+
+RealmList::RealmMap RealmList::GetRealms(uint32* version /*= NULL*/) const
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_realmsLock);
+    if (version)
+        *version = m_version;
+
+    return m_realms;
+}
+
+uint32 RealmList::GetVersion() const
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_realmsLock);
+    return m_version;
+}
+
+uint32 RealmList::size() const
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_realmsLock);
+    return m_realms.size();
+}
+
+void RealmList::UpdateRealm(RealmMap& realms, uint32 id, const std::string& name, ACE_INET_Addr const& address, ACE_INET_Addr const& localAddr, ACE_INET_Addr const& localSubmask, uint8 icon, RealmFlags flag, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, uint32 build)
 {
     // Create new if not exist or update existed
-    Realm& realm = m_realms[name];
+    Realm& realm = realms[name];
 
     realm.m_ID = id;
     realm.name = name;
@@ -58,10 +93,7 @@ void RealmList::UpdateIfNeed()
 
     m_NextUpdateTime = time(NULL) + m_UpdateInterval;
 
-    // Clears Realm list
-    m_realms.clear();
-
-    // Get the content of the realmlist table in the database
+    // Get the content of the realmlist table in the database, replaces the current list
     UpdateRealms();
 }
 
@@ -72,6 +104,9 @@ void RealmList::UpdateRealms(bool init)
     PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_REALMLIST);
     PreparedQueryResult result = LoginDatabase.Query(stmt);
 
+    // Built aside and swapped in, readers never see a partial list
+    RealmMap realms;
+
     // Circle through results and add them to the realm map
     if (result)
     {
@@ -95,11 +130,24 @@ void RealmList::UpdateRealms(bool init)
             ACE_INET_Addr localAddr(port, localAddress.c_str(), AF_INET);
             ACE_INET_Addr submask(0, localSubmask.c_str(), AF_INET);
 
-            UpdateRealm(realmId, name, externalAddr, localAddr, submask, icon, flag, timezone, (allowedSecurityLevel <= SEC_ADMINISTRATOR ? AccountTypes(allowedSecurityLevel) : SEC_ADMINISTRATOR), pop, build);
+            UpdateRealm(realms, realmId, name, externalAddr, localAddr, submask, icon, flag, timezone, (allowedSecurityLevel <= SEC_ADMINISTRATOR ? AccountTypes(allowedSecurityLevel) : SEC_ADMINISTRATOR), pop, build);
 
             if (init)
-                TC_LOG_INFO("server.authserver", "Added realm \"%s\" at %s:%u.", name.c_str(), m_realms[name].ExternalAddress.get_host_addr(), port);
+                TC_LOG_INFO("server.authserver", "Added realm \"%s\" at %s:%u.", name.c_str(), realms[name].ExternalAddress.get_host_addr(), port);
         }
         while (result->NextRow());
     }
+
+    TRINITY_GUARD(ACE_Thread_Mutex, m_realmsLock);
+
+    // Only a real change invalidates the realm list packets built from the old list
+    bool changed = realms.size() != m_realms.size();
+    for (RealmMap::const_iterator itr = realms.begin(), old = m_realms.begin(); !changed && itr != realms.end(); ++itr, ++old)
+        changed = !IsSameRealm(itr->second, old->second);
+
+    if (changed)
+    {
+        m_realms.swap(realms);
+        ++m_version;
+    }
 }
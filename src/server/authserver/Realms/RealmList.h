@@ -20,6 +20,7 @@
 
 #include <ace/Singleton.h>
 #include <ace/Null_Mutex.h>
+#include <ace/Thread_Mutex.h>
 #include <ace/INET_Addr.h>
 #include "Common.h"
 
@@ -65,17 +66,23 @@ public:
 
     void UpdateIfNeed();
 
-    void AddRealm(const Realm& NewRealm) { m_realms[NewRealm.name] = NewRealm; }
+    void AddRealm(const Realm& NewRealm);
 
-    RealmMap::const_iterator begin() const { return m_realms.begin(); }
-    RealmMap::const_iterator end() const { return m_realms.end(); }
-    uint32 size() const { return m_realms.size(); }
+    // Network threads read the list while the main thread refreshes it, so only copies are handed out.
+    // version receives the list version the copy belongs to.
+    RealmMap GetRealms(uint32* version = NULL) const;
+    uint32 size() const;
+
+    // Changes whenever realm rows were added, removed or modified, not on every reload
+    uint32 GetVersion() const;
 
 private:
     void UpdateRealms(bool init=false);
-    void UpdateRealm(uint32 id, const std::string& name, ACE_INET_Addr const& address, ACE_INET_Addr const& localAddr, ACE_INET_Addr const& localSubmask, uint8 icon, RealmFlags flag, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, uint32 build);
+    void UpdateRealm(RealmMap& realms, uint32 id, const std::string& name, ACE_INET_Addr const& address, ACE_INET_Addr const& localAddr, ACE_INET_Addr const& localSubmask, uint8 icon, RealmFlags flag, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, uint32 build);
 
     RealmMap m_realms;
+    uint32   m_version;
+    mutable ACE_Thread_Mutex m_realmsLock;
     uint32   m_UpdateInterval;
     time_t   m_NextUpdateTime;
 };
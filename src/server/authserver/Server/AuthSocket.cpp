@@ -25,6 +25,7 @@
 #include "Log.h"
 #include "RealmList.h"
 #include "AuthSocket.h"
+#include "AuthWorkerPool.h"
 #include "AuthCodes.h"
 #include "TOTP.h"
 #include "SHA1.h"
@@ -136,6 +137,7 @@ typedef struct AuthHandler
     eAuthCmd cmd;
     uint32 status;
     bool (AuthSocket::*handler)(void);
+    AuthPhase phase;
 } AuthHandler;
 
 // GCC have alternative #pragma pack() syntax and old gcc version not support pack(pop), also any gcc version not support it at some paltform
@@ -180,14 +182,14 @@ private:
 
 const AuthHandler table[] =
 {
-    { AUTH_LOGON_CHALLENGE,     STATUS_CONNECTED, &AuthSocket::_HandleLogonChallenge    },
-    { AUTH_LOGON_PROOF,         STATUS_CONNECTED, &AuthSocket::_HandleLogonProof        },
-    { AUTH_RECONNECT_CHALLENGE, STATUS_CONNECTED, &AuthSocket::_HandleReconnectChallenge},
-    { AUTH_RECONNECT_PROOF,     STATUS_CONNECTED, &AuthSocket::_HandleReconnectProof    },
-    { REALM_LIST,               STATUS_AUTHED,    &AuthSocket::_HandleRealmList         },
-    { XFER_ACCEPT,              STATUS_CONNECTED, &AuthSocket::_HandleXferAccept        },
-    { XFER_RESUME,              STATUS_CONNECTED, &AuthSocket::_HandleXferResume        },
-    { XFER_CANCEL,              STATUS_CONNECTED, &AuthSocket::_HandleXferCancel        }
+    { AUTH_LOGON_CHALLENGE,     STATUS_CONNECTED, &AuthSocket::_HandleLogonChallenge,     AUTH_PHASE_LOGON_CHALLENGE     },
+    { AUTH_LOGON_PROOF,         STATUS_CONNECTED, &AuthSocket::_HandleLogonProof,         AUTH_PHASE_LOGON_PROOF         },
+    { AUTH_RECONNECT_CHALLENGE, STATUS_CONNECTED, &AuthSocket::_HandleReconnectChallenge, AUTH_PHASE_RECONNECT_CHALLENGE },
+    { AUTH_RECONNECT_PROOF,     STATUS_CONNECTED, &AuthSocket::_HandleReconnectProof,     AUTH_PHASE_RECONNECT_PROOF     },
+    { REALM_LIST,               STATUS_AUTHED,    &AuthSocket::_HandleRealmList,          AUTH_PHASE_REALM_LIST          },
+    { XFER_ACCEPT,              STATUS_CONNECTED, &AuthSocket::_HandleXferAccept,         AUTH_PHASE_NONE                },
+    { XFER_RESUME,              STATUS_CONNECTED, &AuthSocket::_HandleXferResume,         AUTH_PHASE_NONE                },
+    { XFER_CANCEL,              STATUS_CONNECTED, &AuthSocket::_HandleXferCancel,         AUTH_PHASE_NONE                }
 };
 
 #define AUTH_TOTAL_COMMANDS 8
@@ -195,10 +197,227 @@ const AuthHandler table[] =
 // Holds the MD5 hash of client patches present on the server
 Patcher PatchesCache;
 
+// Processing time of the logon phases, shared by all network threads
+struct AuthPhaseStats
+{
+    AuthPhaseStats() : count(0), totalTime(0), maxTime(0) { }
+
+    uint64 count;
+    uint64 totalTime;                                       // in microseconds
+    uint64 maxTime;                                         // in microseconds
+};
+
+AuthPhaseStats PhaseStats[MAX_AUTH_PHASE];
+ACE_Thread_Mutex PhaseStatsLock;
+
+static char const* const PhaseNames[MAX_AUTH_PHASE] =
+{
+    "logon challenge",
+    "logon proof",
+    "reconnect challenge",
+    "reconnect proof",
+    "realm list"
+};
+
+static void RecordPhaseTime(AuthPhase phase, ACE_Time_Value const& start)
+{
+    ACE_Time_Value elapsed = ACE_OS::gettimeofday() - start;
+    uint64 time = 0;
+    elapsed.to_usec(time);
+
+    TRINITY_GUARD(ACE_Thread_Mutex, PhaseStatsLock);
+    AuthPhaseStats& stats = PhaseStats[phase];
+    ++stats.count;
+    stats.totalTime += time;
+    if (time > stats.maxTime)
+        stats.maxTime = time;
+}
+
+void AuthSocket::LogPhaseStats()
+{
+    AuthPhaseStats stats[MAX_AUTH_PHASE];
+    {
+        TRINITY_GUARD(ACE_Thread_Mutex, PhaseStatsLock);
+        for (uint8 i = 0; i < MAX_AUTH_PHASE; ++i)
+        {
+            stats[i] = PhaseStats[i];
+            PhaseStats[i] = AuthPhaseStats();
+        }
+    }
+
+    for (uint8 i = 0; i < MAX_AUTH_PHASE; ++i)
+    {
+        if (!stats[i].count)
+            continue;
+
+        TC_LOG_INFO("server.authserver", "Phase %s: " UI64FMTD " handled, avg " UI64FMTD " us, max " UI64FMTD " us",
+            PhaseNames[i], stats[i].count, stats[i].totalTime / stats[i].count, stats[i].maxTime);
+    }
+}
+
+// Runs one logon step of a connection on a logon worker
+class AuthStepRequest : public ACE_Method_Request
+{
+public:
+    AuthStepRequest(AuthSocket* session, AuthSocket::AsyncStep step, AuthSocket::QueryResults const& results) :
+        _session(session), _step(step), _results(results) { }
+
+    int call()
+    {
+        (_session->*_step)(_results);
+        return 0;
+    }
+
+private:
+    AuthSocket* _session;
+    AuthSocket::AsyncStep _step;
+    AuthSocket::QueryResults _results;
+};
+
+// Runs LoginDatabase lookups on the asynchronous connections and queues the next logon step once all of them returned.
+// The step gets the results in the order the lookups were added. Deletes itself when the step is queued.
+class AuthQueryJoin : public ACE_Future_Observer<PreparedQueryResult>
+{
+public:
+    AuthQueryJoin(AuthSocket* session, AuthSocket::AsyncStep step) : _session(session), _step(step), _pending(1) { }
+
+    void Add(PreparedStatement* stmt)
+    {
+        _futures.push_back(LoginDatabase.AsyncQuery(stmt, SQL_PRIORITY_INTERACTIVE));
+    }
+
+    // Called once all lookups were added, this may be the last use of the object
+    void Start()
+    {
+        _pending = long(_futures.size()) + 1;
+        for (size_t i = 0; i < _futures.size(); ++i)
+            _futures[i].attach(this);                       // Calls update right away for a lookup that already returned
+
+        Done();
+    }
+
+    // Called by the database worker that set the result
+    void update(ACE_Future<PreparedQueryResult> const& /*future*/)
+    {
+        Done();
+    }
+
+private:
+    void Done()
+    {
+        if (--_pending != 0)
+            return;
+
+        AuthSocket::QueryResults results(_futures.size());
+        for (size_t i = 0; i < _futures.size(); ++i)
+            _futures[i].get(results[i]);
+
+        sAuthWorkerPool->Enqueue(new AuthStepRequest(_session, _step, results));
+        delete this;
+    }
+
+    AuthSocket* _session;
+    AuthSocket::AsyncStep _step;
+    std::vector<PreparedQueryResultFuture> _futures;
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> _pending;
+};
+
+// Part of a realm list entry that does not depend on the requesting account
+struct RealmListEntry
+{
+    Realm realm;
+    uint8 flag;
+    std::string name;
+    ByteBuffer tail;                                        // Everything after the character count
+};
+
+// Realm list entries for one client build, rebuilt when the realm list version changes
+struct RealmListCache
+{
+    uint32 version;
+    std::vector<RealmListEntry> entries;
+};
+
+typedef Trinity::AutoPtr<RealmListCache, ACE_Thread_Mutex> RealmListCachePtr;
+
+// Keyed by client build and expansion flags
+static std::map<uint32, RealmListCachePtr> RealmListCaches;
+static ACE_Thread_Mutex RealmListCachesLock;
+
+static RealmListCachePtr GetRealmListCache(uint16 build, uint8 expversion)
+{
+    uint32 key = (uint32(build) << 8) | expversion;
+
+    {
+        TRINITY_GUARD(ACE_Thread_Mutex, RealmListCachesLock);
+        std::map<uint32, RealmListCachePtr>::const_iterator itr = RealmListCaches.find(key);
+        if (itr != RealmListCaches.end() && itr->second->version == sRealmList->GetVersion())
+            return itr->second;
+    }
+
+    RealmListCachePtr cache(new RealmListCache());
+    RealmList::RealmMap realms = sRealmList->GetRealms(&cache->version);
+
+    for (RealmList::RealmMap::const_iterator i = realms.begin(); i != realms.end(); ++i)
+    {
+        const Realm &realm = i->second;
+        // don't work with realms which not compatible with the client
+        bool okBuild = ((expversion & POST_BC_EXP_FLAG) && realm.gamebuild == build) || ((expversion & PRE_BC_EXP_FLAG) && !AuthHelper::IsPreBCAcceptedClientBuild(realm.gamebuild));
+
+        // No SQL injection. id of realm is controlled by the database.
+        uint32 flag = realm.flag;
+        RealmBuildInfo const* buildInfo = AuthHelper::GetBuildInfo(realm.gamebuild);
+        if (!okBuild)
+        {
+            if (!buildInfo)
+                continue;
+
+            flag |= REALM_FLAG_OFFLINE | REALM_FLAG_SPECIFYBUILD;   // tell the client what build the realm is for
+        }
+
+        if (!buildInfo)
+            flag &= ~REALM_FLAG_SPECIFYBUILD;
+
+        std::string name = i->first;
+        if (expversion & PRE_BC_EXP_FLAG && flag & REALM_FLAG_SPECIFYBUILD)
+        {
+            std::ostringstream ss;
+            ss << name << " (" << buildInfo->MajorVersion << '.' << buildInfo->MinorVersion << '.' << buildInfo->BugfixVersion << ')';
+            name = ss.str();
+        }
+
+        RealmListEntry entry;
+        entry.realm = realm;
+        entry.flag = uint8(flag);
+        entry.name = name;
+
+        entry.tail << realm.timezone;                       // realm category
+        if (expversion & POST_BC_EXP_FLAG)                  // 2.x and 3.x clients
+            entry.tail << uint8(0x2C);                      // unk, may be realm number/id?
+        else
+            entry.tail << uint8(0x0);                       // 1.12.1 and 1.12.2 clients
+
+        if (expversion & POST_BC_EXP_FLAG && flag & REALM_FLAG_SPECIFYBUILD)
+        {
+            entry.tail << uint8(buildInfo->MajorVersion);
+            entry.tail << uint8(buildInfo->MinorVersion);
+            entry.tail << uint8(buildInfo->BugfixVersion);
+            entry.tail << uint16(buildInfo->Build);
+        }
+
+        cache->entries.push_back(entry);
+    }
+
+    TRINITY_GUARD(ACE_Thread_Mutex, RealmListCachesLock);
+    RealmListCaches[key] = cache;
+    return cache;
+}
+
 // Constructor - set the N and g values for SRP6
 AuthSocket::AuthSocket(RealmSocket& socket) :
-    pPatch(NULL), socket_(socket), _authed(false), _build(0),
-    _expversion(0), _accountSecurityLevel(SEC_PLAYER)
+    pPatch(NULL), socket_(socket), _authed(false), _asyncPending(0), _asyncStarted(false), _closeRequested(false),
+    _currentPhase(AUTH_PHASE_NONE), _proofHasToken(false), _build(0),
+    _expversion(0), _accountSecurityLevel(SEC_PLAYER), _realmCharactersLoaded(false)
 {
     N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
     g.SetDword(7);
@@ -226,6 +445,16 @@ void AuthSocket::OnRead()
     uint8 _cmd;
     while (1)
     {
+        // A logon step is still running on a logon worker, it resumes reading once it is done
+        if (_asyncPending.value())
+            return;
+
+        if (_closeRequested)
+        {
+            socket().shutdown();
+            return;
+        }
+
         if (!socket().recv_soft((char *)&_cmd, 1))
             return;
 
@@ -249,7 +478,17 @@ void AuthSocket::OnRead()
             {
                 TC_LOG_DEBUG("server.authserver", "Got data for cmd %u recv length %u", (uint32)_cmd, (uint32)socket().recv_len());
 
-                if (!(*this.*table[i].handler)())
+                _currentPhase = table[i].phase;
+                _phaseStart = ACE_OS::gettimeofday();
+                bool handled = (*this.*table[i].handler)();
+
+                // Phases handed to the logon workers are timed when their last step is done
+                if (_asyncStarted)
+                    _asyncStarted = false;
+                else if (_currentPhase != AUTH_PHASE_NONE)
+                    RecordPhaseTime(_currentPhase, _phaseStart);
+
+                if (!handled)
                 {
                     TC_LOG_DEBUG("server.authserver", "Command handler failed for cmd %u recv length %u", (uint32)_cmd, (uint32)socket().recv_len());
                     return;
@@ -268,6 +507,36 @@ void AuthSocket::OnRead()
     }
 }
 
+void AuthSocket::_BeginAsync()
+{
+    // Keeps the socket and with it this session alive until _EndAsync
+    socket().add_reference();
+    _asyncStarted = true;
+    _asyncPending = 1;
+}
+
+void AuthSocket::_QueueStep(AsyncStep step)
+{
+    sAuthWorkerPool->Enqueue(new AuthStepRequest(this, step, QueryResults()));
+}
+
+void AuthSocket::_EndAsync(bool close)
+{
+    if (_currentPhase != AUTH_PHASE_NONE)
+        RecordPhaseTime(_currentPhase, _phaseStart);
+
+    // Sockets are only closed by the network threads
+    if (close)
+        _closeRequested = true;
+
+    // Releases the session state to the network threads, they continue with the input that arrived meanwhile
+    _asyncPending = 0;
+    socket().resume_input();
+
+    // May delete this session
+    socket().remove_reference();
+}
+
 // Make the SRP6 calculation from hash in dB
 void AuthSocket::_SetVSFields(const std::string& rI)
 {
@@ -352,8 +621,6 @@ bool AuthSocket::_HandleLogonChallenge()
     EndianConvert(ch->ip);
 #endif
 
-    ByteBuffer pkt;
-
     _login = (const char*)ch->I;
     _build = ch->build;
     _expversion = uint8(AuthHelper::IsPostBCAcceptedClientBuild(_build) ? POST_BC_EXP_FLAG : (AuthHelper::IsPreBCAcceptedClientBuild(_build) ? PRE_BC_EXP_FLAG : NO_VALID_EXP_FLAG));
@@ -365,191 +632,240 @@ bool AuthSocket::_HandleLogonChallenge()
     // Restore string order as its byte order is reversed
     std::reverse(_os.begin(), _os.end());
 
-    pkt << uint8(AUTH_LOGON_CHALLENGE);
-    pkt << uint8(0x00);
+    _localizationName.resize(4);
+    for (int i = 0; i < 4; ++i)
+        _localizationName[i] = ch->country[4-i-1];
 
     // Verify that this IP is not in the ip_banned table
     LoginDatabase.Execute(LoginDatabase.GetPreparedStatement(LOGIN_DEL_EXPIRED_IP_BANS));
 
-    std::string const& ip_address = socket().getRemoteAddress();
+    // The ban and account lookups run in parallel on the LoginDatabase workers, _LogonChallengeAccountStep continues once both returned
+    AuthQueryJoin* lookups = new AuthQueryJoin(this, &AuthSocket::_LogonChallengeAccountStep);
+
     PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_IP_BANNED);
-    stmt->setString(0, ip_address);
-    PreparedQueryResult result = LoginDatabase.Query(stmt);
-    if (result)
+    stmt->setString(0, socket().getRemoteAddress());
+    lookups->Add(stmt);
+
+    // Get the account details from the account table
+    // No SQL injection (prepared statement)
+    stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_LOGONCHALLENGE);
+    stmt->setString(0, _login);
+    lookups->Add(stmt);
+
+    _BeginAsync();
+    lookups->Start();
+    return true;
+}
+
+// Logon challenge, continued with the ip ban and the account row
+void AuthSocket::_LogonChallengeAccountStep(QueryResults const& results)
+{
+    ByteBuffer pkt;
+    pkt << uint8(AUTH_LOGON_CHALLENGE);
+    pkt << uint8(0x00);
+
+    std::string const& ip_address = socket().getRemoteAddress();
+    if (results[0])
     {
         pkt << uint8(WOW_FAIL_BANNED);
         TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] Banned ip tries to login!", socket().getRemoteAddress().c_str(), socket().getRemotePort());
+        socket().send((char const*)pkt.contents(), pkt.size());
+        _EndAsync(false);
+        return;
+    }
+
+    if (!results[1])                                        //no account
+    {
+        pkt << uint8(WOW_FAIL_UNKNOWN_ACCOUNT);
+        socket().send((char const*)pkt.contents(), pkt.size());
+        _EndAsync(false);
+        return;
+    }
+
+    _accountResult = results[1];
+    Field* fields = _accountResult->Fetch();
+    bool checkCountry = false;
+
+    // If the IP is 'locked', check that the player comes indeed from the correct IP address
+    if (fields[2].GetUInt8() == 1)                          // if ip is locked
+    {
+        TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), fields[3].GetCString());
+        TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Player address is '%s'", ip_address.c_str());
+
+        if (strcmp(fields[4].GetCString(), ip_address.c_str()) != 0)
+        {
+            TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account IP differs");
+            pkt << uint8(WOW_FAIL_LOCKED_ENFORCED);
+            socket().send((char const*)pkt.contents(), pkt.size());
+            _accountResult = PreparedQueryResult(NULL);
+            _EndAsync(false);
+            return;
+        }
+        else
+            TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account IP matches");
     }
     else
     {
-        // Get the account details from the account table
-        // No SQL injection (prepared statement)
-        stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_LOGONCHALLENGE);
-        stmt->setString(0, _login);
+        TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
+        std::string accountCountry = fields[3].GetString();
+        if (accountCountry.empty() || accountCountry == "00")
+            TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account '%s' is not locked to country", _login.c_str());
+        else
+            checkCountry = true;
+    }
+
+    //set expired bans to inactive
+    LoginDatabase.Execute(LoginDatabase.GetPreparedStatement(LOGIN_UPD_EXPIRED_ACCOUNT_BANS));
 
-        PreparedQueryResult res2 = LoginDatabase.Query(stmt);
-        if (res2)
+    // The ban and the country of the client are looked up together, the ban only counts once the country matched
+    AuthQueryJoin* lookups = new AuthQueryJoin(this, &AuthSocket::_LogonChallengeBanStep);
+
+    PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_ACCOUNT_BANNED);
+    stmt->setUInt32(0, fields[1].GetUInt32());
+    lookups->Add(stmt);
+
+    if (checkCountry)
+    {
+        uint32 ip = inet_addr(ip_address.c_str());
+        EndianConvertReverse(ip);
+
+        stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_LOGON_COUNTRY);
+        stmt->setUInt32(0, ip);
+        lookups->Add(stmt);
+    }
+
+    lookups->Start();
+}
+
+// Logon challenge, continued with the account ban and, for accounts locked to a country, the country of the client
+void AuthSocket::_LogonChallengeBanStep(QueryResults const& results)
+{
+    ByteBuffer pkt;
+    pkt << uint8(AUTH_LOGON_CHALLENGE);
+    pkt << uint8(0x00);
+
+    PreparedQueryResult account = _accountResult;
+    _accountResult = PreparedQueryResult(NULL);
+    Field* fields = account->Fetch();
+
+    bool locked = false;
+    if (results.size() > 1)
+    {
+        std::string accountCountry = fields[3].GetString();
+        if (PreparedQueryResult sessionCountryQuery = results[1])
         {
-            Field* fields = res2->Fetch();
+            std::string loginCountry = (*sessionCountryQuery)[0].GetString();
+            TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account '%s' is locked to country: '%s' Player country is '%s'", _login.c_str(), accountCountry.c_str(), loginCountry.c_str());
+            if (loginCountry != accountCountry)
+            {
+                TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account country differs.");
+                pkt << uint8(WOW_FAIL_UNLOCKABLE_LOCK);
+                locked = true;
+            }
+            else
+                TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account country matches");
+        }
+        else
+            TC_LOG_DEBUG("server.authserver", "[AuthChallenge] IP2NATION Table empty");
+    }
 
-            // If the IP is 'locked', check that the player comes indeed from the correct IP address
-            bool locked = false;
-            if (fields[2].GetUInt8() == 1)                  // if ip is locked
+    if (!locked)
+    {
+        // If the account is banned, reject the logon attempt
+        if (PreparedQueryResult banresult = results[0])
+        {
+            if ((*banresult)[0].GetUInt32() == (*banresult)[1].GetUInt32())
+            {
+                pkt << uint8(WOW_FAIL_BANNED);
+                TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] Banned account %s tried to login!", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str ());
+            }
+            else
             {
-                TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), fields[3].GetCString());
-                TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Player address is '%s'", ip_address.c_str());
+                pkt << uint8(WOW_FAIL_SUSPENDED);
+                TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] Temporarily banned account %s tried to login!", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str ());
+            }
+        }
+        else
+        {
+            // Get the password from the account table, upper it, and make the SRP6 calculation
+            std::string rI = fields[0].GetString();
 
-                if (strcmp(fields[4].GetCString(), ip_address.c_str()) != 0)
-                {
-                    TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account IP differs");
-                    pkt << uint8(WOW_FAIL_LOCKED_ENFORCED);
-                    locked = true;
-                }
-                else
-                    TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account IP matches");
+            // Don't calculate (v, s) if there are already some in the database
+            std::string databaseV = fields[6].GetString();
+            std::string databaseS = fields[7].GetString();
+
+            TC_LOG_DEBUG("network", "database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
+
+            // multiply with 2 since bytes are stored as hexstring
+            if (databaseV.size() != s_BYTE_SIZE * 2 || databaseS.size() != s_BYTE_SIZE * 2)
+                _SetVSFields(rI);
+            else
+            {
+                s.SetHexStr(databaseS.c_str());
+                v.SetHexStr(databaseV.c_str());
             }
+
+            b.SetRand(19 * 8);
+            BigNumber gmod = g.ModExp(b, N);
+            B = ((v * 3) + gmod) % N;
+
+            ASSERT(gmod.GetNumBytes() <= 32);
+
+            BigNumber unk3;
+            unk3.SetRand(16 * 8);
+
+            // Fill the response packet with the result
+            if (AuthHelper::IsAcceptedClientBuild(_build))
+                pkt << uint8(WOW_SUCCESS);
             else
+                pkt << uint8(WOW_FAIL_VERSION_INVALID);
+
+            // B may be calculated < 32B so we force minimal length to 32B
+            pkt.append(B.AsByteArray(32).get(), 32);      // 32 bytes
+            pkt << uint8(1);
+            pkt.append(g.AsByteArray().get(), 1);
+            pkt << uint8(32);
+            pkt.append(N.AsByteArray(32).get(), 32);
+            pkt.append(s.AsByteArray().get(), s.GetNumBytes());   // 32 bytes
+            pkt.append(unk3.AsByteArray(16).get(), 16);
+            uint8 securityFlags = 0;
+
+            // Check if token is used
+            _tokenKey = fields[8].GetString();
+            if (!_tokenKey.empty())
+                securityFlags = 4;
+
+            pkt << uint8(securityFlags);            // security flags (0x0...0x04)
+
+            if (securityFlags & 0x01)               // PIN input
             {
-                TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
-                std::string accountCountry = fields[3].GetString();
-                if (accountCountry.empty() || accountCountry == "00")
-                    TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account '%s' is not locked to country", _login.c_str());
-                else if (!accountCountry.empty())
-                {
-                    uint32 ip = inet_addr(ip_address.c_str());
-                    EndianConvertReverse(ip);
-
-                    stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_LOGON_COUNTRY);
-                    stmt->setUInt32(0, ip);
-                    if (PreparedQueryResult sessionCountryQuery = LoginDatabase.Query(stmt))
-                    {
-                        std::string loginCountry = (*sessionCountryQuery)[0].GetString();
-                        TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account '%s' is locked to country: '%s' Player country is '%s'", _login.c_str(), accountCountry.c_str(), loginCountry.c_str());
-                        if (loginCountry != accountCountry)
-                        {
-                            TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account country differs.");
-                            pkt << uint8(WOW_FAIL_UNLOCKABLE_LOCK);
-                            locked = true;
-                        }
-                        else
-                            TC_LOG_DEBUG("server.authserver", "[AuthChallenge] Account country matches");
-                    }
-                    else
-                        TC_LOG_DEBUG("server.authserver", "[AuthChallenge] IP2NATION Table empty");
-                }
+                pkt << uint32(0);
+                pkt << uint64(0) << uint64(0);      // 16 bytes hash?
             }
 
-            if (!locked)
+            if (securityFlags & 0x02)               // Matrix input
             {
-                //set expired bans to inactive
-                LoginDatabase.Execute(LoginDatabase.GetPreparedStatement(LOGIN_UPD_EXPIRED_ACCOUNT_BANS));
-
-                // If the account is banned, reject the logon attempt
-                stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_ACCOUNT_BANNED);
-                stmt->setUInt32(0, fields[1].GetUInt32());
-                PreparedQueryResult banresult = LoginDatabase.Query(stmt);
-                if (banresult)
-                {
-                    if ((*banresult)[0].GetUInt32() == (*banresult)[1].GetUInt32())
-                    {
-                        pkt << uint8(WOW_FAIL_BANNED);
-                        TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] Banned account %s tried to login!", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str ());
-                    }
-                    else
-                    {
-                        pkt << uint8(WOW_FAIL_SUSPENDED);
-                        TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] Temporarily banned account %s tried to login!", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str ());
-                    }
-                }
-                else
-                {
-                    // Get the password from the account table, upper it, and make the SRP6 calculation
-                    std::string rI = fields[0].GetString();
-
-                    // Don't calculate (v, s) if there are already some in the database
-                    std::string databaseV = fields[6].GetString();
-                    std::string databaseS = fields[7].GetString();
-
-                    TC_LOG_DEBUG("network", "database authentication values: v='%s' s='%s'", databaseV.c_str(), databaseS.c_str());
-
-                    // multiply with 2 since bytes are stored as hexstring
-                    if (databaseV.size() != s_BYTE_SIZE * 2 || databaseS.size() != s_BYTE_SIZE * 2)
-                        _SetVSFields(rI);
-                    else
-                    {
-                        s.SetHexStr(databaseS.c_str());
-                        v.SetHexStr(databaseV.c_str());
-                    }
-
-                    b.SetRand(19 * 8);
-                    BigNumber gmod = g.ModExp(b, N);
-                    B = ((v * 3) + gmod) % N;
-
-                    ASSERT(gmod.GetNumBytes() <= 32);
-
-                    BigNumber unk3;
-                    unk3.SetRand(16 * 8);
-
-                    // Fill the response packet with the result
-                    if (AuthHelper::IsAcceptedClientBuild(_build))
-                        pkt << uint8(WOW_SUCCESS);
-                    else
-                        pkt << uint8(WOW_FAIL_VERSION_INVALID);
-
-                    // B may be calculated < 32B so we force minimal length to 32B
-                    pkt.append(B.AsByteArray(32).get(), 32);      // 32 bytes
-                    pkt << uint8(1);
-                    pkt.append(g.AsByteArray().get(), 1);
-                    pkt << uint8(32);
-                    pkt.append(N.AsByteArray(32).get(), 32);
-                    pkt.append(s.AsByteArray().get(), s.GetNumBytes());   // 32 bytes
-                    pkt.append(unk3.AsByteArray(16).get(), 16);
-                    uint8 securityFlags = 0;
-
-                    // Check if token is used
-                    _tokenKey = fields[8].GetString();
-                    if (!_tokenKey.empty())
-                        securityFlags = 4;
-
-                    pkt << uint8(securityFlags);            // security flags (0x0...0x04)
-
-                    if (securityFlags & 0x01)               // PIN input
-                    {
-                        pkt << uint32(0);
-                        pkt << uint64(0) << uint64(0);      // 16 bytes hash?
-                    }
-
-                    if (securityFlags & 0x02)               // Matrix input
-                    {
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint8(0);
-                        pkt << uint64(0);
-                    }
-
-                    if (securityFlags & 0x04)               // Security token input
-                        pkt << uint8(1);
-
-                    uint8 secLevel = fields[5].GetUInt8();
-                    _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
-
-                    _localizationName.resize(4);
-                    for (int i = 0; i < 4; ++i)
-                        _localizationName[i] = ch->country[4-i-1];
-
-                    TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] account %s is using '%c%c%c%c' locale (%u)", socket().getRemoteAddress().c_str(), socket().getRemotePort(),
-                            _login.c_str (), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(_localizationName)
-                        );
-                }
+                pkt << uint8(0);
+                pkt << uint8(0);
+                pkt << uint8(0);
+                pkt << uint8(0);
+                pkt << uint64(0);
             }
+
+            if (securityFlags & 0x04)               // Security token input
+                pkt << uint8(1);
+
+            uint8 secLevel = fields[5].GetUInt8();
+            _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
+
+            TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] account %s is using '%s' locale (%u)", socket().getRemoteAddress().c_str(), socket().getRemotePort(),
+                    _login.c_str (), _localizationName.c_str(), GetLocaleByName(_localizationName)
+                );
         }
-        else                                                //no account
-            pkt << uint8(WOW_FAIL_UNKNOWN_ACCOUNT);
     }
 
     socket().send((char const*)pkt.contents(), pkt.size());
-    return true;
+    _EndAsync(false);
 }
 
 // Logon Proof command handler
@@ -559,9 +875,26 @@ bool AuthSocket::_HandleLogonProof()
     // Read the packet
     sAuthLogonProof_C lp;
 
-    if (!socket().recv((char *)&lp, sizeof(sAuthLogonProof_C)))
+    if (!socket().recv_soft((char *)&lp, sizeof(sAuthLogonProof_C)))
         return false;
 
+    // The authenticator token follows the proof, wait until it arrived as well
+    bool hasToken = (lp.securityFlags & 0x04) || !_tokenKey.empty();
+    std::vector<char> buf(sizeof(sAuthLogonProof_C) + 1);
+    if (hasToken)
+    {
+        if (!socket().recv_soft(&buf[0], buf.size()))
+            return false;
+
+        buf.resize(buf.size() + uint8(buf.back()));
+        if (!socket().recv_soft(&buf[0], buf.size()))
+            return false;
+    }
+    else
+        buf.resize(sizeof(sAuthLogonProof_C));
+
+    socket().recv_skip(buf.size());
+
     // If the client has no valid version
     if (_expversion == NO_VALID_EXP_FLAG)
     {
@@ -571,16 +904,31 @@ bool AuthSocket::_HandleLogonProof()
         return true;
     }
 
+    memcpy(_proofA, lp.A, sizeof(_proofA));
+    memcpy(_proofM1, lp.M1, sizeof(_proofM1));
+    _proofHasToken = hasToken;
+    if (hasToken)
+        _proofToken.assign(&buf[sizeof(sAuthLogonProof_C) + 1], buf.size() - sizeof(sAuthLogonProof_C) - 1);
+
+    // The SRP6 math runs on a logon worker
+    _BeginAsync();
+    _QueueStep(&AuthSocket::_LogonProofStep);
+    return true;
+}
+
+// Logon proof, verifies the SRP6 proof of the client
+void AuthSocket::_LogonProofStep(QueryResults const& /*results*/)
+{
     // Continue the SRP6 calculation based on data received from the client
     BigNumber A;
 
-    A.SetBinary(lp.A, 32);
+    A.SetBinary(_proofA, 32);
 
     // SRP safeguard: abort if A == 0
     if (A.isZero())
     {
-        socket().shutdown();
-        return true;
+        _EndAsync(true);
+        return;
     }
 
     SHA1Hash sha;
@@ -648,7 +996,7 @@ bool AuthSocket::_HandleLogonProof()
     M.SetBinary(sha.GetDigest(), 20);
 
     // Check if SRP6 results match (password is correct), else send an error
-    if (!memcmp(M.AsByteArray().get(), lp.M1, 20))
+    if (!memcmp(M.AsByteArray().get(), _proofM1, 20))
     {
         TC_LOG_DEBUG("server.authserver", "'%s:%d' User '%s' successfully authenticated", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str());
 
@@ -672,21 +1020,16 @@ bool AuthSocket::_HandleLogonProof()
         sha.Finalize();
 
         // Check auth token
-        if ((lp.securityFlags & 0x04) || !_tokenKey.empty())
+        if (_proofHasToken)
         {
-            uint8 size;
-            socket().recv((char*)&size, 1);
-            char* token = new char[size + 1];
-            token[size] = '\0';
-            socket().recv(token, size);
             unsigned int validToken = TOTP::GenerateToken(_tokenKey.c_str());
-            unsigned int incomingToken = atoi(token);
-            delete[] token;
+            unsigned int incomingToken = atoi(_proofToken.c_str());
             if (validToken != incomingToken)
             {
                 char data[] = { AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT, 3, 0 };
                 socket().send(data, sizeof(data));
-                return false;
+                _EndAsync(false);
+                return;
             }
         }
 
@@ -712,61 +1055,72 @@ bool AuthSocket::_HandleLogonProof()
         }
 
         _authed = true;
+        _EndAsync(false);
+        return;
     }
-    else
+
+    char data[4] = { AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT, 3, 0 };
+    socket().send(data, sizeof(data));
+
+    TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] account %s tried to login with invalid password!", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str ());
+
+    uint32 MaxWrongPassCount = sConfigMgr->GetIntDefault("WrongPass.MaxCount", 0);
+    if (!MaxWrongPassCount)
     {
-        char data[4] = { AUTH_LOGON_PROOF, WOW_FAIL_UNKNOWN_ACCOUNT, 3, 0 };
-        socket().send(data, sizeof(data));
+        _EndAsync(false);
+        return;
+    }
 
-        TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] account %s tried to login with invalid password!", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str ());
+    //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
+    PreparedStatement *stmt = LoginDatabase.GetPreparedStatement(LOGIN_UPD_FAILEDLOGINS);
+    stmt->setString(0, _login);
+    LoginDatabase.Execute(stmt);
+
+    AuthQueryJoin* lookups = new AuthQueryJoin(this, &AuthSocket::_FailedLoginsStep);
+    stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_FAILEDLOGINS);
+    stmt->setString(0, _login);
+    lookups->Add(stmt);
+    lookups->Start();
+}
 
+// Logon proof with a wrong password, bans the account or ip once it failed too often
+void AuthSocket::_FailedLoginsStep(QueryResults const& results)
+{
+    if (PreparedQueryResult loginfail = results[0])
+    {
+        uint32 failed_logins = (*loginfail)[1].GetUInt32();
         uint32 MaxWrongPassCount = sConfigMgr->GetIntDefault("WrongPass.MaxCount", 0);
-        if (MaxWrongPassCount > 0)
-        {
-            //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
-            PreparedStatement *stmt = LoginDatabase.GetPreparedStatement(LOGIN_UPD_FAILEDLOGINS);
-            stmt->setString(0, _login);
-            LoginDatabase.Execute(stmt);
 
-            stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_FAILEDLOGINS);
-            stmt->setString(0, _login);
+        if (failed_logins >= MaxWrongPassCount)
+        {
+            uint32 WrongPassBanTime = sConfigMgr->GetIntDefault("WrongPass.BanTime", 600);
+            bool WrongPassBanType = sConfigMgr->GetBoolDefault("WrongPass.BanType", false);
 
-            if (PreparedQueryResult loginfail = LoginDatabase.Query(stmt))
+            if (WrongPassBanType)
             {
-                uint32 failed_logins = (*loginfail)[1].GetUInt32();
+                uint32 acc_id = (*loginfail)[0].GetUInt32();
+                PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_INS_ACCOUNT_AUTO_BANNED);
+                stmt->setUInt32(0, acc_id);
+                stmt->setUInt32(1, WrongPassBanTime);
+                LoginDatabase.Execute(stmt);
+
+                TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
+                    socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str(), WrongPassBanTime, failed_logins);
+            }
+            else
+            {
+                PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_INS_IP_AUTO_BANNED);
+                stmt->setString(0, socket().getRemoteAddress());
+                stmt->setUInt32(1, WrongPassBanTime);
+                LoginDatabase.Execute(stmt);
 
-                if (failed_logins >= MaxWrongPassCount)
-                {
-                    uint32 WrongPassBanTime = sConfigMgr->GetIntDefault("WrongPass.BanTime", 600);
-                    bool WrongPassBanType = sConfigMgr->GetBoolDefault("WrongPass.BanType", false);
-
-                    if (WrongPassBanType)
-                    {
-                        uint32 acc_id = (*loginfail)[0].GetUInt32();
-                        stmt = LoginDatabase.GetPreparedStatement(LOGIN_INS_ACCOUNT_AUTO_BANNED);
-                        stmt->setUInt32(0, acc_id);
-                        stmt->setUInt32(1, WrongPassBanTime);
-                        LoginDatabase.Execute(stmt);
-
-                        TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
-                            socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str(), WrongPassBanTime, failed_logins);
-                    }
-                    else
-                    {
-                        stmt = LoginDatabase.GetPreparedStatement(LOGIN_INS_IP_AUTO_BANNED);
-                        stmt->setString(0, socket().getRemoteAddress());
-                        stmt->setUInt32(1, WrongPassBanTime);
-                        LoginDatabase.Execute(stmt);
-
-                        TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
-                            socket().getRemoteAddress().c_str(), socket().getRemotePort(), socket().getRemoteAddress().c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
-                    }
-                }
+                TC_LOG_DEBUG("server.authserver", "'%s:%d' [AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
+                    socket().getRemoteAddress().c_str(), socket().getRemotePort(), socket().getRemoteAddress().c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
             }
         }
     }
 
-    return true;
+    _EndAsync(false);
 }
 
 // Reconnect Challenge command handler
@@ -802,31 +1156,43 @@ bool AuthSocket::_HandleReconnectChallenge()
     TC_LOG_DEBUG("server.authserver", "[ReconnectChallenge] got full packet, %#04x bytes", ch->size);
     TC_LOG_DEBUG("server.authserver", "[ReconnectChallenge] name(%d): '%s'", ch->I_len, ch->I);
 
+    std::string os = (const char*)ch->os;
+    if (os.size() > 4)
+        return false;
+
     _login = (const char*)ch->I;
 
+    // Reinitialize build, expansion and the account securitylevel
+    _build = ch->build;
+    _expversion = uint8(AuthHelper::IsPostBCAcceptedClientBuild(_build) ? POST_BC_EXP_FLAG : (AuthHelper::IsPreBCAcceptedClientBuild(_build) ? PRE_BC_EXP_FLAG : NO_VALID_EXP_FLAG));
+    _os = os;
+
+    // Restore string order as its byte order is reversed
+    std::reverse(_os.begin(), _os.end());
+
+    AuthQueryJoin* lookups = new AuthQueryJoin(this, &AuthSocket::_ReconnectChallengeStep);
     PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_SESSIONKEY);
     stmt->setString(0, _login);
-    PreparedQueryResult result = LoginDatabase.Query(stmt);
+    lookups->Add(stmt);
+
+    _BeginAsync();
+    lookups->Start();
+    return true;
+}
+
+// Reconnect challenge, continued with the session key of the account
+void AuthSocket::_ReconnectChallengeStep(QueryResults const& results)
+{
+    PreparedQueryResult result = results[0];
 
     // Stop if the account is not found
     if (!result)
     {
         TC_LOG_ERROR("server.authserver", "'%s:%d' [ERROR] user %s tried to login and we cannot find his session key in the database.", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str());
-        socket().shutdown();
-        return false;
+        _EndAsync(true);
+        return;
     }
 
-    // Reinitialize build, expansion and the account securitylevel
-    _build = ch->build;
-    _expversion = uint8(AuthHelper::IsPostBCAcceptedClientBuild(_build) ? POST_BC_EXP_FLAG : (AuthHelper::IsPreBCAcceptedClientBuild(_build) ? PRE_BC_EXP_FLAG : NO_VALID_EXP_FLAG));
-    _os = (const char*)ch->os;
-
-    if (_os.size() > 4)
-        return false;
-
-    // Restore string order as its byte order is reversed
-    std::reverse(_os.begin(), _os.end());
-
     Field* fields = result->Fetch();
     uint8 secLevel = fields[2].GetUInt8();
     _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
@@ -841,7 +1207,7 @@ bool AuthSocket::_HandleReconnectChallenge()
     pkt.append(_reconnectProof.AsByteArray(16).get(), 16);        // 16 bytes random
     pkt << uint64(0x00) << uint64(0x00);                    // 16 bytes zeros
     socket().send((char const*)pkt.contents(), pkt.size());
-    return true;
+    _EndAsync(false);
 }
 
 // Reconnect Proof command handler
@@ -915,23 +1281,42 @@ bool AuthSocket::_HandleRealmList()
 
     socket().recv_skip(5);
 
-    // Get the user id (else close the connection)
-    // No SQL injection (prepared statement)
-    PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_ACCOUNT_ID_BY_NAME);
-    stmt->setString(0, _login);
-    PreparedQueryResult result = LoginDatabase.Query(stmt);
-    if (!result)
+    // Character counts are loaded once per connection, the client requests the list repeatedly while the realm list is shown
+    if (!_realmCharactersLoaded)
     {
-        TC_LOG_ERROR("server.authserver", "'%s:%d' [ERROR] user %s tried to login but we cannot find him in the database.", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str());
-        socket().shutdown();
-        return false;
-    }
+        // Get the user id (else close the connection)
+        // No SQL injection (prepared statement)
+        PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_ACCOUNT_ID_BY_NAME);
+        stmt->setString(0, _login);
+        PreparedQueryResult result = LoginDatabase.Query(stmt);
+        if (!result)
+        {
+            TC_LOG_ERROR("server.authserver", "'%s:%d' [ERROR] user %s tried to login but we cannot find him in the database.", socket().getRemoteAddress().c_str(), socket().getRemotePort(), _login.c_str());
+            socket().shutdown();
+            return false;
+        }
 
-    Field* fields = result->Fetch();
-    uint32 id = fields[0].GetUInt32();
+        Field* fields = result->Fetch();
+        uint32 id = fields[0].GetUInt32();
+
+        // One lookup for all realms instead of one per realm
+        stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_REALM_CHARACTERS_BY_ACCOUNT);
+        stmt->setUInt32(0, id);
+        if (PreparedQueryResult counts = LoginDatabase.Query(stmt))
+        {
+            do
+            {
+                fields = counts->Fetch();
+                _realmCharacters[fields[0].GetUInt32()] = fields[1].GetUInt8();
+            }
+            while (counts->NextRow());
+        }
 
-    // Update realm list if need
-    sRealmList->UpdateIfNeed();
+        _realmCharactersLoaded = true;
+    }
+
+    // Realm data is shared by all clients of the same build and only rebuilt when realms change
+    RealmListCachePtr cache = GetRealmListCache(_build, _expversion);
 
     ACE_INET_Addr clientAddr;
     socket().peer().get_remote_addr(clientAddr);
@@ -940,33 +1325,9 @@ bool AuthSocket::_HandleRealmList()
     ByteBuffer pkt;
 
     size_t RealmListSize = 0;
-    for (RealmList::RealmMap::const_iterator i = sRealmList->begin(); i != sRealmList->end(); ++i)
+    for (std::vector<RealmListEntry>::const_iterator i = cache->entries.begin(); i != cache->entries.end(); ++i)
     {
-        const Realm &realm = i->second;
-        // don't work with realms which not compatible with the client
-        bool okBuild = ((_expversion & POST_BC_EXP_FLAG) && realm.gamebuild == _build) || ((_expversion & PRE_BC_EXP_FLAG) && !AuthHelper::IsPreBCAcceptedClientBuild(realm.gamebuild));
-
-        // No SQL injection. id of realm is controlled by the database.
-        uint32 flag = realm.flag;
-        RealmBuildInfo const* buildInfo = AuthHelper::GetBuildInfo(realm.gamebuild);
-        if (!okBuild)
-        {
-            if (!buildInfo)
-                continue;
-
-            flag |= REALM_FLAG_OFFLINE | REALM_FLAG_SPECIFYBUILD;   // tell the client what build the realm is for
-        }
-
-        if (!buildInfo)
-            flag &= ~REALM_FLAG_SPECIFYBUILD;
-
-        std::string name = i->first;
-        if (_expversion & PRE_BC_EXP_FLAG && flag & REALM_FLAG_SPECIFYBUILD)
-        {
-            std::ostringstream ss;
-            ss << name << " (" << buildInfo->MajorVersion << '.' << buildInfo->MinorVersion << '.' << buildInfo->BugfixVersion << ')';
-            name = ss.str();
-        }
+        const Realm &realm = i->realm;
 
         // We don't need the port number from which client connects with but the realm's port
         clientAddr.set_port_number(realm.ExternalAddress.get_port_number());
@@ -974,34 +1335,19 @@ bool AuthSocket::_HandleRealmList()
         uint8 lock = (realm.allowedSecurityLevel > _accountSecurityLevel) ? 1 : 0;
 
         uint8 AmountOfCharacters = 0;
-        stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_NUM_CHARS_ON_REALM);
-        stmt->setUInt32(0, realm.m_ID);
-        stmt->setUInt32(1, id);
-        result = LoginDatabase.Query(stmt);
-        if (result)
-            AmountOfCharacters = (*result)[0].GetUInt8();
+        std::map<uint32, uint8>::const_iterator chars = _realmCharacters.find(realm.m_ID);
+        if (chars != _realmCharacters.end())
+            AmountOfCharacters = chars->second;
 
         pkt << realm.icon;                                  // realm type
         if (_expversion & POST_BC_EXP_FLAG)                 // only 2.x and 3.x clients
             pkt << lock;                                    // if 1, then realm locked
-        pkt << uint8(flag);                                 // RealmFlags
-        pkt << name;
+        pkt << i->flag;                                     // RealmFlags
+        pkt << i->name;
         pkt << GetAddressString(GetAddressForClient(realm, clientAddr));
         pkt << realm.populationLevel;
         pkt << AmountOfCharacters;
-        pkt << realm.timezone;                              // realm category
-        if (_expversion & POST_BC_EXP_FLAG)                 // 2.x and 3.x clients
-            pkt << uint8(0x2C);                             // unk, may be realm number/id?
-        else
-            pkt << uint8(0x0);                              // 1.12.1 and 1.12.2 clients
-
-        if (_expversion & POST_BC_EXP_FLAG && flag & REALM_FLAG_SPECIFYBUILD)
-        {
-            pkt << uint8(buildInfo->MajorVersion);
-            pkt << uint8(buildInfo->MinorVersion);
-            pkt << uint8(buildInfo->BugfixVersion);
-            pkt << uint16(buildInfo->Build);
-        }
+        pkt.append(i->tail);
 
         ++RealmListSize;
     }
@@ -18,19 +18,37 @@
 #ifndef _AUTHSOCKET_H
 #define _AUTHSOCKET_H
 
+#include <ace/Atomic_Op.h>
 #include "Common.h"
 #include "BigNumber.h"
+#include "QueryResult.h"
 #include "RealmSocket.h"
 
 class ACE_INET_Addr;
 struct Realm;
 
+// Logon steps whose processing time is tracked
+enum AuthPhase
+{
+    AUTH_PHASE_LOGON_CHALLENGE,
+    AUTH_PHASE_LOGON_PROOF,
+    AUTH_PHASE_RECONNECT_CHALLENGE,
+    AUTH_PHASE_RECONNECT_PROOF,
+    AUTH_PHASE_REALM_LIST,
+    MAX_AUTH_PHASE,
+    AUTH_PHASE_NONE = MAX_AUTH_PHASE
+};
+
 // Handle login commands
 class AuthSocket: public RealmSocket::Session
 {
 public:
     const static int s_BYTE_SIZE = 32;
 
+    typedef std::vector<PreparedQueryResult> QueryResults;
+    // Part of a logon that runs on a logon worker, with the results of the lookups it waited for
+    typedef void (AuthSocket::*AsyncStep)(QueryResults const& results);
+
     AuthSocket(RealmSocket& socket);
     virtual ~AuthSocket(void);
 
@@ -40,12 +58,22 @@ public:
 
     static ACE_INET_Addr const& GetAddressForClient(Realm const& realm, ACE_INET_Addr const& clientAddr);
 
+    // Logs count, average and maximum processing time of every logon phase since the last call
+    static void LogPhaseStats();
+
     bool _HandleLogonChallenge();
     bool _HandleLogonProof();
     bool _HandleReconnectChallenge();
     bool _HandleReconnectProof();
     bool _HandleRealmList();
 
+    // Logon steps continued by the logon workers. While one is pending the connection reads no further commands.
+    void _LogonChallengeAccountStep(QueryResults const& results);
+    void _LogonChallengeBanStep(QueryResults const& results);
+    void _LogonProofStep(QueryResults const& results);
+    void _FailedLoginsStep(QueryResults const& results);
+    void _ReconnectChallengeStep(QueryResults const& results);
+
     //data transfer handle for patch
     bool _HandleXferResume();
     bool _HandleXferCancel();
@@ -60,6 +88,13 @@ private:
     RealmSocket& socket_;
     RealmSocket& socket(void) { return socket_; }
 
+    // Called by a handler on the network thread before it hands the logon over to the logon workers
+    void _BeginAsync();
+    // Queues a step without lookups to wait for
+    void _QueueStep(AsyncStep step);
+    // Called by the last step, hands the connection back to the network threads
+    void _EndAsync(bool close);
+
     BigNumber N, s, g, v;
     BigNumber b, B;
     BigNumber K;
@@ -67,6 +102,19 @@ private:
 
     bool _authed;
 
+    ACE_Atomic_Op<ACE_Thread_Mutex, long> _asyncPending;
+    bool _asyncStarted;                                     // Set by _BeginAsync, only used by the network thread
+    bool _closeRequested;
+    AuthPhase _currentPhase;
+    ACE_Time_Value _phaseStart;
+
+    // Carried from one logon step to the next
+    PreparedQueryResult _accountResult;
+    uint8 _proofA[32];
+    uint8 _proofM1[20];
+    bool _proofHasToken;
+    std::string _proofToken;
+
     std::string _login;
     std::string _tokenKey;
 
@@ -77,6 +125,10 @@ private:
     uint16 _build;
     uint8 _expversion;
     AccountTypes _accountSecurityLevel;
+
+    // Characters per realm of this account, loaded with the first realm list request of the connection
+    std::map<uint32, uint8> _realmCharacters;
+    bool _realmCharactersLoaded;
 };
 
 #endif
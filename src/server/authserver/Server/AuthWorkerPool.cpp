@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AuthWorkerPool.h"
+#include "Log.h"
+
+void AuthWorkerPool::Start(uint32 threads)
+{
+    _threads = threads;
+    activate(THR_NEW_LWP | THR_JOINABLE, int(threads));
+
+    TC_LOG_INFO("server.authserver", "Using %u logon worker threads.", threads);
+}
+
+void AuthWorkerPool::Stop()
+{
+    if (!_threads)
+        return;
+
+    // Wakes every worker, dequeue returns NULL from now on
+    _queue.queue()->deactivate();
+    wait();
+    _threads = 0;
+}
+
+bool AuthWorkerPool::Enqueue(ACE_Method_Request* request)
+{
+    if (_queue.enqueue(request) == -1)
+    {
+        delete request;
+        return false;
+    }
+
+    return true;
+}
+
+int AuthWorkerPool::svc()
+{
+    while (ACE_Method_Request* request = _queue.dequeue())
+    {
+        request->call();
+        delete request;
+    }
+
+    return 0;
+}
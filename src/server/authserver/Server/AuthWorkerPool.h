@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _AUTHWORKERPOOL_H
+#define _AUTHWORKERPOOL_H
+
+#include <ace/Task.h>
+#include <ace/Activation_Queue.h>
+#include <ace/Method_Request.h>
+#include <ace/Singleton.h>
+#include <ace/Null_Mutex.h>
+#include "Common.h"
+
+// Threads running the SRP6 math of logons and the steps that continue a logon once its
+// asynchronous LoginDatabase lookups returned, so network threads never wait for either.
+class AuthWorkerPool : protected ACE_Task_Base
+{
+public:
+    AuthWorkerPool() : ACE_Task_Base(), _threads(0) { }
+
+    void Start(uint32 threads);
+    void Stop();
+
+    // Takes ownership of the request. Returns false once the pool is stopped, the request is deleted then.
+    bool Enqueue(ACE_Method_Request* request);
+
+    ///- Inherited from ACE_Task_Base
+    int svc();
+
+private:
+    ACE_Activation_Queue _queue;
+    uint32 _threads;
+};
+
+#define sAuthWorkerPool ACE_Singleton<AuthWorkerPool, ACE_Null_Mutex>::instance()
+#endif
@@ -162,6 +162,8 @@ bool RealmSocket::send(const char *buf, size_t len)
     if (buf == NULL || len == 0)
         return true;
 
+    TRINITY_GUARD(ACE_Thread_Mutex, output_lock_);
+
     ACE_Data_Block db(len, ACE_Message_Block::MB_DATA, (const char*)buf, 0, 0, ACE_Message_Block::DONT_DELETE, 0);
     ACE_Message_Block message_block(&db, ACE_Message_Block::DONT_DELETE, 0);
 
@@ -202,6 +204,8 @@ int RealmSocket::handle_output(ACE_HANDLE)
     if (closing_)
         return -1;
 
+    TRINITY_GUARD(ACE_Thread_Mutex, output_lock_);
+
     ACE_Message_Block* mb = 0;
 
     if (msg_queue()->is_empty())
@@ -261,6 +265,10 @@ int RealmSocket::handle_input(ACE_HANDLE)
     if (closing_)
         return -1;
 
+    TRINITY_GUARD(ACE_Thread_Mutex, input_lock_);
+
+    // A session waiting for a logon worker leaves its input buffered, a client that keeps sending meanwhile
+    // eventually fills the buffer and is disconnected
     const ssize_t space = input_buffer_.space();
 
     ssize_t n = peer().recv(input_buffer_.wr_ptr(), space);
@@ -282,6 +290,29 @@ int RealmSocket::handle_input(ACE_HANDLE)
     return n == space ? 1 : 0;
 }
 
+int RealmSocket::handle_exception(ACE_HANDLE)
+{
+    if (closing_)
+        return 0;
+
+    TRINITY_GUARD(ACE_Thread_Mutex, input_lock_);
+
+    if (session_ != NULL)
+    {
+        session_->OnRead();
+        input_buffer_.crunch();
+    }
+
+    return 0;
+}
+
+void RealmSocket::resume_input(void)
+{
+    // The notification holds its own reference to the handler, the caller may drop its reference right away
+    if (!closing_)
+        reactor()->notify(this, ACE_Event_Handler::EXCEPT_MASK);
+}
+
 void RealmSocket::set_session(Session* session)
 {
     delete session_;
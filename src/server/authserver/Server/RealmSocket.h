@@ -23,6 +23,7 @@
 #include <ace/SOCK_Stream.h>
 #include <ace/Message_Block.h>
 #include <ace/Basic_Types.h>
+#include <ace/Thread_Mutex.h>
 #include "Common.h"
 
 class RealmSocket : public ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH>
@@ -50,8 +51,13 @@ public:
     bool recv(char *buf, size_t len);
     void recv_skip(size_t len);
 
+    // May be called from any thread
     bool send(const char *buf, size_t len);
 
+    // Makes a network thread call Session::OnRead again for the input that is already buffered.
+    // Used by sessions that stopped reading while waiting for work done on another thread.
+    void resume_input(void);
+
     const std::string& getRemoteAddress(void) const;
 
     uint16 getRemotePort(void) const;
@@ -62,6 +68,7 @@ public:
 
     virtual int handle_input(ACE_HANDLE = ACE_INVALID_HANDLE);
     virtual int handle_output(ACE_HANDLE = ACE_INVALID_HANDLE);
+    virtual int handle_exception(ACE_HANDLE = ACE_INVALID_HANDLE);
 
     virtual int handle_close(ACE_HANDLE = ACE_INVALID_HANDLE, ACE_Reactor_Mask = ACE_Event_Handler::ALL_EVENTS_MASK);
 
@@ -71,6 +78,8 @@ private:
     ssize_t noblk_send(ACE_Message_Block &message_block);
 
     ACE_Message_Block input_buffer_;
+    ACE_Thread_Mutex input_lock_;       // Serializes OnRead of the reactor and of resume_input
+    ACE_Thread_Mutex output_lock_;      // Guards the output queue, sessions send from logon workers too
     Session* session_;
     std::string _remoteAddress;
     uint16 _remotePort;
@@ -16,6 +16,7 @@
  */
 
 #include "BoundingIntervalHierarchy.h"
+#include "MappedFile.h"
 
 #ifdef _MSC_VER
   #define isnan _isnan
@@ -257,20 +258,22 @@ bool BIH::writeToFile(FILE* wf) const
     return check == (3 + 3 + 2 + treeSize + count);
 }
 
-bool BIH::readFromFile(FILE* rf)
+bool BIH::readFromFile(VMAP::MappedFile& rf)
 {
-    uint32 treeSize;
+    uint32 treeSize = 0;
     G3D::Vector3 lo, hi;
     uint32 check=0, count=0;
-    check += fread(&lo, sizeof(float), 3, rf);
-    check += fread(&hi, sizeof(float), 3, rf);
+    check += rf.read(&lo, sizeof(float), 3);
+    check += rf.read(&hi, sizeof(float), 3);
     bounds = G3D::AABox(lo, hi);
-    check += fread(&treeSize, sizeof(uint32), 1, rf);
+    check += rf.read(&treeSize, sizeof(uint32), 1);
     tree.resize(treeSize);
-    check += fread(&tree[0], sizeof(uint32), treeSize, rf);
-    check += fread(&count, sizeof(uint32), 1, rf);
+    if (treeSize)
+        check += rf.read(&tree[0], sizeof(uint32), treeSize);
+    check += rf.read(&count, sizeof(uint32), 1);
     objects.resize(count); // = new uint32[nObjects];
-    check += fread(&objects[0], sizeof(uint32), count, rf);
+    if (count)
+        check += rf.read(&objects[0], sizeof(uint32), count);
     return uint64(check) == uint64(3 + 3 + 1 + 1 + uint64(treeSize) + uint64(count));
 }
 
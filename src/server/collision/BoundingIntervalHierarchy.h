@@ -23,6 +23,7 @@
 #include "G3D/AABox.h"
 
 #include "Define.h"
+#include "RayPacket.h"
 
 #include <stdexcept>
 #include <vector>
@@ -32,6 +33,11 @@
 
 #define MAX_STACK_SIZE 64
 
+namespace VMAP
+{
+    class MappedFile;
+}
+
 static inline uint32 floatToRawIntBits(float f)
 {
     union
@@ -255,6 +261,184 @@ class BIH
             }
         }
 
+        /** Traces the rays of a packet together, see intersectRay.
+            Nodes are visited once for all lanes that reach them, rays going in different
+            directions only cost extra work in the subtrees they do not share.
+            The callback is called as callback(packet, lanes, entry, maxDist, stopAtFirst)
+            and returns the lanes it found a hit for; maxDist holds one distance per lane.
+            Returns the lanes that had a hit reported.
+        */
+        template<typename PacketCallback>
+        uint32 intersectRayPacket(const RayPacket &packet, PacketCallback& intersectCallback, float* maxDist, uint32 lanes, bool stopAtFirst=false) const
+        {
+            float tnear[RAY_PACKET_SIZE];
+            float tfar[RAY_PACKET_SIZE];
+            // clip every ray against the tree bounds, same as intersectRay
+            for (uint32 lane = 0; lane < RAY_PACKET_SIZE; ++lane)
+            {
+                tnear[lane] = 0.f;
+                tfar[lane] = 0.f;
+                if (!(lanes & (1 << lane)))
+                    continue;
+
+                float intervalMin = -1.f;
+                float intervalMax = -1.f;
+                for (int i=0; i<3; ++i)
+                {
+                    if (G3D::fuzzyNe(packet.direction[i][lane], 0.0f))
+                    {
+                        float t1 = (bounds.low()[i]  - packet.origin[i][lane]) * packet.invDirection[i][lane];
+                        float t2 = (bounds.high()[i] - packet.origin[i][lane]) * packet.invDirection[i][lane];
+                        if (t1 > t2)
+                            std::swap(t1, t2);
+                        if (t1 > intervalMin)
+                            intervalMin = t1;
+                        if (t2 < intervalMax || intervalMax < 0.f)
+                            intervalMax = t2;
+                        if (intervalMax <= 0 || intervalMin >= maxDist[lane])
+                            break;
+                    }
+                }
+
+                if (intervalMin > intervalMax || intervalMax <= 0 || intervalMin >= maxDist[lane])
+                {
+                    lanes &= ~(1 << lane);
+                    continue;
+                }
+                tnear[lane] = std::max(intervalMin, 0.f);
+                tfar[lane] = std::min(intervalMax, maxDist[lane]);
+            }
+
+            if (!lanes)
+                return 0;
+
+            PacketFloat org[3];
+            PacketFloat invDir[3];
+            PacketFloat negative[3];
+            for (int i=0; i<3; ++i)
+            {
+                org[i] = packet.getOrigin(i);
+                invDir[i] = packet.getInvDirection(i);
+                negative[i] = packet.getNegative(i);
+            }
+
+            PacketFloat intervalMin = PacketFloat::load(tnear);
+            PacketFloat intervalMax = PacketFloat::load(tfar);
+            uint32 active = lanes;
+            uint32 hits = 0;
+            uint32 finished = 0;
+
+            PacketStackNode stack[MAX_STACK_SIZE];
+            int stackPos = 0;
+            int node = 0;
+
+            while (true) {
+                while (true)
+                {
+                    uint32 tn = tree[node];
+                    uint32 axis = (tn & (3 << 30)) >> 30;
+                    bool BVH2 = tn & (1 << 29);
+                    int offset = tn & ~(7 << 29);
+                    if (!BVH2)
+                    {
+                        if (axis < 3)
+                        {
+                            // "normal" interior node, left child holds everything below the left plane
+                            PacketFloat tl = (PacketFloat(intBitsToFloat(tree[node + 1])) - org[axis]) * invDir[axis];
+                            PacketFloat tr = (PacketFloat(intBitsToFloat(tree[node + 2])) - org[axis]) * invDir[axis];
+                            PacketFloat leftMin = packetSelect(negative[axis], packetMax(tl, intervalMin), intervalMin);
+                            PacketFloat leftMax = packetSelect(negative[axis], intervalMax, packetMin(tl, intervalMax));
+                            PacketFloat rightMin = packetSelect(negative[axis], intervalMin, packetMax(tr, intervalMin));
+                            PacketFloat rightMax = packetSelect(negative[axis], packetMin(tr, intervalMax), intervalMax);
+                            uint32 left = active & packetLessEqual(leftMin, leftMax);
+                            uint32 right = active & packetLessEqual(rightMin, rightMax);
+                            // all rays pass between clip zones
+                            if (!left && !right)
+                                break;
+
+                            // the first ray decides which child is near
+                            bool rightFirst = (packet.negativeLanes[axis] & active & (~active + 1)) != 0;
+                            if (left && right)
+                            {
+                                // push back far node
+                                PacketStackNode& farNode = stack[stackPos++];
+                                farNode.node = rightFirst ? offset : offset + 3;
+                                farNode.lanes = rightFirst ? left : right;
+                                (rightFirst ? leftMin : rightMin).store(farNode.tnear);
+                                (rightFirst ? leftMax : rightMax).store(farNode.tfar);
+                            }
+
+                            if ((rightFirst && right) || !left)
+                            {
+                                node = offset + 3;
+                                active = right;
+                                intervalMin = rightMin;
+                                intervalMax = rightMax;
+                            }
+                            else
+                            {
+                                node = offset;
+                                active = left;
+                                intervalMin = leftMin;
+                                intervalMax = leftMax;
+                            }
+                            continue;
+                        }
+                        else
+                        {
+                            // leaf - test some objects
+                            int n = tree[node + 1];
+                            while (n > 0) {
+                                uint32 hit = intersectCallback(packet, active, objects[offset], maxDist, stopAtFirst);
+                                hits |= hit;
+                                if (stopAtFirst && hit)
+                                {
+                                    finished |= hit;
+                                    if (finished == lanes)
+                                        return hits;
+                                    active &= ~hit;
+                                    if (!active)
+                                        break;
+                                }
+                                --n;
+                                ++offset;
+                            }
+                            break;
+                        }
+                    }
+                    else
+                    {
+                        if (axis>2)
+                            return hits; // should not happen
+                        PacketFloat tl = (PacketFloat(intBitsToFloat(tree[node + 1])) - org[axis]) * invDir[axis];
+                        PacketFloat tr = (PacketFloat(intBitsToFloat(tree[node + 2])) - org[axis]) * invDir[axis];
+                        node = offset;
+                        intervalMin = packetMax(packetSelect(negative[axis], tr, tl), intervalMin);
+                        intervalMax = packetMin(packetSelect(negative[axis], tl, tr), intervalMax);
+                        active &= packetLessEqual(intervalMin, intervalMax);
+                        if (!active)
+                            break;
+                        continue;
+                    }
+                } // traversal loop
+                do
+                {
+                    // stack is empty?
+                    if (stackPos == 0)
+                        return hits;
+                    // move back up the stack
+                    stackPos--;
+                    intervalMin = PacketFloat::load(stack[stackPos].tnear);
+                    active = stack[stackPos].lanes & ~finished & packetLessEqual(intervalMin, PacketFloat::load(maxDist));
+                    if (!active)
+                        continue;
+                    node = stack[stackPos].node;
+                    intervalMax = PacketFloat::load(stack[stackPos].tfar);
+                    break;
+                } while (true);
+            }
+        }
+
         template<typename IsectCallback>
         void intersectPoint(const G3D::Vector3 &p, IsectCallback& intersectCallback) const
         {
@@ -334,7 +518,7 @@ class BIH
         }
 
         bool writeToFile(FILE* wf) const;
-        bool readFromFile(FILE* rf);
+        bool readFromFile(VMAP::MappedFile& rf);
 
     protected:
         std::vector<uint32> tree;
@@ -354,6 +538,13 @@ class BIH
             float tnear;
             float tfar;
         };
+        struct PacketStackNode
+        {
+            uint32 node;
+            uint32 lanes;
+            float tnear[RAY_PACKET_SIZE];
+            float tfar[RAY_PACKET_SIZE];
+        };
 
         class BuildStats
         {
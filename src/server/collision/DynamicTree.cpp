@@ -245,6 +245,14 @@ bool DynamicMapTree::isInLineOfSight(float x1, float y1, float z1, float x2, flo
     return !callback.did_hit;
 }
 
+void DynamicMapTree::isInLineOfSight(float x1, float y1, float z1, const float* targets, bool* results, uint32 count, uint32 phasemask) const
+{
+    // gameobject models are spread over a regular grid that is walked cell by cell for every ray,
+    // there is no shared traversal to gain here
+    for (uint32 i = 0; i < count; ++i)
+        results[i] = isInLineOfSight(x1, y1, z1, targets[i * 3], targets[i * 3 + 1], targets[i * 3 + 2], phasemask);
+}
+
 float DynamicMapTree::getHeight(float x, float y, float z, float maxSearchDist, uint32 phasemask) const
 {
     G3D::Vector3 v(x, y, z);
@@ -41,6 +41,9 @@ public:
 
     bool isInLineOfSight(float x1, float y1, float z1, float x2, float y2,
                          float z2, uint32 phasemask) const;
+    //! targets holds count x, y, z triples, results[i] is set for the i-th of them
+    void isInLineOfSight(float x1, float y1, float z1, const float* targets,
+                         bool* results, uint32 count, uint32 phasemask) const;
 
     bool getIntersectionTime(uint32 phasemask, const G3D::Ray& ray,
                              const G3D::Vector3& endPos, float& maxDist) const;
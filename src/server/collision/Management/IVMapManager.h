@@ -60,6 +60,11 @@ namespace VMAP
             virtual void unloadMap(unsigned int pMapId) = 0;
 
             virtual bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) = 0;
+            /**
+            line of sight from one position to several others, traced together
+            targets holds count x, y, z triples, results[i] is set for the i-th of them
+            */
+            virtual void isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, const float* targets, bool* results, unsigned int count) = 0;
             virtual float getHeight(unsigned int pMapId, float x, float y, float z, float maxSearchDist) = 0;
             /**
             test if we hit an object. return true if we hit one. rx, ry, rz will hold the hit position or the dest position, if no intersection was found
@@ -152,6 +152,42 @@ namespace VMAP
         return true;
     }
 
+    void VMapManager2::isInLineOfSight(unsigned int mapId, float x1, float y1, float z1, const float* targets, bool* results, unsigned int count)
+    {
+        std::fill(results, results + count, true);
+
+        if (!isLineOfSightCalcEnabled() || DisableMgr::IsDisabledFor(DISABLE_TYPE_VMAP, mapId, NULL, VMAP_DISABLE_LOS))
+            return;
+
+        InstanceTreeMap::iterator instanceTree = iInstanceMapTrees.find(mapId);
+        if (instanceTree == iInstanceMapTrees.end())
+            return;
+
+        Vector3 pos1 = convertPositionToInternalRep(x1, y1, z1);
+        std::vector<Vector3> pos2;
+        std::vector<unsigned int> indexes;
+        pos2.reserve(count);
+        indexes.reserve(count);
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            Vector3 pos = convertPositionToInternalRep(targets[i * 3], targets[i * 3 + 1], targets[i * 3 + 2]);
+            if (pos != pos1)
+            {
+                pos2.push_back(pos);
+                indexes.push_back(i);
+            }
+        }
+
+        if (pos2.empty())
+            return;
+
+        bool* los = new bool[pos2.size()];
+        instanceTree->second->isInLineOfSight(pos1, &pos2[0], los, pos2.size());
+        for (size_t i = 0; i < pos2.size(); ++i)
+            results[indexes[i]] = los[i];
+        delete[] los;
+    }
+
     /**
     get the hit position and return true if we hit something
     otherwise the result pos will be the dest pos
@@ -91,6 +91,7 @@ namespace VMAP
             void unloadMap(unsigned int mapId);
 
             bool isInLineOfSight(unsigned int mapId, float x1, float y1, float z1, float x2, float y2, float z2) ;
+            void isInLineOfSight(unsigned int mapId, float x1, float y1, float z1, const float* targets, bool* results, unsigned int count);
             /**
             fill the hit pos and return true, if an object was hit
             */
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFile.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace VMAP
+{
+    MappedFile::MappedFile() : iData(NULL), iSize(0), iPos(0)
+#ifdef _WIN32
+        , iFile(INVALID_HANDLE_VALUE), iMapping(NULL)
+#endif
+    {
+    }
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    bool MappedFile::open(const std::string& filename)
+    {
+        close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping)
+        {
+            CloseHandle(file);
+            return false;
+        }
+
+        void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!data)
+        {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        iFile = file;
+        iMapping = mapping;
+        iSize = size_t(size.QuadPart);
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        void* data = mmap(NULL, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // the mapping stays valid without the descriptor
+        ::close(fd);
+        if (data == MAP_FAILED)
+            return false;
+
+        // files are parsed front to back once
+        madvise(data, size_t(st.st_size), MADV_SEQUENTIAL);
+        iSize = size_t(st.st_size);
+#endif
+
+        iData = static_cast<const uint8*>(data);
+        iPos = 0;
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (!iData)
+            return;
+
+#ifdef _WIN32
+        UnmapViewOfFile(iData);
+        CloseHandle(iMapping);
+        CloseHandle(iFile);
+        iMapping = NULL;
+        iFile = INVALID_HANDLE_VALUE;
+#else
+        munmap(const_cast<uint8*>(iData), iSize);
+#endif
+
+        iData = NULL;
+        iSize = 0;
+        iPos = 0;
+    }
+
+    size_t MappedFile::read(void* dest, size_t size, size_t count)
+    {
+        if (!size || iPos >= iSize)
+            return 0;
+
+        size_t available = (iSize - iPos) / size;
+        if (count > available)
+            count = available;
+
+        memcpy(dest, iData + iPos, size * count);
+        iPos += size * count;
+        return count;
+    }
+
+    const uint8* MappedFile::readInPlace(size_t size)
+    {
+        if (iPos > iSize || iSize - iPos < size)
+            return NULL;
+
+        const uint8* data = iData + iPos;
+        iPos += size;
+        return data;
+    }
+
+    bool readChunk(MappedFile& rf, char *dest, const char *compare, uint32 len)
+    {
+        if (rf.read(dest, sizeof(char), len) != len) return false;
+        return memcmp(dest, compare, len) == 0;
+    }
+}
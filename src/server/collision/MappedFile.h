@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MAPPEDFILE_H
+#define _MAPPEDFILE_H
+
+#include "Define.h"
+
+#include <string>
+
+namespace VMAP
+{
+    /**
+    Read-only view of a whole file mapped into memory.
+    The read functions walk the file sequentially with the same semantics as fread,
+    so file parsers only trade their FILE* for a MappedFile.
+    */
+    class MappedFile
+    {
+        public:
+            MappedFile();
+            ~MappedFile();
+
+            bool open(const std::string& filename);
+            void close();
+            bool isOpen() const { return iData != NULL; }
+
+            const uint8* getData() const { return iData; }
+            size_t getSize() const { return iSize; }
+
+            //! copies up to count elements of size bytes, returns the number of complete elements copied
+            size_t read(void* dest, size_t size, size_t count);
+            //! returns a pointer to the next size bytes and skips them, NULL if the file is too short
+            const uint8* readInPlace(size_t size);
+            bool eof() const { return iPos >= iSize; }
+            size_t tell() const { return iPos; }
+
+        private:
+            MappedFile(const MappedFile&);
+            MappedFile& operator=(const MappedFile&);
+
+            const uint8* iData;
+            size_t iSize;
+            size_t iPos;
+#ifdef _WIN32
+            void* iFile;
+            void* iMapping;
+#endif
+    };
+
+    bool readChunk(MappedFile& rf, char *dest, const char *compare, uint32 len);
+}
+
+#endif // _MAPPEDFILE_H
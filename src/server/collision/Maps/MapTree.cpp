@@ -19,6 +19,7 @@
 #include "ModelInstance.h"
 #include "VMapManager2.h"
 #include "VMapDefinitions.h"
+#include "MappedFile.h"
 #include "Log.h"
 #include "Errors.h"
 
@@ -49,6 +50,18 @@ namespace VMAP
         bool hit;
     };
 
+    class MapRayPacketCallback
+    {
+        public:
+            MapRayPacketCallback(ModelInstance* val): prims(val) { }
+            uint32 operator()(const RayPacket& packet, uint32 lanes, uint32 entry, float* distance, bool pStopAtFirstHit=true)
+            {
+                return prims[entry].intersectRayPacket(packet, lanes, distance, pStopAtFirstHit);
+            }
+    protected:
+        ModelInstance* prims;
+    };
+
     class AreaInfoCallback
     {
         public:
@@ -172,6 +185,50 @@ namespace VMAP
 
         return true;
     }
+
+    void StaticMapTree::isInLineOfSight(const Vector3& pos1, const Vector3* pos2, bool* results, uint32 count) const
+    {
+        // rays sharing an origin stay close to each other in the tree, trace them in packets
+        for (uint32 first = 0; first < count; first += RAY_PACKET_SIZE)
+        {
+            RayPacket packet;
+            float maxDist[RAY_PACKET_SIZE];
+            uint32 lanes = 0;
+            for (uint32 i = 0; i < RAY_PACKET_SIZE; ++i)
+            {
+                maxDist[i] = 0.f;
+                if (first + i >= count)
+                    break;
+
+                // same checks as the single ray version
+                float dist = (pos2[first + i] - pos1).magnitude();
+                if (dist == std::numeric_limits<float>::max() ||
+                    dist == std::numeric_limits<float>::infinity())
+                {
+                    results[first + i] = false;
+                    continue;
+                }
+
+                ASSERT(dist < std::numeric_limits<float>::max());
+                results[first + i] = true;
+                if (dist < 1e-10f)
+                    continue;
+
+                packet.setRay(i, G3D::Ray::fromOriginAndDirection(pos1, (pos2[first + i] - pos1)/dist));
+                maxDist[i] = dist;
+                lanes |= 1 << i;
+            }
+
+            if (!lanes)
+                continue;
+
+            MapRayPacketCallback intersectionCallBack(iTreeValues);
+            uint32 hits = iTree.intersectRayPacket(packet, intersectionCallBack, maxDist, lanes, true);
+            for (uint32 i = 0; i < RAY_PACKET_SIZE; ++i)
+                if (hits & (1 << i))
+                    results[first + i] = false;
+        }
+    }
     //=========================================================
     /**
     When moving from pos1 to pos2 check if we hit an object. Return true and the position if we hit one
@@ -280,14 +337,14 @@ namespace VMAP
         VMAP_DEBUG_LOG("maps", "StaticMapTree::InitMap() : initializing StaticMapTree '%s'", fname.c_str());
         bool success = false;
         std::string fullname = iBasePath + fname;
-        FILE* rf = fopen(fullname.c_str(), "rb");
-        if (!rf)
+        MappedFile rf;
+        if (!rf.open(fullname))
             return false;
 
         char chunk[8];
         char tiled = '\0';
 
-        if (readChunk(rf, chunk, VMAP_MAGIC, 8) && fread(&tiled, sizeof(char), 1, rf) == 1 &&
+        if (readChunk(rf, chunk, VMAP_MAGIC, 8) && rf.read(&tiled, sizeof(char), 1) == 1 &&
             readChunk(rf, chunk, "NODE", 4) && iTree.readFromFile(rf))
         {
             iNTreeValues = iTree.primCount();
@@ -320,7 +377,6 @@ namespace VMAP
             }
         }
 
-        fclose(rf);
         return success;
     }
 
@@ -336,6 +392,7 @@ namespace VMAP
         }
         iLoadedSpawns.clear();
         iLoadedTiles.clear();
+        iLoadedTileSpawns.clear();
     }
 
     //=========================================================
@@ -357,16 +414,18 @@ namespace VMAP
         bool result = true;
 
         std::string tilefile = iBasePath + getTileFileName(iMapID, tileX, tileY);
-        FILE* tf = fopen(tilefile.c_str(), "rb");
-        if (tf)
+        MappedFile tf;
+        if (tf.open(tilefile))
         {
             char chunk[8];
 
             if (!readChunk(tf, chunk, VMAP_MAGIC, 8))
                 result = false;
             uint32 numSpawns = 0;
-            if (result && fread(&numSpawns, sizeof(uint32), 1, tf) != 1)
+            if (result && tf.read(&numSpawns, sizeof(uint32), 1) != 1)
                 result = false;
+            std::vector<uint32>& tileSpawns = iLoadedTileSpawns[packTileID(tileX, tileY)];
+            tileSpawns.reserve(numSpawns);
             for (uint32 i=0; i<numSpawns && result; ++i)
             {
                 // read model spawns
@@ -382,7 +441,7 @@ namespace VMAP
                     // update tree
                     uint32 referencedVal;
 
-                    if (fread(&referencedVal, sizeof(uint32), 1, tf) == 1)
+                    if (tf.read(&referencedVal, sizeof(uint32), 1) == 1)
                     {
                         if (!iLoadedSpawns.count(referencedVal))
                         {
@@ -406,13 +465,13 @@ namespace VMAP
                                 TC_LOG_DEBUG("maps", "StaticMapTree::LoadMapTile() : name collision on GUID=%u", spawn.ID);
 #endif
                         }
+                        tileSpawns.push_back(referencedVal);
                     }
                     else
                         result = false;
                 }
             }
             iLoadedTiles[packTileID(tileX, tileY)] = true;
-            fclose(tf);
         }
         else
             iLoadedTiles[packTileID(tileX, tileY)] = false;
@@ -430,48 +489,29 @@ namespace VMAP
             VMAP_ERROR_LOG("misc", "StaticMapTree::UnloadMapTile() : trying to unload non-loaded tile - Map:%u X:%u Y:%u", iMapID, tileX, tileY);
             return;
         }
-        if (tile->second) // file associated with tile
+        loadedTileSpawnMap::iterator tileSpawns = iLoadedTileSpawns.find(tileID);
+        if (tileSpawns != iLoadedTileSpawns.end()) // file associated with tile
         {
-            std::string tilefile = iBasePath + getTileFileName(iMapID, tileX, tileY);
-            FILE* tf = fopen(tilefile.c_str(), "rb");
-            if (tf)
+            for (std::vector<uint32>::const_iterator itr = tileSpawns->second.begin(); itr != tileSpawns->second.end(); ++itr)
             {
-                bool result=true;
-                char chunk[8];
-                if (!readChunk(tf, chunk, VMAP_MAGIC, 8))
-                    result = false;
-                uint32 numSpawns;
-                if (fread(&numSpawns, sizeof(uint32), 1, tf) != 1)
-                    result = false;
-                for (uint32 i=0; i<numSpawns && result; ++i)
+                uint32 referencedNode = *itr;
+                if (!iLoadedSpawns.count(referencedNode))
                 {
-                    // read model spawns
-                    ModelSpawn spawn;
-                    result = ModelSpawn::readFromFile(tf, spawn);
-                    if (result)
-                    {
-                        // release model instance
-                        vm->releaseModelInstance(spawn.name);
+                    VMAP_ERROR_LOG("misc", "StaticMapTree::UnloadMapTile() : trying to unload non-referenced model '%s' (ID:%u)", iTreeValues[referencedNode].name.c_str(), iTreeValues[referencedNode].ID);
+                    continue;
+                }
 
-                        // update tree
-                        uint32 referencedNode;
+                // release model instance
+                vm->releaseModelInstance(iTreeValues[referencedNode].name);
 
-                        if (fread(&referencedNode, sizeof(uint32), 1, tf) != 1)
-                            result = false;
-                        else
-                        {
-                            if (!iLoadedSpawns.count(referencedNode))
-                            VMAP_ERROR_LOG("misc", "StaticMapTree::UnloadMapTile() : trying to unload non-referenced model '%s' (ID:%u)", spawn.name.c_str(), spawn.ID);
-                            else if (--iLoadedSpawns[referencedNode] == 0)
-                            {
-                                iTreeValues[referencedNode].setUnloaded();
-                                iLoadedSpawns.erase(referencedNode);
-                            }
-                        }
-                    }
+                // update tree
+                if (--iLoadedSpawns[referencedNode] == 0)
+                {
+                    iTreeValues[referencedNode].setUnloaded();
+                    iLoadedSpawns.erase(referencedNode);
                 }
-                fclose(tf);
             }
+            iLoadedTileSpawns.erase(tileSpawns);
         }
         iLoadedTiles.erase(tile);
     }
@@ -40,6 +40,7 @@ namespace VMAP
     {
         typedef UNORDERED_MAP<uint32, bool> loadedTileMap;
         typedef UNORDERED_MAP<uint32, uint32> loadedSpawnMap;
+        typedef UNORDERED_MAP<uint32, std::vector<uint32> > loadedTileSpawnMap;
         private:
             uint32 iMapID;
             bool iIsTiled;
@@ -53,6 +54,8 @@ namespace VMAP
             loadedTileMap iLoadedTiles;
             // stores <tree_index, reference_count> to invalidate tree values, unload map, and to be able to report errors
             loadedSpawnMap iLoadedSpawns;
+            // tree indices referenced by each loaded tile, so unloading a tile does not need to read its file again
+            loadedTileSpawnMap iLoadedTileSpawns;
             std::string iBasePath;
 
         private:
@@ -68,6 +71,8 @@ namespace VMAP
             ~StaticMapTree();
 
             bool isInLineOfSight(const G3D::Vector3& pos1, const G3D::Vector3& pos2) const;
+            //! line of sight from pos1 to each of count positions, results[i] is set for pos2[i]
+            void isInLineOfSight(const G3D::Vector3& pos1, const G3D::Vector3* pos2, bool* results, uint32 count) const;
             bool getObjectHitPos(const G3D::Vector3& pos1, const G3D::Vector3& pos2, G3D::Vector3& pResultHitPos, float pModifyDist) const;
             float getHeight(const G3D::Vector3& pPos, float maxSearchDist) const;
             bool getAreaInfo(G3D::Vector3 &pos, uint32 &flags, int32 &adtId, int32 &rootId, int32 &groupId) const;
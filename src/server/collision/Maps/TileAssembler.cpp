@@ -19,11 +19,14 @@
 #include "MapTree.h"
 #include "BoundingIntervalHierarchy.h"
 #include "VMapDefinitions.h"
+#include "MappedFile.h"
 
 #include <set>
 #include <iomanip>
 #include <sstream>
 #include <iomanip>
+#include <fstream>
+#include <cstdlib>
 
 using G3D::Vector3;
 using G3D::AABox;
@@ -43,6 +46,50 @@ namespace VMAP
         return memcmp(dest, compare, len) == 0;
     }
 
+    // name of the file in the destination directory remembering the inputs of the last conversion
+    static const char* ASSEMBLER_MANIFEST = "assembler.manifest";
+
+    // 64 bit FNV-1a, only used to detect changed input files between two runs
+    static const uint64 CONTENT_HASH_SEED = UI64LIT(0xcbf29ce484222325);
+
+    static uint64 hashContent(const void* data, size_t size, uint64 hash)
+    {
+        const uint8* bytes = static_cast<const uint8*>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= UI64LIT(0x100000001b3);
+        }
+        return hash;
+    }
+
+    // covers everything ModelSpawn::writeToFile writes
+    static uint64 hashSpawn(const ModelSpawn& spawn, uint64 hash)
+    {
+        hash = hashContent(&spawn.flags, sizeof(uint32), hash);
+        hash = hashContent(&spawn.adtId, sizeof(uint16), hash);
+        hash = hashContent(&spawn.ID, sizeof(uint32), hash);
+        hash = hashContent(&spawn.iPos, sizeof(float) * 3, hash);
+        hash = hashContent(&spawn.iRot, sizeof(float) * 3, hash);
+        hash = hashContent(&spawn.iScale, sizeof(float), hash);
+        if (spawn.flags & MOD_HAS_BOUND)
+        {
+            hash = hashContent(&spawn.iBound.low(), sizeof(float) * 3, hash);
+            hash = hashContent(&spawn.iBound.high(), sizeof(float) * 3, hash);
+        }
+        return hashContent(spawn.name.c_str(), spawn.name.length(), hash);
+    }
+
+    static bool fileExists(const std::string& filename)
+    {
+        if (FILE* f = fopen(filename.c_str(), "rb"))
+        {
+            fclose(f);
+            return true;
+        }
+        return false;
+    }
+
     Vector3 ModelPosition::transform(const Vector3& pIn) const
     {
         Vector3 out = pIn * iScale;
@@ -70,6 +117,8 @@ namespace VMAP
         if (!success)
             return false;
 
+        loadManifest();
+
         // export Map data
         for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end() && success; ++map_iter)
         {
@@ -95,6 +144,47 @@ namespace VMAP
                 spawnedModelFiles.insert(entry->second.name);
             }
 
+            // the map tree and the tile files only depend on the spawns (including the bounds calculated above),
+            // so they are not rebuilt when neither the spawns nor the output files changed since the last run
+            std::stringstream mapKey;
+            mapKey << "map " << std::setfill('0') << std::setw(3) << map_iter->first;
+            uint64 mapHash = CONTENT_HASH_SEED;
+            for (entry = map_iter->second->UniqueEntries.begin(); entry != map_iter->second->UniqueEntries.end(); ++entry)
+                mapHash = hashSpawn(entry->second, mapHash);
+            for (TileMap::const_iterator tile = map_iter->second->TileEntries.begin(); tile != map_iter->second->TileEntries.end(); ++tile)
+            {
+                mapHash = hashContent(&tile->first, sizeof(uint32), mapHash);
+                mapHash = hashContent(&tile->second, sizeof(uint32), mapHash);
+            }
+
+            if (isUpToDate(mapKey.str(), mapHash))
+            {
+                std::set<uint32> tileIds;
+                for (TileMap::const_iterator tile = map_iter->second->TileEntries.begin(); tile != map_iter->second->TileEntries.end(); ++tile)
+                    if (!(map_iter->second->UniqueEntries[tile->second].flags & MOD_WORLDSPAWN))
+                        tileIds.insert(tile->first);
+
+                std::stringstream mapfilename;
+                mapfilename << iDestDir << '/' << std::setfill('0') << std::setw(3) << map_iter->first << ".vmtree";
+                bool outputExists = fileExists(mapfilename.str());
+                for (std::set<uint32>::const_iterator tileId = tileIds.begin(); tileId != tileIds.end() && outputExists; ++tileId)
+                {
+                    uint32 x, y;
+                    StaticMapTree::unpackTileID(*tileId, x, y);
+                    std::stringstream tilefilename;
+                    tilefilename.fill('0');
+                    tilefilename << iDestDir << '/' << std::setw(3) << map_iter->first << '_' << std::setw(2) << x << '_' << std::setw(2) << y << ".vmtile";
+                    outputExists = fileExists(tilefilename.str());
+                }
+
+                if (outputExists)
+                {
+                    printf("Map %u is unchanged, skipping map tree\n", map_iter->first);
+                    iHashes[mapKey.str()] = mapHash;
+                    continue;
+                }
+            }
+
             printf("Creating map tree for map %u...\n", map_iter->first);
             BIH pTree;
 
@@ -180,6 +270,9 @@ namespace VMAP
                     fclose(tilefile);
                 }
             }
+
+            if (success)
+                iHashes[mapKey.str()] = mapHash;
             // break; //test, extract only first map; TODO: remvoe this line
         }
 
@@ -189,6 +282,21 @@ namespace VMAP
         std::cout << "\nConverting Model Files" << std::endl;
         for (std::set<std::string>::iterator mfile = spawnedModelFiles.begin(); mfile != spawnedModelFiles.end(); ++mfile)
         {
+            std::string modelKey = "model " + *mfile;
+            uint64 modelHash = CONTENT_HASH_SEED;
+            MappedFile rawFile;
+            if (rawFile.open(iSrcDir + "/" + *mfile))
+            {
+                modelHash = hashContent(rawFile.getData(), rawFile.getSize(), modelHash);
+                rawFile.close();
+
+                if (isUpToDate(modelKey, modelHash) && fileExists(iDestDir + "/" + *mfile + ".vmo"))
+                {
+                    iHashes[modelKey] = modelHash;
+                    continue;
+                }
+            }
+
             std::cout << "Converting " << *mfile << std::endl;
             if (!convertRawFile(*mfile))
             {
@@ -196,8 +304,14 @@ namespace VMAP
                 success = false;
                 break;
             }
+
+            iHashes[modelKey] = modelHash;
         }
 
+        // remember what was converted, even after a failure the finished parts need not be redone
+        if (!saveManifest())
+            std::cout << "Cannot write " << iDestDir << '/' << ASSEMBLER_MANIFEST << std::endl;
+
         //cleanup:
         for (MapData::iterator map_iter = mapData.begin(); map_iter != mapData.end(); ++map_iter)
         {
@@ -206,11 +320,51 @@ namespace VMAP
         return success;
     }
 
+    // manifest lines are "<hash> <key>", the first line holds the vmap magic so a format change rebuilds everything
+    void TileAssembler::loadManifest()
+    {
+        iPreviousHashes.clear();
+        iHashes.clear();
+
+        std::ifstream manifest((iDestDir + "/" + ASSEMBLER_MANIFEST).c_str());
+        std::string line;
+        if (!std::getline(manifest, line) || line != VMAP_MAGIC)
+            return;
+
+        while (std::getline(manifest, line))
+        {
+            size_t separator = line.find(' ');
+            if (separator == std::string::npos)
+                continue;
+
+            iPreviousHashes[line.substr(separator + 1)] = strtoull(line.substr(0, separator).c_str(), NULL, 16);
+        }
+    }
+
+    bool TileAssembler::saveManifest() const
+    {
+        std::ofstream manifest((iDestDir + "/" + ASSEMBLER_MANIFEST).c_str(), std::ios::out | std::ios::trunc);
+        if (!manifest)
+            return false;
+
+        manifest << VMAP_MAGIC << '\n';
+        for (ContentHashMap::const_iterator itr = iHashes.begin(); itr != iHashes.end(); ++itr)
+            manifest << std::hex << itr->second << ' ' << itr->first << '\n';
+
+        return manifest.good();
+    }
+
+    bool TileAssembler::isUpToDate(const std::string& key, uint64 hash) const
+    {
+        ContentHashMap::const_iterator itr = iPreviousHashes.find(key);
+        return itr != iPreviousHashes.end() && itr->second == hash;
+    }
+
     bool TileAssembler::readMapSpawns()
     {
         std::string fname = iSrcDir + "/dir_bin";
-        FILE* dirf = fopen(fname.c_str(), "rb");
-        if (!dirf)
+        MappedFile dirf;
+        if (!dirf.open(fname))
         {
             printf("Could not read dir_bin file!\n");
             return false;
@@ -219,17 +373,23 @@ namespace VMAP
         uint32 mapID, tileX, tileY, check=0;
         G3D::Vector3 v1, v2;
         ModelSpawn spawn;
-        while (!feof(dirf))
+        bool success = true;
+        while (!dirf.eof())
         {
             check = 0;
             // read mapID, tileX, tileY, Flags, adtID, ID, Pos, Rot, Scale, Bound_lo, Bound_hi, name
-            check += fread(&mapID, sizeof(uint32), 1, dirf);
+            check += dirf.read(&mapID, sizeof(uint32), 1);
             if (check == 0) // EoF...
                 break;
-            check += fread(&tileX, sizeof(uint32), 1, dirf);
-            check += fread(&tileY, sizeof(uint32), 1, dirf);
-            if (!ModelSpawn::readFromFile(dirf, spawn))
+            check += dirf.read(&tileX, sizeof(uint32), 1);
+            check += dirf.read(&tileY, sizeof(uint32), 1);
+            // the mapping holds the whole file, a short read can only mean a truncated dir_bin
+            if (check != 3 || !ModelSpawn::readFromFile(dirf, spawn))
+            {
+                printf("dir_bin is truncated or corrupt at offset %u!\n", uint32(dirf.tell()));
+                success = false;
                 break;
+            }
 
             MapSpawns *current;
             MapData::iterator map_iter = mapData.find(mapID);
@@ -242,8 +402,6 @@ namespace VMAP
             current->UniqueEntries.insert(pair<uint32, ModelSpawn>(spawn.ID, spawn));
             current->TileEntries.insert(pair<uint32, uint32>(StaticMapTree::packTileID(tileX, tileY), spawn.ID));
         }
-        bool success = (ferror(dirf) == 0);
-        fclose(dirf);
         return success;
     }
 
@@ -100,6 +100,15 @@ namespace VMAP
             MapData mapData;
             std::set<std::string> spawnedModelFiles;
 
+            // content hashes of the inputs of the previous and the current run, see loadManifest
+            typedef std::map<std::string, uint64> ContentHashMap;
+            ContentHashMap iPreviousHashes;
+            ContentHashMap iHashes;
+
+            void loadManifest();
+            bool saveManifest() const;
+            bool isUpToDate(const std::string& key, uint64 hash) const;
+
         public:
             TileAssembler(const std::string& pSrcDirName, const std::string& pDestDirName);
             virtual ~TileAssembler();
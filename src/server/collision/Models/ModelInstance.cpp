@@ -19,6 +19,7 @@
 #include "WorldModel.h"
 #include "MapTree.h"
 #include "VMapDefinitions.h"
+#include "MappedFile.h"
 
 using G3D::Vector3;
 using G3D::Ray;
@@ -64,6 +65,43 @@ namespace VMAP
         return hit;
     }
 
+    uint32 ModelInstance::intersectRayPacket(const RayPacket& pPacket, uint32 pLanes, float* pMaxDist, bool pStopAtFirstHit) const
+    {
+        if (!iModel)
+            return 0;
+
+        // child bounds are defined in object space, transform every ray that crosses our bound
+        RayPacket modPacket;
+        float distance[RAY_PACKET_SIZE];
+        for (uint32 i = 0; i < RAY_PACKET_SIZE; ++i)
+        {
+            distance[i] = 0.f;
+            if (!(pLanes & (1 << i)))
+                continue;
+
+            const G3D::Ray& ray = pPacket.rays[i];
+            if (ray.intersectionTime(iBound) == G3D::inf())
+            {
+                pLanes &= ~(1 << i);
+                continue;
+            }
+
+            Vector3 p = iInvRot * (ray.origin() - iPos) * iInvScale;
+            modPacket.setRay(i, Ray(p, iInvRot * ray.direction()));
+            distance[i] = pMaxDist[i] * iInvScale;
+        }
+
+        if (!pLanes)
+            return 0;
+
+        uint32 hits = iModel->IntersectRayPacket(modPacket, pLanes, distance, pStopAtFirstHit);
+        for (uint32 i = 0; i < RAY_PACKET_SIZE; ++i)
+            if (hits & (1 << i))
+                pMaxDist[i] = distance[i] * iScale;
+
+        return hits;
+    }
+
     void ModelInstance::intersectPoint(const G3D::Vector3& p, AreaInfo &info) const
     {
         if (!iModel)
@@ -150,49 +188,44 @@ namespace VMAP
         return false;
     }
 
-    bool ModelSpawn::readFromFile(FILE* rf, ModelSpawn &spawn)
+    bool ModelSpawn::readFromFile(MappedFile& rf, ModelSpawn &spawn)
     {
-        uint32 check = 0, nameLen;
-        check += fread(&spawn.flags, sizeof(uint32), 1, rf);
+        uint32 check = 0, nameLen = 0;
+        check += rf.read(&spawn.flags, sizeof(uint32), 1);
         // EoF?
         if (!check)
-        {
-            if (ferror(rf))
-                std::cout << "Error reading ModelSpawn!\n";
             return false;
-        }
-        check += fread(&spawn.adtId, sizeof(uint16), 1, rf);
-        check += fread(&spawn.ID, sizeof(uint32), 1, rf);
-        check += fread(&spawn.iPos, sizeof(float), 3, rf);
-        check += fread(&spawn.iRot, sizeof(float), 3, rf);
-        check += fread(&spawn.iScale, sizeof(float), 1, rf);
+        check += rf.read(&spawn.adtId, sizeof(uint16), 1);
+        check += rf.read(&spawn.ID, sizeof(uint32), 1);
+        check += rf.read(&spawn.iPos, sizeof(float), 3);
+        check += rf.read(&spawn.iRot, sizeof(float), 3);
+        check += rf.read(&spawn.iScale, sizeof(float), 1);
         bool has_bound = (spawn.flags & MOD_HAS_BOUND);
         if (has_bound) // only WMOs have bound in MPQ, only available after computation
         {
             Vector3 bLow, bHigh;
-            check += fread(&bLow, sizeof(float), 3, rf);
-            check += fread(&bHigh, sizeof(float), 3, rf);
+            check += rf.read(&bLow, sizeof(float), 3);
+            check += rf.read(&bHigh, sizeof(float), 3);
             spawn.iBound = G3D::AABox(bLow, bHigh);
         }
-        check += fread(&nameLen, sizeof(uint32), 1, rf);
+        check += rf.read(&nameLen, sizeof(uint32), 1);
         if (check != uint32(has_bound ? 17 : 11))
         {
             std::cout << "Error reading ModelSpawn!\n";
             return false;
         }
-        char nameBuff[500];
         if (nameLen > 500) // file names should never be that long, must be file error
         {
             std::cout << "Error reading ModelSpawn, file name too long!\n";
             return false;
         }
-        check = fread(nameBuff, sizeof(char), nameLen, rf);
-        if (check != nameLen)
+        const uint8* name = rf.readInPlace(nameLen);
+        if (!name)
         {
             std::cout << "Error reading ModelSpawn!\n";
             return false;
         }
-        spawn.name = std::string(nameBuff, nameLen);
+        spawn.name.assign(reinterpret_cast<const char*>(name), nameLen);
         return true;
     }
 
@@ -25,8 +25,11 @@
 
 #include "Define.h"
 
+struct RayPacket;
+
 namespace VMAP
 {
+    class MappedFile;
     class WorldModel;
     struct AreaInfo;
     struct LocationInfo;
@@ -55,7 +58,7 @@ namespace VMAP
             // temp?
             const G3D::AABox& getBounds() const { return iBound; }
 
-            static bool readFromFile(FILE* rf, ModelSpawn &spawn);
+            static bool readFromFile(MappedFile& rf, ModelSpawn &spawn);
             static bool writeToFile(FILE* rw, const ModelSpawn &spawn);
     };
 
@@ -66,6 +69,7 @@ namespace VMAP
             ModelInstance(const ModelSpawn &spawn, WorldModel* model);
             void setUnloaded() { iModel = 0; }
             bool intersectRay(const G3D::Ray& pRay, float& pMaxDist, bool pStopAtFirstHit) const;
+            uint32 intersectRayPacket(const RayPacket& pPacket, uint32 pLanes, float* pMaxDist, bool pStopAtFirstHit) const;
             void intersectPoint(const G3D::Vector3& p, AreaInfo &info) const;
             bool GetLocationInfo(const G3D::Vector3& p, LocationInfo &info) const;
             bool GetLiquidLevel(const G3D::Vector3& p, LocationInfo &info, float &liqHeight) const;
@@ -19,6 +19,7 @@
 #include "ModelInstance.h"
 #include "VMapDefinitions.h"
 #include "MapTree.h"
+#include "MappedFile.h"
 
 using G3D::Vector3;
 using G3D::Ray;
@@ -80,6 +81,64 @@ namespace VMAP
         return false;
     }
 
+    //! IntersectTriangle for the given lanes of a packet, returns the lanes that hit
+    uint32 IntersectTrianglePacket(const MeshTriangle &tri, std::vector<Vector3>::const_iterator points, const RayPacket &packet, uint32 lanes, float* distance)
+    {
+        static const float EPS = 1e-5f;
+
+        const Vector3 e1 = points[tri.idx1] - points[tri.idx0];
+        const Vector3 e2 = points[tri.idx2] - points[tri.idx0];
+        const Vector3 &p0 = points[tri.idx0];
+
+        const PacketFloat dx = packet.getDirection(0);
+        const PacketFloat dy = packet.getDirection(1);
+        const PacketFloat dz = packet.getDirection(2);
+
+        const PacketFloat px = dy * e2.z - dz * e2.y;
+        const PacketFloat py = dz * e2.x - dx * e2.z;
+        const PacketFloat pz = dx * e2.y - dy * e2.x;
+        const PacketFloat a = px * e1.x + py * e1.y + pz * e1.z;
+
+        // ill-conditioned determinant
+        lanes &= packetLessEqual(PacketFloat(EPS), packetAbs(a));
+        if (!lanes)
+            return 0;
+
+        const PacketFloat f = PacketFloat(1.0f) / a;
+        const PacketFloat sx = packet.getOrigin(0) - p0.x;
+        const PacketFloat sy = packet.getOrigin(1) - p0.y;
+        const PacketFloat sz = packet.getOrigin(2) - p0.z;
+        const PacketFloat u = f * (sx * px + sy * py + sz * pz);
+
+        lanes &= packetLessEqual(PacketFloat(0.0f), u) & packetLessEqual(u, PacketFloat(1.0f));
+        if (!lanes)
+            return 0;
+
+        const PacketFloat qx = sy * e1.z - sz * e1.y;
+        const PacketFloat qy = sz * e1.x - sx * e1.z;
+        const PacketFloat qz = sx * e1.y - sy * e1.x;
+        const PacketFloat v = f * (dx * qx + dy * qy + dz * qz);
+
+        lanes &= packetLessEqual(PacketFloat(0.0f), v) & packetLessEqual(u + v, PacketFloat(1.0f));
+        if (!lanes)
+            return 0;
+
+        const PacketFloat t = f * (qx * e2.x + qy * e2.y + qz * e2.z);
+
+        // only hits closer than the previous ones
+        lanes &= packetLess(PacketFloat(0.0f), t) & packetLess(t, PacketFloat::load(distance));
+        if (!lanes)
+            return 0;
+
+        float hitTime[RAY_PACKET_SIZE];
+        t.store(hitTime);
+        for (uint32 i = 0; i < RAY_PACKET_SIZE; ++i)
+            if (lanes & (1 << i))
+                distance[i] = hitTime[i];
+
+        return lanes;
+    }
+
     class TriBoundFunc
     {
         public:
@@ -221,23 +280,23 @@ namespace VMAP
         return result;
     }
 
-    bool WmoLiquid::readFromFile(FILE* rf, WmoLiquid* &out)
+    bool WmoLiquid::readFromFile(MappedFile& rf, WmoLiquid* &out)
     {
         bool result = false;
         WmoLiquid* liquid = new WmoLiquid();
 
-        if (fread(&liquid->iTilesX, sizeof(uint32), 1, rf) == 1 &&
-            fread(&liquid->iTilesY, sizeof(uint32), 1, rf) == 1 &&
-            fread(&liquid->iCorner, sizeof(Vector3), 1, rf) == 1 &&
-            fread(&liquid->iType, sizeof(uint32), 1, rf) == 1)
+        if (rf.read(&liquid->iTilesX, sizeof(uint32), 1) == 1 &&
+            rf.read(&liquid->iTilesY, sizeof(uint32), 1) == 1 &&
+            rf.read(&liquid->iCorner, sizeof(Vector3), 1) == 1 &&
+            rf.read(&liquid->iType, sizeof(uint32), 1) == 1)
         {
             uint32 size = (liquid->iTilesX + 1) * (liquid->iTilesY + 1);
             liquid->iHeight = new float[size];
-            if (fread(liquid->iHeight, sizeof(float), size, rf) == size)
+            if (rf.read(liquid->iHeight, sizeof(float), size) == size)
             {
                 size = liquid->iTilesX * liquid->iTilesY;
                 liquid->iFlags = new uint8[size];
-                result = fread(liquid->iFlags, sizeof(uint8), size, rf) == size;
+                result = rf.read(liquid->iFlags, sizeof(uint8), size) == size;
             }
         }
 
@@ -313,7 +372,7 @@ namespace VMAP
         return result;
     }
 
-    bool GroupModel::readFromFile(FILE* rf)
+    bool GroupModel::readFromFile(MappedFile& rf)
     {
         char chunk[8];
         bool result = true;
@@ -324,25 +383,25 @@ namespace VMAP
         delete iLiquid;
         iLiquid = NULL;
 
-        if (result && fread(&iBound, sizeof(G3D::AABox), 1, rf) != 1) result = false;
-        if (result && fread(&iMogpFlags, sizeof(uint32), 1, rf) != 1) result = false;
-        if (result && fread(&iGroupWMOID, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && rf.read(&iBound, sizeof(G3D::AABox), 1) != 1) result = false;
+        if (result && rf.read(&iMogpFlags, sizeof(uint32), 1) != 1) result = false;
+        if (result && rf.read(&iGroupWMOID, sizeof(uint32), 1) != 1) result = false;
 
         // read vertices
         if (result && !readChunk(rf, chunk, "VERT", 4)) result = false;
-        if (result && fread(&chunkSize, sizeof(uint32), 1, rf) != 1) result = false;
-        if (result && fread(&count, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && rf.read(&chunkSize, sizeof(uint32), 1) != 1) result = false;
+        if (result && rf.read(&count, sizeof(uint32), 1) != 1) result = false;
         if (!count) // models without (collision) geometry end here, unsure if they are useful
             return result;
         if (result) vertices.resize(count);
-        if (result && fread(&vertices[0], sizeof(Vector3), count, rf) != count) result = false;
+        if (result && rf.read(&vertices[0], sizeof(Vector3), count) != count) result = false;
 
         // read triangle mesh
         if (result && !readChunk(rf, chunk, "TRIM", 4)) result = false;
-        if (result && fread(&chunkSize, sizeof(uint32), 1, rf) != 1) result = false;
-        if (result && fread(&count, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && rf.read(&chunkSize, sizeof(uint32), 1) != 1) result = false;
+        if (result && rf.read(&count, sizeof(uint32), 1) != 1) result = false;
         if (result) triangles.resize(count);
-        if (result && fread(&triangles[0], sizeof(MeshTriangle), count, rf) != count) result = false;
+        if (result && rf.read(&triangles[0], sizeof(MeshTriangle), count) != count) result = false;
 
         // read mesh BIH
         if (result && !readChunk(rf, chunk, "MBIH", 4)) result = false;
@@ -350,7 +409,7 @@ namespace VMAP
 
         // write liquid data
         if (result && !readChunk(rf, chunk, "LIQU", 4)) result = false;
-        if (result && fread(&chunkSize, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && rf.read(&chunkSize, sizeof(uint32), 1) != 1) result = false;
         if (result && chunkSize > 0)
             result = WmoLiquid::readFromFile(rf, iLiquid);
         return result;
@@ -381,6 +440,27 @@ namespace VMAP
         return callback.hit;
     }
 
+    struct GModelRayPacketCallback
+    {
+        GModelRayPacketCallback(const std::vector<MeshTriangle> &tris, const std::vector<Vector3> &vert):
+            vertices(vert.begin()), triangles(tris.begin()) { }
+        uint32 operator()(const RayPacket& packet, uint32 lanes, uint32 entry, float* distance, bool /*pStopAtFirstHit*/)
+        {
+            return IntersectTrianglePacket(triangles[entry], vertices, packet, lanes, distance);
+        }
+        std::vector<Vector3>::const_iterator vertices;
+        std::vector<MeshTriangle>::const_iterator triangles;
+    };
+
+    uint32 GroupModel::IntersectRayPacket(const RayPacket &packet, uint32 lanes, float* distance, bool stopAtFirstHit) const
+    {
+        if (triangles.empty())
+            return 0;
+
+        GModelRayPacketCallback callback(triangles, vertices);
+        return meshTree.intersectRayPacket(packet, callback, distance, lanes, stopAtFirstHit);
+    }
+
     bool GroupModel::IsInsideObject(const Vector3 &pos, const Vector3 &down, float &z_dist) const
     {
         if (triangles.empty() || !iBound.contains(pos))
@@ -442,6 +522,25 @@ namespace VMAP
         return isc.hit;
     }
 
+    struct WModelRayPacketCallBack
+    {
+        WModelRayPacketCallBack(const std::vector<GroupModel> &mod): models(mod.begin()) { }
+        uint32 operator()(const RayPacket& packet, uint32 lanes, uint32 entry, float* distance, bool pStopAtFirstHit)
+        {
+            return models[entry].IntersectRayPacket(packet, lanes, distance, pStopAtFirstHit);
+        }
+        std::vector<GroupModel>::const_iterator models;
+    };
+
+    uint32 WorldModel::IntersectRayPacket(const RayPacket &packet, uint32 lanes, float* distance, bool stopAtFirstHit) const
+    {
+        if (groupModels.size() == 1)
+            return groupModels[0].IntersectRayPacket(packet, lanes, distance, stopAtFirstHit);
+
+        WModelRayPacketCallBack isc(groupModels);
+        return groupTree.intersectRayPacket(packet, isc, distance, lanes, stopAtFirstHit);
+    }
+
     class WModelAreaCallback {
         public:
             WModelAreaCallback(const std::vector<GroupModel> &vals, const Vector3 &down):
@@ -549,8 +648,8 @@ namespace VMAP
 
     bool WorldModel::readFile(const std::string &filename)
     {
-        FILE* rf = fopen(filename.c_str(), "rb");
-        if (!rf)
+        MappedFile rf;
+        if (!rf.open(filename))
             return false;
 
         bool result = true;
@@ -560,15 +659,15 @@ namespace VMAP
         if (!readChunk(rf, chunk, VMAP_MAGIC, 8)) result = false;
 
         if (result && !readChunk(rf, chunk, "WMOD", 4)) result = false;
-        if (result && fread(&chunkSize, sizeof(uint32), 1, rf) != 1) result = false;
-        if (result && fread(&RootWMOID, sizeof(uint32), 1, rf) != 1) result = false;
+        if (result && rf.read(&chunkSize, sizeof(uint32), 1) != 1) result = false;
+        if (result && rf.read(&RootWMOID, sizeof(uint32), 1) != 1) result = false;
 
         // read group models
         if (result && readChunk(rf, chunk, "GMOD", 4))
         {
             //if (fread(&chunkSize, sizeof(uint32), 1, rf) != 1) result = false;
 
-            if (result && fread(&count, sizeof(uint32), 1, rf) != 1) result = false;
+            if (result && rf.read(&count, sizeof(uint32), 1) != 1) result = false;
             if (result) groupModels.resize(count);
             //if (result && fread(&groupModels[0], sizeof(GroupModel), count, rf) != count) result = false;
             for (uint32 i=0; i<count && result; ++i)
@@ -579,7 +678,6 @@ namespace VMAP
             if (result) result = groupTree.readFromFile(rf);
         }
 
-        fclose(rf);
         return result;
     }
 }
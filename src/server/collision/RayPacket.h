@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RAYPACKET_H
+#define _RAYPACKET_H
+
+#include "G3D/Vector3.h"
+#include "G3D/Ray.h"
+
+#include "Define.h"
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define RAY_PACKET_SSE
+#include <xmmintrin.h>
+#endif
+
+#define RAY_PACKET_SIZE 4
+#define RAY_PACKET_ALL_LANES ((1 << RAY_PACKET_SIZE) - 1)
+
+/** One float per ray of a RayPacket.
+    Lane masks returned by the comparisons have bit i set when the comparison holds for lane i.
+    Min and Max return their second argument if either one is NaN, so a NaN plane distance
+    never narrows a ray interval.
+*/
+#ifdef RAY_PACKET_SSE
+
+struct PacketFloat
+{
+    PacketFloat() { }
+    PacketFloat(__m128 value) : v(value) { }
+    explicit PacketFloat(float value) : v(_mm_set1_ps(value)) { }
+
+    static PacketFloat load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    __m128 v;
+};
+
+inline PacketFloat operator+(PacketFloat a, PacketFloat b) { return _mm_add_ps(a.v, b.v); }
+inline PacketFloat operator-(PacketFloat a, PacketFloat b) { return _mm_sub_ps(a.v, b.v); }
+inline PacketFloat operator*(PacketFloat a, PacketFloat b) { return _mm_mul_ps(a.v, b.v); }
+inline PacketFloat operator/(PacketFloat a, PacketFloat b) { return _mm_div_ps(a.v, b.v); }
+inline PacketFloat packetMin(PacketFloat a, PacketFloat b) { return _mm_min_ps(a.v, b.v); }
+inline PacketFloat packetMax(PacketFloat a, PacketFloat b) { return _mm_max_ps(a.v, b.v); }
+inline PacketFloat packetAbs(PacketFloat a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a.v); }
+//! Lanes of a where mask is set, lanes of b elsewhere
+inline PacketFloat packetSelect(PacketFloat mask, PacketFloat a, PacketFloat b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+inline uint32 packetLess(PacketFloat a, PacketFloat b) { return _mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)); }
+inline uint32 packetLessEqual(PacketFloat a, PacketFloat b) { return _mm_movemask_ps(_mm_cmple_ps(a.v, b.v)); }
+//! packetSelect mask of the lanes where a < b
+inline PacketFloat packetLessMask(PacketFloat a, PacketFloat b) { return _mm_cmplt_ps(a.v, b.v); }
+
+#else
+
+struct PacketFloat
+{
+    PacketFloat() { }
+    explicit PacketFloat(float value) { for (int i = 0; i < RAY_PACKET_SIZE; ++i) v[i] = value; }
+
+    static PacketFloat load(const float* p) { PacketFloat r; for (int i = 0; i < RAY_PACKET_SIZE; ++i) r.v[i] = p[i]; return r; }
+    void store(float* p) const { for (int i = 0; i < RAY_PACKET_SIZE; ++i) p[i] = v[i]; }
+
+    float v[RAY_PACKET_SIZE];
+};
+
+inline PacketFloat operator+(PacketFloat a, PacketFloat b) { for (int i = 0; i < RAY_PACKET_SIZE; ++i) a.v[i] += b.v[i]; return a; }
+inline PacketFloat operator-(PacketFloat a, PacketFloat b) { for (int i = 0; i < RAY_PACKET_SIZE; ++i) a.v[i] -= b.v[i]; return a; }
+inline PacketFloat operator*(PacketFloat a, PacketFloat b) { for (int i = 0; i < RAY_PACKET_SIZE; ++i) a.v[i] *= b.v[i]; return a; }
+inline PacketFloat operator/(PacketFloat a, PacketFloat b) { for (int i = 0; i < RAY_PACKET_SIZE; ++i) a.v[i] /= b.v[i]; return a; }
+inline PacketFloat packetMin(PacketFloat a, PacketFloat b) { for (int i = 0; i < RAY_PACKET_SIZE; ++i) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return a; }
+inline PacketFloat packetMax(PacketFloat a, PacketFloat b) { for (int i = 0; i < RAY_PACKET_SIZE; ++i) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return a; }
+inline PacketFloat packetAbs(PacketFloat a) { for (int i = 0; i < RAY_PACKET_SIZE; ++i) a.v[i] = fabs(a.v[i]); return a; }
+inline PacketFloat packetSelect(PacketFloat mask, PacketFloat a, PacketFloat b)
+{
+    for (int i = 0; i < RAY_PACKET_SIZE; ++i)
+        if (!std::signbit(mask.v[i]))   // set lanes have every bit set
+            a.v[i] = b.v[i];
+    return a;
+}
+inline uint32 packetLess(PacketFloat a, PacketFloat b) { uint32 m = 0; for (int i = 0; i < RAY_PACKET_SIZE; ++i) if (a.v[i] < b.v[i]) m |= 1 << i; return m; }
+inline uint32 packetLessEqual(PacketFloat a, PacketFloat b) { uint32 m = 0; for (int i = 0; i < RAY_PACKET_SIZE; ++i) if (a.v[i] <= b.v[i]) m |= 1 << i; return m; }
+inline PacketFloat packetLessMask(PacketFloat a, PacketFloat b);
+
+#endif
+
+inline PacketFloat operator*(PacketFloat a, float b) { return a * PacketFloat(b); }
+inline PacketFloat operator-(PacketFloat a, float b) { return a - PacketFloat(b); }
+
+//! Lane value of a packetSelect mask
+inline float packetLaneMask(bool set)
+{
+    union
+    {
+        uint32 ival;
+        float fval;
+    } temp;
+    temp.ival = set ? 0xFFFFFFFF : 0;
+    return temp.fval;
+}
+
+#ifndef RAY_PACKET_SSE
+inline PacketFloat packetLessMask(PacketFloat a, PacketFloat b)
+{
+    for (int i = 0; i < RAY_PACKET_SIZE; ++i)
+        a.v[i] = packetLaneMask(a.v[i] < b.v[i]);
+    return a;
+}
+#endif
+
+/** Up to RAY_PACKET_SIZE rays traced together.
+    Components are stored per axis so one PacketFloat load yields the same component of every ray.
+    Lanes that are not set keep a dummy ray; traversal functions take a lane mask telling which lanes to trace.
+*/
+struct RayPacket
+{
+    RayPacket()
+    {
+        for (int axis = 0; axis < 3; ++axis)
+            negativeLanes[axis] = 0;
+        for (uint32 i = 0; i < RAY_PACKET_SIZE; ++i)
+            setRay(i, G3D::Ray());
+    }
+
+    void setRay(uint32 lane, const G3D::Ray& ray)
+    {
+        rays[lane] = ray;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            origin[axis][lane] = ray.origin()[axis];
+            direction[axis][lane] = ray.direction()[axis];
+            invDirection[axis][lane] = 1.f / ray.direction()[axis];
+            // sign bit only, a direction of -0 has to be treated as negative like BIH::intersectRay does
+            negative[axis][lane] = packetLaneMask(std::signbit(ray.direction()[axis]));
+            if (std::signbit(ray.direction()[axis]))
+                negativeLanes[axis] |= 1 << lane;
+            else
+                negativeLanes[axis] &= ~(1 << lane);
+        }
+    }
+
+    PacketFloat getOrigin(int axis) const { return PacketFloat::load(origin[axis]); }
+    PacketFloat getDirection(int axis) const { return PacketFloat::load(direction[axis]); }
+    PacketFloat getInvDirection(int axis) const { return PacketFloat::load(invDirection[axis]); }
+    //! packetSelect mask of the lanes whose ray points towards negative axis
+    PacketFloat getNegative(int axis) const { return PacketFloat::load(negative[axis]); }
+
+    G3D::Ray rays[RAY_PACKET_SIZE];
+    float origin[3][RAY_PACKET_SIZE];
+    float direction[3][RAY_PACKET_SIZE];
+    float invDirection[3][RAY_PACKET_SIZE];
+    float negative[3][RAY_PACKET_SIZE];
+    uint32 negativeLanes[3];
+};
+
+#endif // _RAYPACKET_H
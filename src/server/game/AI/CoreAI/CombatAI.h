@@ -30,6 +30,7 @@ class AggressorAI : public CreatureAI
         explicit AggressorAI(Creature* c) : CreatureAI(c) { }
 
         void UpdateAI(uint32);
+        bool CanSleep() const { return typeid(*this) == typeid(AggressorAI); }
         static int Permissible(const Creature*);
 };
 
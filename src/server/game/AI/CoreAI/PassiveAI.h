@@ -28,6 +28,7 @@ class PassiveAI : public CreatureAI
         void MoveInLineOfSight(Unit*) { }
         void AttackStart(Unit*) { }
         void UpdateAI(uint32);
+        bool CanSleep() const { return typeid(*this) == typeid(PassiveAI); }
 
         static int Permissible(const Creature*) { return PERMIT_BASE_IDLE;  }
 };
@@ -56,6 +57,7 @@ class NullCreatureAI : public CreatureAI
         void MoveInLineOfSight(Unit*) { }
         void AttackStart(Unit*) { }
         void UpdateAI(uint32) { }
+        bool CanSleep() const { return typeid(*this) == typeid(NullCreatureAI); }
         void EnterEvadeMode() { }
         void OnCharmed(bool /*apply*/) { }
 
@@ -69,6 +71,7 @@ class CritterAI : public PassiveAI
 
         void DamageTaken(Unit* done_by, uint32& /*damage*/);
         void EnterEvadeMode();
+        bool CanSleep() const { return typeid(*this) == typeid(CritterAI); }
 };
 
 class TriggerAI : public NullCreatureAI
@@ -76,6 +79,7 @@ class TriggerAI : public NullCreatureAI
     public:
         explicit TriggerAI(Creature* c) : NullCreatureAI(c) { }
         void IsSummonedBy(Unit* summoner);
+        bool CanSleep() const { return typeid(*this) == typeid(TriggerAI); }
 };
 
 #endif
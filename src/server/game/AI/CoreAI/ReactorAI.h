@@ -30,6 +30,7 @@ class ReactorAI : public CreatureAI
 
         void MoveInLineOfSight(Unit*) { }
         void UpdateAI(uint32 diff);
+        bool CanSleep() const { return typeid(*this) == typeid(ReactorAI); }
 
         static int Permissible(const Creature*);
 };
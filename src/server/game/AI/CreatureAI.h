@@ -22,6 +22,8 @@
 #include "UnitAI.h"
 #include "Common.h"
 
+#include <typeinfo>
+
 class WorldObject;
 class Unit;
 class Creature;
@@ -95,6 +97,11 @@ class CreatureAI : public UnitAI
         // Called in Creature::Update when deathstate = DEAD. Inherited classes may maniuplate the ability to respawn based on scripted events.
         virtual bool CanRespawn() { return true; }
 
+        // True if UpdateAI has nothing to do while the creature is out of combat, see Creature::CanSleep.
+        // Every AI opts in for its own class only (typeid(*this) == typeid(ThatAI)), scripts deriving from it
+        // may have out of combat timers and stay awake unless they opt in themselves.
+        virtual bool CanSleep() const { return false; }
+
         // Called for reaction at stopping attack at no attackers or targets
         virtual void EnterEvadeMode();
 
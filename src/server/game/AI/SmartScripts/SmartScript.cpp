@@ -94,6 +94,8 @@ SmartScript::SmartScript()
     goOrigGUID = 0;
     mLastInvoker = 0;
     mScriptType = SMART_SCRIPT_TYPE_CREATURE;
+    memset(mEventIndexStart, 0, sizeof(mEventIndexStart));
+    mEventConditionsVersion = 0;
 }
 
 SmartScript::~SmartScript()
@@ -116,26 +118,36 @@ void SmartScript::OnReset()
             (*i).runOnce = false;
         }
     }
+    IndexEvents();
     ProcessEventsFor(SMART_EVENT_RESET);
     mLastInvoker = 0;
 }
 
 void SmartScript::ProcessEventsFor(SMART_EVENT e, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob)
 {
-    for (SmartAIEventList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
+    if (e == SMART_EVENT_LINK || e >= SMART_EVENT_END)//special handling
+        return;
+
+    if (mEventConditionsVersion != sConditionMgr->GetConditionsVersion())
+        UpdateEventConditions();
+
+    for (uint32 i = mEventIndexStart[e]; i < mEventIndexStart[e + 1]; ++i)
     {
-        SMART_EVENT eventType = SMART_EVENT((*i).GetEventType());
-        if (eventType == SMART_EVENT_LINK)//special handling
-            continue;
+        uint32 index = mEventIndex[i];
+        SmartScriptHolder& holder = mEvents[index];
 
-        if (eventType == e/* && (!(*i).event.event_phase_mask || IsInPhase((*i).event.event_phase_mask)) && !((*i).event.event_flags & SMART_EVENT_FLAG_NOT_REPEATABLE && (*i).runOnce)*/)
+        if (ConditionList const* conds = mEventConditions[index])
         {
-            ConditionList conds = sConditionMgr->GetConditionsForSmartEvent((*i).entryOrGuid, (*i).event_id, (*i).source_type);
             ConditionSourceInfo info = ConditionSourceInfo(unit, GetBaseObject());
-
-            if (sConditionMgr->IsObjectMeetToConditions(info, conds))
-                ProcessEvent(*i, unit, var0, var1, bvar, spell, gob);
+            if (!sConditionMgr->IsObjectMeetToConditions(info, *conds))
+                continue;
         }
+
+        ProcessEvent(holder, unit, var0, var1, bvar, spell, gob);
+
+        // the event started a cooldown, it is counted down by OnUpdate until it ends
+        if (!holder.active && !IsTimedEvent(e) && std::find(mCooldownEvents.begin(), mCooldownEvents.end(), index) == mCooldownEvents.end())
+            mCooldownEvents.push_back(index);
     }
 }
 
@@ -2190,10 +2202,10 @@ void SmartScript::ProcessAction(SmartScriptHolder& e, Unit* unit, uint32 var0, u
 
 void SmartScript::ProcessTimedAction(SmartScriptHolder& e, uint32 const& min, uint32 const& max, Unit* unit, uint32 var0, uint32 var1, bool bvar, const SpellInfo* spell, GameObject* gob)
 {
-    ConditionList const conds = sConditionMgr->GetConditionsForSmartEvent(e.entryOrGuid, e.event_id, e.source_type);
+    ConditionList const* conds = sConditionMgr->GetConditionsForSmartEvent(e.entryOrGuid, e.event_id, e.source_type);
     ConditionSourceInfo info = ConditionSourceInfo(unit, GetBaseObject());
 
-    if (sConditionMgr->IsObjectMeetToConditions(info, conds))
+    if (!conds || sConditionMgr->IsObjectMeetToConditions(info, *conds))
         ProcessAction(e, unit, var0, var1, bvar, spell, gob);
 
     RecalcTimer(e, min, max);
@@ -3181,6 +3193,35 @@ bool SmartScript::CheckTimer(SmartScriptHolder const& e) const
     return e.active;
 }
 
+// Events whose timer is set up by InitTimer or which are only processed from UpdateTimer
+bool SmartScript::IsTimedEvent(uint32 eventType)
+{
+    switch (eventType)
+    {
+        case SMART_EVENT_UPDATE:
+        case SMART_EVENT_UPDATE_OOC:
+        case SMART_EVENT_UPDATE_IC:
+        case SMART_EVENT_IC_LOS:
+        case SMART_EVENT_OOC_LOS:
+        case SMART_EVENT_HEALT_PCT:
+        case SMART_EVENT_TARGET_HEALTH_PCT:
+        case SMART_EVENT_MANA_PCT:
+        case SMART_EVENT_TARGET_MANA_PCT:
+        case SMART_EVENT_RANGE:
+        case SMART_EVENT_VICTIM_CASTING:
+        case SMART_EVENT_FRIENDLY_HEALTH:
+        case SMART_EVENT_FRIENDLY_IS_CC:
+        case SMART_EVENT_FRIENDLY_MISSING_BUFF:
+        case SMART_EVENT_HAS_AURA:
+        case SMART_EVENT_TARGET_BUFFED:
+        case SMART_EVENT_IS_BEHIND_TARGET:
+        case SMART_EVENT_FRIENDLY_HEALTH_PCT:
+            return true;
+        default:
+            return false;
+    }
+}
+
 void SmartScript::InstallEvents()
 {
     if (!mInstallEvents.empty())
@@ -3189,9 +3230,56 @@ void SmartScript::InstallEvents()
             mEvents.push_back(*i);//must be before UpdateTimers
 
         mInstallEvents.clear();
+        IndexEvents();
     }
 }
 
+// Must be called whenever mEvents changed, all stored positions refer to it
+void SmartScript::IndexEvents()
+{
+    memset(mEventIndexStart, 0, sizeof(mEventIndexStart));
+    mTimedEvents.clear();
+    mCooldownEvents.clear();
+
+    for (uint32 i = 0; i < mEvents.size(); ++i)
+    {
+        uint32 eventType = mEvents[i].GetEventType();
+        if (eventType == SMART_EVENT_LINK || eventType >= SMART_EVENT_END)
+            continue;
+
+        ++mEventIndexStart[eventType + 1];
+
+        if (IsTimedEvent(eventType))
+            mTimedEvents.push_back(i);
+        else if (!mEvents[i].active)
+            mCooldownEvents.push_back(i);
+    }
+
+    for (uint32 eventType = 0; eventType < SMART_EVENT_END; ++eventType)
+        mEventIndexStart[eventType + 1] += mEventIndexStart[eventType];
+
+    // holders keep their mEvents order within their event type
+    std::vector<uint32> next(mEventIndexStart, mEventIndexStart + SMART_EVENT_END);
+    mEventIndex.resize(mEventIndexStart[SMART_EVENT_END]);
+    for (uint32 i = 0; i < mEvents.size(); ++i)
+    {
+        uint32 eventType = mEvents[i].GetEventType();
+        if (eventType != SMART_EVENT_LINK && eventType < SMART_EVENT_END)
+            mEventIndex[next[eventType]++] = i;
+    }
+
+    UpdateEventConditions();
+}
+
+void SmartScript::UpdateEventConditions()
+{
+    mEventConditions.resize(mEvents.size());
+    for (uint32 i = 0; i < mEvents.size(); ++i)
+        mEventConditions[i] = sConditionMgr->GetConditionsForSmartEvent(mEvents[i].entryOrGuid, mEvents[i].event_id, mEvents[i].source_type);
+
+    mEventConditionsVersion = sConditionMgr->GetConditionsVersion();
+}
+
 void SmartScript::OnUpdate(uint32 const diff)
 {
     if ((mScriptType == SMART_SCRIPT_TYPE_CREATURE || mScriptType == SMART_SCRIPT_TYPE_GAMEOBJECT) && !GetBaseObject())
@@ -3199,8 +3287,22 @@ void SmartScript::OnUpdate(uint32 const diff)
 
     InstallEvents();//before UpdateTimers
 
-    for (SmartAIEventList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
-        UpdateTimer(*i, diff);
+    // holders of other events only need their timer while a cooldown runs
+    for (uint32 i = 0; i < mTimedEvents.size(); ++i)
+        UpdateTimer(mEvents[mTimedEvents[i]], diff);
+
+    for (uint32 i = 0; i < mCooldownEvents.size();)
+    {
+        SmartScriptHolder& holder = mEvents[mCooldownEvents[i]];
+        UpdateTimer(holder, diff);
+        if (holder.active)
+        {
+            mCooldownEvents[i] = mCooldownEvents.back();
+            mCooldownEvents.pop_back();
+        }
+        else
+            ++i;
+    }
 
     if (!mStoredEvents.empty())
         for (SmartAIEventList::iterator i = mStoredEvents.begin(); i != mStoredEvents.end(); ++i)
@@ -3340,6 +3442,7 @@ void SmartScript::OnInitialize(WorldObject* obj, AreaTriggerEntry const* at)
     for (SmartAIEventList::iterator i = mEvents.begin(); i != mEvents.end(); ++i)
         InitTimer((*i));//calculate timers for first time use
 
+    IndexEvents();
     ProcessEventsFor(SMART_EVENT_AI_INIT);
     InstallEvents();
     ProcessEventsFor(SMART_EVENT_JUST_CREATED);
@@ -44,6 +44,7 @@ class SmartScript
         void RecalcTimer(SmartScriptHolder& e, uint32 min, uint32 max);
         void UpdateTimer(SmartScriptHolder& e, uint32 const diff);
         void InitTimer(SmartScriptHolder& e);
+        static bool IsTimedEvent(uint32 eventType);
         void ProcessAction(SmartScriptHolder& e, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellInfo* spell = NULL, GameObject* gob = NULL);
         void ProcessTimedAction(SmartScriptHolder& e, uint32 const& min, uint32 const& max, Unit* unit = NULL, uint32 var0 = 0, uint32 var1 = 0, bool bvar = false, const SpellInfo* spell = NULL, GameObject* gob = NULL);
         ObjectList* GetTargets(SmartScriptHolder const& e, Unit* invoker = NULL);
@@ -220,6 +221,13 @@ class SmartScript
         void SetPhase(uint32 p = 0) { mEventPhase = p; }
 
         SmartAIEventList mEvents;
+        // mEvents positions grouped by event type, the holders of type t are mEventIndex[mEventIndexStart[t]] up to mEventIndex[mEventIndexStart[t + 1]]
+        std::vector<uint32> mEventIndex;
+        uint32 mEventIndexStart[SMART_EVENT_END + 1];
+        std::vector<ConditionList const*> mEventConditions; // conditions of the mEvents holders, NULL if they have none
+        uint32 mEventConditionsVersion;
+        std::vector<uint32> mTimedEvents;                   // mEvents positions of the holders checked every update
+        std::vector<uint32> mCooldownEvents;                // mEvents positions of other holders while their cooldown runs
         SmartAIEventList mInstallEvents;
         SmartAIEventList mTimedActionList;
         Creature* me;
@@ -242,6 +250,8 @@ class SmartScript
 
         SMARTAI_TEMPLATE mTemplate;
         void InstallEvents();
+        void IndexEvents();
+        void UpdateEventConditions();
 
         void RemoveStoredEvent (uint32 id)
         {
@@ -181,15 +181,19 @@ RBACCommandResult RBACData::RevokePermission(uint32 permissionId, int32 realmId
 
 void RBACData::LoadFromDB()
 {
-    ClearData();
-
-    TC_LOG_DEBUG("rbac", "RBACData::LoadFromDB [Id: %u Name: %s]: Loading permissions", GetId(), GetName().c_str());
     // Load account permissions (granted and denied) that affect current realm
     PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_RBAC_ACCOUNT_PERMISSIONS);
     stmt->setUInt32(0, GetId());
     stmt->setInt32(1, GetRealmId());
 
-    PreparedQueryResult result = LoginDatabase.Query(stmt);
+    LoadFromDB(LoginDatabase.Query(stmt));
+}
+
+void RBACData::LoadFromDB(PreparedQueryResult result)
+{
+    ClearData();
+
+    TC_LOG_DEBUG("rbac", "RBACData::LoadFromDB [Id: %u Name: %s]: Loading permissions", GetId(), GetName().c_str());
     if (result)
     {
         do
@@ -41,6 +41,7 @@
 #define _RBAC_H
 
 #include "Define.h"
+#include "QueryResult.h"
 #include <string>
 #include <set>
 #include <map>
@@ -701,6 +702,12 @@ enum RBACPermissions
     RBAC_PERM_COMMAND_QUESTCOMPLETER_DEL                     = 1005,
 	RBAC_PERM_COMMAND_MALL									 = 1006,
 	RBAC_PERM_COMMAND_WORLD_CHAT							 = 1007,
+    RBAC_PERM_COMMAND_SERVER_SLABS                           = 1008,
+    RBAC_PERM_COMMAND_DEBUG_PACKETLOG                        = 1009,
+    RBAC_PERM_COMMAND_DEBUG_PACKETLOG_FLUSH                  = 1010,
+    RBAC_PERM_COMMAND_DEBUG_PACKETLOG_REPLAY                 = 1011,
+    RBAC_PERM_COMMAND_SERVER_TICKSTATS                       = 1012,
+    RBAC_PERM_COMMAND_DEBUG_BGQUEUESIM                       = 1013,
     RBAC_PERM_MAX
 };
 
@@ -861,6 +868,9 @@ class RBACData
         /// Loads all permissions assigned to current account
         void LoadFromDB();
 
+        /// Loads all permissions assigned to current account from the result of LOGIN_SEL_RBAC_ACCOUNT_PERMISSIONS
+        void LoadFromDB(PreparedQueryResult result);
+
         /// Sets security level
         void SetSecurityLevel(uint8 id)
         {
@@ -30,8 +30,10 @@
 /***            BATTLEGROUND QUEUE SYSTEM              ***/
 /*********************************************************/
 
-BattlegroundQueue::BattlegroundQueue()
+BattlegroundQueue::BattlegroundQueue() : m_WaitingSequence(0)
 {
+    memset(m_WaitingPlayers, 0, sizeof(m_WaitingPlayers));
+
     for (uint32 i = 0; i < BG_TEAMS_COUNT; ++i)
     {
         for (uint32 j = 0; j < MAX_BATTLEGROUND_BRACKETS; ++j)
@@ -193,7 +195,7 @@ GroupQueueInfo* BattlegroundQueue::AddGroup(Player* leader, Group* grp, Battlegr
     //add GroupInfo to m_QueuedGroups
     {
         //ACE_Guard<ACE_Recursive_Thread_Mutex> guard(m_Lock);
-        m_QueuedGroups[bracketId][index].push_back(ginfo);
+        QueueGroup(ginfo, bracketId, index, false);
 
         //announce to world, this code needs mutex
         if (!isRated && !isPremade && sWorld->getBoolConfig(CONFIG_BATTLEGROUND_QUEUE_ANNOUNCER_ENABLE))
@@ -202,17 +204,10 @@ GroupQueueInfo* BattlegroundQueue::AddGroup(Player* leader, Group* grp, Battlegr
             {
                 char const* bgName = bg->GetName();
                 uint32 MinPlayers = bg->GetMinPlayersPerTeam();
-                uint32 qHorde = 0;
-                uint32 qAlliance = 0;
+                uint32 qHorde = m_WaitingPlayers[bracketId][BG_QUEUE_NORMAL_HORDE];
+                uint32 qAlliance = m_WaitingPlayers[bracketId][BG_QUEUE_NORMAL_ALLIANCE];
                 uint32 q_min_level = bracketEntry->minLevel;
                 uint32 q_max_level = bracketEntry->maxLevel;
-                GroupsQueueType::const_iterator itr;
-                for (itr = m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_ALLIANCE].begin(); itr != m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_ALLIANCE].end(); ++itr)
-                    if (!(*itr)->isInvitedToBGInstanceGUID)
-                        qAlliance += (*itr)->players.size();
-                for (itr = m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_HORDE].begin(); itr != m_QueuedGroups[bracketId][BG_QUEUE_NORMAL_HORDE].end(); ++itr)
-                    if (!(*itr)->isInvitedToBGInstanceGUID)
-                        qHorde += (*itr)->players.size();
 
                 // Show queue status to player only (when joining queue)
                 if (sWorld->getBoolConfig(CONFIG_BATTLEGROUND_QUEUE_ANNOUNCER_PLAYERONLY))
@@ -301,39 +296,9 @@ void BattlegroundQueue::RemovePlayer(uint64 guid, bool decreaseInvitedCount)
     }
 
     GroupQueueInfo* group = itr->second.GroupInfo;
-    GroupsQueueType::iterator group_itr;
-    // mostly people with the highest levels are in battlegrounds, thats why
-    // we count from MAX_BATTLEGROUND_QUEUES - 1 to 0
-
-    uint32 index = (group->team == HORDE) ? BG_QUEUE_PREMADE_HORDE : BG_QUEUE_PREMADE_ALLIANCE;
-
-    for (int32 bracket_id_tmp = MAX_BATTLEGROUND_BRACKETS - 1; bracket_id_tmp >= 0 && bracket_id == -1; --bracket_id_tmp)
-    {
-        //we must check premade and normal team's queue - because when players from premade are joining bg,
-        //they leave groupinfo so we can't use its players size to find out index
-        for (uint32 j = index; j < BG_QUEUE_GROUP_TYPES_COUNT; j += BG_TEAMS_COUNT)
-        {
-            GroupsQueueType::iterator k = m_QueuedGroups[bracket_id_tmp][j].begin();
-            for (; k != m_QueuedGroups[bracket_id_tmp][j].end(); ++k)
-            {
-                if ((*k) == group)
-                {
-                    bracket_id = bracket_id_tmp;
-                    group_itr = k;
-                    //we must store index to be able to erase iterator
-                    index = j;
-                    break;
-                }
-            }
-        }
-    }
+    // the group knows the queue it is stored in
+    bracket_id = group->bracketId;
 
-    //player can't be in queue without group, but just in case
-    if (bracket_id == -1)
-    {
-        TC_LOG_ERROR("bg.battleground", "BattlegroundQueue: ERROR Cannot find groupinfo for player GUID: %u", GUID_LOPART(guid));
-        return;
-    }
     TC_LOG_DEBUG("bg.battleground", "BattlegroundQueue: Removing player GUID %u, from bracket_id %u", GUID_LOPART(guid), (uint32)bracket_id);
 
     // ALL variables are correctly set
@@ -344,7 +309,11 @@ void BattlegroundQueue::RemovePlayer(uint64 guid, bool decreaseInvitedCount)
     // remove player queue info from group queue info
     std::map<uint64, PlayerQueueInfo*>::iterator pitr = group->players.find(guid);
     if (pitr != group->players.end())
+    {
         group->players.erase(pitr);
+        if (!group->isInvitedToBGInstanceGUID)
+            --m_WaitingPlayers[group->bracketId][group->queueIndex];
+    }
 
     // if invited to bg, and should decrease invited count, then do it
     if (decreaseInvitedCount && group->isInvitedToBGInstanceGUID)
@@ -386,7 +355,7 @@ void BattlegroundQueue::RemovePlayer(uint64 guid, bool decreaseInvitedCount)
     // remove group queue info if needed
     if (group->players.empty())
     {
-        m_QueuedGroups[bracket_id][index].erase(group_itr);
+        UnqueueGroup(group);
         delete group;
         return;
     }
@@ -447,6 +416,8 @@ bool BattlegroundQueue::InviteGroupToBG(GroupQueueInfo* ginfo, Battleground* bg,
     if (!ginfo->isInvitedToBGInstanceGUID)
     {
         // not yet invited
+        RemoveWaitingGroup(ginfo);
+
         // set invitation
         ginfo->isInvitedToBGInstanceGUID = bg->GetInstanceID();
         BattlegroundTypeId bgTypeId = bg->GetTypeID();
@@ -508,16 +479,16 @@ void BattlegroundQueue::FillPlayersToBG(Battleground* bg, BattlegroundBracketId
     int32 aliFree   = bg->GetFreeSlotsForTeam(ALLIANCE);
 
     //iterator for iterating through bg queue
-    GroupsQueueType::const_iterator Ali_itr = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE].begin();
+    GroupsQueueType::const_iterator Ali_itr = m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE].begin();
     //count of groups in queue - used to stop cycles
-    uint32 aliCount = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE].size();
+    uint32 aliCount = m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE].size();
     //index to queue which group is current
     uint32 aliIndex = 0;
     for (; aliIndex < aliCount && m_SelectionPools[TEAM_ALLIANCE].AddGroup((*Ali_itr), aliFree); aliIndex++)
         ++Ali_itr;
     //the same thing for horde
-    GroupsQueueType::const_iterator Horde_itr = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_HORDE].begin();
-    uint32 hordeCount = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_HORDE].size();
+    GroupsQueueType::const_iterator Horde_itr = m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_HORDE].begin();
+    uint32 hordeCount = m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_HORDE].size();
     uint32 hordeIndex = 0;
     for (; hordeIndex < hordeCount && m_SelectionPools[TEAM_HORDE].AddGroup((*Horde_itr), hordeFree); hordeIndex++)
         ++Horde_itr;
@@ -583,37 +554,25 @@ void BattlegroundQueue::FillPlayersToBG(Battleground* bg, BattlegroundBracketId
 bool BattlegroundQueue::CheckPremadeMatch(BattlegroundBracketId bracket_id, uint32 MinPlayersPerTeam, uint32 MaxPlayersPerTeam)
 {
     //check match
-    if (!m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].empty() && !m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].empty())
+    //start premade match with the first groups that aren't invited
+    if (!m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].empty() && !m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].empty())
     {
-        //start premade match
-        //if groups aren't invited
-        GroupsQueueType::const_iterator ali_group, horde_group;
-        for (ali_group = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].begin(); ali_group != m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].end(); ++ali_group)
-            if (!(*ali_group)->isInvitedToBGInstanceGUID)
-                break;
-        for (horde_group = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].begin(); horde_group != m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].end(); ++horde_group)
-            if (!(*horde_group)->isInvitedToBGInstanceGUID)
-                break;
-
-        if (ali_group != m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].end() && horde_group != m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].end())
+        m_SelectionPools[TEAM_ALLIANCE].AddGroup(m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].front(), MaxPlayersPerTeam);
+        m_SelectionPools[TEAM_HORDE].AddGroup(m_WaitingGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].front(), MaxPlayersPerTeam);
+        //add groups/players from normal queue to size of bigger group
+        uint32 maxPlayers = std::min(m_SelectionPools[TEAM_ALLIANCE].GetPlayerCount(), m_SelectionPools[TEAM_HORDE].GetPlayerCount());
+        GroupsQueueType::const_iterator itr;
+        for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
         {
-            m_SelectionPools[TEAM_ALLIANCE].AddGroup((*ali_group), MaxPlayersPerTeam);
-            m_SelectionPools[TEAM_HORDE].AddGroup((*horde_group), MaxPlayersPerTeam);
-            //add groups/players from normal queue to size of bigger group
-            uint32 maxPlayers = std::min(m_SelectionPools[TEAM_ALLIANCE].GetPlayerCount(), m_SelectionPools[TEAM_HORDE].GetPlayerCount());
-            GroupsQueueType::const_iterator itr;
-            for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
+            for (itr = m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].begin(); itr != m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].end(); ++itr)
             {
-                for (itr = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].begin(); itr != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].end(); ++itr)
-                {
-                    //if itr can join BG and player count is less that maxPlayers, then add group to selectionpool
-                    if (!(*itr)->isInvitedToBGInstanceGUID && !m_SelectionPools[i].AddGroup((*itr), maxPlayers))
-                        break;
-                }
+                //if itr can join BG and player count is less that maxPlayers, then add group to selectionpool
+                if (!m_SelectionPools[i].AddGroup((*itr), maxPlayers))
+                    break;
             }
-            //premade selection pools are set
-            return true;
         }
+        //premade selection pools are set
+        return true;
     }
     // now check if we can move group from Premade queue to normal queue (timer has expired) or group size lowered!!
     // this could be 2 cycles but i'm checking only first team in queue - it can cause problem -
@@ -624,12 +583,12 @@ bool BattlegroundQueue::CheckPremadeMatch(BattlegroundBracketId bracket_id, uint
     {
         if (!m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].empty())
         {
-            GroupsQueueType::iterator itr = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].begin();
-            if (!(*itr)->isInvitedToBGInstanceGUID && ((*itr)->joinTime < time_before || (*itr)->players.size() < MinPlayersPerTeam))
+            GroupQueueInfo* ginfo = m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].front();
+            if (!ginfo->isInvitedToBGInstanceGUID && (ginfo->joinTime < time_before || ginfo->players.size() < MinPlayersPerTeam))
             {
                 //we must insert group to normal queue and erase pointer from premade queue
-                m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].push_front((*itr));
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE + i].erase(itr);
+                UnqueueGroup(ginfo);
+                QueueGroup(ginfo, bracket_id, BG_QUEUE_NORMAL_ALLIANCE + i, true);
             }
         }
     }
@@ -638,20 +597,22 @@ bool BattlegroundQueue::CheckPremadeMatch(BattlegroundBracketId bracket_id, uint
 }
 
 // this method tries to create battleground or arena with MinPlayersPerTeam against MinPlayersPerTeam
-bool BattlegroundQueue::CheckNormalMatch(Battleground* /*bg_template*/, BattlegroundBracketId bracket_id, uint32 minPlayers, uint32 maxPlayers)
+bool BattlegroundQueue::CheckNormalMatch(Battleground* bg_template, BattlegroundBracketId bracket_id, uint32 minPlayers, uint32 maxPlayers)
 {
+    // not enough players waiting on one side, skip building the pools (arenas still need them for same faction skirmishes)
+    if (!bg_template->IsArena() && !sBattlegroundMgr->isTesting()
+        && (m_WaitingPlayers[bracket_id][BG_QUEUE_NORMAL_ALLIANCE] < minPlayers || m_WaitingPlayers[bracket_id][BG_QUEUE_NORMAL_HORDE] < minPlayers))
+        return false;
+
     GroupsQueueType::const_iterator itr_team[BG_TEAMS_COUNT];
     for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
     {
-        itr_team[i] = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].begin();
-        for (; itr_team[i] != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].end(); ++(itr_team[i]))
+        itr_team[i] = m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].begin();
+        for (; itr_team[i] != m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + i].end(); ++(itr_team[i]))
         {
-            if (!(*(itr_team[i]))->isInvitedToBGInstanceGUID)
-            {
-                m_SelectionPools[i].AddGroup(*(itr_team[i]), maxPlayers);
-                if (m_SelectionPools[i].GetPlayerCount() >= minPlayers)
-                    break;
-            }
+            m_SelectionPools[i].AddGroup(*(itr_team[i]), maxPlayers);
+            if (m_SelectionPools[i].GetPlayerCount() >= minPlayers)
+                break;
         }
     }
     //try to invite same number of players - this cycle may cause longer wait time even if there are enough players in queue, but we want ballanced bg
@@ -663,11 +624,10 @@ bool BattlegroundQueue::CheckNormalMatch(Battleground* /*bg_template*/, Battlegr
     {
         //we will try to invite more groups to team with less players indexed by j
         ++(itr_team[j]);                                         //this will not cause a crash, because for cycle above reached break;
-        for (; itr_team[j] != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + j].end(); ++(itr_team[j]))
+        for (; itr_team[j] != m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + j].end(); ++(itr_team[j]))
         {
-            if (!(*(itr_team[j]))->isInvitedToBGInstanceGUID)
-                if (!m_SelectionPools[j].AddGroup(*(itr_team[j]), m_SelectionPools[(j + 1) % BG_TEAMS_COUNT].GetPlayerCount()))
-                    break;
+            if (!m_SelectionPools[j].AddGroup(*(itr_team[j]), m_SelectionPools[(j + 1) % BG_TEAMS_COUNT].GetPlayerCount()))
+                break;
         }
         // do not allow to start bg with more than 2 players more on 1 faction
         if (abs((int32)(m_SelectionPools[TEAM_HORDE].GetPlayerCount() - m_SelectionPools[TEAM_ALLIANCE].GetPlayerCount())) > 2)
@@ -698,20 +658,16 @@ bool BattlegroundQueue::CheckSkirmishForSameFaction(BattlegroundBracketId bracke
     m_SelectionPools[otherTeam].Init();
     //store last ginfo pointer
     GroupQueueInfo* ginfo = m_SelectionPools[teamIndex].SelectedGroups.back();
-    //set itr_team to group that was added to selection pool latest
-    GroupsQueueType::iterator itr_team = m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].begin();
-    for (; itr_team != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].end(); ++itr_team)
-        if (ginfo == *itr_team)
-            break;
-    if (itr_team == m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].end())
+    //the group that was added to selection pool latest is still waiting in its queue
+    if (ginfo->bracketId != bracket_id || ginfo->queueIndex != BG_QUEUE_NORMAL_ALLIANCE + teamIndex)
         return false;
-    GroupsQueueType::iterator itr_team2 = itr_team;
+    GroupsQueueType::iterator itr_team2 = ginfo->waitingPosition;
     ++itr_team2;
     //invite players to other selection pool
-    for (; itr_team2 != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].end(); ++itr_team2)
+    for (; itr_team2 != m_WaitingGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].end(); ++itr_team2)
     {
         //if selection pool is full then break;
-        if (!(*itr_team2)->isInvitedToBGInstanceGUID && !m_SelectionPools[otherTeam].AddGroup(*itr_team2, minPlayersPerTeam))
+        if (!m_SelectionPools[otherTeam].AddGroup(*itr_team2, minPlayersPerTeam))
             break;
     }
     if (m_SelectionPools[otherTeam].GetPlayerCount() != minPlayersPerTeam)
@@ -722,21 +678,92 @@ bool BattlegroundQueue::CheckSkirmishForSameFaction(BattlegroundBracketId bracke
     {
         //set correct team
         (*itr)->team = otherTeamId;
-        //add team to other queue
-        m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + otherTeam].push_front(*itr);
-        //remove team from old queue
-        GroupsQueueType::iterator itr2 = itr_team;
-        ++itr2;
-        for (; itr2 != m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].end(); ++itr2)
+        //move team to the front of the other queue
+        UnqueueGroup(*itr);
+        QueueGroup(*itr, bracket_id, BG_QUEUE_NORMAL_ALLIANCE + otherTeam, true);
+    }
+    return true;
+}
+
+void BattlegroundQueue::QueueGroup(GroupQueueInfo* ginfo, BattlegroundBracketId bracket_id, uint32 index, bool front)
+{
+    ginfo->bracketId = bracket_id;
+    ginfo->queueIndex = index;
+
+    GroupsQueueType& queued = m_QueuedGroups[bracket_id][index];
+    ginfo->queuePosition = queued.insert(front ? queued.begin() : queued.end(), ginfo);
+
+    if (ginfo->isInvitedToBGInstanceGUID)
+        return;
+
+    GroupsQueueType& waiting = m_WaitingGroups[bracket_id][index];
+    ginfo->waitingPosition = waiting.insert(front ? waiting.begin() : waiting.end(), ginfo);
+    m_WaitingPlayers[bracket_id][index] += ginfo->players.size();
+
+    if (index < BG_QUEUE_NORMAL_ALLIANCE)
+    {
+        // groups put to the front count down, so the order matches the waiting list without walking it
+        ++m_WaitingSequence;
+        ginfo->waitingOrder = front ? -int64(m_WaitingSequence) : int64(m_WaitingSequence);
+        ginfo->ratingPosition = m_WaitingRatings[bracket_id][index].insert(std::make_pair(ginfo->teamMatchmakerRating, ginfo));
+    }
+}
+
+void BattlegroundQueue::UnqueueGroup(GroupQueueInfo* ginfo)
+{
+    m_QueuedGroups[ginfo->bracketId][ginfo->queueIndex].erase(ginfo->queuePosition);
+
+    if (!ginfo->isInvitedToBGInstanceGUID)
+        RemoveWaitingGroup(ginfo);
+}
+
+void BattlegroundQueue::RemoveWaitingGroup(GroupQueueInfo* ginfo)
+{
+    m_WaitingGroups[ginfo->bracketId][ginfo->queueIndex].erase(ginfo->waitingPosition);
+    m_WaitingPlayers[ginfo->bracketId][ginfo->queueIndex] -= ginfo->players.size();
+
+    if (ginfo->queueIndex < BG_QUEUE_NORMAL_ALLIANCE)
+        m_WaitingRatings[ginfo->bracketId][ginfo->queueIndex].erase(ginfo->ratingPosition);
+}
+
+GroupQueueInfo* BattlegroundQueue::SelectRatedGroup(BattlegroundBracketId bracket_id, uint32 index, uint32 minRating, uint32 maxRating, uint32 discardTime, GroupQueueInfo const* opponent)
+{
+    // groups which waited longer than discardTime match any rating, they are at the front of the queue
+    GroupsQueueType const& waiting = m_WaitingGroups[bracket_id][index];
+    for (GroupsQueueType::const_iterator itr = waiting.begin(); itr != waiting.end() && (*itr)->joinTime < discardTime; ++itr)
+        if (!opponent || opponent->leaderGUID != (*itr)->leaderGUID)
+            return *itr;
+
+    // otherwise the group within the rating range that is closest to the front of the queue
+    GroupQueueInfo* selected = NULL;
+    GroupsRatingIndex const& ratings = m_WaitingRatings[bracket_id][index];
+    for (GroupsRatingIndex::const_iterator itr = ratings.lower_bound(minRating); itr != ratings.end() && itr->first <= maxRating; ++itr)
+        if ((!opponent || opponent->leaderGUID != itr->second->leaderGUID) && (!selected || itr->second->waitingOrder < selected->waitingOrder))
+            selected = itr->second;
+
+    return selected;
+}
+
+uint8 BattlegroundQueue::SelectRatedTeams(BattlegroundBracketId bracket_id, uint32 minRating, uint32 maxRating, uint32 discardTime, GroupQueueInfo* teams[BG_TEAMS_COUNT])
+{
+    uint8 found = 0;
+    uint8 team = 0;
+
+    for (uint8 i = BG_QUEUE_PREMADE_ALLIANCE; i < BG_QUEUE_NORMAL_ALLIANCE; i++)
+    {
+        // take the group that joined first
+        if (GroupQueueInfo* ginfo = SelectRatedGroup(bracket_id, i, minRating, maxRating, discardTime, NULL))
         {
-            if (*itr2 == *itr)
-            {
-                m_QueuedGroups[bracket_id][BG_QUEUE_NORMAL_ALLIANCE + teamIndex].erase(itr2);
-                break;
-            }
+            teams[found++] = ginfo;
+            team = i;
         }
     }
-    return true;
+
+    if (found == 1)
+        if (GroupQueueInfo* ginfo = SelectRatedGroup(bracket_id, team, minRating, maxRating, discardTime, teams[0]))
+            teams[found++] = ginfo;
+
+    return found;
 }
 
 void BattlegroundQueue::UpdateEvents(uint32 diff)
@@ -904,51 +931,14 @@ void BattlegroundQueue::BattlegroundQueueUpdate(uint32 /*diff*/, BattlegroundTyp
         uint32 discardTime = getMSTime() - sBattlegroundMgr->GetRatingDiscardTimer();
 
         // we need to find 2 teams which will play next game
-        GroupsQueueType::iterator itr_teams[BG_TEAMS_COUNT];
-        uint8 found = 0;
-        uint8 team = 0;
-
-        for (uint8 i = BG_QUEUE_PREMADE_ALLIANCE; i < BG_QUEUE_NORMAL_ALLIANCE; i++)
-        {
-            // take the group that joined first
-            GroupsQueueType::iterator itr2 = m_QueuedGroups[bracket_id][i].begin();
-            for (; itr2 != m_QueuedGroups[bracket_id][i].end(); ++itr2)
-            {
-                // if group match conditions, then add it to pool
-                if (!(*itr2)->isInvitedToBGInstanceGUID
-                    && (((*itr2)->teamMatchmakerRating >= arenaMinRating && (*itr2)->teamMatchmakerRating <= arenaMaxRating)
-                        || (*itr2)->joinTime < discardTime))
-                {
-                    itr_teams[found++] = itr2;
-                    team = i;
-                    break;
-                }
-            }
-        }
-
-        if (!found)
-            return;
-
-        if (found == 1)
-        {
-            for (GroupsQueueType::iterator itr3 = itr_teams[0]; itr3 != m_QueuedGroups[bracket_id][team].end(); ++itr3)
-            {
-                if (!(*itr3)->isInvitedToBGInstanceGUID
-                    && (((*itr3)->teamMatchmakerRating >= arenaMinRating && (*itr3)->teamMatchmakerRating <= arenaMaxRating)
-                        || (*itr3)->joinTime < discardTime)
-                    && (*itr_teams[0])->leaderGUID != (*itr3)->leaderGUID)
-                {
-                    itr_teams[found++] = itr3;
-                    break;
-                }
-            }
-        }
+        GroupQueueInfo* teams[BG_TEAMS_COUNT];
+        uint8 found = SelectRatedTeams(bracket_id, arenaMinRating, arenaMaxRating, discardTime, teams);
 
         //if we have 2 teams, then start new arena and invite players!
         if (found == 2)
         {
-            GroupQueueInfo* aTeam = *itr_teams[TEAM_ALLIANCE];
-            GroupQueueInfo* hTeam = *itr_teams[TEAM_HORDE];
+            GroupQueueInfo* aTeam = teams[TEAM_ALLIANCE];
+            GroupQueueInfo* hTeam = teams[TEAM_HORDE];
             Battleground* arena = sBattlegroundMgr->CreateNewBattleground(bgTypeId, bracketEntry, ratedType, true);
             if (!arena)
             {
@@ -966,13 +956,13 @@ void BattlegroundQueue::BattlegroundQueueUpdate(uint32 /*diff*/, BattlegroundTyp
             // now we must move team if we changed its faction to another faction queue, because then we will spam log by errors in Queue::RemovePlayer
             if (aTeam->team != ALLIANCE)
             {
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].push_front(aTeam);
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].erase(itr_teams[TEAM_ALLIANCE]);
+                UnqueueGroup(aTeam);
+                QueueGroup(aTeam, bracket_id, BG_QUEUE_PREMADE_ALLIANCE, true);
             }
             if (hTeam->team != HORDE)
             {
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_HORDE].push_front(hTeam);
-                m_QueuedGroups[bracket_id][BG_QUEUE_PREMADE_ALLIANCE].erase(itr_teams[TEAM_HORDE]);
+                UnqueueGroup(hTeam);
+                QueueGroup(hTeam, bracket_id, BG_QUEUE_PREMADE_HORDE, true);
             }
 
             arena->SetTeamMatchmakerRating(ALLIANCE, aTeam->teamMatchmakerRating);
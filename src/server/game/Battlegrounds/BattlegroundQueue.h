@@ -52,6 +52,12 @@ struct GroupQueueInfo                                       // stores informatio
     uint32  teamMatchmakerRating;                           // if rated match, inited to the rating of the team
     uint32  opponentsTeamRating;                            // for rated arena matches
     uint32  opponentsTeamMatchmakerRating;                  // for rated arena matches
+    BattlegroundBracketId bracketId;                        // bracket of the queue the group is stored in
+    uint32  queueIndex;                                     // BattlegroundQueueGroupTypes of the queue the group is stored in
+    std::list<GroupQueueInfo*>::iterator queuePosition;     // position in BattlegroundQueue::m_QueuedGroups
+    std::list<GroupQueueInfo*>::iterator waitingPosition;   // position in BattlegroundQueue::m_WaitingGroups, until invited
+    std::multimap<uint32, GroupQueueInfo*>::iterator ratingPosition; // position in BattlegroundQueue::m_WaitingRatings, until invited (premade queues only)
+    int64   waitingOrder;                                   // orders the group in its waiting list, lower is closer to the front (premade queues only)
 };
 
 enum BattlegroundQueueGroupTypes
@@ -64,8 +70,11 @@ enum BattlegroundQueueGroupTypes
 #define BG_QUEUE_GROUP_TYPES_COUNT 4
 
 class Battleground;
+class BattlegroundQueueSimulation;
 class BattlegroundQueue
 {
+    friend class BattlegroundQueueSimulation;
+
     public:
         BattlegroundQueue();
         ~BattlegroundQueue();
@@ -101,6 +110,16 @@ class BattlegroundQueue
         */
         GroupsQueueType m_QueuedGroups[MAX_BATTLEGROUND_BRACKETS][BG_QUEUE_GROUP_TYPES_COUNT];
 
+        /*
+        Groups of m_QueuedGroups that are not invited yet, in the same order, so matching never walks invited groups.
+        Groups of the premade queues (rated arena teams) are also indexed by matchmaker rating.
+        Only change them through QueueGroup, UnqueueGroup and InviteGroupToBG.
+        */
+        typedef std::multimap<uint32, GroupQueueInfo*> GroupsRatingIndex;
+        GroupsQueueType m_WaitingGroups[MAX_BATTLEGROUND_BRACKETS][BG_QUEUE_GROUP_TYPES_COUNT];
+        GroupsRatingIndex m_WaitingRatings[MAX_BATTLEGROUND_BRACKETS][BG_TEAMS_COUNT];
+        uint32 m_WaitingPlayers[MAX_BATTLEGROUND_BRACKETS][BG_QUEUE_GROUP_TYPES_COUNT];
+
         // class to select and invite groups to bg
         class SelectionPool
         {
@@ -122,6 +141,17 @@ class BattlegroundQueue
     private:
 
         bool InviteGroupToBG(GroupQueueInfo* ginfo, Battleground* bg, uint32 side);
+
+        // adds the group to the front or the back of a queue, and to the waiting groups if it is not invited yet
+        void QueueGroup(GroupQueueInfo* ginfo, BattlegroundBracketId bracket_id, uint32 index, bool front);
+        // removes the group from the queue it is stored in
+        void UnqueueGroup(GroupQueueInfo* ginfo);
+        void RemoveWaitingGroup(GroupQueueInfo* ginfo);
+        // returns the longest waiting group of a premade queue that has a rating within the range or has waited longer than discardTime
+        GroupQueueInfo* SelectRatedGroup(BattlegroundBracketId bracket_id, uint32 index, uint32 minRating, uint32 maxRating, uint32 discardTime, GroupQueueInfo const* opponent);
+        // fills teams with the groups that play the next rated arena, returns how many were found
+        uint8 SelectRatedTeams(BattlegroundBracketId bracket_id, uint32 minRating, uint32 maxRating, uint32 discardTime, GroupQueueInfo* teams[BG_TEAMS_COUNT]);
+        uint32 m_WaitingSequence;
         uint32 m_WaitTimes[BG_TEAMS_COUNT][MAX_BATTLEGROUND_BRACKETS][COUNT_OF_PLAYERS_TO_AVERAGE_WAIT_TIME];
         uint32 m_WaitTimeLastPlayer[BG_TEAMS_COUNT][MAX_BATTLEGROUND_BRACKETS];
         uint32 m_SumOfWaitTimes[BG_TEAMS_COUNT][MAX_BATTLEGROUND_BRACKETS];
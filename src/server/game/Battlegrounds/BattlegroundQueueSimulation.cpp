@@ -0,0 +1,406 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BattlegroundQueueSimulation.h"
+#include "BattlegroundMgr.h"
+#include "Log.h"
+#include "Timer.h"
+#include "World.h"
+
+static uint32 GetUSTimeDiffToNow(ACE_Time_Value const& start)
+{
+    ACE_UINT64 elapsed;
+    (ACE_OS::gettimeofday() - start).to_usec(elapsed);
+    return uint32(elapsed);
+}
+
+void BattlegroundQueueSimulationTime::Add(uint32 time)
+{
+    totalTime += time;
+    maxTime = std::max(maxTime, time);
+    ++samples;
+}
+
+BattlegroundQueueSimulation::BattlegroundQueueSimulation(uint32 groupCount, uint32 seed) : _groupCount(groupCount),
+    _random(seed ? seed : 1), _round(0), _time(getMSTime()), _guid(0), _instanceId(0), _bgTemplate(NULL), _minPlayers(0), _maxPlayers(0),
+    _ratedType(RATED_TYPE_NOT_RATED), _battlegroundGroups(0), _arenaGroups(0), _battlegrounds(0), _arenas(0), _mismatches(0)
+{
+}
+
+void BattlegroundQueueSimulation::Run(Battleground* bgTemplate, RatedType ratedType)
+{
+    _bgTemplate = bgTemplate;
+    _ratedType = ratedType;
+    _maxPlayers = std::max<uint32>(bgTemplate->GetMaxPlayersPerTeam(), 1);
+    _minPlayers = sBattlegroundMgr->isTesting() ? 1 : std::max<uint32>(std::min<uint32>(bgTemplate->GetMinPlayersPerTeam(), _maxPlayers), 1);
+
+    // queues that filled up while nothing was matched, a quarter of the groups wait for rated arenas
+    for (uint32 i = 0; i < _groupCount; ++i)
+    {
+        if (Random(0, 3))
+            JoinBattleground();
+        else
+            JoinArena();
+    }
+
+    // every join is followed by an update of the bracket it joined, as BattlegroundMgr::ScheduleQueueUpdate does
+    uint32 joinsPerRound = std::max<uint32>(_groupCount / ROUNDS, 1);
+    for (_round = 1; _round <= ROUNDS; ++_round)
+    {
+        RemoveInvited();
+
+        for (uint32 i = 0; i < joinsPerRound; ++i)
+        {
+            if (Random(0, 3))
+                UpdateBattleground(JoinBattleground()->bracketId);
+            else
+            {
+                GroupQueueInfo* ginfo = JoinArena();
+                UpdateArena(ginfo->bracketId, ginfo->teamMatchmakerRating);
+            }
+        }
+    }
+}
+
+uint32 BattlegroundQueueSimulation::Random(uint32 min, uint32 max)
+{
+    // xorshift, the same seed gives the same queues on every run
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return min + _random % (max - min + 1);
+}
+
+BattlegroundBracketId BattlegroundQueueSimulation::RandomBracket()
+{
+    if (Random(0, 9) < 7)
+        return BattlegroundBracketId(MAX_BATTLEGROUND_BRACKETS - 1);
+
+    return BattlegroundBracketId(Random(0, MAX_BATTLEGROUND_BRACKETS - 2));
+}
+
+GroupQueueInfo* BattlegroundQueueSimulation::CreateGroup(uint32 size, uint32 team, bool isRated, uint32 matchmakerRating)
+{
+    GroupQueueInfo* ginfo                   = new GroupQueueInfo;
+    ginfo->bgTypeId                         = isRated ? BATTLEGROUND_AA : _bgTemplate->GetTypeID();
+    ginfo->ratedType                        = isRated ? _ratedType : RATED_TYPE_NOT_RATED;
+    ginfo->isRated                          = isRated;
+    ginfo->isInvitedToBGInstanceGUID        = 0;
+    ginfo->joinTime                         = _time;
+    ginfo->removeInviteTime                 = 0;
+    ginfo->leaderGUID                       = _guid + 1;
+    ginfo->team                             = team;
+    ginfo->teamRating                       = matchmakerRating;
+    ginfo->teamMatchmakerRating             = matchmakerRating;
+    ginfo->opponentsTeamRating              = 0;
+    ginfo->opponentsTeamMatchmakerRating    = 0;
+
+    // only the number of players is used by the selection, there are no PlayerQueueInfo
+    for (uint32 i = 0; i < size; ++i)
+        ginfo->players[++_guid] = NULL;
+
+    // a quarter of the groups joins in the same millisecond as the one before
+    if (Random(0, 3))
+        _time += JOIN_INTERVAL;
+
+    return ginfo;
+}
+
+GroupQueueInfo* BattlegroundQueueSimulation::JoinBattleground()
+{
+    uint32 team = Random(0, 1) ? HORDE : ALLIANCE;
+    bool isPremade = !Random(0, 9);
+    uint32 size = isPremade ? Random(_minPlayers, _maxPlayers) : (Random(0, 9) < 7 ? 1 : Random(1, std::min<uint32>(5, _maxPlayers)));
+
+    GroupQueueInfo* ginfo = CreateGroup(size, team, false, 0);
+    uint32 index = (isPremade ? BG_QUEUE_PREMADE_ALLIANCE : BG_QUEUE_NORMAL_ALLIANCE) + (team == HORDE ? 1 : 0);
+    _battlegroundQueue.QueueGroup(ginfo, RandomBracket(), index, false);
+    ++_battlegroundGroups;
+    return ginfo;
+}
+
+GroupQueueInfo* BattlegroundQueueSimulation::JoinArena()
+{
+    uint32 team = Random(0, 1) ? HORDE : ALLIANCE;
+    uint32 matchmakerRating = 1000 + Random(0, 1000) + Random(0, 1000);
+
+    GroupQueueInfo* ginfo = CreateGroup(_ratedType, team, true, matchmakerRating);
+    _arenaQueue.QueueGroup(ginfo, RandomBracket(), team == HORDE ? BG_QUEUE_PREMADE_HORDE : BG_QUEUE_PREMADE_ALLIANCE, false);
+    ++_arenaGroups;
+    return ginfo;
+}
+
+void BattlegroundQueueSimulation::UpdateBattleground(BattlegroundBracketId bracket_id)
+{
+    BattlegroundQueue& queue = _battlegroundQueue;
+    uint32 oldTime = 0;
+    uint32 newTime = 0;
+
+    for (uint32 i = 0; i < BG_TEAMS_COUNT; ++i)
+    {
+        queue.m_SelectionPools[i].Init();
+        _oldSelectionPools[i].Init();
+    }
+
+    // the old selection goes first, CheckPremadeMatch moves groups to the normal queues when it does not match
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    bool oldMatch = OldCheckPremadeMatch(bracket_id, _maxPlayers);
+    oldTime += GetUSTimeDiffToNow(start);
+
+    start = ACE_OS::gettimeofday();
+    bool match = queue.CheckPremadeMatch(bracket_id, _minPlayers, _maxPlayers);
+    newTime += GetUSTimeDiffToNow(start);
+
+    if (match != oldMatch || (match && !ComparePools(queue)))
+        Mismatch("premade", bracket_id);
+
+    if (match)
+    {
+        InvitePools(queue);
+        ++_battlegrounds;
+    }
+
+    for (uint32 i = 0; i < BG_TEAMS_COUNT; ++i)
+    {
+        queue.m_SelectionPools[i].Init();
+        _oldSelectionPools[i].Init();
+    }
+
+    start = ACE_OS::gettimeofday();
+    oldMatch = OldCheckNormalMatch(bracket_id, _minPlayers, _maxPlayers);
+    oldTime += GetUSTimeDiffToNow(start);
+
+    start = ACE_OS::gettimeofday();
+    match = queue.CheckNormalMatch(_bgTemplate, bracket_id, _minPlayers, _maxPlayers);
+    newTime += GetUSTimeDiffToNow(start);
+
+    // the queue gives up early when a side is short of players, the pools only have to agree on a match
+    if (match != oldMatch || (match && !ComparePools(queue)))
+        Mismatch("normal", bracket_id);
+
+    if (match)
+    {
+        InvitePools(queue);
+        ++_battlegrounds;
+    }
+
+    _oldBattlegroundTime.Add(oldTime);
+    _newBattlegroundTime.Add(newTime);
+}
+
+void BattlegroundQueueSimulation::UpdateArena(BattlegroundBracketId bracket_id, uint32 arenaRating)
+{
+    uint32 maxDifference = sBattlegroundMgr->GetMaxRatingDifference();
+    uint32 minRating = (arenaRating <= maxDifference) ? 0 : arenaRating - maxDifference;
+    uint32 maxRating = arenaRating + maxDifference;
+    uint32 discardTimer = sBattlegroundMgr->GetRatingDiscardTimer();
+    uint32 discardTime = _time > discardTimer ? _time - discardTimer : 0;
+
+    GroupQueueInfo* oldTeams[BG_TEAMS_COUNT];
+    ACE_Time_Value start = ACE_OS::gettimeofday();
+    uint8 oldFound = OldSelectRatedTeams(bracket_id, minRating, maxRating, discardTime, oldTeams);
+    _oldArenaTime.Add(GetUSTimeDiffToNow(start));
+
+    GroupQueueInfo* teams[BG_TEAMS_COUNT];
+    start = ACE_OS::gettimeofday();
+    uint8 found = _arenaQueue.SelectRatedTeams(bracket_id, minRating, maxRating, discardTime, teams);
+    _newArenaTime.Add(GetUSTimeDiffToNow(start));
+
+    bool same = found == oldFound;
+    for (uint8 i = 0; same && i < found; ++i)
+        same = teams[i] == oldTeams[i];
+
+    if (!same)
+        Mismatch("rated arena", bracket_id);
+
+    if (found != 2)
+        return;
+
+    // as BattlegroundQueueUpdate does, the first team plays for the alliance
+    GroupQueueInfo* aTeam = teams[TEAM_ALLIANCE];
+    GroupQueueInfo* hTeam = teams[TEAM_HORDE];
+    if (aTeam->team != ALLIANCE)
+    {
+        _arenaQueue.UnqueueGroup(aTeam);
+        _arenaQueue.QueueGroup(aTeam, bracket_id, BG_QUEUE_PREMADE_ALLIANCE, true);
+    }
+    if (hTeam->team != HORDE)
+    {
+        _arenaQueue.UnqueueGroup(hTeam);
+        _arenaQueue.QueueGroup(hTeam, bracket_id, BG_QUEUE_PREMADE_HORDE, true);
+    }
+
+    ++_instanceId;
+    Invite(_arenaQueue, aTeam, ALLIANCE);
+    Invite(_arenaQueue, hTeam, HORDE);
+    ++_arenas;
+}
+
+void BattlegroundQueueSimulation::Invite(BattlegroundQueue& queue, GroupQueueInfo* ginfo, uint32 side)
+{
+    ginfo->team = side;
+    queue.RemoveWaitingGroup(ginfo);
+    ginfo->isInvitedToBGInstanceGUID = _instanceId;
+    ginfo->removeInviteTime = _time + INVITE_ACCEPT_WAIT_TIME;
+    _invited.push_back(InvitedGroup(&queue, ginfo, _round + INVITE_ROUNDS));
+}
+
+void BattlegroundQueueSimulation::InvitePools(BattlegroundQueue& queue)
+{
+    ++_instanceId;
+    for (uint32 i = 0; i < BG_TEAMS_COUNT; ++i)
+        for (BattlegroundQueue::GroupsQueueType::const_iterator itr = queue.m_SelectionPools[i].SelectedGroups.begin(); itr != queue.m_SelectionPools[i].SelectedGroups.end(); ++itr)
+            Invite(queue, *itr, (*itr)->team);
+}
+
+void BattlegroundQueueSimulation::RemoveInvited()
+{
+    while (!_invited.empty() && _invited.front().expireRound <= _round)
+    {
+        InvitedGroup const& invited = _invited.front();
+        invited.queue->UnqueueGroup(invited.ginfo);
+        delete invited.ginfo;
+        _invited.pop_front();
+    }
+}
+
+bool BattlegroundQueueSimulation::ComparePools(BattlegroundQueue const& queue) const
+{
+    for (uint32 i = 0; i < BG_TEAMS_COUNT; ++i)
+        if (queue.m_SelectionPools[i].SelectedGroups != _oldSelectionPools[i].SelectedGroups)
+            return false;
+
+    return true;
+}
+
+void BattlegroundQueueSimulation::Mismatch(char const* selection, BattlegroundBracketId bracket_id)
+{
+    ++_mismatches;
+    TC_LOG_ERROR("bg.battleground", "BattlegroundQueueSimulation: the %s selection of bracket %u in round %u differs from the old selection", selection, bracket_id, _round);
+}
+
+bool BattlegroundQueueSimulation::OldCheckPremadeMatch(BattlegroundBracketId bracket_id, uint32 MaxPlayersPerTeam)
+{
+    BattlegroundQueue::GroupsQueueType (&queued)[BG_QUEUE_GROUP_TYPES_COUNT] = _battlegroundQueue.m_QueuedGroups[bracket_id];
+    if (queued[BG_QUEUE_PREMADE_ALLIANCE].empty() || queued[BG_QUEUE_PREMADE_HORDE].empty())
+        return false;
+
+    BattlegroundQueue::GroupsQueueType::const_iterator ali_group, horde_group;
+    for (ali_group = queued[BG_QUEUE_PREMADE_ALLIANCE].begin(); ali_group != queued[BG_QUEUE_PREMADE_ALLIANCE].end(); ++ali_group)
+        if (!(*ali_group)->isInvitedToBGInstanceGUID)
+            break;
+    for (horde_group = queued[BG_QUEUE_PREMADE_HORDE].begin(); horde_group != queued[BG_QUEUE_PREMADE_HORDE].end(); ++horde_group)
+        if (!(*horde_group)->isInvitedToBGInstanceGUID)
+            break;
+
+    if (ali_group == queued[BG_QUEUE_PREMADE_ALLIANCE].end() || horde_group == queued[BG_QUEUE_PREMADE_HORDE].end())
+        return false;
+
+    _oldSelectionPools[TEAM_ALLIANCE].AddGroup((*ali_group), MaxPlayersPerTeam);
+    _oldSelectionPools[TEAM_HORDE].AddGroup((*horde_group), MaxPlayersPerTeam);
+    uint32 maxPlayers = std::min(_oldSelectionPools[TEAM_ALLIANCE].GetPlayerCount(), _oldSelectionPools[TEAM_HORDE].GetPlayerCount());
+    for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
+        for (BattlegroundQueue::GroupsQueueType::const_iterator itr = queued[BG_QUEUE_NORMAL_ALLIANCE + i].begin(); itr != queued[BG_QUEUE_NORMAL_ALLIANCE + i].end(); ++itr)
+            if (!(*itr)->isInvitedToBGInstanceGUID && !_oldSelectionPools[i].AddGroup((*itr), maxPlayers))
+                break;
+
+    return true;
+}
+
+bool BattlegroundQueueSimulation::OldCheckNormalMatch(BattlegroundBracketId bracket_id, uint32 minPlayers, uint32 maxPlayers)
+{
+    BattlegroundQueue::GroupsQueueType (&queued)[BG_QUEUE_GROUP_TYPES_COUNT] = _battlegroundQueue.m_QueuedGroups[bracket_id];
+    BattlegroundQueue::GroupsQueueType::const_iterator itr_team[BG_TEAMS_COUNT];
+    for (uint32 i = 0; i < BG_TEAMS_COUNT; i++)
+    {
+        itr_team[i] = queued[BG_QUEUE_NORMAL_ALLIANCE + i].begin();
+        for (; itr_team[i] != queued[BG_QUEUE_NORMAL_ALLIANCE + i].end(); ++(itr_team[i]))
+        {
+            if (!(*(itr_team[i]))->isInvitedToBGInstanceGUID)
+            {
+                _oldSelectionPools[i].AddGroup(*(itr_team[i]), maxPlayers);
+                if (_oldSelectionPools[i].GetPlayerCount() >= minPlayers)
+                    break;
+            }
+        }
+    }
+
+    uint32 j = TEAM_ALLIANCE;
+    if (_oldSelectionPools[TEAM_HORDE].GetPlayerCount() < _oldSelectionPools[TEAM_ALLIANCE].GetPlayerCount())
+        j = TEAM_HORDE;
+    if (sWorld->getIntConfig(CONFIG_BATTLEGROUND_INVITATION_TYPE) != 0
+        && _oldSelectionPools[TEAM_HORDE].GetPlayerCount() >= minPlayers && _oldSelectionPools[TEAM_ALLIANCE].GetPlayerCount() >= minPlayers)
+    {
+        ++(itr_team[j]);
+        for (; itr_team[j] != queued[BG_QUEUE_NORMAL_ALLIANCE + j].end(); ++(itr_team[j]))
+        {
+            if (!(*(itr_team[j]))->isInvitedToBGInstanceGUID)
+                if (!_oldSelectionPools[j].AddGroup(*(itr_team[j]), _oldSelectionPools[(j + 1) % BG_TEAMS_COUNT].GetPlayerCount()))
+                    break;
+        }
+        if (abs((int32)(_oldSelectionPools[TEAM_HORDE].GetPlayerCount() - _oldSelectionPools[TEAM_ALLIANCE].GetPlayerCount())) > 2)
+            return false;
+    }
+
+    if (sBattlegroundMgr->isTesting() && (_oldSelectionPools[TEAM_ALLIANCE].GetPlayerCount() || _oldSelectionPools[TEAM_HORDE].GetPlayerCount()))
+        return true;
+
+    return _oldSelectionPools[TEAM_ALLIANCE].GetPlayerCount() >= minPlayers && _oldSelectionPools[TEAM_HORDE].GetPlayerCount() >= minPlayers;
+}
+
+uint8 BattlegroundQueueSimulation::OldSelectRatedTeams(BattlegroundBracketId bracket_id, uint32 minRating, uint32 maxRating, uint32 discardTime, GroupQueueInfo* teams[BG_TEAMS_COUNT])
+{
+    BattlegroundQueue::GroupsQueueType (&queued)[BG_QUEUE_GROUP_TYPES_COUNT] = _arenaQueue.m_QueuedGroups[bracket_id];
+    BattlegroundQueue::GroupsQueueType::iterator itr_teams[BG_TEAMS_COUNT];
+    uint8 found = 0;
+    uint8 team = 0;
+
+    for (uint8 i = BG_QUEUE_PREMADE_ALLIANCE; i < BG_QUEUE_NORMAL_ALLIANCE; i++)
+    {
+        for (BattlegroundQueue::GroupsQueueType::iterator itr2 = queued[i].begin(); itr2 != queued[i].end(); ++itr2)
+        {
+            if (!(*itr2)->isInvitedToBGInstanceGUID
+                && (((*itr2)->teamMatchmakerRating >= minRating && (*itr2)->teamMatchmakerRating <= maxRating)
+                    || (*itr2)->joinTime < discardTime))
+            {
+                itr_teams[found++] = itr2;
+                team = i;
+                break;
+            }
+        }
+    }
+
+    if (found == 1)
+    {
+        for (BattlegroundQueue::GroupsQueueType::iterator itr3 = itr_teams[0]; itr3 != queued[team].end(); ++itr3)
+        {
+            if (!(*itr3)->isInvitedToBGInstanceGUID
+                && (((*itr3)->teamMatchmakerRating >= minRating && (*itr3)->teamMatchmakerRating <= maxRating)
+                    || (*itr3)->joinTime < discardTime)
+                && (*itr_teams[0])->leaderGUID != (*itr3)->leaderGUID)
+            {
+                itr_teams[found++] = itr3;
+                break;
+            }
+        }
+    }
+
+    for (uint8 i = 0; i < found; ++i)
+        teams[i] = *itr_teams[i];
+
+    return found;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BATTLEGROUNDQUEUESIMULATION_H
+#define __BATTLEGROUNDQUEUESIMULATION_H
+
+#include "BattlegroundQueue.h"
+
+#include <deque>
+
+//! Time spent selecting groups, in microseconds
+struct BattlegroundQueueSimulationTime
+{
+    BattlegroundQueueSimulationTime() : totalTime(0), maxTime(0), samples(0) { }
+
+    void Add(uint32 time);
+    float GetAverageTime() const { return samples ? float(totalTime) / samples : 0.0f; }
+
+    uint64 totalTime;
+    uint32 maxTime;
+    uint32 samples;
+};
+
+//! Fills private battleground and rated arena queues with generated groups, without players, and matches them the
+//! way BattlegroundQueueUpdate does. Every selection is made twice, by the queue and by the list walks the queue used
+//! before the waiting groups were indexed, and both the results and the time spent are compared.
+//! Runs on the calling thread and does not touch the real queues.
+class BattlegroundQueueSimulation
+{
+    public:
+        enum
+        {
+            INVITE_ROUNDS       = 4,        //! Invited groups stay queued for this many rounds, like the invite accept window
+            ROUNDS              = 100,      //! The same number of groups as queued at the start joins over this many rounds
+            JOIN_INTERVAL       = 100       //! Milliseconds between the join times of two groups, unless they join at once
+        };
+
+        //! groupCount groups are queued at the start and groupCount more join during the rounds
+        BattlegroundQueueSimulation(uint32 groupCount, uint32 seed);
+
+        //! Battleground matching uses the player limits of bgTemplate, arena matching the rated type
+        void Run(Battleground* bgTemplate, RatedType ratedType);
+
+        uint32 GetBattlegroundGroupCount() const { return _battlegroundGroups; }
+        uint32 GetArenaGroupCount() const { return _arenaGroups; }
+        uint32 GetStartedBattlegroundCount() const { return _battlegrounds; }
+        uint32 GetStartedArenaCount() const { return _arenas; }
+        //! Selections where the queue and the old list walks did not pick the same groups
+        uint32 GetMismatchCount() const { return _mismatches; }
+        BattlegroundQueueSimulationTime const& GetOldBattlegroundTime() const { return _oldBattlegroundTime; }
+        BattlegroundQueueSimulationTime const& GetNewBattlegroundTime() const { return _newBattlegroundTime; }
+        BattlegroundQueueSimulationTime const& GetOldArenaTime() const { return _oldArenaTime; }
+        BattlegroundQueueSimulationTime const& GetNewArenaTime() const { return _newArenaTime; }
+
+    private:
+        struct InvitedGroup
+        {
+            InvitedGroup(BattlegroundQueue* _queue, GroupQueueInfo* _ginfo, uint32 _expireRound) : queue(_queue), ginfo(_ginfo), expireRound(_expireRound) { }
+
+            BattlegroundQueue* queue;
+            GroupQueueInfo* ginfo;
+            uint32 expireRound;
+        };
+
+        uint32 Random(uint32 min, uint32 max);
+        //! Most players are in the highest bracket
+        BattlegroundBracketId RandomBracket();
+        GroupQueueInfo* CreateGroup(uint32 size, uint32 team, bool isRated, uint32 matchmakerRating);
+
+        GroupQueueInfo* JoinBattleground();
+        GroupQueueInfo* JoinArena();
+        void UpdateBattleground(BattlegroundBracketId bracket_id);
+        void UpdateArena(BattlegroundBracketId bracket_id, uint32 arenaRating);
+        //! Does the queue part of BattlegroundQueue::InviteGroupToBG
+        void Invite(BattlegroundQueue& queue, GroupQueueInfo* ginfo, uint32 side);
+        void InvitePools(BattlegroundQueue& queue);
+        //! Removes the groups whose invitation ran out, as if they entered
+        void RemoveInvited();
+
+        bool ComparePools(BattlegroundQueue const& queue) const;
+        void Mismatch(char const* selection, BattlegroundBracketId bracket_id);
+
+        //! The selections as they were before BattlegroundQueue kept the waiting groups apart, they walk m_QueuedGroups
+        bool OldCheckPremadeMatch(BattlegroundBracketId bracket_id, uint32 MaxPlayersPerTeam);
+        bool OldCheckNormalMatch(BattlegroundBracketId bracket_id, uint32 minPlayers, uint32 maxPlayers);
+        uint8 OldSelectRatedTeams(BattlegroundBracketId bracket_id, uint32 minRating, uint32 maxRating, uint32 discardTime, GroupQueueInfo* teams[BG_TEAMS_COUNT]);
+
+        uint32 _groupCount;
+        uint32 _random;
+        uint32 _round;
+        uint32 _time;
+        uint64 _guid;
+        uint32 _instanceId;
+
+        Battleground* _bgTemplate;
+        uint32 _minPlayers;
+        uint32 _maxPlayers;
+        RatedType _ratedType;
+
+        BattlegroundQueue _battlegroundQueue;
+        BattlegroundQueue _arenaQueue;
+        BattlegroundQueue::SelectionPool _oldSelectionPools[BG_TEAMS_COUNT];
+        std::deque<InvitedGroup> _invited;
+
+        uint32 _battlegroundGroups;
+        uint32 _arenaGroups;
+        uint32 _battlegrounds;
+        uint32 _arenas;
+        uint32 _mismatches;
+        BattlegroundQueueSimulationTime _oldBattlegroundTime;
+        BattlegroundQueueSimulationTime _newBattlegroundTime;
+        BattlegroundQueueSimulationTime _oldArenaTime;
+        BattlegroundQueueSimulationTime _newArenaTime;
+};
+
+#endif
@@ -26,6 +26,9 @@
 #include "SpellAuras.h"
 #include "SpellMgr.h"
 
+#include <algorithm>
+#include <vector>
+
 //==============================================================
 //================= ThreatCalcHelper ===========================
 //==============================================================
@@ -259,6 +262,8 @@ void ThreatContainer::clearReferences()
     }
 
     iThreatList.clear();
+    iReferenceIndex.clear();
+    iChangedCount = 0;
 }
 
 //============================================================
@@ -268,15 +273,43 @@ HostileReference* ThreatContainer::getReferenceByTarget(Unit* victim) const
     if (!victim)
         return NULL;
 
-    uint64 const guid = victim->GetGUID();
-    for (ThreatContainer::StorageType::const_iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
-    {
-        HostileReference* ref = (*i);
-        if (ref && ref->getUnitGuid() == guid)
-            return ref;
-    }
+    ReferenceIndex::const_iterator itr = iReferenceIndex.find(victim->GetGUID());
+    return itr != iReferenceIndex.end() ? *itr->second.position : NULL;
+}
+
+//============================================================
+
+void ThreatContainer::remove(HostileReference* hostileRef)
+{
+    ReferenceIndex::iterator itr = iReferenceIndex.find(hostileRef->getUnitGuid());
+    if (itr == iReferenceIndex.end() || *itr->second.position != hostileRef)
+        return;
+
+    if (itr->second.changed)
+        --iChangedCount;
 
-    return NULL;
+    iThreatList.erase(itr->second.position);
+    iReferenceIndex.erase(itr);
+}
+
+void ThreatContainer::addReference(HostileReference* hostileRef)
+{
+    // placed by the next update, like a reference whose threat changed at the end of the list
+    IndexEntry& entry = iReferenceIndex[hostileRef->getUnitGuid()];
+    entry.position = iThreatList.insert(iThreatList.end(), hostileRef);
+    entry.changed = true;
+    ++iChangedCount;
+}
+
+void ThreatContainer::markThreatChanged(HostileReference* hostileRef)
+{
+    ReferenceIndex::iterator itr = iReferenceIndex.find(hostileRef->getUnitGuid());
+    if (itr == iReferenceIndex.end() || itr->second.changed || *itr->second.position != hostileRef)
+        return;
+
+    itr->second.changed = true;
+    ++iChangedCount;
+    iDirty = true;
 }
 
 //============================================================
@@ -299,12 +332,73 @@ void ThreatContainer::modifyThreatPercent(Unit* victim, int32 percent)
 }
 
 //============================================================
-// Check if the list is dirty and sort if necessary
+// Move the references with changed threat to their new position.
+// The list is only reordered here, so code iterating the threat list may safely change threat values.
+
+namespace
+{
+    struct ChangedReference
+    {
+        ChangedReference(ThreatContainer::StorageType::iterator pos, uint32 before) : position(pos), unchangedBefore(before) { }
+
+        ThreatContainer::StorageType::iterator position;
+        uint32 unchangedBefore;                             // unchanged references in front of it before the update
+    };
+
+    bool ChangedReferenceOrder(ChangedReference const& left, ChangedReference const& right)
+    {
+        return (*left.position)->getThreat() > (*right.position)->getThreat();
+    }
+}
 
 void ThreatContainer::update()
 {
-    if (iDirty && iThreatList.size() > 1)
-        iThreatList.sort(Trinity::ThreatOrderPred());
+    if (iChangedCount)
+    {
+        // The result is the order a stable sort of the whole list gives: by threat, and references of equal
+        // threat in their previous order. One walk takes the changed references out and counts the unchanged
+        // ones in front of each, the unchanged references stay sorted. The changed ones are stable sorted on
+        // their own and merged back, in front of an unchanged reference of equal threat only if they were
+        // in front of it before. O(n + k log k) for k changed references.
+        std::vector<ChangedReference> changed;
+        changed.reserve(iChangedCount);
+        StorageType removed;
+        uint32 unchanged = 0;
+        for (StorageType::iterator itr = iThreatList.begin(); itr != iThreatList.end();)
+        {
+            StorageType::iterator current = itr++;
+            IndexEntry& entry = iReferenceIndex[(*current)->getUnitGuid()];
+            if (!entry.changed)
+            {
+                ++unchanged;
+                continue;
+            }
+
+            entry.changed = false;
+            // splice keeps the iterator stored in the index valid
+            removed.splice(removed.end(), iThreatList, current);
+            changed.push_back(ChangedReference(current, unchanged));
+        }
+
+        std::stable_sort(changed.begin(), changed.end(), ChangedReferenceOrder);
+
+        StorageType::iterator next = iThreatList.begin();
+        uint32 position = 0;                                // of next among the unchanged references
+        for (std::vector<ChangedReference>::const_iterator itr = changed.begin(); itr != changed.end(); ++itr)
+        {
+            float threat = (*itr->position)->getThreat();
+            while (next != iThreatList.end() && ((*next)->getThreat() > threat ||
+                ((*next)->getThreat() == threat && position < itr->unchangedBefore)))
+            {
+                ++next;
+                ++position;
+            }
+
+            iThreatList.splice(next, removed, itr->position);
+        }
+
+        iChangedCount = 0;
+    }
 
     iDirty = false;
 }
@@ -522,6 +616,7 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
     switch (threatRefStatusChangeEvent->getType())
     {
         case UEV_THREAT_REF_THREAT_CHANGE:
+            iThreatContainer.markThreatChanged(hostilRef);
             if ((getCurrentVictim() == hostilRef && threatRefStatusChangeEvent->getFValue()<0.0f) ||
                 (getCurrentVictim() != hostilRef && threatRefStatusChangeEvent->getFValue()>0.0f))
                 setDirty(true);                             // the order in the threat list might have changed
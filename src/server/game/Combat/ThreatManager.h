@@ -146,7 +146,7 @@ class ThreatContainer
     public:
         typedef std::list<HostileReference*> StorageType;
 
-        ThreatContainer(): iDirty(false) { }
+        ThreatContainer(): iChangedCount(0), iDirty(false) { }
 
         ~ThreatContainer() { clearReferences(); }
 
@@ -174,23 +174,31 @@ class ThreatContainer
 
         StorageType const & getThreatList() const { return iThreatList; }
 
+        // The threat of the reference changed, its position in the list is corrected with the next update
+        void markThreatChanged(HostileReference* hostileRef);
+
     private:
-        void remove(HostileReference* hostileRef)
+        // Position of a reference in iThreatList, looked up by target guid
+        struct IndexEntry
         {
-            iThreatList.remove(hostileRef);
-        }
+            StorageType::iterator position;
+            bool changed;
+        };
 
-        void addReference(HostileReference* hostileRef)
-        {
-            iThreatList.push_back(hostileRef);
-        }
+        typedef UNORDERED_MAP<uint64, IndexEntry> ReferenceIndex;
+
+        void remove(HostileReference* hostileRef);
+
+        void addReference(HostileReference* hostileRef);
 
         void clearReferences();
 
-        // Sort the list if necessary
+        // Move references with changed threat to their new position
         void update();
 
-        StorageType iThreatList;
+        StorageType iThreatList;                            // sorted by threat, apart from changed references
+        ReferenceIndex iReferenceIndex;
+        uint32 iChangedCount;
         bool iDirty;
 };
 
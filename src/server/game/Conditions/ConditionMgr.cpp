@@ -519,7 +519,7 @@ uint32 Condition::GetMaxAvailableConditionTargets()
     }
 }
 
-ConditionMgr::ConditionMgr() { }
+ConditionMgr::ConditionMgr() : ConditionsVersion(0) { }
 
 ConditionMgr::~ConditionMgr()
 {
@@ -575,7 +575,24 @@ uint32 ConditionMgr::GetSearcherTypeMaskForConditionList(ConditionList const& co
     return mask;
 }
 
+// Decides a single condition for the list interpreter and condition programs
+struct ConditionMeetsCheck
+{
+    explicit ConditionMeetsCheck(ConditionSourceInfo& sourceInfo) : SourceInfo(sourceInfo) { }
+
+    bool operator()(Condition* condition) { return condition->Meets(SourceInfo); }
+
+    ConditionSourceInfo& SourceInfo;
+};
+
 bool ConditionMgr::IsObjectMeetToConditionList(ConditionSourceInfo& sourceInfo, ConditionList const& conditions)
+{
+    ConditionMeetsCheck check(sourceInfo);
+    return EvaluateConditionList(check, conditions);
+}
+
+template<class Check>
+bool ConditionMgr::EvaluateConditionList(Check& check, ConditionList const& conditions) const
 {
     //     groupId, groupCheckPassed
     std::map<uint32, bool> ElseGroupStore;
@@ -597,7 +614,7 @@ bool ConditionMgr::IsObjectMeetToConditionList(ConditionSourceInfo& sourceInfo,
                 ConditionReferenceContainer::const_iterator ref = ConditionReferenceStore.find((*i)->ReferenceId);
                 if (ref != ConditionReferenceStore.end())
                 {
-                    if (!IsObjectMeetToConditionList(sourceInfo, (*ref).second))
+                    if (!EvaluateConditionList(check, (*ref).second))
                         ElseGroupStore[(*i)->ElseGroup] = false;
                 }
                 else
@@ -609,7 +626,7 @@ bool ConditionMgr::IsObjectMeetToConditionList(ConditionSourceInfo& sourceInfo,
             }
             else //handle normal condition
             {
-                if (!(*i)->Meets(sourceInfo))
+                if (!check(*i))
                     ElseGroupStore[(*i)->ElseGroup] = false;
             }
         }
@@ -639,9 +656,303 @@ bool ConditionMgr::IsObjectMeetToConditions(ConditionSourceInfo& sourceInfo, Con
         return true;
 
     TC_LOG_DEBUG("condition", "ConditionMgr::IsObjectMeetToConditions");
+
+    // lists handed out by the stores (or copied from them) always hold all conditions of their source,
+    // lists combining several sources (spell implicit targets of several effects) fall back to the list interpreter
+    Condition const* first = conditions.front();
+    if (ConditionProgram const* program = GetConditionProgram(first->SourceType, first->SourceGroup, first->SourceEntry, first->SourceId))
+        if (program->GetConditionCount() == conditions.size())
+            return program->Evaluate(sourceInfo);
+
     return IsObjectMeetToConditionList(sourceInfo, conditions);
 }
 
+ConditionProgram const* ConditionMgr::GetConditionProgram(ConditionSourceType sourceType, uint32 sourceGroup, int32 sourceEntry, uint32 sourceId) const
+{
+    ConditionProgramContainer::const_iterator itr = ConditionProgramStore.find(ConditionProgramKey(sourceType, sourceGroup, sourceEntry, sourceId));
+    return itr != ConditionProgramStore.end() ? &itr->second : NULL;
+}
+
+void ConditionMgr::CompileConditionPrograms()
+{
+    // every reference program gets its final address first, so programs can point to references compiled later
+    for (ConditionReferenceContainer::const_iterator itr = ConditionReferenceStore.begin(); itr != ConditionReferenceStore.end(); ++itr)
+        ConditionReferenceProgramStore[itr->first];
+
+    // references are evaluated from spell conditions as well, keep their order
+    for (ConditionReferenceContainer::const_iterator itr = ConditionReferenceStore.begin(); itr != ConditionReferenceStore.end(); ++itr)
+        ConditionReferenceProgramStore[itr->first].Compile(itr->second, true, ConditionReferenceProgramStore);
+
+    // collect the conditions of every source, grouped conditions only live in the lists of their consumers
+    typedef UNORDERED_MAP<ConditionProgramKey, ConditionList, ConditionProgramKeyHash> SourceContainer;
+    SourceContainer sources;
+    for (std::list<Condition*>::const_iterator itr = AllocatedMemoryStore.begin(); itr != AllocatedMemoryStore.end(); ++itr)
+        sources[ConditionProgramKey((*itr)->SourceType, (*itr)->SourceGroup, (*itr)->SourceEntry, (*itr)->SourceId)].push_back(*itr);
+
+    std::vector<ConditionTypeContainer const*> containers;
+    for (ConditionContainer::const_iterator itr = ConditionStore.begin(); itr != ConditionStore.end(); ++itr)
+        containers.push_back(&itr->second);
+    for (CreatureSpellConditionContainer::const_iterator itr = VehicleSpellConditionStore.begin(); itr != VehicleSpellConditionStore.end(); ++itr)
+        containers.push_back(&itr->second);
+    for (CreatureSpellConditionContainer::const_iterator itr = SpellClickEventConditionStore.begin(); itr != SpellClickEventConditionStore.end(); ++itr)
+        containers.push_back(&itr->second);
+    for (NpcVendorConditionContainer::const_iterator itr = NpcVendorConditionContainerStore.begin(); itr != NpcVendorConditionContainerStore.end(); ++itr)
+        containers.push_back(&itr->second);
+    for (SmartEventConditionContainer::const_iterator itr = SmartEventConditionStore.begin(); itr != SmartEventConditionStore.end(); ++itr)
+        containers.push_back(&itr->second);
+    for (PhaseDefinitionConditionContainer::const_iterator itr = PhaseDefinitionsConditionStore.begin(); itr != PhaseDefinitionsConditionStore.end(); ++itr)
+        containers.push_back(&itr->second);
+
+    for (std::vector<ConditionTypeContainer const*>::const_iterator container = containers.begin(); container != containers.end(); ++container)
+    {
+        for (ConditionTypeContainer::const_iterator itr = (*container)->begin(); itr != (*container)->end(); ++itr)
+        {
+            if (itr->second.empty())
+                continue;
+
+            Condition const* first = itr->second.front();
+            sources[ConditionProgramKey(first->SourceType, first->SourceGroup, first->SourceEntry, first->SourceId)] = itr->second;
+        }
+    }
+
+    for (SourceContainer::const_iterator itr = sources.begin(); itr != sources.end(); ++itr)
+        ConditionProgramStore[itr->first].Compile(itr->second, itr->first.SourceType == CONDITION_SOURCE_TYPE_SPELL, ConditionReferenceProgramStore);
+
+    TC_LOG_INFO("server.loading", ">> Compiled %u condition programs and %u reference programs", uint32(ConditionProgramStore.size()), uint32(ConditionReferenceProgramStore.size()));
+
+    if (!sWorld->getBoolConfig(CONFIG_CONDITIONS_VERIFY_PROGRAMS))
+        return;
+
+    uint32 mismatches = 0;
+    for (ConditionReferenceContainer::const_iterator itr = ConditionReferenceStore.begin(); itr != ConditionReferenceStore.end(); ++itr)
+    {
+        if (!VerifyConditionProgram(ConditionReferenceProgramStore[itr->first], itr->second, true))
+        {
+            TC_LOG_ERROR("condition", "Compiled program of reference template -%u differs from the condition list interpreter", itr->first);
+            ++mismatches;
+        }
+    }
+
+    for (SourceContainer::const_iterator itr = sources.begin(); itr != sources.end(); ++itr)
+    {
+        if (!VerifyConditionProgram(ConditionProgramStore[itr->first], itr->second, itr->first.SourceType == CONDITION_SOURCE_TYPE_SPELL))
+        {
+            TC_LOG_ERROR("condition", "Compiled program of SourceType %u, SourceGroup %u, SourceEntry %d, SourceId %u differs from the condition list interpreter",
+                uint32(itr->first.SourceType), itr->first.SourceGroup, itr->first.SourceEntry, itr->first.SourceId);
+            ++mismatches;
+        }
+    }
+
+    TC_LOG_INFO("server.loading", ">> Verified %u condition programs against the condition list interpreter, %u differ",
+        uint32(ConditionReferenceStore.size() + sources.size()), mismatches);
+}
+
+#define CONDITION_PROGRAM_VERIFY_ROUNDS 34           // all conditions met, none met and 32 mixed results
+
+// Decides the single conditions from a hash of their address and a seed, instead of evaluating them.
+// Seed 0 meets all conditions and seed 1 none. Remembers the order the conditions were asked for.
+struct ConditionVerifyCheck
+{
+    explicit ConditionVerifyCheck(uint32 seed) : Seed(seed) { }
+
+    bool operator()(Condition* condition)
+    {
+        Checked.push_back(condition);
+        if (Seed < 2)
+            return Seed == 0;
+
+        uint64 hash = uint64(reinterpret_cast<uintptr_t>(condition)) * UI64LIT(0x9E3779B97F4A7C15) ^ uint64(Seed) * UI64LIT(0xC2B2AE3D27D4EB4F);
+        hash ^= hash >> 29;
+        hash *= UI64LIT(0xBF58476D1CE4E5B9);
+        return (hash >> 63) != 0;
+    }
+
+    uint32 Seed;
+    std::vector<Condition*> Checked;
+};
+
+bool ConditionMgr::VerifyConditionProgram(ConditionProgram const& program, ConditionList const& conditions, bool ordered) const
+{
+    for (uint32 seed = 0; seed < CONDITION_PROGRAM_VERIFY_ROUNDS; ++seed)
+    {
+        ConditionVerifyCheck listCheck(seed);
+        ConditionVerifyCheck programCheck(seed);
+        if (EvaluateConditionList(listCheck, conditions) != program.Evaluate(programCheck))
+            return false;
+
+        // ordered programs have to ask for the conditions (and run their scripts) in the order of the list interpreter
+        if (ordered && listCheck.Checked != programCheck.Checked)
+            return false;
+    }
+
+    return true;
+}
+
+//============================================================
+//================= ConditionProgram =========================
+//============================================================
+
+// Rough evaluation cost of a condition type, cheap checks of fields are done before lookups and grid searches
+static uint32 GetConditionEvaluationCost(Condition const* condition)
+{
+    if (condition->ReferenceId)
+        return 3;
+
+    switch (condition->ConditionType)
+    {
+        case CONDITION_ITEM:
+        case CONDITION_NEAR_CREATURE:
+        case CONDITION_NEAR_GAMEOBJECT:
+            return 2;
+        case CONDITION_AURA:
+        case CONDITION_ITEM_EQUIPPED:
+        case CONDITION_REPUTATION_RANK:
+        case CONDITION_SKILL:
+        case CONDITION_QUESTREWARDED:
+        case CONDITION_QUESTTAKEN:
+        case CONDITION_WORLD_STATE:
+        case CONDITION_ACTIVE_EVENT:
+        case CONDITION_INSTANCE_INFO:
+        case CONDITION_QUEST_NONE:
+        case CONDITION_ACHIEVEMENT:
+        case CONDITION_SPELL:
+        case CONDITION_QUEST_COMPLETE:
+        case CONDITION_RELATION_TO:
+        case CONDITION_REACTION_TO:
+        case CONDITION_DISTANCE_TO:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+struct ConditionCostOrderPred
+{
+    bool operator()(Condition const* left, Condition const* right) const
+    {
+        if (left->ElseGroup != right->ElseGroup)
+            return left->ElseGroup < right->ElseGroup;
+        return GetConditionEvaluationCost(left) < GetConditionEvaluationCost(right);
+    }
+};
+
+void ConditionProgram::Compile(ConditionList const& conditions, bool ordered, ConditionReferenceProgramContainer const& references)
+{
+    _instructions.clear();
+    _groupEnds.clear();
+    _conditionCount = uint32(conditions.size());
+    _ordered = ordered;
+
+    // not loaded conditions are skipped by the list interpreter and do not open their ElseGroup
+    std::vector<Condition*> loaded;
+    for (ConditionList::const_iterator itr = conditions.begin(); itr != conditions.end(); ++itr)
+        if ((*itr)->isLoaded())
+            loaded.push_back(*itr);
+
+    if (!ordered)
+        std::stable_sort(loaded.begin(), loaded.end(), ConditionCostOrderPred());
+
+    std::map<uint32, uint32> groups;
+    for (std::vector<Condition*>::const_iterator itr = loaded.begin(); itr != loaded.end(); ++itr)
+    {
+        Instruction instruction;
+        instruction.condition = *itr;
+        instruction.reference = NULL;
+        if ((*itr)->ReferenceId)
+        {
+            ConditionReferenceProgramContainer::const_iterator ref = references.find((*itr)->ReferenceId);
+            if (ref != references.end())
+                instruction.reference = &ref->second;
+        }
+
+        std::map<uint32, uint32>::const_iterator group = groups.find((*itr)->ElseGroup);
+        if (group == groups.end())
+            group = groups.insert(std::make_pair((*itr)->ElseGroup, uint32(groups.size()))).first;
+        instruction.group = group->second;
+
+        if (!ordered && !_instructions.empty() && _instructions.back().group != instruction.group)
+            _groupEnds.push_back(uint32(_instructions.size()));
+
+        _instructions.push_back(instruction);
+    }
+
+    if (!ordered && !_instructions.empty())
+        _groupEnds.push_back(uint32(_instructions.size()));
+
+    _groupCount = uint32(groups.size());
+}
+
+template<class Check>
+bool ConditionProgram::Execute(Instruction const& instruction, Check& check) const
+{
+    if (instruction.reference)
+        return instruction.reference->Evaluate(check);
+
+    if (instruction.condition->ReferenceId)
+    {
+        TC_LOG_DEBUG("condition", "ConditionProgram::Execute: Reference template -%u not found", instruction.condition->ReferenceId);
+        return true;                                        // checked at loading, should never happen
+    }
+
+    return check(instruction.condition);
+}
+
+bool ConditionProgram::Evaluate(ConditionSourceInfo& sourceInfo) const
+{
+    ConditionMeetsCheck check(sourceInfo);
+    return Evaluate(check);
+}
+
+template<class Check>
+bool ConditionProgram::Evaluate(Check& check) const
+{
+    if (!_ordered)
+    {
+        // any group with all conditions met is enough
+        uint32 begin = 0;
+        for (std::vector<uint32>::const_iterator end = _groupEnds.begin(); end != _groupEnds.end(); ++end)
+        {
+            uint32 i = begin;
+            while (i < *end && Execute(_instructions[i], check))
+                ++i;
+
+            if (i == *end)
+                return true;
+
+            begin = *end;
+        }
+
+        return false;
+    }
+
+    // same order and side effects (mLastFailedCondition, condition scripts) as the list interpreter
+    if (_groupCount > MAX_MASKED_GROUPS)
+        return EvaluateManyGroups(check);
+
+    uint64 failedGroups = 0;
+    for (std::vector<Instruction>::const_iterator itr = _instructions.begin(); itr != _instructions.end(); ++itr)
+        if (!(failedGroups & (UI64LIT(1) << itr->group)) && !Execute(*itr, check))
+            failedGroups |= UI64LIT(1) << itr->group;
+
+    uint64 allGroups = _groupCount == MAX_MASKED_GROUPS ? ~UI64LIT(0) : (UI64LIT(1) << _groupCount) - 1;
+    return failedGroups != allGroups;
+}
+
+template<class Check>
+bool ConditionProgram::EvaluateManyGroups(Check& check) const
+{
+    std::vector<bool> failedGroups(_groupCount, false);
+    for (std::vector<Instruction>::const_iterator itr = _instructions.begin(); itr != _instructions.end(); ++itr)
+        if (!failedGroups[itr->group] && !Execute(*itr, check))
+            failedGroups[itr->group] = true;
+
+    for (uint32 i = 0; i < _groupCount; ++i)
+        if (!failedGroups[i])
+            return true;
+
+    return false;
+}
+
 bool ConditionMgr::CanHaveSourceGroupSet(ConditionSourceType sourceType) const
 {
     return (sourceType == CONDITION_SOURCE_TYPE_CREATURE_LOOT_TEMPLATE ||
@@ -722,20 +1033,19 @@ ConditionList ConditionMgr::GetConditionsForVehicleSpell(uint32 creatureId, uint
     return cond;
 }
 
-ConditionList ConditionMgr::GetConditionsForSmartEvent(int32 entryOrGuid, uint32 eventId, uint32 sourceType)
+ConditionList const* ConditionMgr::GetConditionsForSmartEvent(int32 entryOrGuid, uint32 eventId, uint32 sourceType)
 {
-    ConditionList cond;
     SmartEventConditionContainer::const_iterator itr = SmartEventConditionStore.find(std::make_pair(entryOrGuid, sourceType));
     if (itr != SmartEventConditionStore.end())
     {
         ConditionTypeContainer::const_iterator i = (*itr).second.find(eventId + 1);
         if (i != (*itr).second.end())
         {
-            cond = (*i).second;
             TC_LOG_DEBUG("condition", "GetConditionsForSmartEvent: found conditions for Smart Event entry or guid %d event_id %u", entryOrGuid, eventId);
+            return &(*i).second;
         }
     }
-    return cond;
+    return NULL;
 }
 
 ConditionList const* ConditionMgr::GetConditionsForPhaseDefinition(uint32 zone, uint32 entry)
@@ -775,6 +1085,7 @@ void ConditionMgr::LoadConditions(bool isReload)
     uint32 oldMSTime = getMSTime();
 
     Clean();
+    ++ConditionsVersion;
 
     //must clear all custom handled cases (groupped types) before reload
     if (isReload)
@@ -1045,6 +1356,8 @@ void ConditionMgr::LoadConditions(bool isReload)
     }
     while (result->NextRow());
 
+    CompileConditionPrograms();
+
     TC_LOG_INFO("server.loading", ">> Loaded %u conditions in %u ms", count, GetMSTimeDiffToNow(oldMSTime));
 
 }
@@ -2048,6 +2361,9 @@ bool ConditionMgr::isConditionTypeValid(Condition* cond)
 
 void ConditionMgr::Clean()
 {
+    ConditionProgramStore.clear();
+    ConditionReferenceProgramStore.clear();
+
     for (ConditionReferenceContainer::iterator itr = ConditionReferenceStore.begin(); itr != ConditionReferenceStore.end(); ++itr)
     {
         for (ConditionList::const_iterator it = itr->second.begin(); it != itr->second.end(); ++it)
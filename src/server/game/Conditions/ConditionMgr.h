@@ -20,9 +20,11 @@
 
 #include "Define.h"
 #include "Errors.h"
+#include "Dynamic/UnorderedMap.h"
 #include <ace/Singleton.h>
 #include <list>
 #include <map>
+#include <vector>
 
 class Player;
 class Unit;
@@ -220,6 +222,79 @@ typedef std::map<int32 /*zoneId*/, ConditionTypeContainer> PhaseDefinitionCondit
 
 typedef std::map<uint32, ConditionList> ConditionReferenceContainer;//only used for references
 
+class ConditionProgram;
+typedef std::map<uint32, ConditionProgram> ConditionReferenceProgramContainer;
+
+// The conditions of one source (all conditions sharing source type, group, entry and id) prepared for evaluation at load time.
+// Gives the same result as evaluating the condition list, but without per call allocations and, unless the
+// program is ordered, checking the cheapest conditions of every ElseGroup first and stopping at the first met group.
+// Ordered programs keep their failed groups in a bit mask, only those with more than MAX_MASKED_GROUPS ElseGroups allocate.
+class ConditionProgram
+{
+    public:
+        enum
+        {
+            MAX_MASKED_GROUPS = 64                          // bits of the failed group mask of ordered programs
+        };
+
+        ConditionProgram() : _groupCount(0), _conditionCount(0), _ordered(false) { }
+
+        // Ordered programs evaluate in list order and visit every group, exactly like the list interpreter.
+        // They are used where the failed condition is reported to the player (spell cast errors).
+        void Compile(ConditionList const& conditions, bool ordered, ConditionReferenceProgramContainer const& references);
+        bool Evaluate(ConditionSourceInfo& sourceInfo) const;
+        // check(condition) decides the single conditions, used to compare the program with the list interpreter
+        template<class Check> bool Evaluate(Check& check) const;
+
+        // Size of the list the program was compiled from, including conditions which are not loaded
+        uint32 GetConditionCount() const { return _conditionCount; }
+
+    private:
+        struct Instruction
+        {
+            Condition* condition;
+            ConditionProgram const* reference;              // resolved reference program, NULL for plain conditions and unknown references
+            uint32 group;                                   // index of the ElseGroup
+        };
+
+        template<class Check> bool Execute(Instruction const& instruction, Check& check) const;
+        // ordered evaluation for programs whose groups do not fit the mask
+        template<class Check> bool EvaluateManyGroups(Check& check) const;
+
+        std::vector<Instruction> _instructions;             // ordered: list order, otherwise grouped and sorted by cost inside each group
+        std::vector<uint32> _groupEnds;                     // not ordered: end of every group in _instructions
+        uint32 _groupCount;
+        uint32 _conditionCount;
+        bool _ordered;
+};
+
+struct ConditionProgramKey
+{
+    ConditionProgramKey(ConditionSourceType sourceType, uint32 sourceGroup, int32 sourceEntry, uint32 sourceId) :
+        SourceType(sourceType), SourceGroup(sourceGroup), SourceEntry(sourceEntry), SourceId(sourceId) { }
+
+    bool operator==(ConditionProgramKey const& right) const
+    {
+        return SourceType == right.SourceType && SourceGroup == right.SourceGroup && SourceEntry == right.SourceEntry && SourceId == right.SourceId;
+    }
+
+    ConditionSourceType SourceType;
+    uint32 SourceGroup;
+    int32 SourceEntry;
+    uint32 SourceId;
+};
+
+struct ConditionProgramKeyHash
+{
+    size_t operator()(ConditionProgramKey const& key) const
+    {
+        uint64 hash = (uint64(key.SourceType) << 56) ^ (uint64(key.SourceId) << 40) ^ (uint64(key.SourceGroup) << 20) ^ uint64(uint32(key.SourceEntry));
+        return size_t(hash ^ (hash >> 32));
+    }
+};
+
+typedef UNORDERED_MAP<ConditionProgramKey, ConditionProgram, ConditionProgramKeyHash> ConditionProgramContainer;
+
 class ConditionMgr
 {
     friend class ACE_Singleton<ConditionMgr, ACE_Null_Mutex>;
@@ -241,10 +316,14 @@ class ConditionMgr
         bool CanHaveSourceIdSet(ConditionSourceType sourceType) const;
         ConditionList GetConditionsForNotGroupedEntry(ConditionSourceType sourceType, uint32 entry);
         ConditionList GetConditionsForSpellClickEvent(uint32 creatureId, uint32 spellId);
-        ConditionList GetConditionsForSmartEvent(int32 entryOrGuid, uint32 eventId, uint32 sourceType);
+        ConditionList const* GetConditionsForSmartEvent(int32 entryOrGuid, uint32 eventId, uint32 sourceType);
         ConditionList GetConditionsForVehicleSpell(uint32 creatureId, uint32 spellId);
         ConditionList const* GetConditionsForPhaseDefinition(uint32 zone, uint32 entry);
         ConditionList GetConditionsForNpcVendorEvent(uint32 creatureId, uint32 itemId);
+        ConditionProgram const* GetConditionProgram(ConditionSourceType sourceType, uint32 sourceGroup, int32 sourceEntry, uint32 sourceId) const;
+
+        // Incremented by every (re)load, pointers returned by the getters above are invalid once it changed
+        uint32 GetConditionsVersion() const { return ConditionsVersion; }
 
     private:
         bool isSourceTypeValid(Condition* cond);
@@ -253,6 +332,9 @@ class ConditionMgr
         bool addToGossipMenuItems(Condition* cond);
         bool addToSpellImplicitTargetConditions(Condition* cond);
         bool IsObjectMeetToConditionList(ConditionSourceInfo& sourceInfo, ConditionList const& conditions);
+        template<class Check> bool EvaluateConditionList(Check& check, ConditionList const& conditions) const;
+        void CompileConditionPrograms();
+        bool VerifyConditionProgram(ConditionProgram const& program, ConditionList const& conditions, bool ordered) const;
 
         void Clean(); // free up resources
         std::list<Condition*> AllocatedMemoryStore; // some garbage collection :)
@@ -264,6 +346,9 @@ class ConditionMgr
         NpcVendorConditionContainer       NpcVendorConditionContainerStore;
         SmartEventConditionContainer      SmartEventConditionStore;
         PhaseDefinitionConditionContainer PhaseDefinitionsConditionStore;
+        ConditionProgramContainer         ConditionProgramStore;
+        ConditionReferenceProgramContainer ConditionReferenceProgramStore;
+        uint32 ConditionsVersion;
 };
 
 #define sConditionMgr ACE_Singleton<ConditionMgr, ACE_Null_Mutex>::instance()
@@ -24,6 +24,8 @@
 #include "Log.h"
 #include "AreaTrigger.h"
 
+DEFINE_SLAB_ALLOCATOR(AreaTrigger)
+
 AreaTrigger::AreaTrigger() : WorldObject(false), _duration(0), m_caster(NULL), m_visualRadius(0.0f)
 {
     m_objectType |= TYPEMASK_AREATRIGGER;
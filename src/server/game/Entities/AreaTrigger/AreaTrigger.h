@@ -19,6 +19,7 @@
 #define TRINITYCORE_AREATRIGGER_H
 
 #include "Object.h"
+#include "SlabAllocator.h"
 
 class Unit;
 class SpellInfo;
@@ -26,6 +27,8 @@ class SpellInfo;
 class AreaTrigger : public WorldObject, public GridObject<AreaTrigger>
 {
     public:
+        DECLARE_SLAB_ALLOCATOR();
+
         AreaTrigger();
         ~AreaTrigger();
 
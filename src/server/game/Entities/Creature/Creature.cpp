@@ -140,6 +140,8 @@ bool ForcedDespawnDelayEvent::Execute(uint64 /*e_time*/, uint32 /*p_time*/)
     return true;
 }
 
+DEFINE_SLAB_ALLOCATOR(Creature)
+
 Creature::Creature(bool isWorldObject): Unit(isWorldObject), MapObject(),
 lootForPickPocketed(false), lootForBody(false), m_groupLootTimer(0), lootingGroupLowGUID(0),
 m_PlayerDamageReq(0), m_lootRecipient(0), m_lootRecipientGroup(0), m_corpseRemoveTime(0), m_respawnTime(0),
@@ -592,6 +594,82 @@ void Creature::Update(uint32 diff)
     }
 
     sScriptMgr->OnCreatureUpdate(this, diff);
+
+    m_sleeping = CanSleep();
+}
+
+bool Creature::CanSleep() const
+{
+    if (!sWorld->getBoolConfig(CONFIG_CREATURE_IDLE_SLEEP))
+        return false;
+
+    // Summons, pets, vehicles, passengers, controlled, active and scripted creatures have their own work every tick
+    if (m_unitTypeMask != UNIT_MASK_NONE || m_vehicle || m_movedPlayer || GetCharmerOrOwnerGUID() || isActiveObject() || GetScriptId())
+        return false;
+
+    if (NeedChangeAI || TriggerJustRespawned || !m_Events.Empty() || !m_removedAuras.empty())
+        return false;
+
+    if (m_deathState == DEAD)
+        return true;
+
+    if (m_deathState != ALIVE || IsInCombat() || IsInEvadeMode() || !IsAIEnabled || !AI()->CanSleep())
+        return false;
+
+    for (uint8 i = 0; i < CURRENT_MAX_SPELL; ++i)
+        if (m_currentSpells[i])
+            return false;
+
+    for (uint8 i = 0; i < MAX_ATTACK; ++i)
+        if (m_attackTimer[i])
+            return false;
+
+    for (uint8 i = 0; i < MAX_REACTIVE; ++i)
+        if (m_reactiveTimer[i])
+            return false;
+
+    if (!m_gameObj.empty() || !m_dynObj.empty() || !m_AreaTrigger.empty())
+        return false;
+
+    if (!movespline->Finalized() || GetMotionMaster()->GetCurrentMovementGeneratorType() != IDLE_MOTION_TYPE)
+        return false;
+
+    // Regeneration still has something to do
+    Powers power = getPowerType();
+    if (!IsFullHealth() || ((power == POWER_MANA || power == POWER_ENERGY) && GetPower(power) < GetMaxPower(power)))
+        return false;
+
+    // The auras are only looked at again after they changed, see Unit::AurasChanged
+    if (!m_sleepAurasChecked)
+    {
+        // Pending client updates are sent by the next update and setting one calls AurasChanged, so they are not cached
+        for (VisibleAuraMap::const_iterator itr = m_visibleAuras.begin(); itr != m_visibleAuras.end(); ++itr)
+            if (itr->second->IsNeedClientUpdate())
+                return false;
+
+        m_sleepAurasAllowed = HasOnlyIdleAuras();
+        m_sleepAurasChecked = true;
+    }
+
+    return m_sleepAurasAllowed;
+}
+
+bool Creature::HasOnlyIdleAuras() const
+{
+    // Only auras that are never updated are allowed: no duration, ticks, area targets or scripts
+    for (AuraMap::const_iterator itr = m_ownedAuras.begin(); itr != m_ownedAuras.end(); ++itr)
+    {
+        Aura const* aura = itr->second;
+        if (!aura->IsPermanent() || aura->IsArea() || !aura->m_loadedScripts.empty())
+            return false;
+
+        for (uint8 i = 0; i < MAX_SPELL_EFFECTS; ++i)
+            if (AuraEffect const* effect = aura->GetEffect(i))
+                if (effect->IsPeriodic())
+                    return false;
+    }
+
+    return true;
 }
 
 void Creature::RegenerateMana()
@@ -707,6 +785,8 @@ bool Creature::AIM_Initialize(CreatureAI* ai)
         return false;
     }
 
+    WakeUp();
+
     UnitAI* oldAI = i_AI;
 
     Motion_Initialize();
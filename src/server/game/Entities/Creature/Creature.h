@@ -25,6 +25,7 @@
 #include "LootMgr.h"
 #include "DatabaseEnv.h"
 #include "Cell.h"
+#include "SlabAllocator.h"
 
 #include <list>
 
@@ -421,6 +422,8 @@ class Creature : public Unit, public GridObject<Creature>, public MapObject
 {
     public:
 
+        DECLARE_SLAB_ALLOCATOR();
+
         explicit Creature(bool isWorldObject = false);
         virtual ~Creature();
 
@@ -443,6 +446,19 @@ class Creature : public Unit, public GridObject<Creature>, public MapObject
         uint32 GetDBTableGUIDLow() const { return m_DBTableGuid; }
 
         void Update(uint32 time);                         // overwrited Unit::Update
+
+        // An idle creature whose update would do nothing is put to sleep after its update
+        // and skipped by the map until NeedsWakeUp or one of the Unit::WakeUp calls says otherwise
+        bool CanSleep() const;
+        bool HasOnlyIdleAuras() const;
+        bool NeedsWakeUp(time_t now) const
+        {
+            // Dead creatures only wait for their respawn time
+            if (m_deathState == DEAD)
+                return m_respawnTime <= now;
+
+            return IsInCombat() || !m_Events.Empty() || !m_removedAuras.empty() || NeedChangeAI || TriggerJustRespawned || isActiveObject();
+        }
         void GetRespawnPosition(float &x, float &y, float &z, float* ori = NULL, float* dist =NULL) const;
 
         void SetCorpseDelay(uint32 delay) { m_corpseDelay = delay; }
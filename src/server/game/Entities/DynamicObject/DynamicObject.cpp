@@ -27,6 +27,8 @@
 #include "ScriptMgr.h"
 #include "Group.h"
 
+DEFINE_SLAB_ALLOCATOR(DynamicObject)
+
 DynamicObject::DynamicObject(bool isWorldObject) : WorldObject(isWorldObject),
     _aura(NULL), _removedAura(NULL), _caster(NULL), _duration(0), _isViewpoint(false)
 {
@@ -19,6 +19,7 @@
 #define TRINITYCORE_DYNAMICOBJECT_H
 
 #include "Object.h"
+#include "SlabAllocator.h"
 
 class Unit;
 class Aura;
@@ -34,6 +35,8 @@ enum DynamicObjectType
 class DynamicObject : public WorldObject, public GridObject<DynamicObject>
 {
     public:
+        DECLARE_SLAB_ALLOCATOR();
+
         DynamicObject(bool isWorldObject);
         ~DynamicObject();
 
@@ -34,6 +34,8 @@
 #include "World.h"
 #include "Transport.h"
 
+DEFINE_SLAB_ALLOCATOR(GameObject)
+
 GameObject::GameObject() : WorldObject(false), MapObject(),
     m_model(NULL), m_goValue(), m_AI(NULL)
 {
@@ -2181,6 +2183,9 @@ void GameObject::EnableCollision(bool enable)
         GetMap()->InsertGameObjectModel(*m_model);*/
 
     m_model->enable(enable ? GetPhaseMask() : 0);
+
+    if (Map* map = FindMap())
+        map->GameObjectModelChanged(*m_model);
 }
 
 void GameObject::UpdateModel()
@@ -24,6 +24,7 @@
 #include "Object.h"
 #include "LootMgr.h"
 #include "DatabaseEnv.h"
+#include "SlabAllocator.h"
 
 class GameObjectAI;
 class Group;
@@ -644,6 +645,8 @@ class GameObjectModel;
 class GameObject : public WorldObject, public GridObject<GameObject>, public MapObject
 {
     public:
+        DECLARE_SLAB_ALLOCATOR();
+
         explicit GameObject();
         ~GameObject();
 
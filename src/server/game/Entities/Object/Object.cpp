@@ -1583,6 +1583,33 @@ bool WorldObject::IsWithinLOSInMap(const WorldObject* obj) const
     return IsWithinLOS(ox, oy, oz);
 }
 
+void WorldObject::IsWithinLOSInMap(WorldObject const* const* objects, bool* results, uint32 count) const
+{
+    std::vector<float> targets;
+    std::vector<uint32> indexes;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        results[i] = IsInMap(objects[i]);
+        if (!results[i] || !IsInWorld())
+            continue;
+
+        // same heights as IsWithinLOS
+        targets.push_back(objects[i]->GetPositionX());
+        targets.push_back(objects[i]->GetPositionY());
+        targets.push_back(objects[i]->GetPositionZ() + 2.f);
+        indexes.push_back(i);
+    }
+
+    if (indexes.empty())
+        return;
+
+    bool* los = new bool[indexes.size()];
+    GetMap()->isInLineOfSight(GetPositionX(), GetPositionY(), GetPositionZ() + 2.f, &targets[0], los, indexes.size(), GetPhaseMask());
+    for (uint32 i = 0; i < indexes.size(); ++i)
+        results[indexes[i]] = los[i];
+    delete[] los;
+}
+
 float WorldObject::GetDistance(const WorldObject* obj) const
 {
     float d = GetExactDist(obj) - GetObjectSize() - obj->GetObjectSize();
@@ -1982,6 +2009,59 @@ void WorldObject::UpdateAllowedPositionZ(float x, float y, float &z) const
     }
 }
 
+void WorldObject::UpdateAllowedPositionZ(float* points, uint32 count) const
+{
+    if (!count)
+        return;
+
+    bool canFly = true;
+    bool needsWaterLevel = false;
+    switch (GetTypeId())
+    {
+        case TYPEID_UNIT:
+            canFly = ToCreature()->CanFly();
+            needsWaterLevel = !canFly && ToCreature()->CanSwim();
+            break;
+        case TYPEID_PLAYER:
+            canFly = ToPlayer()->CanFly();
+            needsWaterLevel = !canFly;
+            break;
+        default:
+            break;
+    }
+
+    // water levels are not batched, keep the single point version for anything that may swim
+    if (needsWaterLevel)
+    {
+        for (uint32 i = 0; i < count; ++i)
+            UpdateAllowedPositionZ(points[i * 3], points[i * 3 + 1], points[i * 3 + 2]);
+        return;
+    }
+
+    std::vector<float> heights(count);
+    GetMap()->GetHeights(GetPhaseMask(), points, &heights[0], count, true);
+
+    // same rules as the single point version
+    for (uint32 i = 0; i < count; ++i)
+    {
+        float& z = points[i * 3 + 2];
+        float ground_z = heights[i];
+        if (GetTypeId() == TYPEID_UNIT || GetTypeId() == TYPEID_PLAYER)
+        {
+            if (!canFly)
+            {
+                // non swimming creature, max_z is the ground itself
+                if (ground_z > INVALID_HEIGHT)
+                    z = ground_z;
+            }
+            else if (z < ground_z)
+                z = ground_z;
+        }
+        else if (ground_z > INVALID_HEIGHT)
+            z = ground_z;
+    }
+}
+
 bool Position::IsPositionValid() const
 {
     return Trinity::IsValidMapCoord(m_positionX, m_positionY, m_positionZ, m_orientation);
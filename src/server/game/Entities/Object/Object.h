@@ -602,6 +602,8 @@ class WorldObject : public Object, public WorldLocation
         float GetObjectSize() const;
         void UpdateGroundPositionZ(float x, float y, float &z) const;
         void UpdateAllowedPositionZ(float x, float y, float &z) const;
+        //! UpdateAllowedPositionZ for count x, y, z triples, ground heights are looked up together where possible
+        void UpdateAllowedPositionZ(float* points, uint32 count) const;
 
         void GetRandomPoint(Position const &srcPos, float distance, float &rand_x, float &rand_y, float &rand_z) const;
         void GetRandomPoint(Position const &srcPos, float distance, Position &pos) const;
@@ -642,6 +644,8 @@ class WorldObject : public Object, public WorldLocation
         bool IsWithinDistInMap(WorldObject const* obj, float dist2compare, bool is3D = true) const;
         bool IsWithinLOS(float x, float y, float z) const;
         bool IsWithinLOSInMap(WorldObject const* obj) const;
+        //! IsWithinLOSInMap for several objects at once, the rays are traced together
+        void IsWithinLOSInMap(WorldObject const* const* objects, bool* results, uint32 count) const;
         bool GetDistanceOrder(WorldObject const* obj1, WorldObject const* obj2, bool is3D = true) const;
         bool IsInRange(WorldObject const* obj, float minRange, float maxRange, bool is3D = true) const;
         bool IsInRange2d(float x, float y, float minRange, float maxRange) const;
@@ -165,7 +165,8 @@ Unit::Unit(bool isWorldObject) :
     m_ControlledByPlayer(false), movespline(new Movement::MoveSpline()),
     i_AI(NULL), i_disabledAI(NULL), m_AutoRepeatFirstCast(false), m_procDeep(0),
     m_removedAurasCount(0), i_motionMaster(new MotionMaster(this)), m_ThreatManager(this),
-    m_vehicle(NULL), m_vehicleKit(NULL), m_unitTypeMask(UNIT_MASK_NONE),
+    m_vehicle(NULL), m_vehicleKit(NULL), m_unitTypeMask(UNIT_MASK_NONE), m_sleeping(false),
+    m_sleepAurasChecked(false), m_sleepAurasAllowed(false),
     m_HostileRefManager(this), _lastDamagedTime(0)
 {
 #ifdef _MSC_VER
@@ -3146,6 +3147,8 @@ void Unit::SetCurrentCastedSpell(Spell* pSpell)
 {
     ASSERT(pSpell);                                         // NULL may be never passed here, use InterruptSpell or InterruptNonMeleeSpells
 
+    WakeUp();
+
     CurrentSpellTypes CSpellType = pSpell->GetCurrentContainer();
 
     if (pSpell == m_currentSpells[CSpellType])             // avoid breaking self
@@ -3398,6 +3401,9 @@ Aura* Unit::_TryStackingOrRefreshingExistingAura(SpellInfo const* newAura, uint3
 {
     ASSERT(casterGUID || caster);
 
+    // A refreshed or restacked aura must be updated again
+    AurasChanged();
+
     // Check if these can stack anyway
     if (!casterGUID && !newAura->IsStackableOnOneSlotWithDifferentCasters())
         casterGUID = caster->GetGUID();
@@ -3455,6 +3461,7 @@ void Unit::_AddAura(UnitAura* aura, Unit* caster)
 {
     ASSERT(!m_cleanupDone);
     m_ownedAuras.insert(AuraMap::value_type(aura->GetId(), aura));
+    AurasChanged();
 
     _RemoveNoStackAurasDueToAura(aura);
 
@@ -3507,6 +3514,8 @@ AuraApplication * Unit::_CreateAuraApplication(Aura* aura, uint32 effMask)
     // aura mustn't be already applied on target
     ASSERT (!aura->IsAppliedOnTarget(GetGUID()) && "Unit::_CreateAuraApplication: aura musn't be applied on target");
 
+    AurasChanged();
+
     SpellInfo const* aurSpellInfo = aura->GetSpellInfo();
     uint32 aurId = aurSpellInfo->Id;
 
@@ -3729,6 +3738,7 @@ void Unit::RemoveOwnedAura(AuraMap::iterator &i, AuraRemoveMode removeMode)
 
     m_ownedAuras.erase(i);
     m_removedAuras.push_back(aura);
+    AurasChanged();
 
     // unregister casted aura
     Unit* caster = aura->GetCaster();
@@ -5227,6 +5237,7 @@ void Unit::AddGameObject(GameObject* gameObj)
 
     m_gameObj.push_back(gameObj);
     gameObj->SetOwnerGUID(GetGUID());
+    WakeUp();
 
     if (GetTypeId() == TYPEID_PLAYER && gameObj->GetSpellId())
     {
@@ -14357,6 +14368,8 @@ void Unit::SetSpeed(UnitMoveType mtype, float rate, bool forced)
 
 void Unit::setDeathState(DeathState s)
 {
+    WakeUp();
+
     // Death state needs to be updated before RemoveAllAurasOnDeath() is called, to prevent entering combat
     m_deathState = s;
 
@@ -15277,6 +15290,9 @@ void Unit::SetLevel(uint8 lvl)
 
 void Unit::SetHealth(uint32 val)
 {
+    // Health below maximum has to regenerate
+    WakeUp();
+
     if (getDeathState() == JUST_DIED)
         val = 0;
     else if (GetTypeId() == TYPEID_PLAYER && getDeathState() == DEAD)
@@ -15309,6 +15325,8 @@ void Unit::SetHealth(uint32 val)
 
 void Unit::SetMaxHealth(uint32 val)
 {
+    WakeUp();
+
     if (!val)
         val = 1;
 
@@ -15397,6 +15415,7 @@ void Unit::SetPower(Powers power, int32 val)
     if (val == GetInt32Value(UNIT_FIELD_POWER + powerIndex))
         return;
 
+    WakeUp();
     SetInt32Value(UNIT_FIELD_POWER + powerIndex, val);
 
     if (IsInWorld())
@@ -15436,6 +15455,8 @@ void Unit::SetPower(Powers power, int32 val)
 
 void Unit::SetMaxPower(Powers power, int32 val)
 {
+    WakeUp();
+
     uint32 powerIndex = GetPowerIndexByClass(power, getClass());
     if (powerIndex == MAX_POWERS)
         return;
@@ -19502,6 +19523,8 @@ void Unit::_EnterVehicle(Vehicle* vehicle, int8 seatId, AuraApplication const* a
     // Must be called only from aura handler
     ASSERT(aurApp);
 
+    WakeUp();
+
     if (!IsAlive() || GetVehicleKit() == vehicle || vehicle->GetBase()->IsOnVehicle(this))
         return;
 
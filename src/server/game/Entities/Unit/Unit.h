@@ -2008,6 +2008,13 @@ class Unit : public WorldObject
         // Event handler
         EventProcessor m_Events;
 
+        // Idle creatures are skipped by the map update while sleeping, see Creature::CanSleep.
+        // Anything that gives a unit work to do in its next update must wake it up.
+        bool IsSleeping() const { return m_sleeping; }
+        void WakeUp() { m_sleeping = false; }
+        // Owned auras were added, removed or changed, the next sleep check looks at them again
+        void AurasChanged() { m_sleeping = false; m_sleepAurasChecked = false; }
+
         // stat system
         bool HandleStatModifier(UnitMods unitMod, UnitModifierType modifierType, float amount, bool apply);
         void SetModifierValue(UnitMods unitMod, UnitModifierType modifierType, float value) { m_auraModifiersGroup[unitMod][modifierType] = value; }
@@ -2414,6 +2421,10 @@ class Unit : public WorldObject
         uint32 m_unitTypeMask;
         LiquidTypeEntry const* _lastLiquid;
 
+        bool m_sleeping;
+        mutable bool m_sleepAurasChecked;               // m_sleepAurasAllowed is up to date
+        mutable bool m_sleepAurasAllowed;               // the owned auras let the unit sleep
+
         bool IsAlwaysVisibleFor(WorldObject const* seer) const;
         bool IsAlwaysDetectableFor(WorldObject const* seer) const;
 
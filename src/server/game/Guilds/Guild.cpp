@@ -1245,6 +1245,8 @@ Guild::Guild():
     m_createdDate(0),
     m_accountsNumber(0),
     m_bankMoney(0),
+    m_rosterValid(false),
+    m_rosterTime(0),
     m_eventLog(NULL),
     m_newsLog(NULL),
     m_achievementMgr(this),
@@ -1429,7 +1431,7 @@ void Guild::UpdateMemberData(Player* player, uint8 dataid, uint32 value)
                 TC_LOG_ERROR("guild", "Guild::UpdateMemberData: Called with incorrect DATAID %u (value %u)", dataid, value);
                 return;
         }
-        //HandleRoster();
+        _InvalidateRoster();
     }
 }
 
@@ -1440,6 +1442,9 @@ void Guild::OnPlayerStatusChange(Player* player, uint32 flag, bool state)
         if (state)
             member->AddFlag(flag);
         else member->RemFlag(flag);
+
+        _UpdateMemberOnline(member);
+        _InvalidateRoster();
     }
 }
 
@@ -1469,11 +1474,29 @@ bool Guild::SetName(std::string const& name)
 }
 
 void Guild::HandleRoster(WorldSession* session /*= NULL*/)
+{
+    if (!m_rosterValid || m_rosterTime + GUILD_ROSTER_CACHE_TIME <= ::time(NULL))
+        _BuildRosterPacket();
+
+    if (session)
+    {
+        TC_LOG_DEBUG("guild", "SMSG_GUILD_ROSTER [%s]", session->GetPlayerInfo().c_str());
+        session->SendPacket(&m_rosterPacket);
+    }
+    else
+    {
+        TC_LOG_DEBUG("guild", "SMSG_GUILD_ROSTER [Broadcast]");
+        BroadcastPacket(&m_rosterPacket);
+    }
+}
+
+void Guild::_BuildRosterPacket()
 {
     ByteBuffer memberData(100);
     // Guess size
 
-    WorldPacket data(SMSG_GUILD_ROSTER, 100);
+    WorldPacket& data = m_rosterPacket;
+    data.Initialize(SMSG_GUILD_ROSTER, 100);
 
     data.WriteBits(m_members.size(), 17);
     data.WriteBits(m_motd.length(), 10);
@@ -1538,16 +1561,8 @@ void Guild::HandleRoster(WorldSession* session /*= NULL*/)
     data.WriteString(m_motd);
     data << uint32(0);
 
-    if (session)
-    {
-        TC_LOG_DEBUG("guild", "SMSG_GUILD_ROSTER [%s]", session->GetPlayerInfo().c_str());
-        session->SendPacket(&data);
-    }
-    else
-    {
-        TC_LOG_DEBUG("guild", "SMSG_GUILD_ROSTER [Broadcast]");
-        BroadcastPacket(&data);
-    }
+    m_rosterValid = true;
+    m_rosterTime = ::time(NULL);
 }
 
 void Guild::HandleQuery(WorldSession* session)
@@ -1652,6 +1667,7 @@ void Guild::HandleSetMOTD(WorldSession* session, std::string const& motd)
     else
     {
         m_motd = motd;
+        _InvalidateRoster();
 
         sScriptMgr->OnGuildMOTDChanged(this, motd);
 
@@ -1671,6 +1687,7 @@ void Guild::HandleSetInfo(WorldSession* session, std::string const& info)
     if (_HasRankRight(session->GetPlayer(), GR_RIGHT_MODIFY_GUILD_INFO))
     {
         m_info = info;
+        _InvalidateRoster();
 
         sScriptMgr->OnGuildInfoChanged(this, info);
 
@@ -1826,6 +1843,7 @@ void Guild::HandleSetMemberNote(WorldSession* session, std::string const& note,
             member->SetPublicNote(note);
         else
             member->SetOfficerNote(note);
+        _InvalidateRoster();
 
         ObjectGuid memberGuid = member->GetGUID();
 
@@ -2264,6 +2282,7 @@ void Guild::HandleRemoveRank(WorldSession* session, uint8 rankId)
     for (Members::iterator itr = m_members.begin(); itr != m_members.end(); ++itr)
         if (itr->second->GetRankId() > rankId)
             itr->second->ChangeRank(itr->second->GetRankId() - 1, false);
+    _InvalidateRoster();
 
     // Update DB
     _UpdateAllGuildRightsOnRankDeleted(rankId);
@@ -2370,6 +2389,7 @@ void Guild::HandleSwitchRank(uint8 rankId, bool up)
         else if (itr->second->GetRankId() == otherRankId)
             itr->second->ChangeRank(rankId);
     }
+    _InvalidateRoster();
 }
 
 void Guild::_SendGuildMoney() const
@@ -2458,6 +2478,8 @@ void Guild::HandleMemberLogout(WorldSession* session)
         member->SetStats(player);
         member->UpdateLogoutTime();
         member->ResetFlags();
+        _UpdateMemberOnline(member);
+        _InvalidateRoster();
     }
     _SendPlayerLogged(player->GetGUID(), player->GetName(), false);
 
@@ -2654,6 +2676,8 @@ void Guild::SendLoginInfo(WorldSession* session)
 
     member->SetStats(player);
     member->AddFlag(GUILDMEMBER_STATUS_ONLINE);
+    _UpdateMemberOnline(member);
+    _InvalidateRoster();
     GetAchievementMgr().CheckAllAchievementCriteria(player);
     _SendPlayerLogged(player->GetGUID(), player->GetName(), true);
 }
@@ -2888,8 +2912,8 @@ void Guild::BroadcastToGuild(WorldSession* session, bool officerOnly, std::strin
     {
         WorldPacket data;
         ChatHandler::BuildChatPacket(data, officerOnly ? CHAT_MSG_OFFICER : CHAT_MSG_GUILD, Language(language), session->GetPlayer(), NULL, msg);
-        for (Members::const_iterator itr = m_members.begin(); itr != m_members.end(); ++itr)
-            if (Player* player = itr->second->FindPlayer())
+        for (OnlineMembers::const_iterator itr = m_onlineMembers.begin(); itr != m_onlineMembers.end(); ++itr)
+            if (Player* player = (*itr)->FindPlayer())
                 if (player->GetSession() && _HasRankRight(player, officerOnly ? GR_RIGHT_OFFCHATLISTEN : GR_RIGHT_GCHATLISTEN) &&
                     !player->GetSocial()->HasIgnore(session->GetPlayer()->GetGUIDLow()))
                     player->GetSession()->SendPacket(&data);
@@ -2902,8 +2926,8 @@ void Guild::BroadcastAddonToGuild(WorldSession* session, bool officerOnly, std::
     {
         WorldPacket data;
         ChatHandler::BuildChatPacket(data, officerOnly ? CHAT_MSG_OFFICER : CHAT_MSG_GUILD, LANG_ADDON, session->GetPlayer(), NULL, msg, 0, "", DEFAULT_LOCALE, prefix);
-        for (Members::const_iterator itr = m_members.begin(); itr != m_members.end(); ++itr)
-            if (Player* player = itr->second->FindPlayer())
+        for (OnlineMembers::const_iterator itr = m_onlineMembers.begin(); itr != m_onlineMembers.end(); ++itr)
+            if (Player* player = (*itr)->FindPlayer())
                 if (player->GetSession() && _HasRankRight(player, officerOnly ? GR_RIGHT_OFFCHATLISTEN : GR_RIGHT_GCHATLISTEN) &&
                     !player->GetSocial()->HasIgnore(session->GetPlayer()->GetGUIDLow()) &&
                     player->GetSession()->IsAddonRegistered(prefix))
@@ -2913,16 +2937,16 @@ void Guild::BroadcastAddonToGuild(WorldSession* session, bool officerOnly, std::
 
 void Guild::BroadcastPacketToRank(WorldPacket* packet, uint8 rankId) const
 {
-    for (Members::const_iterator itr = m_members.begin(); itr != m_members.end(); ++itr)
-        if (itr->second->IsRank(rankId))
-            if (Player* player = itr->second->FindPlayer())
+    for (OnlineMembers::const_iterator itr = m_onlineMembers.begin(); itr != m_onlineMembers.end(); ++itr)
+        if ((*itr)->IsRank(rankId))
+            if (Player* player = (*itr)->FindPlayer())
                 player->GetSession()->SendPacket(packet);
 }
 
 void Guild::BroadcastPacket(WorldPacket* packet) const
 {
-    for (Members::const_iterator itr = m_members.begin(); itr != m_members.end(); ++itr)
-        if (Player* player = itr->second->FindPlayer())
+    for (OnlineMembers::const_iterator itr = m_onlineMembers.begin(); itr != m_onlineMembers.end(); ++itr)
+        if (Player* player = (*itr)->FindPlayer())
             player->GetSession()->SendPacket(packet);
 }
 
@@ -3178,8 +3202,12 @@ void Guild::DeleteMember(uint64 guid, bool isDisbanding, bool isKicked, bool can
     sScriptMgr->OnGuildRemoveMember(this, player, isDisbanding, isKicked);
 
     if (Member* member = GetMember(guid))
+    {
+        m_onlineMembers.erase(member);
         delete member;
+    }
     m_members.erase(lowguid);
+    _InvalidateRoster();
 
     // If player not online data in data field will be loaded from guild tabs no need to update it !!
     if (player)
@@ -3221,6 +3249,7 @@ bool Guild::ChangeMemberRank(uint64 guid, uint8 newRank)
         if (Member* member = GetMember(guid))
         {
             member->ChangeRank(newRank);
+            _InvalidateRoster();
             return true;
         }
     return false;
@@ -3348,6 +3377,15 @@ void Guild::_UpdateAccountsNumber()
         accountsIdSet.insert(itr->second->GetAccountId());
 
     m_accountsNumber = accountsIdSet.size();
+    _InvalidateRoster();
+}
+
+void Guild::_UpdateMemberOnline(Member* member)
+{
+    if (member->IsOnline())
+        m_onlineMembers.insert(member);
+    else
+        m_onlineMembers.erase(member);
 }
 
 // Detects if player is the guild master.
@@ -3399,6 +3437,7 @@ void Guild::_SetLeaderGUID(Member* pLeader)
 
     m_leaderGuid = pLeader->GetGUID();
     pLeader->ChangeRank(GR_GUILDMASTER);
+    _InvalidateRoster();
 
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_UPD_GUILD_LEADER);
     stmt->setUInt32(0, GUID_LOPART(m_leaderGuid));
@@ -3751,13 +3790,13 @@ void Guild::_SendBankContentUpdate(uint8 tabId, SlotIds slots) const
         if (!tabData.empty())
             data.append(tabData);
 
-        for (Members::const_iterator itr = m_members.begin(); itr != m_members.end(); ++itr)
+        for (OnlineMembers::const_iterator itr = m_onlineMembers.begin(); itr != m_onlineMembers.end(); ++itr)
         {
-            if (_MemberHasTabRights(itr->second->GetGUID(), tabId, GUILD_BANK_RIGHT_VIEW_TAB))
+            if (_MemberHasTabRights((*itr)->GetGUID(), tabId, GUILD_BANK_RIGHT_VIEW_TAB))
             {
-                if (Player* player = itr->second->FindPlayer())
+                if (Player* player = (*itr)->FindPlayer())
                 {
-                    data.put<uint32>(pos, uint32(_GetMemberRemainingSlots(itr->second, tabId)));
+                    data.put<uint32>(pos, uint32(_GetMemberRemainingSlots(*itr, tabId)));
                     player->GetSession()->SendPacket(&data);
                 }
             }
@@ -3917,6 +3956,7 @@ void Guild::SendGuildRanksUpdate(uint64 setterGuid, uint64 targetGuid, uint32 ra
     BroadcastPacket(&data);
 
     member->ChangeRank(rank);
+    _InvalidateRoster();
 
     TC_LOG_DEBUG("network", "SMSG_GUILD_RANKS_UPDATE [Broadcast] Target: %u, Issuer: %u, RankId: %u",
         GUID_LOPART(targetGuid), GUID_LOPART(setterGuid), rank);
@@ -3941,7 +3981,10 @@ void Guild::GiveXP(uint32 xp, Player* source)
     _todayExperience += xp;
 
     if (Member* member = GetMember(source->GetGUID()))
+    {
         member->AddActivity(xp);
+        _InvalidateRoster();
+    }
 
     SendGuildXP(source->GetSession());
 
@@ -3964,9 +4007,9 @@ void Guild::GiveXP(uint32 xp, Player* source)
                     perksToLearn.push_back(entry->SpellId);
 
         // Notify all online players that guild level changed and learn perks
-        for (Members::const_iterator itr = m_members.begin(); itr != m_members.end(); ++itr)
+        for (OnlineMembers::const_iterator itr = m_onlineMembers.begin(); itr != m_onlineMembers.end(); ++itr)
         {
-            if (Player* player = itr->second->FindPlayer())
+            if (Player* player = (*itr)->FindPlayer())
             {
                 player->SetGuildLevel(GetLevel());
                 for (size_t i = 0; i < perksToLearn.size(); ++i)
@@ -4010,6 +4053,7 @@ void Guild::SendGuildReputationWeeklyCap(Member* member) const
 void Guild::ResetTimes(bool weekly)
 {
     _todayExperience = 0;
+    _InvalidateRoster();
     for (Members::const_iterator itr = m_members.begin(); itr != m_members.end(); ++itr)
     {
         itr->second->ResetValues(weekly);
@@ -4092,6 +4136,7 @@ void Guild::GiveReputationToMember(uint32 reputation, Player* player)
 
     player->GetReputationMgr().ModifyReputation(sFactionStore.LookupEntry(GUILD_FACTION_ID), reputation);
     member->AddReputation(reputation);
+    _InvalidateRoster();
     SendGuildReputationWeeklyCap(member);
 }
 
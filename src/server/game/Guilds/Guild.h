@@ -42,7 +42,8 @@ enum GuildMisc
     GUILD_EXPERIENCE_UNCAPPED_LEVEL     = 20,                   ///> Hardcoded in client, starting from this level, guild daily experience gain is unlimited.
     TAB_UNDEFINED                       = 0xFF,
     GUILD_FACTION_ID                    = 1168,                 // guild reputation
-    MAX_GUILD_PROFESSIONS               = 2
+    MAX_GUILD_PROFESSIONS               = 2,
+    GUILD_ROSTER_CACHE_TIME             = 60                    // seconds a cached roster is sent, keeps the offline time of members current
 };
 
 enum GuildMemberData
@@ -770,6 +771,7 @@ private:
     };
 
     typedef UNORDERED_MAP<uint32, Member*> Members;
+    typedef std::set<Member*> OnlineMembers;
     typedef std::vector<RankInfo> Ranks;
     typedef std::vector<BankTab*> BankTabs;
 
@@ -918,8 +920,14 @@ protected:
 
     Ranks m_ranks;
     Members m_members;
+    OnlineMembers m_onlineMembers;                          // members with GUILDMEMBER_STATUS_ONLINE, used for broadcasts
     BankTabs m_bankTabs;
 
+    // SMSG_GUILD_ROSTER is sent from cache until something shown in it changes
+    WorldPacket m_rosterPacket;
+    bool m_rosterValid;
+    time_t m_rosterTime;
+
     // These are actually ordered lists. The first element is the oldest entry.
     LogHolder* m_eventLog;
     LogHolder* m_bankEventLog[GUILD_BANK_MAX_TABS + 1];
@@ -986,6 +994,11 @@ private:
     bool _CreateRank(std::string const& name, uint32 rights);
     // Update account number when member added/removed from guild
     void _UpdateAccountsNumber();
+    // Keeps m_onlineMembers in sync with the online flag of a member
+    void _UpdateMemberOnline(Member* member);
+    // Must be called whenever data sent in SMSG_GUILD_ROSTER changes
+    inline void _InvalidateRoster() { m_rosterValid = false; }
+    void _BuildRosterPacket();
     bool _IsLeader(Player* player) const;
     void _DeleteBankItems(SQLTransaction& trans, bool removeItemsFromDB = false);
     bool _ModifyBankMoney(SQLTransaction& trans, uint64 amount, bool add);
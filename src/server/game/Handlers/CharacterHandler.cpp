@@ -852,6 +852,7 @@ void WorldSession::HandlePlayerLoginOpcode(WorldPacket& recvData)
         return;
     }
 
+    _charLoginQueryTime = getMSTime();
 	_charLoginCallback = CharacterDatabase.DelayQueryHolder((SQLQueryHolder*)holder);
     PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_CHARACTER_SPELL);
     stmt->setUInt32(0, GetAccountId());
@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CollisionQueryCache.h"
+#include "GridDefines.h"
+
+#include <algorithm>
+#include <cstring>
+
+enum CollisionQueryCacheLimits
+{
+    // Queries spanning more cells are not cached, checking their cells would cost more than it saves
+    MAX_CACHED_QUERY_CELLS  = 4,
+    // Once this many cells changed the stamps are folded into _validFrom, which drops all entries once
+    MAX_CELL_STAMPS         = 1024
+};
+
+CollisionQueryCache::CollisionQueryCache() : _size(0), _mask(0), _clock(1), _validFrom(1) { }
+
+void CollisionQueryCache::Initialize(uint32 size)
+{
+    _entries.clear();
+    _mask = 0;
+    _size = 0;
+
+    if (!size)
+        return;
+
+    _size = 1;
+    while (_size < size)
+        _size <<= 1;
+}
+
+uint32 CollisionQueryCache::ComputeCell(float coord)
+{
+    // Same cells as Trinity::ComputeCellCoord, clamped to the map
+    double offset = (double(coord) - CENTER_GRID_CELL_OFFSET) / SIZE_OF_GRID_CELL + CENTER_GRID_CELL_ID + 0.5;
+    if (!(offset > 0.0))                                // also catches NaN
+        return 0;
+
+    if (offset >= double(TOTAL_NUMBER_OF_CELLS_PER_MAP))
+        return TOTAL_NUMBER_OF_CELLS_PER_MAP - 1;
+
+    return uint32(offset);
+}
+
+bool CollisionQueryCache::MakeArea(float minX, float minY, float maxX, float maxY, CellArea& area)
+{
+    area.minX = ComputeCell(minX);
+    area.minY = ComputeCell(minY);
+    area.maxX = ComputeCell(maxX);
+    area.maxY = ComputeCell(maxY);
+    return area.maxX - area.minX < MAX_CACHED_QUERY_CELLS && area.maxY - area.minY < MAX_CACHED_QUERY_CELLS;
+}
+
+void CollisionQueryCache::InvalidateGrid(uint32 gridX, uint32 gridY)
+{
+    if (!IsEnabled() || gridX >= MAX_NUMBER_OF_GRIDS || gridY >= MAX_NUMBER_OF_GRIDS)
+        return;
+
+    if (_gridStamps.empty())
+        _gridStamps.resize(MAX_NUMBER_OF_GRIDS * MAX_NUMBER_OF_GRIDS, 0);
+
+    _gridStamps[gridX * MAX_NUMBER_OF_GRIDS + gridY] = ++_clock;
+    ++_stats.invalidations;
+}
+
+void CollisionQueryCache::InvalidateArea(float minX, float minY, float maxX, float maxY)
+{
+    if (!IsEnabled())
+        return;
+
+    ++_clock;
+    ++_stats.invalidations;
+
+    uint32 x1 = ComputeCell(minX), x2 = ComputeCell(maxX);
+    uint32 y1 = ComputeCell(minY), y2 = ComputeCell(maxY);
+
+    if (_cellStamps.size() + (x2 - x1 + 1) * (y2 - y1 + 1) > MAX_CELL_STAMPS)
+    {
+        _cellStamps.clear();
+        _validFrom = _clock;
+        return;
+    }
+
+    for (uint32 x = x1; x <= x2; ++x)
+        for (uint32 y = y1; y <= y2; ++y)
+            _cellStamps[x * TOTAL_NUMBER_OF_CELLS_PER_MAP + y] = _clock;
+}
+
+bool CollisionQueryCache::IsCurrent(uint32 stamp, CellArea const& area) const
+{
+    if (stamp < _validFrom)
+        return false;
+
+    if (!_gridStamps.empty())
+        for (uint32 x = area.minX / MAX_NUMBER_OF_CELLS; x <= area.maxX / MAX_NUMBER_OF_CELLS; ++x)
+            for (uint32 y = area.minY / MAX_NUMBER_OF_CELLS; y <= area.maxY / MAX_NUMBER_OF_CELLS; ++y)
+                if (_gridStamps[x * MAX_NUMBER_OF_GRIDS + y] > stamp)
+                    return false;
+
+    if (!_cellStamps.empty())
+        for (uint32 x = area.minX; x <= area.maxX; ++x)
+            for (uint32 y = area.minY; y <= area.maxY; ++y)
+            {
+                UNORDERED_MAP<uint32, uint32>::const_iterator itr = _cellStamps.find(x * TOTAL_NUMBER_OF_CELLS_PER_MAP + y);
+                if (itr != _cellStamps.end() && itr->second > stamp)
+                    return false;
+            }
+
+    return true;
+}
+
+bool CollisionQueryCache::Key::operator==(Key const& other) const
+{
+    return type == other.type && phasemask == other.phasemask && param == other.param &&
+        !memcmp(coords, other.coords, sizeof(coords));
+}
+
+static inline uint32 FloatBits(float value)
+{
+    uint32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+CollisionQueryCache::Key CollisionQueryCache::MakeLineOfSightKey(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask) const
+{
+    Key key;
+    key.coords[0] = FloatBits(x1);
+    key.coords[1] = FloatBits(y1);
+    key.coords[2] = FloatBits(z1);
+    key.coords[3] = FloatBits(x2);
+    key.coords[4] = FloatBits(y2);
+    key.coords[5] = FloatBits(z2);
+    key.phasemask = phasemask;
+    key.param = 0;
+    key.type = COLLISION_QUERY_LOS;
+    return key;
+}
+
+CollisionQueryCache::Key CollisionQueryCache::MakeHeightKey(float x, float y, float z, uint32 phasemask, bool vmap, float maxSearchDist) const
+{
+    Key key;
+    key.coords[0] = FloatBits(x);
+    key.coords[1] = FloatBits(y);
+    key.coords[2] = FloatBits(z);
+    key.coords[3] = FloatBits(maxSearchDist);
+    key.coords[4] = 0;
+    key.coords[5] = 0;
+    key.phasemask = phasemask;
+    key.param = vmap ? 1 : 0;
+    key.type = COLLISION_QUERY_HEIGHT;
+    return key;
+}
+
+CollisionQueryCache::Entry& CollisionQueryCache::GetSlot(Key const& key)
+{
+    // FNV-1a over the key fields
+    uint32 hash = 2166136261u;
+    for (uint8 i = 0; i < 6; ++i)
+        hash = (hash ^ key.coords[i]) * 16777619u;
+    hash = (hash ^ key.phasemask) * 16777619u;
+    hash = (hash ^ (key.param << 8 | key.type)) * 16777619u;
+
+    return _entries[(hash ^ (hash >> 16)) & _mask];
+}
+
+bool CollisionQueryCache::Find(Key const& key, CellArea const& area, float& value)
+{
+    if (_entries.empty())
+    {
+        ++_stats.misses[key.type];
+        return false;
+    }
+
+    Entry& entry = GetSlot(key);
+    if (!entry.stamp || !(entry.key == key) || !IsCurrent(entry.stamp, area))
+    {
+        ++_stats.misses[key.type];
+        return false;
+    }
+
+    ++_stats.hits[key.type];
+    value = entry.value;
+    return true;
+}
+
+void CollisionQueryCache::Store(Key const& key, float value)
+{
+    if (_entries.empty())
+    {
+        _entries.resize(_size);
+        _mask = _size - 1;
+    }
+
+    // Direct mapped, a colliding query simply replaces the older one
+    Entry& entry = GetSlot(key);
+    entry.key = key;
+    entry.stamp = _clock;
+    entry.value = value;
+}
+
+bool CollisionQueryCache::GetLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask, bool& result)
+{
+    CellArea area;
+    if (!IsEnabled() || !MakeArea(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2), area))
+        return false;
+
+    float value;
+    if (!Find(MakeLineOfSightKey(x1, y1, z1, x2, y2, z2, phasemask), area, value))
+        return false;
+
+    result = value != 0.0f;
+    return true;
+}
+
+void CollisionQueryCache::SetLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask, bool result)
+{
+    CellArea area;
+    if (IsEnabled() && MakeArea(std::min(x1, x2), std::min(y1, y2), std::max(x1, x2), std::max(y1, y2), area))
+        Store(MakeLineOfSightKey(x1, y1, z1, x2, y2, z2, phasemask), result ? 1.0f : 0.0f);
+}
+
+bool CollisionQueryCache::GetHeight(float x, float y, float z, uint32 phasemask, bool vmap, float maxSearchDist, float& height)
+{
+    CellArea area;
+    if (!IsEnabled() || !MakeArea(x, y, x, y, area))
+        return false;
+
+    return Find(MakeHeightKey(x, y, z, phasemask, vmap, maxSearchDist), area, height);
+}
+
+void CollisionQueryCache::SetHeight(float x, float y, float z, uint32 phasemask, bool vmap, float maxSearchDist, float height)
+{
+    if (IsEnabled())
+        Store(MakeHeightKey(x, y, z, phasemask, vmap, maxSearchDist), height);
+}
+
+CollisionQueryCacheStats CollisionQueryCache::GetStats(bool reset /*= false*/)
+{
+    CollisionQueryCacheStats stats = _stats;
+    if (reset)
+        _stats = CollisionQueryCacheStats();
+
+    return stats;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _COLLISION_QUERY_CACHE_H_INCLUDED
+#define _COLLISION_QUERY_CACHE_H_INCLUDED
+
+#include "Define.h"
+#include "UnorderedMap.h"
+#include <vector>
+
+enum CollisionQueryType
+{
+    COLLISION_QUERY_LOS,
+    COLLISION_QUERY_HEIGHT,
+    MAX_COLLISION_QUERY
+};
+
+struct CollisionQueryCacheStats
+{
+    CollisionQueryCacheStats() : invalidations(0)
+    {
+        for (uint8 i = 0; i < MAX_COLLISION_QUERY; ++i)
+            hits[i] = misses[i] = 0;
+    }
+
+    uint64 hits[MAX_COLLISION_QUERY];
+    uint64 misses[MAX_COLLISION_QUERY];
+    uint32 invalidations;
+};
+
+//! Bounded cache of line of sight and height results of one map.
+//! Queries are keyed by the exact bits of their arguments, a hit returns exactly what the query returned.
+//! Every entry is stamped when it is stored. Changes of the collision geometry stamp the grids (terrain and vmap
+//! tiles) or cells (gameobject models) they affect, an entry is only returned while none of the grids and cells
+//! its query covers changed after it was stored.
+//! The entries are allocated by the first stored result, maps nobody queries cost no memory.
+//! Not thread safe, only used by the thread updating the map.
+class CollisionQueryCache
+{
+    public:
+        CollisionQueryCache();
+
+        //! size is rounded up to a power of two, 0 disables the cache
+        void Initialize(uint32 size);
+
+        bool IsEnabled() const { return _size != 0; }
+
+        //! Called when the terrain or vmap tile of a grid is loaded or unloaded, takes the GridCoord of the grid
+        void InvalidateGrid(uint32 gridX, uint32 gridY);
+        //! Called when a gameobject model covering the area is inserted, removed, enabled, disabled or changes phase
+        void InvalidateArea(float minX, float minY, float maxX, float maxY);
+
+        bool GetLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask, bool& result);
+        void SetLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask, bool result);
+
+        bool GetHeight(float x, float y, float z, uint32 phasemask, bool vmap, float maxSearchDist, float& height);
+        void SetHeight(float x, float y, float z, uint32 phasemask, bool vmap, float maxSearchDist, float height);
+
+        //! Copies the hit statistics and optionally restarts them
+        CollisionQueryCacheStats GetStats(bool reset = false);
+
+    private:
+        struct Key
+        {
+            uint32 coords[6];
+            uint32 phasemask;
+            uint32 param;
+            uint8 type;
+
+            bool operator==(Key const& other) const;
+        };
+
+        struct Entry
+        {
+            Entry() : stamp(0), value(0.0f) { }
+
+            Key key;
+            uint32 stamp;
+            float value;
+        };
+
+        //! Cells covered by a query, inclusive
+        struct CellArea
+        {
+            uint32 minX, minY, maxX, maxY;
+        };
+
+        static uint32 ComputeCell(float coord);
+        static bool MakeArea(float minX, float minY, float maxX, float maxY, CellArea& area);
+
+        Key MakeLineOfSightKey(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask) const;
+        Key MakeHeightKey(float x, float y, float z, uint32 phasemask, bool vmap, float maxSearchDist) const;
+        Entry& GetSlot(Key const& key);
+
+        //! Whether nothing in the area changed after stamp
+        bool IsCurrent(uint32 stamp, CellArea const& area) const;
+
+        //! Returns the value of a valid entry for key and counts the hit or miss
+        bool Find(Key const& key, CellArea const& area, float& value);
+        void Store(Key const& key, float value);
+
+        uint32 _size;
+        std::vector<Entry> _entries;
+        uint32 _mask;
+
+        uint32 _clock;                                  //! Advanced by every invalidation
+        uint32 _validFrom;                              //! Entries stamped before are outdated everywhere
+        std::vector<uint32> _gridStamps;                //! Last change per grid, allocated by the first grid change
+        UNORDERED_MAP<uint32, uint32> _cellStamps;      //! Last change per cell, only cells that ever changed
+
+        CollisionQueryCacheStats _stats;
+};
+
+#endif //_COLLISION_QUERY_CACHE_H_INCLUDED
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GridMapPreloader.h"
+#include "Log.h"
+#include "Map.h"
+
+#include <ace/Guard_T.h>
+#include <ace/Method_Request.h>
+
+//! Keep unclaimed tiles this long before freeing them again
+#define GRID_MAP_PRELOAD_EXPIRY (60 * IN_MILLISECONDS)
+
+class GridMapPreloadRequest : public ACE_Method_Request
+{
+    private:
+
+        GridMapPreloader& m_preloader;
+        uint64 m_key;
+        std::string m_fileName;
+
+    public:
+
+        GridMapPreloadRequest(GridMapPreloader& preloader, uint64 key, std::string const& fileName)
+            : m_preloader(preloader), m_key(key), m_fileName(fileName)
+        {
+        }
+
+        virtual int call()
+        {
+            GridMap* gridMap = new GridMap();
+            if (!gridMap->loadData(const_cast<char*>(m_fileName.c_str())))
+            {
+                TC_LOG_ERROR("maps", "Error preloading map file: \n %s\n", m_fileName.c_str());
+                delete gridMap;
+                gridMap = NULL;
+            }
+
+            m_preloader.LoadFinished(m_key, gridMap);
+            return 0;
+        }
+};
+
+GridMapPreloader::GridMapPreloader() : m_executor(), m_mutex() { }
+
+GridMapPreloader::~GridMapPreloader()
+{
+    deactivate();
+
+    for (PreloadedGridMapContainer::iterator itr = m_gridMaps.begin(); itr != m_gridMaps.end(); ++itr)
+        delete itr->second.gridMap;
+}
+
+int GridMapPreloader::activate(size_t num_threads)
+{
+    return m_executor.start((int)num_threads);
+}
+
+int GridMapPreloader::deactivate()
+{
+    return m_executor.deactivate();
+}
+
+bool GridMapPreloader::activated()
+{
+    return m_executor.activated();
+}
+
+void GridMapPreloader::Schedule(uint32 mapId, int gx, int gy, std::string const& fileName)
+{
+    uint64 key = MakeKey(mapId, gx, gy);
+
+    TRINITY_GUARD(ACE_Thread_Mutex, m_mutex);
+
+    if (m_gridMaps.find(key) != m_gridMaps.end())
+        return;
+
+    m_gridMaps[key] = PreloadedGridMap();
+    if (m_executor.execute(new GridMapPreloadRequest(*this, key, fileName)) == -1)
+        m_gridMaps.erase(key);
+}
+
+GridMap* GridMapPreloader::Take(uint32 mapId, int gx, int gy)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_mutex);
+
+    PreloadedGridMapContainer::iterator itr = m_gridMaps.find(MakeKey(mapId, gx, gy));
+    if (itr == m_gridMaps.end() || !itr->second.gridMap)
+        return NULL;
+
+    GridMap* gridMap = itr->second.gridMap;
+    m_gridMaps.erase(itr);
+    return gridMap;
+}
+
+void GridMapPreloader::Update(uint32 diff)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_mutex);
+
+    for (PreloadedGridMapContainer::iterator itr = m_gridMaps.begin(); itr != m_gridMaps.end();)
+    {
+        PreloadedGridMap& preloaded = itr->second;
+        if (!preloaded.gridMap)
+        {
+            ++itr;
+            continue;
+        }
+
+        preloaded.age += diff;
+        if (preloaded.age < GRID_MAP_PRELOAD_EXPIRY)
+        {
+            ++itr;
+            continue;
+        }
+
+        delete preloaded.gridMap;
+        m_gridMaps.erase(itr++);
+    }
+}
+
+void GridMapPreloader::LoadFinished(uint64 key, GridMap* gridMap)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_mutex);
+
+    PreloadedGridMapContainer::iterator itr = m_gridMaps.find(key);
+    if (itr == m_gridMaps.end() || !gridMap)
+    {
+        //! A failed load is retried synchronously by Map::LoadMap
+        if (itr != m_gridMaps.end())
+            m_gridMaps.erase(itr);
+        delete gridMap;
+        return;
+    }
+
+    itr->second.gridMap = gridMap;
+}
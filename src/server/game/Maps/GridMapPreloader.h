@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GRID_MAP_PRELOADER_H_INCLUDED
+#define _GRID_MAP_PRELOADER_H_INCLUDED
+
+#include <ace/Thread_Mutex.h>
+
+#include "Define.h"
+#include "DelayExecutor.h"
+#include "Dynamic/UnorderedMap.h"
+
+class GridMap;
+
+//! Reads terrain (.map) tiles on background threads before a player reaches them.
+//! Map::LoadMap takes finished tiles from here instead of reading them on the map thread.
+class GridMapPreloader
+{
+    public:
+        GridMapPreloader();
+        ~GridMapPreloader();
+
+        friend class GridMapPreloadRequest;
+
+        int activate(size_t num_threads);
+        int deactivate();
+        bool activated();
+
+        //! Queues the tile for background loading unless it is already queued or loaded. Called from map threads.
+        void Schedule(uint32 mapId, int gx, int gy, std::string const& fileName);
+
+        //! Hands out a finished tile, NULL if it was never scheduled or is still loading. Caller owns the result.
+        GridMap* Take(uint32 mapId, int gx, int gy);
+
+        //! Drops tiles nobody picked up within the expiry time, e.g. because the player turned around.
+        void Update(uint32 diff);
+
+    private:
+        struct PreloadedGridMap
+        {
+            PreloadedGridMap() : gridMap(NULL), age(0) { }
+
+            GridMap* gridMap;   //! NULL while still loading
+            uint32 age;         //! Time in ms since loading finished
+        };
+
+        typedef UNORDERED_MAP<uint64, PreloadedGridMap> PreloadedGridMapContainer;
+
+        static uint64 MakeKey(uint32 mapId, int gx, int gy) { return (uint64(mapId) << 16) | (uint64(gx) << 8) | uint64(gy); }
+
+        void LoadFinished(uint64 key, GridMap* gridMap);
+
+        DelayExecutor m_executor;
+        ACE_Thread_Mutex m_mutex;
+        PreloadedGridMapContainer m_gridMaps;
+};
+
+#endif //_GRID_MAP_PRELOADER_H_INCLUDED
@@ -34,6 +34,7 @@
 #include "Transport.h"
 #include "Vehicle.h"
 #include "VMapFactory.h"
+#include "RayPacket.h"
 
 u_map_magic MapMagic        = { {'M','A','P','S'} };
 u_map_magic MapVersionMagic = { {'v','1','.','3'} };
@@ -187,16 +188,57 @@ void Map::LoadMap(int gx, int gy, bool reload)
     int len = sWorld->GetDataPath().length() + strlen("maps/%03u%02u%02u.map") + 1;
     tmp = new char[len];
     snprintf(tmp, len, (char *)(sWorld->GetDataPath() + "maps/%03u%02u%02u.map").c_str(), GetId(), gx, gy);
-    TC_LOG_DEBUG("maps", "Loading map %s", tmp);
-    // loading data
-    GridMaps[gx][gy] = new GridMap();
-    if (!GridMaps[gx][gy]->loadData(tmp))
-        TC_LOG_ERROR("maps", "Error loading map file: \n %s\n", tmp);
+    // use the terrain read ahead by the preloader if it is already there
+    if (!reload)
+        GridMaps[gx][gy] = sMapMgr->GetGridMapPreloader()->Take(GetId(), gx, gy);
+
+    if (GridMaps[gx][gy])
+        TC_LOG_DEBUG("maps", "Using preloaded map %s", tmp);
+    else
+    {
+        TC_LOG_DEBUG("maps", "Loading map %s", tmp);
+        // loading data
+        GridMaps[gx][gy] = new GridMap();
+        if (!GridMaps[gx][gy]->loadData(tmp))
+            TC_LOG_ERROR("maps", "Error loading map file: \n %s\n", tmp);
+    }
     delete[] tmp;
 
     sScriptMgr->OnLoadGridMap(this, GridMaps[gx][gy], gx, gy);
 }
 
+void Map::PreloadGridMapAhead(Player* player, float x, float y)
+{
+    GridMapPreloader* preloader = sMapMgr->GetGridMapPreloader();
+    if (!preloader->activated())
+        return;
+
+    float dx = x - player->GetPositionX();
+    float dy = y - player->GetPositionY();
+    float dist = std::sqrt(dx * dx + dy * dy);
+    if (dist < 0.1f)
+        return;
+
+    // extrapolate the movement and read the terrain of the grid the player is heading to
+    float lookAhead = float(sWorld->getIntConfig(CONFIG_GRID_PRELOAD_DISTANCE));
+    float aheadX = x + dx / dist * lookAhead;
+    float aheadY = y + dy / dist * lookAhead;
+    if (!Trinity::IsValidMapCoord(aheadX, aheadY))
+        return;
+
+    GridCoord p = Trinity::ComputeGridCoord(aheadX, aheadY);
+    int gx = 63 - p.x_coord;
+    int gy = 63 - p.y_coord;
+
+    // instances share the terrain of their base map
+    if (m_parentMap->GridMaps[gx][gy])
+        return;
+
+    char fileName[1024];
+    snprintf(fileName, sizeof(fileName), (char *)(sWorld->GetDataPath() + "maps/%03u%02u%02u.map").c_str(), GetId(), gx, gy);
+    preloader->Schedule(GetId(), gx, gy, fileName);
+}
+
 void Map::LoadMapAndVMap(int gx, int gy)
 {
     LoadMap(gx, gy);
@@ -206,6 +248,9 @@ void Map::LoadMapAndVMap(int gx, int gy)
         LoadVMap(gx, gy);
         LoadMMap(gx, gy);
     }
+
+    // results computed without the new tile are outdated
+    _collisionCache.InvalidateGrid((MAX_NUMBER_OF_GRIDS - 1) - gx, (MAX_NUMBER_OF_GRIDS - 1) - gy);
 }
 
 void Map::InitStateMachine()
@@ -247,6 +292,9 @@ i_scriptLock(false), _defaultLight(GetDefaultMapLight(id))
     //lets initialize visibility distance for map
     Map::InitVisibilityDistance();
 
+    _collisionCache.Initialize(sWorld->getIntConfig(CONFIG_COLLISION_CACHE_SIZE));
+    _collisionCacheStatsTimer.SetInterval(5 * MINUTE * IN_MILLISECONDS);
+
     sScriptMgr->OnCreateMap(this);
 }
 
@@ -602,6 +650,20 @@ void Map::VisitNearbyCellsOf(WorldObject* obj, TypeContainerVisitor<Trinity::Obj
 void Map::Update(const uint32 t_diff)
 {
     _dynamicTree.update(t_diff);
+
+    if (_collisionCache.IsEnabled())
+    {
+        _collisionCacheStatsTimer.Update(t_diff);
+        if (_collisionCacheStatsTimer.Passed())
+        {
+            _collisionCacheStatsTimer.Reset();
+            CollisionQueryCacheStats stats = _collisionCache.GetStats(true);
+            if (stats.hits[COLLISION_QUERY_LOS] || stats.misses[COLLISION_QUERY_LOS] || stats.hits[COLLISION_QUERY_HEIGHT] || stats.misses[COLLISION_QUERY_HEIGHT])
+                TC_LOG_DEBUG("maps", "Map %u instance %u collision cache: LOS " UI64FMTD " hits / " UI64FMTD " misses, height " UI64FMTD " hits / " UI64FMTD " misses, %u invalidations",
+                    GetId(), GetInstanceId(), stats.hits[COLLISION_QUERY_LOS], stats.misses[COLLISION_QUERY_LOS],
+                    stats.hits[COLLISION_QUERY_HEIGHT], stats.misses[COLLISION_QUERY_HEIGHT], stats.invalidations);
+        }
+    }
     /// update worldsessions for existing players
     for (m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
@@ -846,6 +908,9 @@ void Map::PlayerRelocation(Player* player, float x, float y, float z, float orie
     if (player->HasUnitMovementFlag(MOVEMENTFLAG_HOVER))
         z += player->GetFloatValue(UNIT_FIELD_HOVER_HEIGHT);
 
+    if (old_cell.DiffGrid(new_cell) || old_cell.DiffCell(new_cell))
+        PreloadGridMapAhead(player, x, y);
+
     player->Relocate(x, y, z, orientation);
     if (player->IsVehicle())
         player->GetVehicleKit()->RelocatePassengers();
@@ -1323,6 +1388,7 @@ bool Map::UnloadGrid(NGridType& ngrid, bool unloadAll)
             ((MapInstanced*)m_parentMap)->RemoveGridMapReference(GridCoord(gx, gy));
 
         GridMaps[gx][gy] = NULL;
+        _collisionCache.InvalidateGrid(x, y);
     }
     TC_LOG_DEBUG("maps", "Unloading grid[%u, %u] for map %u finished", x, y, GetId());
     return true;
@@ -1371,8 +1437,7 @@ GridMap::GridMap()
     // Height level data
     _gridHeight = INVALID_HEIGHT;
     _gridGetHeight = &GridMap::getHeightFromFlat;
-    m_V9 = NULL;
-    m_V8 = NULL;
+    m_heightStrips = NULL;
     // Liquid data
     _liquidType    = 0;
     _liquidOffX   = 0;
@@ -1443,14 +1508,12 @@ bool GridMap::loadData(char* filename)
 void GridMap::unloadData()
 {
     delete[] _areaMap;
-    delete[] m_V9;
-    delete[] m_V8;
+    delete[] m_heightStrips;
     delete[] _liquidEntry;
     delete[] _liquidFlags;
     delete[] _liquidMap;
     _areaMap = NULL;
-    m_V9 = NULL;
-    m_V8 = NULL;
+    m_heightStrips = NULL;
     _liquidEntry = NULL;
     _liquidFlags = NULL;
     _liquidMap  = NULL;
@@ -1475,6 +1538,35 @@ bool GridMap::loadAreaData(FILE* in, uint32 offset, uint32 /*size*/)
     return true;
 }
 
+// One strip per cell row x: V9[x][y], V9[x+1][y], V8[x][y] for every y, closed by V9[x][128], V9[x+1][128]
+// Cell (x, y) then starts at x*HEIGHT_STRIP_SIZE + y*3 and holds h1, h2, h5, h3, h4 in this order
+static uint32 const HEIGHT_STRIP_SIZE = (MAP_RESOLUTION + 1) * 2 + MAP_RESOLUTION;
+
+template<class T>
+static T* loadHeightStrips(FILE* in)
+{
+    std::vector<T> V9((MAP_RESOLUTION + 1) * (MAP_RESOLUTION + 1));
+    std::vector<T> V8(MAP_RESOLUTION * MAP_RESOLUTION);
+    if (fread(&V9[0], sizeof(T), V9.size(), in) != V9.size() ||
+        fread(&V8[0], sizeof(T), V8.size(), in) != V8.size())
+        return NULL;
+
+    T* strips = new T[MAP_RESOLUTION * HEIGHT_STRIP_SIZE];
+    T* itr = strips;
+    for (uint32 x = 0; x < MAP_RESOLUTION; ++x)
+    {
+        for (uint32 y = 0; y <= MAP_RESOLUTION; ++y)
+        {
+            *itr++ = V9[x * (MAP_RESOLUTION + 1) + y];
+            *itr++ = V9[(x + 1) * (MAP_RESOLUTION + 1) + y];
+            if (y < MAP_RESOLUTION)
+                *itr++ = V8[x * MAP_RESOLUTION + y];
+        }
+    }
+
+    return strips;
+}
+
 bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
 {
     map_heightHeader header;
@@ -1488,30 +1580,24 @@ bool GridMap::loadHeightData(FILE* in, uint32 offset, uint32 /*size*/)
     {
         if ((header.flags & MAP_HEIGHT_AS_INT16))
         {
-            m_uint16_V9 = new uint16 [129*129];
-            m_uint16_V8 = new uint16 [128*128];
-            if (fread(m_uint16_V9, sizeof(uint16), 129*129, in) != 129*129 ||
-                fread(m_uint16_V8, sizeof(uint16), 128*128, in) != 128*128)
+            m_uint16_heightStrips = loadHeightStrips<uint16>(in);
+            if (!m_uint16_heightStrips)
                 return false;
             _gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 65535;
             _gridGetHeight = &GridMap::getHeightFromUint16;
         }
         else if ((header.flags & MAP_HEIGHT_AS_INT8))
         {
-            m_uint8_V9 = new uint8 [129*129];
-            m_uint8_V8 = new uint8 [128*128];
-            if (fread(m_uint8_V9, sizeof(uint8), 129*129, in) != 129*129 ||
-                fread(m_uint8_V8, sizeof(uint8), 128*128, in) != 128*128)
+            m_uint8_heightStrips = loadHeightStrips<uint8>(in);
+            if (!m_uint8_heightStrips)
                 return false;
             _gridIntHeightMultiplier = (header.gridMaxHeight - header.gridHeight) / 255;
             _gridGetHeight = &GridMap::getHeightFromUint8;
         }
         else
         {
-            m_V9 = new float [129*129];
-            m_V8 = new float [128*128];
-            if (fread(m_V9, sizeof(float), 129*129, in) != 129*129 ||
-                fread(m_V8, sizeof(float), 128*128, in) != 128*128)
+            m_heightStrips = loadHeightStrips<float>(in);
+            if (!m_heightStrips)
                 return false;
             _gridGetHeight = &GridMap::getHeightFromFloat;
         }
@@ -1574,7 +1660,7 @@ float GridMap::getHeightFromFlat(float /*x*/, float /*y*/) const
 
 float GridMap::getHeightFromFloat(float x, float y) const
 {
-    if (!m_V8 || !m_V9)
+    if (!m_heightStrips)
         return _gridHeight;
 
     x = MAP_RESOLUTION * (32 - x/SIZE_OF_GRIDS);
@@ -1602,6 +1688,7 @@ float GridMap::getHeightFromFloat(float x, float y) const
     // 2 - solve linear equation from triangle points
     // Calculate coefficients for solve h = a*x + b*y + c
 
+    float const* cell = &m_heightStrips[x_int * HEIGHT_STRIP_SIZE + y_int * 3];
     float a, b, c;
     // Select triangle:
     if (x+y < 1)
@@ -1609,9 +1696,9 @@ float GridMap::getHeightFromFloat(float x, float y) const
         if (x > y)
         {
             // 1 triangle (h1, h2, h5 points)
-            float h1 = m_V9[(x_int)*129 + y_int];
-            float h2 = m_V9[(x_int+1)*129 + y_int];
-            float h5 = 2 * m_V8[x_int*128 + y_int];
+            float h1 = cell[0];
+            float h2 = cell[1];
+            float h5 = 2 * cell[2];
             a = h2-h1;
             b = h5-h1-h2;
             c = h1;
@@ -1619,9 +1706,9 @@ float GridMap::getHeightFromFloat(float x, float y) const
         else
         {
             // 2 triangle (h1, h3, h5 points)
-            float h1 = m_V9[x_int*129 + y_int  ];
-            float h3 = m_V9[x_int*129 + y_int+1];
-            float h5 = 2 * m_V8[x_int*128 + y_int];
+            float h1 = cell[0];
+            float h3 = cell[3];
+            float h5 = 2 * cell[2];
             a = h5 - h1 - h3;
             b = h3 - h1;
             c = h1;
@@ -1632,9 +1719,9 @@ float GridMap::getHeightFromFloat(float x, float y) const
         if (x > y)
         {
             // 3 triangle (h2, h4, h5 points)
-            float h2 = m_V9[(x_int+1)*129 + y_int  ];
-            float h4 = m_V9[(x_int+1)*129 + y_int+1];
-            float h5 = 2 * m_V8[x_int*128 + y_int];
+            float h2 = cell[1];
+            float h4 = cell[4];
+            float h5 = 2 * cell[2];
             a = h2 + h4 - h5;
             b = h4 - h2;
             c = h5 - h4;
@@ -1642,9 +1729,9 @@ float GridMap::getHeightFromFloat(float x, float y) const
         else
         {
             // 4 triangle (h3, h4, h5 points)
-            float h3 = m_V9[(x_int)*129 + y_int+1];
-            float h4 = m_V9[(x_int+1)*129 + y_int+1];
-            float h5 = 2 * m_V8[x_int*128 + y_int];
+            float h3 = cell[3];
+            float h4 = cell[4];
+            float h5 = 2 * cell[2];
             a = h4 - h3;
             b = h3 + h4 - h5;
             c = h5 - h4;
@@ -1656,7 +1743,7 @@ float GridMap::getHeightFromFloat(float x, float y) const
 
 float GridMap::getHeightFromUint8(float x, float y) const
 {
-    if (!m_uint8_V8 || !m_uint8_V9)
+    if (!m_uint8_heightStrips)
         return _gridHeight;
 
     x = MAP_RESOLUTION * (32 - x/SIZE_OF_GRIDS);
@@ -1670,15 +1757,15 @@ float GridMap::getHeightFromUint8(float x, float y) const
     y_int&=(MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint8 *V9_h1_ptr = &m_uint8_V9[x_int*128 + x_int + y_int];
+    uint8 const* cell = &m_uint8_heightStrips[x_int * HEIGHT_STRIP_SIZE + y_int * 3];
     if (x+y < 1)
     {
         if (x > y)
         {
             // 1 triangle (h1, h2, h5 points)
-            int32 h1 = V9_h1_ptr[  0];
-            int32 h2 = V9_h1_ptr[129];
-            int32 h5 = 2 * m_uint8_V8[x_int*128 + y_int];
+            int32 h1 = cell[0];
+            int32 h2 = cell[1];
+            int32 h5 = 2 * cell[2];
             a = h2-h1;
             b = h5-h1-h2;
             c = h1;
@@ -1686,9 +1773,9 @@ float GridMap::getHeightFromUint8(float x, float y) const
         else
         {
             // 2 triangle (h1, h3, h5 points)
-            int32 h1 = V9_h1_ptr[0];
-            int32 h3 = V9_h1_ptr[1];
-            int32 h5 = 2 * m_uint8_V8[x_int*128 + y_int];
+            int32 h1 = cell[0];
+            int32 h3 = cell[3];
+            int32 h5 = 2 * cell[2];
             a = h5 - h1 - h3;
             b = h3 - h1;
             c = h1;
@@ -1699,9 +1786,9 @@ float GridMap::getHeightFromUint8(float x, float y) const
         if (x > y)
         {
             // 3 triangle (h2, h4, h5 points)
-            int32 h2 = V9_h1_ptr[129];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint8_V8[x_int*128 + y_int];
+            int32 h2 = cell[1];
+            int32 h4 = cell[4];
+            int32 h5 = 2 * cell[2];
             a = h2 + h4 - h5;
             b = h4 - h2;
             c = h5 - h4;
@@ -1709,9 +1796,9 @@ float GridMap::getHeightFromUint8(float x, float y) const
         else
         {
             // 4 triangle (h3, h4, h5 points)
-            int32 h3 = V9_h1_ptr[  1];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint8_V8[x_int*128 + y_int];
+            int32 h3 = cell[3];
+            int32 h4 = cell[4];
+            int32 h5 = 2 * cell[2];
             a = h4 - h3;
             b = h3 + h4 - h5;
             c = h5 - h4;
@@ -1723,7 +1810,7 @@ float GridMap::getHeightFromUint8(float x, float y) const
 
 float GridMap::getHeightFromUint16(float x, float y) const
 {
-    if (!m_uint16_V8 || !m_uint16_V9)
+    if (!m_uint16_heightStrips)
         return _gridHeight;
 
     x = MAP_RESOLUTION * (32 - x/SIZE_OF_GRIDS);
@@ -1737,15 +1824,15 @@ float GridMap::getHeightFromUint16(float x, float y) const
     y_int&=(MAP_RESOLUTION - 1);
 
     int32 a, b, c;
-    uint16 *V9_h1_ptr = &m_uint16_V9[x_int*128 + x_int + y_int];
+    uint16 const* cell = &m_uint16_heightStrips[x_int * HEIGHT_STRIP_SIZE + y_int * 3];
     if (x+y < 1)
     {
         if (x > y)
         {
             // 1 triangle (h1, h2, h5 points)
-            int32 h1 = V9_h1_ptr[  0];
-            int32 h2 = V9_h1_ptr[129];
-            int32 h5 = 2 * m_uint16_V8[x_int*128 + y_int];
+            int32 h1 = cell[0];
+            int32 h2 = cell[1];
+            int32 h5 = 2 * cell[2];
             a = h2-h1;
             b = h5-h1-h2;
             c = h1;
@@ -1753,9 +1840,9 @@ float GridMap::getHeightFromUint16(float x, float y) const
         else
         {
             // 2 triangle (h1, h3, h5 points)
-            int32 h1 = V9_h1_ptr[0];
-            int32 h3 = V9_h1_ptr[1];
-            int32 h5 = 2 * m_uint16_V8[x_int*128 + y_int];
+            int32 h1 = cell[0];
+            int32 h3 = cell[3];
+            int32 h5 = 2 * cell[2];
             a = h5 - h1 - h3;
             b = h3 - h1;
             c = h1;
@@ -1766,9 +1853,9 @@ float GridMap::getHeightFromUint16(float x, float y) const
         if (x > y)
         {
             // 3 triangle (h2, h4, h5 points)
-            int32 h2 = V9_h1_ptr[129];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint16_V8[x_int*128 + y_int];
+            int32 h2 = cell[1];
+            int32 h4 = cell[4];
+            int32 h5 = 2 * cell[2];
             a = h2 + h4 - h5;
             b = h4 - h2;
             c = h5 - h4;
@@ -1776,9 +1863,9 @@ float GridMap::getHeightFromUint16(float x, float y) const
         else
         {
             // 4 triangle (h3, h4, h5 points)
-            int32 h3 = V9_h1_ptr[  1];
-            int32 h4 = V9_h1_ptr[130];
-            int32 h5 = 2 * m_uint16_V8[x_int*128 + y_int];
+            int32 h3 = cell[3];
+            int32 h4 = cell[4];
+            int32 h5 = 2 * cell[2];
             a = h4 - h3;
             b = h3 + h4 - h5;
             c = h5 - h4;
@@ -1788,6 +1875,78 @@ float GridMap::getHeightFromUint16(float x, float y) const
     return (float)((a * x) + (b * y) + c)*_gridIntHeightMultiplier + _gridHeight;
 }
 
+void GridMap::getHeights(float const* points, float* heights, uint32 count) const
+{
+    if (_gridGetHeight == &GridMap::getHeightFromFloat && m_heightStrips)
+        getHeightsFromStrips(m_heightStrips, points, heights, count);
+    else if (_gridGetHeight == &GridMap::getHeightFromUint16 && m_uint16_heightStrips)
+        getHeightsFromStrips(m_uint16_heightStrips, points, heights, count);
+    else if (_gridGetHeight == &GridMap::getHeightFromUint8 && m_uint8_heightStrips)
+        getHeightsFromStrips(m_uint8_heightStrips, points, heights, count);
+    else
+        std::fill(heights, heights + count, _gridHeight);
+}
+
+template<class T>
+void GridMap::getHeightsFromStrips(T const* strips, float const* points, float* heights, uint32 count) const
+{
+    // Integer heights are scaled the same way getHeightFromUint8/16 do it
+    bool isFloat = _gridGetHeight == &GridMap::getHeightFromFloat;
+    PacketFloat const scale(isFloat ? 1.0f : _gridIntHeightMultiplier);
+    PacketFloat const offset(isFloat ? 0.0f : _gridHeight);
+    PacketFloat const one(1.0f);
+
+    for (uint32 first = 0; first < count; first += RAY_PACKET_SIZE)
+    {
+        // Gather the cell points of up to four positions, the same triangles as getHeightFromFloat are then
+        // interpolated for all of them at once, each lane selecting its own triangle
+        float fx[RAY_PACKET_SIZE], fy[RAY_PACKET_SIZE];
+        float h1[RAY_PACKET_SIZE], h2[RAY_PACKET_SIZE], h3[RAY_PACKET_SIZE], h4[RAY_PACKET_SIZE], h5[RAY_PACKET_SIZE];
+        uint32 lanes = std::min<uint32>(count - first, RAY_PACKET_SIZE);
+        for (uint32 lane = 0; lane < RAY_PACKET_SIZE; ++lane)
+        {
+            // unused lanes repeat the last position
+            float const* point = &points[(first + std::min(lane, lanes - 1)) * 3];
+            float x = MAP_RESOLUTION * (32 - point[0] / SIZE_OF_GRIDS);
+            float y = MAP_RESOLUTION * (32 - point[1] / SIZE_OF_GRIDS);
+
+            int x_int = (int)x;
+            int y_int = (int)y;
+            fx[lane] = x - x_int;
+            fy[lane] = y - y_int;
+            x_int &= (MAP_RESOLUTION - 1);
+            y_int &= (MAP_RESOLUTION - 1);
+
+            T const* cell = &strips[x_int * HEIGHT_STRIP_SIZE + y_int * 3];
+            h1[lane] = float(cell[0]);
+            h2[lane] = float(cell[1]);
+            h5[lane] = 2 * float(cell[2]);
+            h3[lane] = float(cell[3]);
+            h4[lane] = float(cell[4]);
+        }
+
+        PacketFloat x = PacketFloat::load(fx);
+        PacketFloat y = PacketFloat::load(fy);
+        PacketFloat p1 = PacketFloat::load(h1);
+        PacketFloat p2 = PacketFloat::load(h2);
+        PacketFloat p3 = PacketFloat::load(h3);
+        PacketFloat p4 = PacketFloat::load(h4);
+        PacketFloat p5 = PacketFloat::load(h5);
+
+        PacketFloat upper = packetLessMask(x + y, one);     // triangles 1 and 2
+        PacketFloat right = packetLessMask(y, x);           // triangles 1 and 3
+
+        PacketFloat a = packetSelect(upper, packetSelect(right, p2 - p1, p5 - p1 - p3), packetSelect(right, p2 + p4 - p5, p4 - p3));
+        PacketFloat b = packetSelect(upper, packetSelect(right, p5 - p1 - p2, p3 - p1), packetSelect(right, p4 - p2, p3 + p4 - p5));
+        PacketFloat c = packetSelect(upper, p1, p5 - p4);
+
+        float result[RAY_PACKET_SIZE];
+        ((a * x + b * y + c) * scale + offset).store(result);
+        for (uint32 lane = 0; lane < lanes; ++lane)
+            heights[first + lane] = result[lane];
+    }
+}
+
 float GridMap::getLiquidLevel(float x, float y) const
 {
     if (!_liquidMap)
@@ -1958,6 +2117,11 @@ float Map::GetHeight(float x, float y, float z, bool checkVMap /*= true*/, float
             mapHeight = gridHeight;
     }
 
+    return SelectHeight(x, y, z, mapHeight, checkVMap, maxSearchDist);
+}
+
+float Map::SelectHeight(float x, float y, float z, float mapHeight, bool checkVMap, float maxSearchDist) const
+{
     float vmapHeight = VMAP_INVALID_HEIGHT_VALUE;
     if (checkVMap)
     {
@@ -2220,8 +2384,68 @@ void Map::GetZoneAndAreaIdByAreaFlag(uint32& zoneid, uint32& areaid, uint16 area
 
 bool Map::isInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask) const
 {
-    return VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2)
+    bool result;
+    if (_collisionCache.GetLineOfSight(x1, y1, z1, x2, y2, z2, phasemask, result))
+        return result;
+
+    result = VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, x2, y2, z2)
         && _dynamicTree.isInLineOfSight(x1, y1, z1, x2, y2, z2, phasemask);
+
+    _collisionCache.SetLineOfSight(x1, y1, z1, x2, y2, z2, phasemask, result);
+    return result;
+}
+
+void Map::isInLineOfSight(float x1, float y1, float z1, const float* targets, bool* results, uint32 count, uint32 phasemask) const
+{
+    // only trace what the cache does not know yet
+    std::vector<float> missTargets;
+    std::vector<uint32> missIndexes;
+    for (uint32 i = 0; i < count; ++i)
+    {
+        const float* target = targets + i * 3;
+        if (_collisionCache.GetLineOfSight(x1, y1, z1, target[0], target[1], target[2], phasemask, results[i]))
+            continue;
+
+        missTargets.insert(missTargets.end(), target, target + 3);
+        missIndexes.push_back(i);
+    }
+
+    if (missIndexes.empty())
+        return;
+
+    uint32 missCount = missIndexes.size();
+    bool* los = new bool[missCount];
+    VMAP::VMapFactory::createOrGetVMapManager()->isInLineOfSight(GetId(), x1, y1, z1, &missTargets[0], los, missCount);
+
+    // gameobjects only need to be checked where terrain does not block already
+    std::vector<float> dynamicTargets;
+    std::vector<uint32> dynamicIndexes;
+    for (uint32 i = 0; i < missCount; ++i)
+    {
+        if (!los[i])
+            continue;
+
+        dynamicTargets.insert(dynamicTargets.end(), &missTargets[i * 3], &missTargets[i * 3] + 3);
+        dynamicIndexes.push_back(i);
+    }
+
+    if (!dynamicIndexes.empty())
+    {
+        bool* dynamicLoS = new bool[dynamicIndexes.size()];
+        _dynamicTree.isInLineOfSight(x1, y1, z1, &dynamicTargets[0], dynamicLoS, dynamicIndexes.size(), phasemask);
+        for (uint32 i = 0; i < dynamicIndexes.size(); ++i)
+            los[dynamicIndexes[i]] = dynamicLoS[i];
+        delete[] dynamicLoS;
+    }
+
+    for (uint32 i = 0; i < missCount; ++i)
+    {
+        const float* target = &missTargets[i * 3];
+        _collisionCache.SetLineOfSight(x1, y1, z1, target[0], target[1], target[2], phasemask, los[i]);
+        results[missIndexes[i]] = los[i];
+    }
+
+    delete[] los;
 }
 
 bool Map::getObjectHitPos(uint32 phasemask, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float& ry, float& rz, float modifyDist)
@@ -2240,7 +2464,58 @@ bool Map::getObjectHitPos(uint32 phasemask, float x1, float y1, float z1, float
 
 float Map::GetHeight(uint32 phasemask, float x, float y, float z, bool vmap/*=true*/, float maxSearchDist/*=DEFAULT_HEIGHT_SEARCH*/) const
 {
-    return std::max<float>(GetHeight(x, y, z, vmap, maxSearchDist), _dynamicTree.getHeight(x, y, z, maxSearchDist, phasemask));
+    float height;
+    if (_collisionCache.GetHeight(x, y, z, phasemask, vmap, maxSearchDist, height))
+        return height;
+
+    height = std::max<float>(GetHeight(x, y, z, vmap, maxSearchDist), _dynamicTree.getHeight(x, y, z, maxSearchDist, phasemask));
+
+    _collisionCache.SetHeight(x, y, z, phasemask, vmap, maxSearchDist, height);
+    return height;
+}
+
+void Map::GetHeights(uint32 phasemask, float const* points, float* heights, uint32 count, bool vmap/*=true*/, float maxSearchDist/*=DEFAULT_HEIGHT_SEARCH*/) const
+{
+    // .map heights first, one GetGrid per run of points in the same grid
+    uint32 first = 0;
+    while (first < count)
+    {
+        int gx = (int)(32 - points[first * 3] / SIZE_OF_GRIDS);
+        int gy = (int)(32 - points[first * 3 + 1] / SIZE_OF_GRIDS);
+
+        uint32 last = first + 1;
+        while (last < count && (int)(32 - points[last * 3] / SIZE_OF_GRIDS) == gx && (int)(32 - points[last * 3 + 1] / SIZE_OF_GRIDS) == gy)
+            ++last;
+
+        if (GridMap* gmap = const_cast<Map*>(this)->GetGrid(points[first * 3], points[first * 3 + 1]))
+            gmap->getHeights(&points[first * 3], &heights[first], last - first);
+        else
+            std::fill(heights + first, heights + last, VMAP_INVALID_HEIGHT_VALUE);
+
+        first = last;
+    }
+
+    // then everything GetHeight does on top of them, per point
+    for (uint32 i = 0; i < count; ++i)
+    {
+        float x = points[i * 3];
+        float y = points[i * 3 + 1];
+        float z = points[i * 3 + 2];
+
+        float height;
+        if (_collisionCache.GetHeight(x, y, z, phasemask, vmap, maxSearchDist, height))
+        {
+            heights[i] = height;
+            continue;
+        }
+
+        // look from a bit higher pos to find the floor, ignore under surface case
+        float mapHeight = z + 2.0f > heights[i] ? heights[i] : VMAP_INVALID_HEIGHT_VALUE;
+        height = std::max<float>(SelectHeight(x, y, z, mapHeight, vmap, maxSearchDist), _dynamicTree.getHeight(x, y, z, maxSearchDist, phasemask));
+
+        _collisionCache.SetHeight(x, y, z, phasemask, vmap, maxSearchDist, height);
+        heights[i] = height;
+    }
 }
 
 bool Map::IsInWater(float x, float y, float pZ, LiquidData* data) const
@@ -31,6 +31,7 @@
 #include "MapRefManager.h"
 #include "DynamicTree.h"
 #include "GameObjectModel.h"
+#include "CollisionQueryCache.h"
 
 #include <bitset>
 #include <list>
@@ -154,15 +155,12 @@ struct LiquidData
 class GridMap
 {
     uint32  _flags;
+    // Height data, V9 and V8 points regrouped at load into one strip per cell row
+    // so that the five points of a cell are adjacent (see loadHeightStrips)
     union{
-        float* m_V9;
-        uint16* m_uint16_V9;
-        uint8* m_uint8_V9;
-    };
-    union{
-        float* m_V8;
-        uint16* m_uint16_V8;
-        uint8* m_uint8_V8;
+        float* m_heightStrips;
+        uint16* m_uint16_heightStrips;
+        uint8* m_uint8_heightStrips;
     };
     // Height level data
     float _gridHeight;
@@ -195,6 +193,8 @@ class GridMap
     float getHeightFromUint16(float x, float y) const;
     float getHeightFromUint8(float x, float y) const;
     float getHeightFromFlat(float x, float y) const;
+    template<class T>
+    void getHeightsFromStrips(T const* strips, float const* points, float* heights, uint32 count) const;
 
 public:
     GridMap();
@@ -204,6 +204,8 @@ public:
 
     uint16 getArea(float x, float y) const;
     inline float getHeight(float x, float y) const {return (this->*_gridGetHeight)(x, y);}
+    // Heights of count points given as x, y, z triples (z is not used), sampled four at a time
+    void getHeights(float const* points, float* heights, uint32 count) const;
     float getLiquidLevel(float x, float y) const;
     uint8 getTerrainType(float x, float y) const;
     ZLiquidStatus getLiquidStatus(float x, float y, float z, uint8 ReqLiquidType, LiquidData* data = 0);
@@ -461,10 +463,22 @@ class Map : public GridRefManager<NGridType>
         const InstanceMap* ToInstanceMap() const { if (IsDungeon())  return (const InstanceMap*)((InstanceMap*)this); else return NULL;  }
         float GetWaterOrGroundLevel(float x, float y, float z, float* ground = NULL, bool swim = false) const;
         float GetHeight(uint32 phasemask, float x, float y, float z, bool vmap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
+        //! GetHeight for several positions at once, points holds count x, y, z triples and heights[i] is set for the i-th of them
+        //! Consecutive points in the same grid share one grid lookup and their .map heights are sampled together
+        void GetHeights(uint32 phasemask, float const* points, float* heights, uint32 count, bool vmap = true, float maxSearchDist = DEFAULT_HEIGHT_SEARCH) const;
         bool isInLineOfSight(float x1, float y1, float z1, float x2, float y2, float z2, uint32 phasemask) const;
+        //! line of sight from one position to several others, traced together
+        //! targets holds count x, y, z triples, results[i] is set for the i-th of them
+        void isInLineOfSight(float x1, float y1, float z1, const float* targets, bool* results, uint32 count, uint32 phasemask) const;
         void Balance() { _dynamicTree.balance(); }
-        void RemoveGameObjectModel(const GameObjectModel& model) { _dynamicTree.remove(model); }
-        void InsertGameObjectModel(const GameObjectModel& model) { _dynamicTree.insert(model); }
+        void RemoveGameObjectModel(const GameObjectModel& model) { _dynamicTree.remove(model); GameObjectModelChanged(model); }
+        void InsertGameObjectModel(const GameObjectModel& model) { _dynamicTree.insert(model); GameObjectModelChanged(model); }
+        //! Must be called when a contained model is enabled, disabled or changes phase
+        void GameObjectModelChanged(const GameObjectModel& model)
+        {
+            G3D::AABox const& bounds = model.getBounds();
+            _collisionCache.InvalidateArea(bounds.low().x, bounds.low().y, bounds.high().x, bounds.high().y);
+        }
         bool ContainsGameObjectModel(const GameObjectModel& model) const { return _dynamicTree.contains(model);}
         bool getObjectHitPos(uint32 phasemask, float x1, float y1, float z1, float x2, float y2, float z2, float& rx, float &ry, float& rz, float modifyDist);
 
@@ -513,7 +527,10 @@ class Map : public GridRefManager<NGridType>
         void LoadVMap(int gx, int gy);
         void LoadMap(int gx, int gy, bool reload = false);
         void LoadMMap(int gx, int gy);
+        void PreloadGridMapAhead(Player* player, float x, float y);
         GridMap* GetGrid(float x, float y);
+        // vmap part of GetHeight, mapHeight is the .map height already checked against z
+        float SelectHeight(float x, float y, float z, float mapHeight, bool checkVMap, float maxSearchDist) const;
 
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
 
@@ -568,6 +585,8 @@ class Map : public GridRefManager<NGridType>
         uint32 m_unloadTimer;
         float m_VisibleDistance;
         DynamicMapTree _dynamicTree;
+        mutable CollisionQueryCache _collisionCache;
+        IntervalTimer _collisionCacheStatsTimer;
 
         MapRefManager m_mapRefManager;
         MapRefManager::iterator m_mapRefIter;
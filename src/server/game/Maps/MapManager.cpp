@@ -62,6 +62,11 @@ void MapManager::Initialize()
     // Start mtmaps if needed.
     if (num_threads > 0 && m_updater.activate(num_threads) == -1)
         abort();
+
+    // Terrain files are read ahead of moving players if enabled
+    int preload_threads(sWorld->getIntConfig(CONFIG_GRID_PRELOAD_THREADS));
+    if (preload_threads > 0 && m_gridMapPreloader.activate(preload_threads) == -1)
+        abort();
 }
 
 void MapManager::InitializeVisibilityDistanceInfo()
@@ -297,6 +302,9 @@ void MapManager::Update(uint32 diff)
 
     sObjectAccessor->Update(uint32(i_timer.GetCurrent()));
 
+    if (m_gridMapPreloader.activated())
+        m_gridMapPreloader.Update(uint32(i_timer.GetCurrent()));
+
     i_timer.SetCurrent(0);
 }
 
@@ -336,6 +344,9 @@ void MapManager::UnloadAll()
     if (m_updater.activated())
         m_updater.deactivate();
 
+    if (m_gridMapPreloader.activated())
+        m_gridMapPreloader.deactivate();
+
     Map::DeleteStateMachine();
 }
 
@@ -22,6 +22,7 @@
 #include "Map.h"
 #include "GridStates.h"
 #include "MapUpdater.h"
+#include "GridMapPreloader.h"
 
 #include <ace/Singleton.h>
 #include <ace/Thread_Mutex.h>
@@ -123,6 +124,7 @@ class MapManager
         void SetNextInstanceId(uint32 nextInstanceId) { _nextInstanceId = nextInstanceId; };
 
         MapUpdater * GetMapUpdater() { return &m_updater; }
+        GridMapPreloader* GetGridMapPreloader() { return &m_gridMapPreloader; }
 
     private:
         typedef UNORDERED_MAP<uint32, Map*> MapMapType;
@@ -153,6 +155,7 @@ class MapManager
         InstanceIds _instanceIds;
         uint32 _nextInstanceId;
         MapUpdater m_updater;
+        GridMapPreloader m_gridMapPreloader;
 };
 #define sMapMgr ACE_Singleton<MapManager, ACE_Thread_Mutex>::instance()
 #endif
@@ -440,15 +440,19 @@ void MotionMaster::MoveCirclePath(float x, float y, float z, float radius, bool
         G3D::Vector3 point;
         point.x = x + radius * cosf(angle);
         point.y = y + radius * sinf(angle);
-
-        if (_owner->IsFlying())
-            point.z = z;
-        else
-            point.z = _owner->GetMap()->GetHeight(_owner->GetPhaseMask(), point.x, point.y, z);
-
+        point.z = z;
         init.Path().push_back(point);
     }
 
+    // all ground heights of the circle at once, G3D::Vector3 is laid out as plain x, y, z floats
+    if (!_owner->IsFlying() && stepCount)
+    {
+        std::vector<float> heights(stepCount);
+        _owner->GetMap()->GetHeights(_owner->GetPhaseMask(), &init.Path()[0].x, &heights[0], stepCount);
+        for (uint8 i = 0; i < stepCount; ++i)
+            init.Path()[i].z = heights[i];
+    }
+
     if (_owner->IsFlying())
     {
         init.SetFly();
@@ -623,6 +627,8 @@ void MotionMaster::MoveDistract(uint32 timer)
 
 void MotionMaster::Mutate(MovementGenerator *m, MovementSlot slot)
 {
+    _owner->WakeUp();
+
     if (MovementGenerator *curr = Impl[slot])
     {
         Impl[slot] = NULL; // in case a new one is generated in this slot during directdelete
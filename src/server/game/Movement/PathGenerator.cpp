@@ -611,8 +611,9 @@ void PathGenerator::BuildPointPath(const float *startPoint, const float *endPoin
 
 void PathGenerator::NormalizePath()
 {
-    for (uint32 i = 0; i < _pathPoints.size(); ++i)
-        _sourceUnit->UpdateAllowedPositionZ(_pathPoints[i].x, _pathPoints[i].y, _pathPoints[i].z);
+    // G3D::Vector3 is laid out as plain x, y, z floats
+    if (!_pathPoints.empty())
+        _sourceUnit->UpdateAllowedPositionZ(&_pathPoints[0].x, _pathPoints.size());
 }
 
 void PathGenerator::BuildShortcut()
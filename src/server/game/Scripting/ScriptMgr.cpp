@@ -32,12 +32,48 @@
 #include "Player.h"
 #include "WorldPacket.h"
 
+#include <atomic>
+
+#if COMPILER == COMPILER_MICROSOFT
+#  define SCRIPT_HOOK_TLS __declspec(thread)
+#else
+#  define SCRIPT_HOOK_TLS __thread
+#endif
+
 namespace
 {
     typedef std::set<ScriptObject*> ExampleScriptContainer;
     ExampleScriptContainer ExampleScripts;
+
+    // Set when the last hook called on this thread was the default implementation
+    SCRIPT_HOOK_TLS bool HookNotImplementedFlag = false;
+
+    // Guards the subscribers of all hooks, only taken on refresh and when a script is dropped from a hook
+    ACE_Thread_Mutex ScriptHookLock;
 }
 
+void ScriptObject::HookNotImplemented()
+{
+    HookNotImplementedFlag = true;
+}
+
+// Scripts subscribed to one hook, one instance per call site. Every registered script of the type starts subscribed
+// and is dropped the first time a call reaches the empty default implementation of the hook, so hooks no script
+// implements cost a single branch. std::atomic has a trivial default constructor, so the hook is zero initialized
+// and needs no construction when first reached by several threads.
+// Count, Scripts and Subscribers are written under ScriptHookLock before Version is stored with release order,
+// callers load Version with acquire order before they read them.
+template<class TScript>
+struct ScriptHook
+{
+    std::atomic<bool> Idle;                                 // no script left to call
+    std::atomic<uint32> Version;                            // registry version the subscribers were taken from, 0 if never
+    uint32 Count;
+    uint32 Subscribed;                                      // guarded by ScriptHookLock
+    TScript** Scripts;                                      // all scripts of the type, in registry order
+    std::atomic<TScript*>* Subscribers;                     // Scripts, but NULL for scripts dropped from the hook
+};
+
 // This is the global static registry of scripts.
 template<class TScript>
 class ScriptRegistry
@@ -93,6 +129,7 @@ class ScriptRegistry
                     {
                         ScriptPointerList[id] = script;
                         sScriptMgr->IncrementScriptCount();
+                        InvalidateHooks();
                     }
                     else
                     {
@@ -119,7 +156,61 @@ class ScriptRegistry
                 // We're dealing with a code-only script; just add it.
                 ScriptPointerList[_scriptIdCounter++] = script;
                 sScriptMgr->IncrementScriptCount();
+                InvalidateHooks();
+            }
+        }
+
+        // Makes every hook take the scripts again on its next call. Like the script list itself, only allowed
+        // while no hook can be called concurrently (startup and shutdown).
+        static void InvalidateHooks()
+        {
+            TRINITY_GUARD(ACE_Thread_Mutex, ScriptHookLock);
+            ++_version;
+            for (typename std::vector<ScriptHook<TScript>*>::const_iterator itr = _hooks.begin(); itr != _hooks.end(); ++itr)
+                (*itr)->Idle.store(false, std::memory_order_release);
+        }
+
+        // Takes the current scripts as subscribers of the hook if the script list changed since the last call.
+        static void SyncHook(ScriptHook<TScript>& hook)
+        {
+            if (hook.Version.load(std::memory_order_acquire) == _version)
+                return;
+
+            TRINITY_GUARD(ACE_Thread_Mutex, ScriptHookLock);
+            uint32 version = hook.Version.load(std::memory_order_relaxed);
+            if (version == _version)
+                return;
+
+            if (!version)
+                _hooks.push_back(&hook);
+
+            delete[] hook.Scripts;
+            delete[] hook.Subscribers;
+            hook.Count = uint32(ScriptPointerList.size());
+            hook.Scripts = new TScript*[hook.Count];
+            hook.Subscribers = new std::atomic<TScript*>[hook.Count];
+            uint32 index = 0;
+            for (ScriptMapIterator it = ScriptPointerList.begin(); it != ScriptPointerList.end(); ++it, ++index)
+            {
+                hook.Scripts[index] = it->second;
+                hook.Subscribers[index].store(it->second, std::memory_order_relaxed);
             }
+
+            hook.Subscribed = hook.Count;
+            hook.Idle.store(!hook.Count, std::memory_order_relaxed);
+            hook.Version.store(_version, std::memory_order_release);
+        }
+
+        // Stops calling the script at index for the hook.
+        static void Unsubscribe(ScriptHook<TScript>& hook, uint32 index)
+        {
+            TRINITY_GUARD(ACE_Thread_Mutex, ScriptHookLock);
+            if (!hook.Subscribers[index].load(std::memory_order_relaxed))
+                return;
+
+            hook.Subscribers[index].store(NULL, std::memory_order_relaxed);
+            if (!--hook.Subscribed)
+                hook.Idle.store(true, std::memory_order_relaxed);
         }
 
         // Gets a script by its ID (assigned by ObjectMgr).
@@ -136,6 +227,90 @@ class ScriptRegistry
 
         // Counter used for code-only scripts.
         static uint32 _scriptIdCounter;
+
+        // Incremented whenever ScriptPointerList changes, starts at 1 so zero initialized hooks are out of date
+        static uint32 _version;
+
+        // Hooks that took subscribers from this registry
+        static std::vector<ScriptHook<TScript>*> _hooks;
+};
+
+// Walks the subscribers of a hook and drops every script whose call reached the default implementation.
+template<class TScript>
+class ScriptHookIterator
+{
+    public:
+
+        explicit ScriptHookIterator(ScriptHook<TScript>& hook)
+            : _hook(hook), _index(0), _end(0), _current(NULL)
+        {
+            ScriptRegistry<TScript>::SyncHook(hook);
+            _end = hook.Count;
+        }
+
+        // Only visits the first script of the type registered for the map, like the map script dispatch always did.
+        // The script is found among all scripts, a first script dropped from the hook does not let a later one run.
+        ScriptHookIterator(ScriptHook<TScript>& hook, uint32 mapId)
+            : _hook(hook), _index(0), _end(0), _current(NULL)
+        {
+            ScriptRegistry<TScript>::SyncHook(hook);
+            for (_index = 0; _index < hook.Count; ++_index)
+            {
+                MapEntry const* entry = hook.Scripts[_index]->GetEntry();
+                if (entry && entry->MapID == mapId)
+                {
+                    _end = _index + 1;
+                    break;
+                }
+            }
+        }
+
+        // Also runs when the caller leaves the loop early
+        ~ScriptHookIterator()
+        {
+            CheckCurrent();
+        }
+
+        bool Next()
+        {
+            if (_current)
+            {
+                CheckCurrent();
+                ++_index;
+            }
+
+            for (; _index < _end; ++_index)
+            {
+                _current = _hook.Subscribers[_index].load(std::memory_order_relaxed);
+                if (_current)
+                {
+                    HookNotImplementedFlag = false;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        TScript* Script() const { return _current; }
+
+    private:
+
+        void CheckCurrent()
+        {
+            if (!HookNotImplementedFlag)
+                return;
+
+            // Cleared again, so a hook triggered from within an implementation does not blame the outer script
+            HookNotImplementedFlag = false;
+            if (_current)
+                ScriptRegistry<TScript>::Unsubscribe(_hook, _index);
+        }
+
+        ScriptHook<TScript>& _hook;
+        uint32 _index;
+        uint32 _end;
+        TScript* _current;
 };
 
 // Utility macros to refer to the script registry.
@@ -155,8 +330,10 @@ class ScriptRegistry
     for (SCR_REG_ITR(T) C = SCR_REG_LST(T).begin(); \
         C != SCR_REG_LST(T).end(); ++C)
 #define FOREACH_SCRIPT(T) \
-    FOR_SCRIPTS(T, itr, end) \
-    itr->second
+    static ScriptHook<T> hook; \
+    if (!hook.Idle.load(std::memory_order_acquire)) \
+        for (ScriptHookIterator<T> itr(hook); itr.Next();) \
+            itr.Script()
 
 // Utility macros for finding specific scripts.
 #define GET_SCRIPT(T, I, V) \
@@ -198,7 +375,8 @@ void ScriptMgr::Unload()
     #define SCR_CLEAR(T) \
         for (SCR_REG_ITR(T) itr = SCR_REG_LST(T).begin(); itr != SCR_REG_LST(T).end(); ++itr) \
             delete itr->second; \
-        SCR_REG_LST(T).clear();
+        SCR_REG_LST(T).clear(); \
+        ScriptRegistry<T>::InvalidateHooks();
 
     // Clear scripts for every script type.
     SCR_CLEAR(SpellScriptLoader);
@@ -502,17 +680,13 @@ void ScriptMgr::OnGroupRateCalculation(float& rate, uint32 count, bool isRaid)
 #define SCR_MAP_BGN(M, V, I, E, C, T) \
     if (V->GetEntry() && V->GetEntry()->T()) \
     { \
-        FOR_SCRIPTS(M, I, E) \
-        { \
-            MapEntry const* C = I->second->GetEntry(); \
-            if (!C) \
-                continue; \
-            if (C->MapID == V->GetId()) \
-            {
+        static ScriptHook<M> mapHook; \
+        if (!mapHook.Idle.load(std::memory_order_acquire)) \
+        for (ScriptHookIterator<M> I(mapHook, V->GetId()); I.Next();) \
+        {
 
 #define SCR_MAP_END \
-                return; \
-            } \
+            return; \
         } \
     }
 
@@ -521,15 +695,15 @@ void ScriptMgr::OnCreateMap(Map* map)
     ASSERT(map);
 
     SCR_MAP_BGN(WorldMapScript, map, itr, end, entry, IsWorldMap);
-        itr->second->OnCreate(map);
+        itr.Script()->OnCreate(map);
     SCR_MAP_END;
 
     SCR_MAP_BGN(InstanceMapScript, map, itr, end, entry, IsDungeon);
-        itr->second->OnCreate((InstanceMap*)map);
+        itr.Script()->OnCreate((InstanceMap*)map);
     SCR_MAP_END;
 
     SCR_MAP_BGN(BattlegroundMapScript, map, itr, end, entry, IsBattleground);
-        itr->second->OnCreate((BattlegroundMap*)map);
+        itr.Script()->OnCreate((BattlegroundMap*)map);
     SCR_MAP_END;
 }
 
@@ -538,15 +712,15 @@ void ScriptMgr::OnDestroyMap(Map* map)
     ASSERT(map);
 
     SCR_MAP_BGN(WorldMapScript, map, itr, end, entry, IsWorldMap);
-        itr->second->OnDestroy(map);
+        itr.Script()->OnDestroy(map);
     SCR_MAP_END;
 
     SCR_MAP_BGN(InstanceMapScript, map, itr, end, entry, IsDungeon);
-        itr->second->OnDestroy((InstanceMap*)map);
+        itr.Script()->OnDestroy((InstanceMap*)map);
     SCR_MAP_END;
 
     SCR_MAP_BGN(BattlegroundMapScript, map, itr, end, entry, IsBattleground);
-        itr->second->OnDestroy((BattlegroundMap*)map);
+        itr.Script()->OnDestroy((BattlegroundMap*)map);
     SCR_MAP_END;
 }
 
@@ -556,15 +730,15 @@ void ScriptMgr::OnLoadGridMap(Map* map, GridMap* gmap, uint32 gx, uint32 gy)
     ASSERT(gmap);
 
     SCR_MAP_BGN(WorldMapScript, map, itr, end, entry, IsWorldMap);
-        itr->second->OnLoadGridMap(map, gmap, gx, gy);
+        itr.Script()->OnLoadGridMap(map, gmap, gx, gy);
     SCR_MAP_END;
 
     SCR_MAP_BGN(InstanceMapScript, map, itr, end, entry, IsDungeon);
-        itr->second->OnLoadGridMap((InstanceMap*)map, gmap, gx, gy);
+        itr.Script()->OnLoadGridMap((InstanceMap*)map, gmap, gx, gy);
     SCR_MAP_END;
 
     SCR_MAP_BGN(BattlegroundMapScript, map, itr, end, entry, IsBattleground);
-        itr->second->OnLoadGridMap((BattlegroundMap*)map, gmap, gx, gy);
+        itr.Script()->OnLoadGridMap((BattlegroundMap*)map, gmap, gx, gy);
     SCR_MAP_END;
 }
 
@@ -574,15 +748,15 @@ void ScriptMgr::OnUnloadGridMap(Map* map, GridMap* gmap, uint32 gx, uint32 gy)
     ASSERT(gmap);
 
     SCR_MAP_BGN(WorldMapScript, map, itr, end, entry, IsWorldMap);
-        itr->second->OnUnloadGridMap(map, gmap, gx, gy);
+        itr.Script()->OnUnloadGridMap(map, gmap, gx, gy);
     SCR_MAP_END;
 
     SCR_MAP_BGN(InstanceMapScript, map, itr, end, entry, IsDungeon);
-        itr->second->OnUnloadGridMap((InstanceMap*)map, gmap, gx, gy);
+        itr.Script()->OnUnloadGridMap((InstanceMap*)map, gmap, gx, gy);
     SCR_MAP_END;
 
     SCR_MAP_BGN(BattlegroundMapScript, map, itr, end, entry, IsBattleground);
-        itr->second->OnUnloadGridMap((BattlegroundMap*)map, gmap, gx, gy);
+        itr.Script()->OnUnloadGridMap((BattlegroundMap*)map, gmap, gx, gy);
     SCR_MAP_END;
 }
 
@@ -594,15 +768,15 @@ void ScriptMgr::OnPlayerEnterMap(Map* map, Player* player)
     FOREACH_SCRIPT(PlayerScript)->OnMapChanged(player);
 
     SCR_MAP_BGN(WorldMapScript, map, itr, end, entry, IsWorldMap);
-        itr->second->OnPlayerEnter(map, player);
+        itr.Script()->OnPlayerEnter(map, player);
     SCR_MAP_END;
 
     SCR_MAP_BGN(InstanceMapScript, map, itr, end, entry, IsDungeon);
-        itr->second->OnPlayerEnter((InstanceMap*)map, player);
+        itr.Script()->OnPlayerEnter((InstanceMap*)map, player);
     SCR_MAP_END;
 
     SCR_MAP_BGN(BattlegroundMapScript, map, itr, end, entry, IsBattleground);
-        itr->second->OnPlayerEnter((BattlegroundMap*)map, player);
+        itr.Script()->OnPlayerEnter((BattlegroundMap*)map, player);
     SCR_MAP_END;
 }
 
@@ -612,15 +786,15 @@ void ScriptMgr::OnPlayerLeaveMap(Map* map, Player* player)
     ASSERT(player);
 
     SCR_MAP_BGN(WorldMapScript, map, itr, end, entry, IsWorldMap);
-        itr->second->OnPlayerLeave(map, player);
+        itr.Script()->OnPlayerLeave(map, player);
     SCR_MAP_END;
 
     SCR_MAP_BGN(InstanceMapScript, map, itr, end, entry, IsDungeon);
-        itr->second->OnPlayerLeave((InstanceMap*)map, player);
+        itr.Script()->OnPlayerLeave((InstanceMap*)map, player);
     SCR_MAP_END;
 
     SCR_MAP_BGN(BattlegroundMapScript, map, itr, end, entry, IsBattleground);
-        itr->second->OnPlayerLeave((BattlegroundMap*)map, player);
+        itr.Script()->OnPlayerLeave((BattlegroundMap*)map, player);
     SCR_MAP_END;
 }
 
@@ -629,15 +803,15 @@ void ScriptMgr::OnMapUpdate(Map* map, uint32 diff)
     ASSERT(map);
 
     SCR_MAP_BGN(WorldMapScript, map, itr, end, entry, IsWorldMap);
-        itr->second->OnUpdate(map, diff);
+        itr.Script()->OnUpdate(map, diff);
     SCR_MAP_END;
 
     SCR_MAP_BGN(InstanceMapScript, map, itr, end, entry, IsDungeon);
-        itr->second->OnUpdate((InstanceMap*)map, diff);
+        itr.Script()->OnUpdate((InstanceMap*)map, diff);
     SCR_MAP_END;
 
     SCR_MAP_BGN(BattlegroundMapScript, map, itr, end, entry, IsBattleground);
-        itr->second->OnUpdate((BattlegroundMap*)map, diff);
+        itr.Script()->OnUpdate((BattlegroundMap*)map, diff);
     SCR_MAP_END;
 }
 
@@ -1546,6 +1720,8 @@ GroupScript::GroupScript(const char* name)
 // Instantiate static members of ScriptRegistry.
 template<class TScript> std::map<uint32, TScript*> ScriptRegistry<TScript>::ScriptPointerList;
 template<class TScript> uint32 ScriptRegistry<TScript>::_scriptIdCounter = 0;
+template<class TScript> uint32 ScriptRegistry<TScript>::_version = 1;
+template<class TScript> std::vector<ScriptHook<TScript>*> ScriptRegistry<TScript>::_hooks;
 
 // Specialize for each script type class like so:
 template class ScriptRegistry<SpellScriptLoader>;
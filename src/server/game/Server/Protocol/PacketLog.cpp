@@ -19,8 +19,194 @@
 #include "Config.h"
 #include "ByteBuffer.h"
 #include "WorldPacket.h"
+#include "Log.h"
+#include "Object.h"
+#include "Timer.h"
+#include "Util.h"
 
-PacketLog::PacketLog() : _file(NULL)
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_fcntl.h>
+#include <ace/OS_NS_unistd.h>
+
+enum PacketCaptureConstants
+{
+    PKT_VERSION_3_1         = 0x0301,
+    PKT_SNIFFER_ID          = 'T',
+    PKT_CLIENT_BUILD        = 18414,
+    PKT_SESSION_KEY_SIZE    = 40,
+    PKT_DIRECTION_CMSG      = 0x47534D43,   // "CMSG"
+    PKT_DIRECTION_SMSG      = 0x47534D53,   // "SMSG"
+    PKT_OPTIONAL_DATA_SIZE  = 8,            // account id and map id
+    PKT_PACKET_HEADER_SIZE  = 8             // uint32 fields in front of every packet's data
+};
+
+//! Buffers for the crash flush are set up at startup, a signal handler must not allocate
+static PacketLog* CrashPacketLog = NULL;
+
+static void AppendFileHeader(ByteBuffer& data)
+{
+    data.append("PKT", 3);
+    data << uint16(PKT_VERSION_3_1);
+    data << uint8(PKT_SNIFFER_ID);
+    data << uint32(PKT_CLIENT_BUILD);
+    data.append("enUS", 4);
+    for (uint8 i = 0; i < PKT_SESSION_KEY_SIZE; ++i)
+        data << uint8(0);
+    data << uint32(time(NULL));
+    data << uint32(getMSTime());
+    data << uint32(0);                              // optional header size
+}
+
+//! Only uses write, safe in signal handlers
+static bool WriteToFile(ACE_HANDLE file, void const* data, size_t size)
+{
+    while (size)
+    {
+        ssize_t written = ACE_OS::write(file, data, size);
+        if (written <= 0)
+            return false;
+
+        data = (uint8 const*)data + written;
+        size -= written;
+    }
+
+    return true;
+}
+
+PacketCaptureRing::PacketCaptureRing(uint32 connectionId, uint32 capacity) : _buffer(capacity), _start(0), _used(0),
+    _connectionId(connectionId), _accountId(0), _mapId(MAPID_INVALID) { }
+
+void PacketCaptureRing::Read(uint32 offset, void* dest, uint32 size) const
+{
+    uint32 first = std::min<uint32>(size, _buffer.size() - offset);
+    memcpy(dest, &_buffer[offset], first);
+    if (first < size)
+        memcpy((uint8*)dest + first, &_buffer[0], size - first);
+}
+
+void PacketCaptureRing::Write(uint32 offset, void const* src, uint32 size)
+{
+    uint32 first = std::min<uint32>(size, _buffer.size() - offset);
+    memcpy(&_buffer[offset], src, first);
+    if (first < size)
+        memcpy(&_buffer[0], (uint8 const*)src + first, size - first);
+}
+
+void PacketCaptureRing::Append(uint32 opcode, Direction direction, uint8 const* data, uint32 size)
+{
+    uint32 capacity = _buffer.size();
+    uint32 recordSize = sizeof(RecordHeader) + size;
+    if (recordSize > capacity)
+        return;
+
+    RecordHeader header;
+    header.opcode = opcode;
+    header.size = size;
+    header.ticks = getMSTime();
+    header.mapId = _mapId;
+    header.direction = direction;
+
+    TRINITY_GUARD(ACE_Thread_Mutex, _lock);
+
+    // Overwrite the oldest records until the new one fits
+    while (capacity - _used < recordSize)
+    {
+        RecordHeader oldest;
+        Read(_start, &oldest, sizeof(RecordHeader));
+        uint32 oldestSize = sizeof(RecordHeader) + oldest.size;
+        _start = (_start + oldestSize) % capacity;
+        _used -= oldestSize;
+    }
+
+    uint32 offset = (_start + _used) % capacity;
+    Write(offset, &header, sizeof(RecordHeader));
+    if (size)
+        Write((offset + sizeof(RecordHeader)) % capacity, data, size);
+    _used += recordSize;
+}
+
+void PacketCaptureRing::BuildPacketHeader(RecordHeader const& header, uint32* packetHeader) const
+{
+    packetHeader[0] = header.direction == CLIENT_TO_SERVER ? PKT_DIRECTION_CMSG : PKT_DIRECTION_SMSG;
+    packetHeader[1] = _connectionId;
+    packetHeader[2] = header.ticks;
+    packetHeader[3] = PKT_OPTIONAL_DATA_SIZE;
+    packetHeader[4] = header.size + 4;
+    packetHeader[5] = _accountId;
+    packetHeader[6] = header.mapId;
+    packetHeader[7] = header.opcode;
+
+    for (uint8 i = 0; i < PKT_PACKET_HEADER_SIZE; ++i)
+        EndianConvert(packetHeader[i]);
+}
+
+uint32 PacketCaptureRing::WriteTo(ByteBuffer& out)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _lock);
+
+    uint32 capacity = _buffer.size();
+    uint32 offset = _start;
+    uint32 count = 0;
+
+    for (uint32 read = 0; read < _used; ++count)
+    {
+        RecordHeader header;
+        Read(offset, &header, sizeof(RecordHeader));
+
+        uint32 packetHeader[PKT_PACKET_HEADER_SIZE];
+        BuildPacketHeader(header, packetHeader);
+        out.append((uint8 const*)packetHeader, sizeof(packetHeader));
+
+        if (header.size)
+        {
+            size_t dataPos = out.size();
+            out.resize(dataPos + header.size);
+            Read((offset + sizeof(RecordHeader)) % capacity, out.contents() + dataPos, header.size);
+        }
+
+        uint32 recordSize = sizeof(RecordHeader) + header.size;
+        offset = (offset + recordSize) % capacity;
+        read += recordSize;
+    }
+
+    return count;
+}
+
+uint32 PacketCaptureRing::WriteToOnCrash(ACE_HANDLE file)
+{
+    if (_lock.tryacquire() == -1)
+        return 0;
+
+    uint32 capacity = _buffer.size();
+    uint32 offset = _start;
+    uint32 count = 0;
+
+    for (uint32 read = 0; read < _used; ++count)
+    {
+        RecordHeader header;
+        Read(offset, &header, sizeof(RecordHeader));
+
+        uint32 packetHeader[PKT_PACKET_HEADER_SIZE];
+        BuildPacketHeader(header, packetHeader);
+        if (!WriteToFile(file, packetHeader, sizeof(packetHeader)))
+            break;
+
+        // The data is written in place, in two parts if it wraps around the end of the buffer
+        uint32 dataOffset = (offset + sizeof(RecordHeader)) % capacity;
+        uint32 first = std::min<uint32>(header.size, capacity - dataOffset);
+        if (!WriteToFile(file, &_buffer[dataOffset], first) || !WriteToFile(file, &_buffer[0], header.size - first))
+            break;
+
+        uint32 recordSize = sizeof(RecordHeader) + header.size;
+        offset = (offset + recordSize) % capacity;
+        read += recordSize;
+    }
+
+    _lock.release();
+    return count;
+}
+
+PacketLog::PacketLog() : _file(NULL), _ringSize(0), _keepClosedRings(0), _allowReplay(false), _nextConnectionId(0)
 {
     Initialize();
 }
@@ -31,19 +217,38 @@ PacketLog::~PacketLog()
         fclose(_file);
 
     _file = NULL;
+
+    for (std::set<PacketCaptureRing*>::iterator itr = _rings.begin(); itr != _rings.end(); ++itr)
+        delete *itr;
+    for (std::deque<PacketCaptureRing*>::iterator itr = _closedRings.begin(); itr != _closedRings.end(); ++itr)
+        delete *itr;
 }
 
 void PacketLog::Initialize()
 {
-    std::string logsDir = sConfigMgr->GetStringDefault("LogsDir", "");
+    _logsDir = sConfigMgr->GetStringDefault("LogsDir", "");
 
-    if (!logsDir.empty())
-        if ((logsDir.at(logsDir.length()-1) != '/') && (logsDir.at(logsDir.length()-1) != '\\'))
-            logsDir.push_back('/');
+    if (!_logsDir.empty())
+        if ((_logsDir.at(_logsDir.length()-1) != '/') && (_logsDir.at(_logsDir.length()-1) != '\\'))
+            _logsDir.push_back('/');
 
     std::string logname = sConfigMgr->GetStringDefault("PacketLogFile", "");
     if (!logname.empty())
-        _file = fopen((logsDir + logname).c_str(), "wb");
+        _file = fopen((_logsDir + logname).c_str(), "wb");
+
+    _ringSize = sConfigMgr->GetIntDefault("PacketLog.Ring.Size", 0);
+    _keepClosedRings = sConfigMgr->GetIntDefault("PacketLog.Ring.KeepClosed", 16);
+    _allowReplay = sConfigMgr->GetBoolDefault("PacketLog.Replay.Enable", false);
+    LoadFilter("PacketLog.Filter.Accounts", _accountFilter);
+    LoadFilter("PacketLog.Filter.Opcodes", _opcodeFilter);
+    LoadFilter("PacketLog.Filter.Maps", _mapFilter);
+}
+
+void PacketLog::LoadFilter(char const* option, std::set<uint32>& filter)
+{
+    Tokenizer tokens(sConfigMgr->GetStringDefault(option, ""), ',');
+    for (Tokenizer::const_iterator itr = tokens.begin(); itr != tokens.end(); ++itr)
+        filter.insert(uint32(strtoul(*itr, NULL, 0)));
 }
 
 void PacketLog::LogPacket(WorldPacket const& packet, Direction direction)
@@ -62,3 +267,199 @@ void PacketLog::LogPacket(WorldPacket const& packet, Direction direction)
     fwrite(data.contents(), 1, data.size(), _file);
     fflush(_file);
 }
+
+PacketCaptureRing* PacketLog::CreateRing()
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _ringsLock);
+
+    PacketCaptureRing* ring = new PacketCaptureRing(++_nextConnectionId, _ringSize);
+    _rings.insert(ring);
+    return ring;
+}
+
+void PacketLog::ReleaseRing(PacketCaptureRing* ring)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _ringsLock);
+
+    _rings.erase(ring);
+    _closedRings.push_back(ring);
+
+    while (_closedRings.size() > _keepClosedRings)
+    {
+        delete _closedRings.front();
+        _closedRings.pop_front();
+    }
+}
+
+void PacketLog::CapturePacket(PacketCaptureRing& ring, WorldPacket const& packet, Direction direction)
+{
+    uint32 opcode = direction == CLIENT_TO_SERVER ? const_cast<WorldPacket&>(packet).GetReceivedOpcode() : serverOpcodeTable[packet.GetOpcode()]->OpcodeNumber;
+
+    if (!_opcodeFilter.empty() && !_opcodeFilter.count(opcode))
+        return;
+
+    if (!_accountFilter.empty() && !_accountFilter.count(ring.GetAccountId()))
+        return;
+
+    if (!_mapFilter.empty() && !_mapFilter.count(ring.GetMapId()))
+        return;
+
+    ring.Append(opcode, direction, packet.size() ? packet.contents() : NULL, packet.size());
+}
+
+uint32 PacketLog::FlushRings(uint32 accountId, std::string& fileName)
+{
+    fileName = "PacketCapture_" + Log::GetTimestampStr() + ".pkt";
+    return WriteRings(accountId, fileName);
+}
+
+void PacketLog::PrepareCrashFlush()
+{
+    _crashFileName = _logsDir + "PacketCapture_" + Log::GetTimestampStr() + "_crash.pkt";
+
+    ByteBuffer header;
+    AppendFileHeader(header);
+    _crashHeader.assign(header.contents(), header.contents() + header.size());
+
+    CrashPacketLog = this;
+}
+
+void PacketLog::FlushRingsOnCrash()
+{
+    PacketLog* packetLog = CrashPacketLog;
+    if (!packetLog)
+        return;
+
+    // Iterating the containers neither allocates nor blocks, they are skipped if the crash interrupted a change to them
+    if (packetLog->_ringsLock.tryacquire() == -1)
+        return;
+
+    ACE_HANDLE file = ACE_OS::open(packetLog->_crashFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file == ACE_INVALID_HANDLE)
+    {
+        packetLog->_ringsLock.release();
+        return;
+    }
+
+    uint32 count = 0;
+    if (WriteToFile(file, &packetLog->_crashHeader[0], packetLog->_crashHeader.size()))
+    {
+        for (std::deque<PacketCaptureRing*>::const_iterator itr = packetLog->_closedRings.begin(); itr != packetLog->_closedRings.end(); ++itr)
+            count += (*itr)->WriteToOnCrash(file);
+
+        for (std::set<PacketCaptureRing*>::const_iterator itr = packetLog->_rings.begin(); itr != packetLog->_rings.end(); ++itr)
+            count += (*itr)->WriteToOnCrash(file);
+    }
+
+    packetLog->_ringsLock.release();
+    ACE_OS::close(file);
+
+    if (!count)
+        ACE_OS::unlink(packetLog->_crashFileName.c_str());
+}
+
+uint32 PacketLog::WriteRings(uint32 accountId, std::string const& fileName)
+{
+    ByteBuffer data;
+    AppendFileHeader(data);
+
+    uint32 count = 0;
+    {
+        TRINITY_GUARD(ACE_Thread_Mutex, _ringsLock);
+
+        for (std::deque<PacketCaptureRing*>::const_iterator itr = _closedRings.begin(); itr != _closedRings.end(); ++itr)
+            if (!accountId || (*itr)->GetAccountId() == accountId)
+                count += (*itr)->WriteTo(data);
+
+        for (std::set<PacketCaptureRing*>::const_iterator itr = _rings.begin(); itr != _rings.end(); ++itr)
+            if (!accountId || (*itr)->GetAccountId() == accountId)
+                count += (*itr)->WriteTo(data);
+    }
+
+    if (!count)
+        return 0;
+
+    FILE* file = fopen((_logsDir + fileName).c_str(), "wb");
+    if (!file)
+        return 0;
+
+    fwrite(data.contents(), 1, data.size(), file);
+    fclose(file);
+    return count;
+}
+
+bool PacketLog::LoadCapture(std::string const& fileName, uint32 accountId, std::list<CapturedPacket>& packets) const
+{
+    // only plain file names inside the logs directory
+    if (fileName.empty() || fileName.find_first_of("/\\") != std::string::npos || fileName.find("..") != std::string::npos)
+    {
+        TC_LOG_ERROR("network", "PacketLog::LoadCapture: Rejected capture file name %s", fileName.c_str());
+        return false;
+    }
+
+    FILE* file = fopen((_logsDir + fileName).c_str(), "rb");
+    if (!file)
+        return false;
+
+    ByteBuffer data;
+    uint8 chunk[4096];
+    while (size_t read = fread(chunk, 1, sizeof(chunk), file))
+        data.append(chunk, read);
+    fclose(file);
+
+    try
+    {
+        char signature[3];
+        data.read((uint8*)signature, 3);
+        if (memcmp(signature, "PKT", 3) || data.read<uint16>() != PKT_VERSION_3_1)
+            return false;
+
+        data.read_skip(1 + 4 + 4 + PKT_SESSION_KEY_SIZE + 4 + 4);  // sniffer id, build, locale, session key, start time and ticks
+        data.read_skip(data.read<uint32>());                        // optional header
+
+        while (data.rpos() < data.size())
+        {
+            uint32 direction = data.read<uint32>();
+            uint32 connectionId = data.read<uint32>();
+            uint32 ticks = data.read<uint32>();
+            uint32 optionalDataSize = data.read<uint32>();
+            uint32 length = data.read<uint32>();
+            uint32 packetAccountId = 0;
+            uint32 mapId = MAPID_INVALID;
+            if (optionalDataSize >= PKT_OPTIONAL_DATA_SIZE)
+            {
+                packetAccountId = data.read<uint32>();
+                mapId = data.read<uint32>();
+                optionalDataSize -= PKT_OPTIONAL_DATA_SIZE;
+            }
+            data.read_skip(optionalDataSize);
+
+            if (length < 4)
+                return false;
+
+            uint32 opcode = data.read<uint32>();
+            if (direction != PKT_DIRECTION_CMSG || (accountId && packetAccountId != accountId))
+            {
+                data.read_skip(length - 4);
+                continue;
+            }
+
+            CapturedPacket packet;
+            packet.connectionId = connectionId;
+            packet.accountId = packetAccountId;
+            packet.mapId = mapId;
+            packet.ticks = ticks;
+            packet.opcode = opcode;
+            packet.data.resize(length - 4);
+            if (length > 4)
+                data.read(&packet.data[0], length - 4);
+            packets.push_back(packet);
+        }
+    }
+    catch (ByteBufferException const&)
+    {
+        // A file written while crashing may end in the middle of a packet, keep the complete ones
+    }
+
+    return true;
+}
@@ -20,6 +20,10 @@
 
 #include "Common.h"
 #include <ace/Singleton.h>
+#include <ace/Thread_Mutex.h>
+#include <deque>
+#include <list>
+#include <set>
 
 enum Direction
 {
@@ -27,8 +31,65 @@ enum Direction
     SERVER_TO_CLIENT
 };
 
+class ByteBuffer;
 class WorldPacket;
 
+//! Most recent packets of one connection, kept in memory while packet capture runs in ring mode.
+//! The oldest packets are overwritten once the ring is full, nothing is written to disk until the
+//! rings are flushed by PacketLog::FlushRings.
+class PacketCaptureRing
+{
+    public:
+        PacketCaptureRing(uint32 connectionId, uint32 capacity);
+
+        uint32 GetConnectionId() const { return _connectionId; }
+        uint32 GetAccountId() const { return _accountId; }
+        void SetAccountId(uint32 accountId) { _accountId = accountId; }
+        uint32 GetMapId() const { return _mapId; }
+        void SetMapId(uint32 mapId) { _mapId = mapId; }
+
+        void Append(uint32 opcode, Direction direction, uint8 const* data, uint32 size);
+        //! Appends every stored packet in PKT 3.1 packet format, returns the number of packets written.
+        uint32 WriteTo(ByteBuffer& out);
+        //! Same as WriteTo but straight to file without allocating or waiting, for the crash handler.
+        //! A ring that is locked is skipped.
+        uint32 WriteToOnCrash(ACE_HANDLE file);
+
+    private:
+        struct RecordHeader
+        {
+            uint32 opcode;
+            uint32 size;
+            uint32 ticks;
+            uint32 mapId;
+            uint32 direction;
+        };
+
+        void Read(uint32 offset, void* dest, uint32 size) const;
+        //! Fills the PKT 3.1 header of a stored packet, in file byte order
+        void BuildPacketHeader(RecordHeader const& header, uint32* packetHeader) const;
+        void Write(uint32 offset, void const* src, uint32 size);
+
+        ACE_Thread_Mutex _lock;
+        std::vector<uint8> _buffer;
+        uint32 _start;                  //! Offset of the oldest record
+        uint32 _used;                   //! Bytes used by records
+        uint32 _connectionId;
+        uint32 _accountId;              //! Set once the connection authenticated
+        uint32 _mapId;                  //! Map of the player, updated by the session
+};
+
+//! Client packet read back from a capture file
+struct CapturedPacket
+{
+    uint32 connectionId;
+    uint32 accountId;
+    uint32 mapId;
+    uint32 ticks;
+    uint32 opcode;
+    std::vector<uint8> data;
+};
+
 class PacketLog
 {
     friend class ACE_Singleton<PacketLog, ACE_Thread_Mutex>;
@@ -42,8 +103,48 @@ class PacketLog
         bool CanLogPacket() const { return (_file != NULL); }
         void LogPacket(WorldPacket const& packet, Direction direction);
 
+        //! Ring mode, every connection records its packets into its own PacketCaptureRing
+        bool IsCapturing() const { return _ringSize != 0; }
+        PacketCaptureRing* CreateRing();
+        //! Called when the connection closed, the ring is kept for later flushes while it is among the most recently closed ones
+        void ReleaseRing(PacketCaptureRing* ring);
+        void CapturePacket(PacketCaptureRing& ring, WorldPacket const& packet, Direction direction);
+
+        //! Writes the rings of an account, or of every connection for 0, to a new file in the logs directory.
+        //! Returns the number of packets written and the file name.
+        uint32 FlushRings(uint32 accountId, std::string& fileName);
+        //! Prepares the file name and header FlushRingsOnCrash writes, called once at startup
+        void PrepareCrashFlush();
+        //! Best effort flush of all rings from the crash handler, also from signal handlers: only open and write,
+        //! no allocation and no waiting. Rings locked at that moment, e.g. by the crashed thread, are skipped.
+        static void FlushRingsOnCrash();
+
+        bool IsReplayAllowed() const { return _allowReplay; }
+        //! Reads the client packets of a ring flush file in the logs directory, optionally only those of one account.
+        //! Names with a path separator or ".." are rejected.
+        bool LoadCapture(std::string const& fileName, uint32 accountId, std::list<CapturedPacket>& packets) const;
+
     private:
+        uint32 WriteRings(uint32 accountId, std::string const& fileName);
+        void LoadFilter(char const* option, std::set<uint32>& filter);
+
         FILE* _file;
+        std::string _logsDir;
+
+        uint32 _ringSize;
+        uint32 _keepClosedRings;
+        bool _allowReplay;
+        std::set<uint32> _accountFilter;
+        std::set<uint32> _opcodeFilter;
+        std::set<uint32> _mapFilter;
+
+        ACE_Thread_Mutex _ringsLock;
+        std::set<PacketCaptureRing*> _rings;
+        std::deque<PacketCaptureRing*> _closedRings;
+        uint32 _nextConnectionId;
+
+        std::string _crashFileName;     //! Full path, built at startup
+        std::vector<uint8> _crashHeader;
 };
 
 #define sPacketLog ACE_Singleton<PacketLog, ACE_Thread_Mutex>::instance()
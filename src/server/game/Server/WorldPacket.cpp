@@ -19,6 +19,8 @@
 #include "WorldPacket.h"
 #include "World.h"
 
+DEFINE_SLAB_ALLOCATOR(WorldPacket)
+
 //! Compresses packet in place
 void WorldPacket::Compress(z_stream* compressionStream)
 {
@@ -21,12 +21,15 @@
 #include "Common.h"
 #include "Opcodes.h"
 #include "ByteBuffer.h"
+#include "SlabAllocator.h"
 
 struct z_stream_s;
 
 class WorldPacket : public ByteBuffer
 {
     public:
+        DECLARE_SLAB_ALLOCATOR();
+
                                                             // just container for later use
         WorldPacket() : ByteBuffer(0), m_opcode(UNKNOWN_OPCODE), m_rcvdOpcodeNumber(0)
         {
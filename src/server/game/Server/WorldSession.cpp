@@ -27,6 +27,7 @@
 #include "AccountMgr.h"
 #include "Log.h"
 #include "Opcodes.h"
+#include "PacketLog.h"
 #include "WorldPacket.h"
 #include "WorldSession.h"
 #include "Player.h"
@@ -111,6 +112,7 @@ WorldSession::WorldSession(uint32 id, WorldSocket* sock, AccountTypes sec, uint8
     _logoutTime(0),
     m_inQueue(false),
     m_playerLoading(false),
+    _charLoginQueryTime(0),
     m_playerLogout(false),
     m_playerRecentlyLogout(false),
     m_playerSave(false),
@@ -301,6 +303,10 @@ bool WorldSession::Update(uint32 diff, PacketFilter& updater)
     UpdateTimeOutTime(diff);
     m_charBooster->Update(diff);
 
+    // Captured packets are filtered by map from the network threads, which must not touch the player
+    if (m_Socket && _player && sPacketLog->IsCapturing())
+        m_Socket->SetCaptureMapId(_player->GetMapId());
+
     ///- Before we process anything:
     /// If necessary, kick the player from the character select screen
     if (IsConnectionIdle())
@@ -813,11 +819,16 @@ void WorldSession::SendAccountDataTimes(uint32 mask)
 
 void WorldSession::LoadTutorialsData()
 {
-    memset(m_Tutorials, 0, sizeof(uint32) * MAX_ACCOUNT_TUTORIAL_VALUES);
-
     PreparedStatement* stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_TUTORIALS);
     stmt->setUInt32(0, GetAccountId());
-    if (PreparedQueryResult result = CharacterDatabase.Query(stmt))
+    LoadTutorialsData(CharacterDatabase.Query(stmt));
+}
+
+void WorldSession::LoadTutorialsData(PreparedQueryResult result)
+{
+    memset(m_Tutorials, 0, sizeof(uint32) * MAX_ACCOUNT_TUTORIAL_VALUES);
+
+    if (result)
         for (uint8 i = 0; i < MAX_ACCOUNT_TUTORIAL_VALUES; ++i)
             m_Tutorials[i] = (*result)[i].GetUInt32();
 
@@ -1121,6 +1132,7 @@ void WorldSession::ProcessQueryCallbacks()
         SQLQueryHolder* param;
         _charLoginCallback.get(param);
         _accountSpellCallback.get(result);
+        TC_LOG_DEBUG("sql.sql", "Login query holder for account %u completed in %u ms", GetAccountId(), getMSTimeDiff(_charLoginQueryTime, getMSTime()));
         HandlePlayerLogin((LoginQueryHolder*)param, result);
         _charLoginCallback.cancel();
         _accountSpellCallback.cancel();
@@ -1421,6 +1433,18 @@ void WorldSession::LoadPermissions()
                    id, name.c_str(), realmID, secLevel);
 }
 
+void WorldSession::LoadPermissions(std::string const& accountName, PreparedQueryResult result)
+{
+    uint32 id = GetAccountId();
+    uint8 secLevel = GetSecurity();
+
+    _RBACData = new rbac::RBACData(id, accountName, realmID, secLevel);
+    _RBACData->LoadFromDB(result);
+
+    TC_LOG_DEBUG("rbac", "WorldSession::LoadPermissions [AccountId: %u, Name: %s, realmId: %d, secLevel: %u]",
+                   id, accountName.c_str(), realmID, secLevel);
+}
+
 rbac::RBACData* WorldSession::GetRBACData()
 {
     return _RBACData;
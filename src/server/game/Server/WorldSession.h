@@ -334,6 +334,7 @@ class WorldSession
         rbac::RBACData* GetRBACData();
         bool HasPermission(uint32 permissionId);
         void LoadPermissions();
+        void LoadPermissions(std::string const& accountName, PreparedQueryResult result);
         void InvalidateRBACData(); // Used to force LoadPermissions at next HasPermission check
         AccountTypes GetSecurity() const { return _security; }
         uint32 GetAccountId() const { return _accountId; }
@@ -427,6 +428,7 @@ class WorldSession
         void LoadAccountData(PreparedQueryResult result, uint32 mask);
 
         void LoadTutorialsData();
+        void LoadTutorialsData(PreparedQueryResult result);
         void SendTutorialsData();
         void SaveTutorialsData(SQLTransaction& trans);
         uint32 GetTutorialInt(uint8 index) const { return m_Tutorials[index]; }
@@ -1222,6 +1224,7 @@ class WorldSession
         time_t _logoutTime;
         bool m_inQueue;                                     // session wait in auth.queue
         bool m_playerLoading;                               // code processed in LoginPlayer
+        uint32 _charLoginQueryTime;                         // getMSTime() when the login query holder was queued
         bool m_playerLogout;                                // code processed in LogoutPlayer
         bool m_playerRecentlyLogout;
         bool m_playerSave;
@@ -25,6 +25,7 @@
 #include <ace/OS_NS_string.h>
 #include <ace/Reactor.h>
 #include <ace/Auto_Ptr.h>
+#include <ace/Atomic_Op.h>
 
 #include "WorldSocket.h"
 #include "Common.h"
@@ -45,6 +46,10 @@
 #include "ScriptMgr.h"
 #include "AccountMgr.h"
 
+/// Packet counters of all sockets, for the world tick statistics
+static ACE_Atomic_Op<ACE_Thread_Mutex, long> ReceivedPacketCount(0);
+static ACE_Atomic_Op<ACE_Thread_Mutex, long> SentPacketCount(0);
+
 #if defined(__GNUC__)
 #pragma pack(1)
 #else
@@ -96,11 +101,78 @@ struct WorldClientPktHeader
 #pragma pack(pop)
 #endif
 
+/// Lookups of a pending CMSG_AUTH_SESSION, all issued as asynchronous queries
+enum AuthSessionQuery
+{
+    AUTH_SESSION_QUERY_ACCOUNT_INFO,
+    AUTH_SESSION_QUERY_GMLEVEL,
+    AUTH_SESSION_QUERY_BANS,
+    AUTH_SESSION_QUERY_RECRUITER,
+    AUTH_SESSION_QUERY_PERMISSIONS,
+    AUTH_SESSION_QUERY_ACCOUNT_DATA,
+    AUTH_SESSION_QUERY_TUTORIALS,
+    MAX_AUTH_SESSION_QUERY
+};
+
+/// Steps of a pending CMSG_AUTH_SESSION, each waits for the queries issued by the previous one
+enum AuthSessionStage
+{
+    AUTH_SESSION_STAGE_ACCOUNT,         // Waiting for the account row
+    AUTH_SESSION_STAGE_CHECKS,          // Waiting for gmlevel, bans, recruiter and permissions
+    AUTH_SESSION_STAGE_SESSION_DATA     // Authenticated, waiting for account data, tutorials and SessionAddDelay
+};
+
+/// Everything known about a client between CMSG_AUTH_SESSION and the creation of its WorldSession
+struct AuthSessionInfo
+{
+    AuthSessionInfo() : stage(AUTH_SESSION_STAGE_ACCOUNT), clientSeed(0), id(0), security(0), expansion(0),
+        mutetime(0), locale(LOCALE_enUS), recruiter(0), hasBoost(false) { }
+
+    AuthSessionStage stage;
+    PreparedQueryResultFuture queries[MAX_AUTH_SESSION_QUERY];
+    PreparedQueryResult results[MAX_AUTH_SESSION_QUERY];
+    ACE_Time_Value addTime;             // Earliest time the session may be added to the world
+
+    // Sent by the client
+    uint8 digest[20];
+    uint32 clientSeed;
+    std::string account;
+    WorldPacket addonsData;
+
+    // Read from the account row
+    uint32 id;
+    uint8 security;
+    uint8 expansion;
+    int64 mutetime;
+    LocaleConstant locale;
+    uint32 recruiter;
+    bool hasBoost;
+    std::string os;
+    BigNumber k;
+
+    /// Returns true once all given queries have completed, their results are moved to results[]
+    bool QueriesReady(AuthSessionQuery first, AuthSessionQuery last)
+    {
+        for (uint8 i = first; i <= last; ++i)
+            if (!queries[i].ready())
+                return false;
+
+        for (uint8 i = first; i <= last; ++i)
+        {
+            queries[i].get(results[i]);
+            queries[i].cancel();
+        }
+
+        return true;
+    }
+};
+
 WorldSocket::WorldSocket (void): WorldHandler(),
 m_LastPingTime(ACE_Time_Value::zero), m_OverSpeedPings(0), m_Session(0),
 m_RecvWPct(0), m_RecvPct(), m_Header(sizeof(AuthClientPktHeader)),
 m_WorldHeader(sizeof(WorldClientPktHeader)), m_OutBuffer(0),
-m_OutBufferSize(65536), m_OutActive(false),
+m_OutBufferSize(65536), m_OutActive(false), m_AuthSession(NULL),
+m_CaptureRing(sPacketLog->IsCapturing() ? sPacketLog->CreateRing() : NULL),
 
 m_Seed(static_cast<uint32> (rand32()))
 {
@@ -113,6 +185,10 @@ m_Seed(static_cast<uint32> (rand32()))
 WorldSocket::~WorldSocket (void)
 {
     delete m_RecvWPct;
+    delete m_AuthSession;
+
+    if (m_CaptureRing)
+        sPacketLog->ReleaseRing(m_CaptureRing);
 
     if (m_OutBuffer)
         m_OutBuffer->release();
@@ -151,6 +227,22 @@ const std::string& WorldSocket::GetRemoteAddress (void) const
     return m_Address;
 }
 
+long WorldSocket::GetReceivedPacketCount()
+{
+    return ReceivedPacketCount.value();
+}
+
+long WorldSocket::GetSentPacketCount()
+{
+    return SentPacketCount.value();
+}
+
+void WorldSocket::SetCaptureMapId(uint32 mapId)
+{
+    if (m_CaptureRing)
+        m_CaptureRing->SetMapId(mapId);
+}
+
 int WorldSocket::SendPacket(WorldPacket const& pct)
 {
     ACE_GUARD_RETURN (LockType, Guard, m_OutBufferLock, -1);
@@ -158,10 +250,15 @@ int WorldSocket::SendPacket(WorldPacket const& pct)
     if (closing_)
         return -1;
 
+    ++SentPacketCount;
+
     // Dump outgoing packet
     if (sPacketLog->CanLogPacket())
         sPacketLog->LogPacket(pct, SERVER_TO_CLIENT);
 
+    if (m_CaptureRing)
+        sPacketLog->CapturePacket(*m_CaptureRing, pct, SERVER_TO_CLIENT);
+
     WorldPacket const* pkt = &pct;
 
     // Empty buffer used in case packet should be compressed
@@ -458,6 +555,9 @@ int WorldSocket::Update (void)
     if (closing_)
         return -1;
 
+    if (m_AuthSession && ProcessAuthSession() == -1)
+        return -1;
+
     if (m_OutActive)
         return 0;
 
@@ -765,10 +865,15 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
     if (closing_)
         return -1;
 
+    ++ReceivedPacketCount;
+
     // Dump received packet.
     if (sPacketLog->CanLogPacket())
         sPacketLog->LogPacket(*new_pct, CLIENT_TO_SERVER);
 
+    if (m_CaptureRing)
+        sPacketLog->CapturePacket(*m_CaptureRing, *new_pct, CLIENT_TO_SERVER);
+
     std::string opcodeName = GetOpcodeNameForLogging(opcode, false);
     if (m_Session)
 		TC_LOG_TRACE("network.opcode", "C->S: %s %s", m_Session->GetPlayerInfo().c_str(), opcodeName.c_str());
@@ -780,9 +885,10 @@ int WorldSocket::ProcessIncoming(WorldPacket* new_pct)
             case CMSG_PING:
                 return HandlePing(*new_pct);
             case CMSG_AUTH_SESSION:
-                if (m_Session)
+                if (m_Session || m_AuthSession)
                 {
-                    TC_LOG_ERROR("network", "WorldSocket::ProcessIncoming: received duplicate CMSG_AUTH_SESSION from %s", m_Session->GetPlayerInfo().c_str());
+                    TC_LOG_ERROR("network", "WorldSocket::ProcessIncoming: received duplicate CMSG_AUTH_SESSION from %s",
+                        m_Session ? m_Session->GetPlayerInfo().c_str() : GetRemoteAddress().c_str());
                     return -1;
                 }
 
@@ -873,17 +979,11 @@ int WorldSocket::HandleSendAuthSession()
 
 int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
 {
-    uint8 digest[20];
-    uint32 clientSeed;
-    uint8 security;
+    // Owned by the socket right away, parsing may throw
+    AuthSessionInfo* info = m_AuthSession = new AuthSessionInfo();
+    uint8* digest = info->digest;
     uint16 clientBuild;
-    uint32 id;
     uint32 addonSize;
-    LocaleConstant locale;
-    std::string account;
-    SHA1Hash sha;
-    BigNumber k;
-    WorldPacket addonsData;
 
     recvPacket.read_skip<uint32>();
     recvPacket.read_skip<uint32>();
@@ -894,7 +994,7 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
     recvPacket >> digest[0];
     recvPacket.read_skip<uint32>();
     recvPacket >> digest[11];
-    recvPacket >> clientSeed;
+    recvPacket >> info->clientSeed;
     recvPacket >> digest[19];
     recvPacket.read_skip<uint8>();
     recvPacket.read_skip<uint8>();
@@ -916,13 +1016,13 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
     recvPacket >> digest[10];
     recvPacket >> addonSize;
 
-    addonsData.resize(addonSize);
-    recvPacket.read((uint8*)addonsData.contents(), addonSize);
+    info->addonsData.resize(addonSize);
+    recvPacket.read((uint8*)info->addonsData.contents(), addonSize);
 
     recvPacket.ReadBit();
     uint32 accountNameLength = recvPacket.ReadBits(11);
 
-    account = recvPacket.ReadString(accountNameLength);
+    info->account = recvPacket.ReadString(accountNameLength);
 
     if (sWorld->IsClosed())
     {
@@ -931,14 +1031,53 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
         return -1;
     }
 
+    // The lookups are done by the async database workers, Update() picks up the results
+    // so the network thread never waits on MySQL.
     // Get the account information from the realmd database
     //         0           1        2       3          4         5       6          7      8   9
     // SELECT id, sessionkey, last_ip, locked, expansion, mutetime, locale, recruiter, boost, os FROM account WHERE username = ?
     PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_ACCOUNT_INFO_BY_NAME);
 
-    stmt->setString(0, account);
+    stmt->setString(0, info->account);
 
-    PreparedQueryResult result = LoginDatabase.Query(stmt);
+    info->queries[AUTH_SESSION_QUERY_ACCOUNT_INFO] = LoginDatabase.AsyncQuery(stmt, SQL_PRIORITY_INTERACTIVE);
+    info->stage = AUTH_SESSION_STAGE_ACCOUNT;
+    return 0;
+}
+
+int WorldSocket::ProcessAuthSession()
+{
+    switch (m_AuthSession->stage)
+    {
+        case AUTH_SESSION_STAGE_ACCOUNT:
+            if (!m_AuthSession->QueriesReady(AUTH_SESSION_QUERY_ACCOUNT_INFO, AUTH_SESSION_QUERY_ACCOUNT_INFO))
+                return 0;
+
+            return HandleAuthSessionAccount();
+        case AUTH_SESSION_STAGE_CHECKS:
+            if (!m_AuthSession->QueriesReady(AUTH_SESSION_QUERY_GMLEVEL, AUTH_SESSION_QUERY_PERMISSIONS))
+                return 0;
+
+            return HandleAuthSessionChecks();
+        case AUTH_SESSION_STAGE_SESSION_DATA:
+            if (ACE_OS::gettimeofday() < m_AuthSession->addTime)
+                return 0;
+
+            if (!m_AuthSession->QueriesReady(AUTH_SESSION_QUERY_ACCOUNT_DATA, AUTH_SESSION_QUERY_TUTORIALS))
+                return 0;
+
+            return HandleAuthSessionComplete();
+        default:
+            break;
+    }
+
+    return -1;
+}
+
+int WorldSocket::HandleAuthSessionAccount()
+{
+    AuthSessionInfo* info = m_AuthSession;
+    PreparedQueryResult result = info->results[AUTH_SESSION_QUERY_ACCOUNT_INFO];
 
     // Stop if the account is not found
     if (!result)
@@ -950,10 +1089,10 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
 
     Field* fields = result->Fetch();
 
-    uint8 expansion = fields[4].GetUInt8();
+    info->expansion = fields[4].GetUInt8();
     uint32 world_expansion = sWorld->getIntConfig(CONFIG_EXPANSION);
-    if (expansion > world_expansion)
-        expansion = world_expansion;
+    if (info->expansion > world_expansion)
+        info->expansion = world_expansion;
 
     ///- Re-check ip locking (same check as in realmd).
     if (fields[3].GetUInt8() == 1) // if ip is locked
@@ -966,65 +1105,87 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
         }
     }
 
-    id = fields[0].GetUInt32();
+    info->id = fields[0].GetUInt32();
 
-    k.SetHexStr(fields[1].GetCString());
+    info->k.SetHexStr(fields[1].GetCString());
 
-    int64 mutetime = fields[5].GetInt64();
+    info->mutetime = fields[5].GetInt64();
     //! Negative mutetime indicates amount of seconds to be muted effective on next login - which is now.
-    if (mutetime < 0)
+    if (info->mutetime < 0)
     {
-        mutetime = time(NULL) + llabs(mutetime);
+        info->mutetime = time(NULL) + llabs(info->mutetime);
 
         PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_UPD_MUTE_TIME_LOGIN);
 
-        stmt->setInt64(0, mutetime);
-        stmt->setUInt32(1, id);
+        stmt->setInt64(0, info->mutetime);
+        stmt->setUInt32(1, info->id);
 
         LoginDatabase.Execute(stmt);
     }
 
-    locale = LocaleConstant (fields[6].GetUInt8());
-    if (locale >= TOTAL_LOCALES)
-        locale = LOCALE_enUS;
+    info->locale = LocaleConstant (fields[6].GetUInt8());
+    if (info->locale >= TOTAL_LOCALES)
+        info->locale = LOCALE_enUS;
 
-    uint32 recruiter = fields[7].GetUInt32();
-    bool hasBoost = fields[8].GetBool();
-    std::string os = fields[9].GetString();
+    info->recruiter = fields[7].GetUInt32();
+    info->hasBoost = fields[8].GetBool();
+    info->os = fields[9].GetString();
 
     // Must be done before WorldSession is created
-    if (sWorld->getBoolConfig(CONFIG_WARDEN_ENABLED) && os != "Win" && os != "OSX")
+    if (sWorld->getBoolConfig(CONFIG_WARDEN_ENABLED) && info->os != "Win" && info->os != "OSX")
     {
         SendAuthResponseError(AUTH_REJECT);
-        TC_LOG_ERROR("network", "WorldSocket::HandleAuthSession: Client %s attempted to log in using invalid client OS (%s).", GetRemoteAddress().c_str(), os.c_str());
+        TC_LOG_ERROR("network", "WorldSocket::HandleAuthSession: Client %s attempted to log in using invalid client OS (%s).", GetRemoteAddress().c_str(), info->os.c_str());
         return -1;
     }
 
+    // The remaining lookups only depend on the account id, run them side by side
+
     // Checks gmlevel per Realm
-    stmt = LoginDatabase.GetPreparedStatement(LOGIN_GET_GMLEVEL_BY_REALMID);
+    PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_GET_GMLEVEL_BY_REALMID);
 
-    stmt->setUInt32(0, id);
+    stmt->setUInt32(0, info->id);
     stmt->setInt32(1, int32(realmID));
 
-    result = LoginDatabase.Query(stmt);
-
-    if (!result)
-        security = 0;
-    else
-    {
-        fields = result->Fetch();
-        security = fields[0].GetUInt8();
-    }
+    info->queries[AUTH_SESSION_QUERY_GMLEVEL] = LoginDatabase.AsyncQuery(stmt, SQL_PRIORITY_INTERACTIVE);
 
     // Re-check account ban (same check as in realmd)
     stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_BANS);
 
-    stmt->setUInt32(0, id);
+    stmt->setUInt32(0, info->id);
     stmt->setString(1, GetRemoteAddress());
 
-    PreparedQueryResult banresult = LoginDatabase.Query(stmt);
+    info->queries[AUTH_SESSION_QUERY_BANS] = LoginDatabase.AsyncQuery(stmt, SQL_PRIORITY_INTERACTIVE);
+
+    // Check if this user is by any chance a recruiter
+    stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_ACCOUNT_RECRUITER);
+
+    stmt->setUInt32(0, info->id);
+
+    info->queries[AUTH_SESSION_QUERY_RECRUITER] = LoginDatabase.AsyncQuery(stmt, SQL_PRIORITY_INTERACTIVE);
+
+    // Account permissions (granted and denied) that affect current realm
+    stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_RBAC_ACCOUNT_PERMISSIONS);
+
+    stmt->setUInt32(0, info->id);
+    stmt->setInt32(1, int32(realmID));
+
+    info->queries[AUTH_SESSION_QUERY_PERMISSIONS] = LoginDatabase.AsyncQuery(stmt, SQL_PRIORITY_INTERACTIVE);
 
-    if (banresult) // if account banned
+    info->stage = AUTH_SESSION_STAGE_CHECKS;
+    return 0;
+}
+
+int WorldSocket::HandleAuthSessionChecks()
+{
+    AuthSessionInfo* info = m_AuthSession;
+
+    if (PreparedQueryResult result = info->results[AUTH_SESSION_QUERY_GMLEVEL])
+        info->security = result->Fetch()[0].GetUInt8();
+    else
+        info->security = 0;
+
+    if (info->results[AUTH_SESSION_QUERY_BANS]) // if account banned
     {
         SendAuthResponseError(AUTH_BANNED);
         TC_LOG_ERROR("network", "WorldSocket::HandleAuthSession: Sent Auth Response (Account banned).");
@@ -1033,8 +1194,8 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
 
     // Check locked state for server
     AccountTypes allowedAccountType = sWorld->GetPlayerSecurityLimit();
-    TC_LOG_DEBUG("network", "Allowed Level: %u Player Level %u", allowedAccountType, AccountTypes(security));
-    if (allowedAccountType > SEC_PLAYER && AccountTypes(security) < allowedAccountType)
+    TC_LOG_DEBUG("network", "Allowed Level: %u Player Level %u", allowedAccountType, AccountTypes(info->security));
+    if (allowedAccountType > SEC_PLAYER && AccountTypes(info->security) < allowedAccountType)
     {
         SendAuthResponseError(AUTH_UNAVAILABLE);
         TC_LOG_INFO("network", "WorldSocket::HandleAuthSession: User tries to login but his security level is not enough");
@@ -1044,64 +1205,80 @@ int WorldSocket::HandleAuthSession(WorldPacket& recvPacket)
     // Check that Key and account name are the same on client and server
     uint32 t = 0;
     uint32 seed = m_Seed;
+    SHA1Hash sha;
 
-    sha.UpdateData(account);
+    sha.UpdateData(info->account);
     sha.UpdateData((uint8*)&t, 4);
-    sha.UpdateData((uint8*)&clientSeed, 4);
+    sha.UpdateData((uint8*)&info->clientSeed, 4);
     sha.UpdateData((uint8*)&seed, 4);
-    sha.UpdateBigNumbers(&k, NULL);
+    sha.UpdateBigNumbers(&info->k, NULL);
     sha.Finalize();
 
     std::string address = GetRemoteAddress();
 
-    if (memcmp(sha.GetDigest(), digest, 20))
+    if (memcmp(sha.GetDigest(), info->digest, 20))
     {
         SendAuthResponseError(AUTH_FAILED);
-        TC_LOG_ERROR("network", "WorldSocket::HandleAuthSession: Authentication failed for account: %u ('%s') address: %s", id, account.c_str(), address.c_str());
+        TC_LOG_ERROR("network", "WorldSocket::HandleAuthSession: Authentication failed for account: %u ('%s') address: %s", info->id, info->account.c_str(), address.c_str());
         return -1;
     }
 
     TC_LOG_DEBUG("network", "WorldSocket::HandleAuthSession: Client '%s' authenticated successfully from %s.",
-        account.c_str(),
+        info->account.c_str(),
         address.c_str());
 
-    // Check if this user is by any chance a recruiter
-    stmt = LoginDatabase.GetPreparedStatement(LOGIN_SEL_ACCOUNT_RECRUITER);
+    // Update the last_ip in the database
+    PreparedStatement* stmt = LoginDatabase.GetPreparedStatement(LOGIN_UPD_LAST_IP);
 
-    stmt->setUInt32(0, id);
+    stmt->setString(0, address);
+    stmt->setString(1, info->account);
 
-    result = LoginDatabase.Query(stmt);
+    LoginDatabase.Execute(stmt);
 
-    bool isRecruiter = false;
-    if (result)
-        isRecruiter = true;
+    // Data the WorldSession loads on creation
+    stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_ACCOUNT_DATA);
+    stmt->setUInt32(0, info->id);
+    info->queries[AUTH_SESSION_QUERY_ACCOUNT_DATA] = CharacterDatabase.AsyncQuery(stmt, SQL_PRIORITY_INTERACTIVE);
 
-    // Update the last_ip in the database
+    stmt = CharacterDatabase.GetPreparedStatement(CHAR_SEL_TUTORIALS);
+    stmt->setUInt32(0, info->id);
+    info->queries[AUTH_SESSION_QUERY_TUTORIALS] = CharacterDatabase.AsyncQuery(stmt, SQL_PRIORITY_INTERACTIVE);
 
-    stmt = LoginDatabase.GetPreparedStatement(LOGIN_UPD_LAST_IP);
+    // Delay adding the session, without holding up the other sockets of this network thread
+    uint32 sleepTime = sWorld->getIntConfig(CONFIG_SESSION_ADD_DELAY);
+    info->addTime = ACE_OS::gettimeofday() + ACE_Time_Value(0, sleepTime);
 
-    stmt->setString(0, address);
-    stmt->setString(1, account);
+    info->stage = AUTH_SESSION_STAGE_SESSION_DATA;
+    return 0;
+}
 
-    LoginDatabase.Execute(stmt);
+int WorldSocket::HandleAuthSessionComplete()
+{
+    AuthSessionInfo* info = m_AuthSession;
+
+    bool isRecruiter = false;
+    if (info->results[AUTH_SESSION_QUERY_RECRUITER])
+        isRecruiter = true;
 
     // NOTE ATM the socket is single-threaded, have this in mind ...
-    ACE_NEW_RETURN(m_Session, WorldSession(id, this, AccountTypes(security), expansion, mutetime, locale, recruiter, isRecruiter, hasBoost), -1);
+    ACE_NEW_RETURN(m_Session, WorldSession(info->id, this, AccountTypes(info->security), info->expansion, info->mutetime, info->locale, info->recruiter, isRecruiter, info->hasBoost), -1);
 
-    m_Crypt.Init(&k);
+    if (m_CaptureRing)
+        m_CaptureRing->SetAccountId(info->id);
 
-    m_Session->LoadGlobalAccountData();
-    m_Session->LoadTutorialsData();
-    m_Session->ReadAddonsInfo(addonsData);
-    m_Session->LoadPermissions();
+    m_Crypt.Init(&info->k);
+
+    m_Session->LoadAccountData(info->results[AUTH_SESSION_QUERY_ACCOUNT_DATA], GLOBAL_CACHE_MASK);
+    m_Session->LoadTutorialsData(info->results[AUTH_SESSION_QUERY_TUTORIALS]);
+    m_Session->ReadAddonsInfo(info->addonsData);
+    m_Session->LoadPermissions(info->account, info->results[AUTH_SESSION_QUERY_PERMISSIONS]);
 
     // Initialize Warden system only if it is enabled by config
     if (sWorld->getBoolConfig(CONFIG_WARDEN_ENABLED))
-        m_Session->InitWarden(&k, os);
+        m_Session->InitWarden(&info->k, info->os);
 
-    // Sleep this Network thread for
-    uint32 sleepTime = sWorld->getIntConfig(CONFIG_SESSION_ADD_DELAY);
-    ACE_OS::sleep(ACE_Time_Value(0, sleepTime));
+    delete m_AuthSession;
+    m_AuthSession = NULL;
 
     sWorld->AddSession(m_Session);
     return 0;
@@ -1157,7 +1334,7 @@ int WorldSocket::HandlePing (WorldPacket& recvPacket)
             m_Session->SetLatency (latency);
             m_Session->ResetClientTimeDelay();
         }
-        else
+        else if (!m_AuthSession)
         {
             TC_LOG_ERROR("network", "WorldSocket::HandlePing: peer sent CMSG_PING, "
                             "but is not authenticated or got recently kicked, "
@@ -43,6 +43,8 @@
 class ACE_Message_Block;
 class WorldPacket;
 class WorldSession;
+struct AuthSessionInfo;
+class PacketCaptureRing;
 
 /// Handler that can communicate over stream sockets.
 typedef ACE_Svc_Handler<ACE_SOCK_STREAM, ACE_NULL_SYNCH> WorldHandler;
@@ -104,6 +106,13 @@ class WorldSocket : public WorldHandler
         /// Get address of connected peer.
         const std::string& GetRemoteAddress(void) const;
 
+        /// Map the player of this connection is on, used to filter captured packets.
+        void SetCaptureMapId(uint32 mapId);
+
+        /// Packets received from and sent to all clients since startup, wrap around.
+        static long GetReceivedPacketCount();
+        static long GetSentPacketCount();
+
         /// Send A packet on the socket, this function is reentrant.
         /// @param pct packet to send
         /// @return -1 of failure
@@ -154,9 +163,17 @@ class WorldSocket : public WorldHandler
         /// @param new_pct received packet, note that you need to delete it.
         int ProcessIncoming(WorldPacket* new_pct);
 
-        /// Called by ProcessIncoming() on CMSG_AUTH_SESSION.
+        /// Called by ProcessIncoming() on CMSG_AUTH_SESSION, starts the account lookups.
         int HandleAuthSession(WorldPacket& recvPacket);
 
+        /// Called by Update() while CMSG_AUTH_SESSION lookups are pending, advances the handshake once they completed.
+        int ProcessAuthSession();
+
+        /// Steps of the CMSG_AUTH_SESSION handshake, see AuthSessionStage.
+        int HandleAuthSessionAccount();
+        int HandleAuthSessionChecks();
+        int HandleAuthSessionComplete();
+
         /// Called by ProcessIncoming() on CMSG_PING.
         int HandlePing(WorldPacket& recvPacket);
 
@@ -207,6 +224,12 @@ class WorldSocket : public WorldHandler
         /// True if the socket is registered with the reactor for output
         bool m_OutActive;
 
+        /// State of the CMSG_AUTH_SESSION handshake while its database lookups are pending
+        AuthSessionInfo* m_AuthSession;
+
+        /// Recent packets of this connection when packet capture runs in ring mode, NULL otherwise.
+        PacketCaptureRing* m_CaptureRing;
+
         uint32 m_Seed;
 
 };
@@ -21,6 +21,7 @@
 #include "SpellAuraDefines.h"
 #include "SpellInfo.h"
 #include "Unit.h"
+#include "SlabAllocator.h"
 
 class SpellInfo;
 struct SpellModifier;
@@ -64,6 +65,8 @@ class AuraApplication
         void _HandleEffect(uint8 effIndex, bool apply);
     public:
 
+        DECLARE_SLAB_ALLOCATOR();
+
         Unit* GetTarget() const { return _target; }
         Aura* GetBase() const { return _base; }
 
@@ -78,7 +81,7 @@ class AuraApplication
         void SetRemoveMode(AuraRemoveMode mode) { _removeMode = mode; }
         AuraRemoveMode GetRemoveMode() const {return _removeMode;}
 
-        void SetNeedClientUpdate() { _needClientUpdate = true;}
+        void SetNeedClientUpdate() { _needClientUpdate = true; _target->AurasChanged(); }
         bool IsNeedClientUpdate() const { return _needClientUpdate;}
         void ClientUpdate(bool remove = false);
 };
@@ -282,6 +285,8 @@ class UnitAura : public Aura
     protected:
         explicit UnitAura(SpellInfo const* spellproto, uint32 effMask, WorldObject* owner, Unit* caster, int32 *baseAmount, Item* castItem, uint64 casterGUID);
     public:
+        DECLARE_SLAB_ALLOCATOR();
+
         void _ApplyForTarget(Unit* target, Unit* caster, AuraApplication * aurApp);
         void _UnapplyForTarget(Unit* target, Unit* caster, AuraApplication * aurApp);
 
@@ -303,6 +308,8 @@ class DynObjAura : public Aura
     protected:
         explicit DynObjAura(SpellInfo const* spellproto, uint32 effMask, WorldObject* owner, Unit* caster, int32 *baseAmount, Item* castItem, uint64 casterGUID);
     public:
+        DECLARE_SLAB_ALLOCATOR();
+
         void Remove(AuraRemoveMode removeMode = AURA_REMOVE_BY_DEFAULT);
 
         void FillTargetMap(std::map<Unit*, uint32> & targets, Unit* caster);
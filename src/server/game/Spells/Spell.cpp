@@ -506,6 +506,8 @@ SpellValue::SpellValue(SpellInfo const* proto)
     AuraStackAmount = 1;
 }
 
+DEFINE_SLAB_ALLOCATOR(Spell)
+
 Spell::Spell(Unit* caster, SpellInfo const* info, TriggerCastFlags triggerFlags, uint64 originalCasterGUID, bool skipCheck) :
 m_spellInfo(sSpellMgr->GetSpellForDifficultyFromSpell(info, caster)),
 m_caster((info->AttributesEx6 & SPELL_ATTR6_CAST_BY_CHARMER && caster->GetCharmerOrOwner()) ? caster->GetCharmerOrOwner() : caster)
@@ -1320,8 +1322,10 @@ void Spell::SelectImplicitAreaTargets(SpellEffIndex effIndex, SpellImplicitTarge
         if (uint32 maxTargets = m_spellValue->MaxAffectedTargets)
             Trinity::Containers::RandomResizeList(unitTargets, maxTargets);
 
+        PrepareAreaTargetsLOS(unitTargets);
         for (std::list<Unit*>::iterator itr = unitTargets.begin(); itr != unitTargets.end(); ++itr)
             AddUnitTarget(*itr, effMask, false);
+        m_areaTargetsLOS.clear();
     }
 
     if (!gObjTargets.empty())
@@ -7380,20 +7384,56 @@ bool Spell::CheckEffectTarget(Unit const* target, uint32 eff) const
             // all ok by some way or another, skip normal check
             break;
         default:                                            // normal case
-            // Get GO cast coordinates if original caster -> GO
-            WorldObject* caster = NULL;
-            if (IS_GAMEOBJECT_GUID(m_originalCasterGUID))
-                caster = m_caster->GetMap()->GetGameObject(m_originalCasterGUID);
-            if (!caster)
-                caster = m_caster;
-            if (target != m_caster && !target->IsWithinLOSInMap(caster))
-                return false;
+            if (target != m_caster)
+            {
+                AreaTargetsLOSMap::const_iterator los = m_areaTargetsLOS.find(target->GetGUID());
+                if (los != m_areaTargetsLOS.end() ? !los->second : !target->IsWithinLOSInMap(GetLOSSource()))
+                    return false;
+            }
             break;
     }
 
     return true;
 }
 
+WorldObject* Spell::GetLOSSource() const
+{
+    // Get GO cast coordinates if original caster -> GO
+    WorldObject* caster = NULL;
+    if (IS_GAMEOBJECT_GUID(m_originalCasterGUID))
+        caster = m_caster->GetMap()->GetGameObject(m_originalCasterGUID);
+    if (!caster)
+        caster = m_caster;
+    return caster;
+}
+
+void Spell::PrepareAreaTargetsLOS(std::list<Unit*> const& targets)
+{
+    m_areaTargetsLOS.clear();
+
+    // CheckEffectTarget does not check line of sight at all then
+    if (targets.size() < 2 || IsTriggered() || m_spellInfo->AttributesEx2 & SPELL_ATTR2_CAN_TARGET_NOT_IN_LOS || DisableMgr::IsDisabledFor(DISABLE_TYPE_SPELL, m_spellInfo->Id, NULL, SPELL_DISABLE_LOS))
+        return;
+
+    WorldObject* source = GetLOSSource();
+
+    // targets in another phase are traced with their own phase mask, leave them to CheckEffectTarget
+    std::vector<WorldObject const*> objects;
+    objects.reserve(targets.size());
+    for (std::list<Unit*>::const_iterator itr = targets.begin(); itr != targets.end(); ++itr)
+        if (*itr != m_caster && (*itr)->GetPhaseMask() == source->GetPhaseMask())
+            objects.push_back(*itr);
+
+    if (objects.size() < 2)
+        return;
+
+    bool* los = new bool[objects.size()];
+    source->IsWithinLOSInMap(&objects[0], los, objects.size());
+    for (uint32 i = 0; i < objects.size(); ++i)
+        m_areaTargetsLOS[objects[i]->GetGUID()] = los[i];
+    delete[] los;
+}
+
 bool Spell::IsNextMeleeSwingSpell() const
 {
     return m_spellInfo->Attributes & SPELL_ATTR0_ON_NEXT_SWING;
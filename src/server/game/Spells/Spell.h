@@ -23,6 +23,7 @@
 #include "ObjectMgr.h"
 #include "SpellInfo.h"
 #include "PathGenerator.h"
+#include "SlabAllocator.h"
 
 class Unit;
 class Player;
@@ -224,6 +225,8 @@ class Spell
     friend class SpellScript;
     public:
 
+        DECLARE_SLAB_ALLOCATOR();
+
         void EffectNULL(SpellEffIndex effIndex);
         void EffectUnused(SpellEffIndex effIndex);
         void EffectDistract(SpellEffIndex effIndex);
@@ -435,6 +438,8 @@ class Spell
         void DoCreateItem(uint32 i, uint32 itemtype);
 
         bool CheckEffectTarget(Unit const* target, uint32 eff) const;
+        WorldObject* GetLOSSource() const;
+        void PrepareAreaTargetsLOS(std::list<Unit*> const& targets);
         bool CanAutoCast(Unit* target);
         void CheckSrc() { if (!m_targets.HasSrc()) m_targets.SetSrc(*m_caster); }
         void CheckDst() { if (!m_targets.HasDst()) m_targets.SetDst(*m_caster); }
@@ -608,6 +613,9 @@ class Spell
             int32  damage;
         };
         std::list<TargetInfo> m_UniqueTargetInfo;
+        // line of sight of the area targets being added, traced together instead of once per target and effect
+        typedef UNORDERED_MAP<uint64, bool> AreaTargetsLOSMap;
+        AreaTargetsLOSMap m_areaTargetsLOS;
         uint32 m_channelTargetEffectMask;                        // Mask req. alive targets
 
         struct GOTargetInfo
@@ -998,6 +998,7 @@ void World::LoadConfigSettings(bool reload)
     m_float_configs[CONFIG_CREATURE_FAMILY_ASSISTANCE_RADIUS] = sConfigMgr->GetFloatDefault("CreatureFamilyAssistanceRadius", 10.0f);
     m_int_configs[CONFIG_CREATURE_FAMILY_ASSISTANCE_DELAY]  = sConfigMgr->GetIntDefault("CreatureFamilyAssistanceDelay", 1500);
     m_int_configs[CONFIG_CREATURE_FAMILY_FLEE_DELAY]        = sConfigMgr->GetIntDefault("CreatureFamilyFleeDelay", 7000);
+    m_bool_configs[CONFIG_CREATURE_IDLE_SLEEP]              = sConfigMgr->GetBoolDefault("Creature.IdleSleep", true);
 
     m_int_configs[CONFIG_WORLD_BOSS_LEVEL_DIFF] = sConfigMgr->GetIntDefault("WorldBossLevelDiff", 3);
 
@@ -1228,7 +1229,16 @@ void World::LoadConfigSettings(bool reload)
     m_bool_configs[CONFIG_SHOW_KICK_IN_WORLD] = sConfigMgr->GetBoolDefault("ShowKickInWorld", false);
     m_int_configs[CONFIG_INTERVAL_LOG_UPDATE] = sConfigMgr->GetIntDefault("RecordUpdateTimeDiffInterval", 60000);
     m_int_configs[CONFIG_MIN_LOG_UPDATE] = sConfigMgr->GetIntDefault("MinRecordUpdateTimeDiff", 100);
+    m_int_configs[CONFIG_TICK_STATS_LOG_INTERVAL] = sConfigMgr->GetIntDefault("TickStats.LogInterval", 0) * IN_MILLISECONDS;
     m_int_configs[CONFIG_NUMTHREADS] = sConfigMgr->GetIntDefault("MapUpdate.Threads", 1);
+    m_int_configs[CONFIG_GRID_PRELOAD_THREADS] = sConfigMgr->GetIntDefault("GridPreload.Threads", 0);
+    m_int_configs[CONFIG_GRID_PRELOAD_DISTANCE] = sConfigMgr->GetIntDefault("GridPreload.Distance", 250);
+    if (m_int_configs[CONFIG_GRID_PRELOAD_DISTANCE] > uint32(SIZE_OF_GRIDS))
+    {
+        TC_LOG_ERROR("server.loading", "GridPreload.Distance (%u) must be <= %u. Using %u instead.", m_int_configs[CONFIG_GRID_PRELOAD_DISTANCE], uint32(SIZE_OF_GRIDS), uint32(SIZE_OF_GRIDS));
+        m_int_configs[CONFIG_GRID_PRELOAD_DISTANCE] = uint32(SIZE_OF_GRIDS);
+    }
+    m_int_configs[CONFIG_COLLISION_CACHE_SIZE] = sConfigMgr->GetIntDefault("CollisionCache.Size", 4096);
     m_int_configs[CONFIG_MAX_RESULTS_LOOKUP_COMMANDS] = sConfigMgr->GetIntDefault("Command.LookupMaxResults", 0);
 
     // chat logging
@@ -1263,6 +1273,9 @@ void World::LoadConfigSettings(bool reload)
     // Rbac Free Permission mode
     m_int_configs[CONFIG_RBAC_FREE_PERMISSION_MODE] = sConfigMgr->GetIntDefault("RBAC.FreePermissionMode", 0);
 
+    // Compare compiled condition programs with the condition list interpreter at loading
+    m_bool_configs[CONFIG_CONDITIONS_VERIFY_PROGRAMS] = sConfigMgr->GetBoolDefault("Conditions.VerifyPrograms", false);
+
     // Random Battleground Rewards
     m_int_configs[CONFIG_BG_REWARD_WINNER_HONOR_FIRST] = sConfigMgr->GetIntDefault("Battleground.RewardWinnerHonorFirst", 27000);
     m_int_configs[CONFIG_BG_REWARD_WINNER_CONQUEST_FIRST] = sConfigMgr->GetIntDefault("Battleground.RewardWinnerConquestFirst", 10000);
@@ -1976,18 +1989,20 @@ void World::SetInitialWorldSettings()
 
 void World::RecordTimeDiff(const char *text, ...)
 {
-    if (m_updateTimeCount != 1)
-        return;
+    uint32 thisTime = getMSTime();
     if (!text)
     {
-        m_currentTime = getMSTime();
+        m_currentTime = thisTime;
         return;
     }
 
-    uint32 thisTime = getMSTime();
     uint32 diff = getMSTimeDiff(m_currentTime, thisTime);
+    m_currentTime = thisTime;
+
+    // Every tick goes into the statistics, only the first of each log interval into the log
+    m_tickStats.AddSubsystemTime(text, diff);
 
-    if (diff > m_int_configs[CONFIG_MIN_LOG_UPDATE])
+    if (m_updateTimeCount == 1 && diff > m_int_configs[CONFIG_MIN_LOG_UPDATE])
     {
         va_list ap;
         char str[256];
@@ -1996,8 +2011,22 @@ void World::RecordTimeDiff(const char *text, ...)
         va_end(ap);
         TC_LOG_INFO("misc", "Difftime %s: %u.", str, diff);
     }
+}
 
-    m_currentTime = thisTime;
+void World::LogTickStats()
+{
+    WorldTickStats const& stats = m_tickStats;
+
+    std::ostringstream subsystems;
+    std::vector<WorldSubsystemTime> const& times = stats.GetSubsystemTimes();
+    for (std::vector<WorldSubsystemTime>::const_iterator itr = times.begin(); itr != times.end(); ++itr)
+        if (itr->samples)
+            subsystems << ' ' << itr->name << ' ' << uint32(itr->totalTime / itr->samples) << '/' << itr->maxTime;
+
+    TC_LOG_INFO("server.tickstats", "ticks %u avg %u p50 %u p95 %u p99 %u max %u ms, sessions %u, packets in %.1f/s out %.1f/s, subsystems avg/max ms:%s",
+        stats.GetTickCount(), stats.GetAverageTickTime(), stats.GetPercentileTickTime(50.0f), stats.GetPercentileTickTime(95.0f),
+        stats.GetPercentileTickTime(99.0f), stats.GetMaxTickTime(), GetActiveSessionCount(), stats.GetReceivedPacketRate(),
+        stats.GetSentPacketRate(), subsystems.str().c_str());
 }
 
 void World::LoadAutobroadcasts()
@@ -2037,6 +2066,7 @@ void World::LoadAutobroadcasts()
 void World::Update(uint32 diff)
 {
     m_updateTime = diff;
+    uint32 tickStartTime = getMSTime();
 
     if (m_int_configs[CONFIG_INTERVAL_LOG_UPDATE] && diff > m_int_configs[CONFIG_MIN_LOG_UPDATE])
     {
@@ -2238,6 +2268,13 @@ void World::Update(uint32 diff)
     ProcessCliCommands();
 
     sScriptMgr->OnWorldUpdate(diff);
+
+    m_tickStats.AddTick(GetMSTimeDiffToNow(tickStartTime));
+    if (m_int_configs[CONFIG_TICK_STATS_LOG_INTERVAL] && m_tickStats.GetWindowTime() >= m_int_configs[CONFIG_TICK_STATS_LOG_INTERVAL])
+    {
+        LogTickStats();
+        m_tickStats.Reset();
+    }
 }
 
 void World::ForceGameEventUpdate()
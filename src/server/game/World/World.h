@@ -29,6 +29,7 @@
 #include "SharedDefines.h"
 #include "QueryResult.h"
 #include "Callback.h"
+#include "WorldTickStats.h"
 
 #include <map>
 #include <set>
@@ -171,6 +172,8 @@ enum WorldBoolConfigs
     CONFIG_INSTANCES_RESET_ANNOUNCE,
     CONFIG_TICKETS_GM_ENABLED,
     CONFIG_TICKETS_FEEDBACK_SYSTEM_ENABLED,
+    CONFIG_CREATURE_IDLE_SLEEP,
+    CONFIG_CONDITIONS_VERIFY_PROGRAMS,
     BOOL_CONFIG_VALUE_COUNT
 };
 
@@ -305,9 +308,13 @@ enum WorldIntConfigs
     CONFIG_PVP_TOKEN_COUNT,
     CONFIG_INTERVAL_LOG_UPDATE,
     CONFIG_MIN_LOG_UPDATE,
+    CONFIG_TICK_STATS_LOG_INTERVAL,
     CONFIG_ENABLE_SINFO_LOGIN,
     CONFIG_PLAYER_ALLOW_COMMANDS,
     CONFIG_NUMTHREADS,
+    CONFIG_GRID_PRELOAD_THREADS,
+    CONFIG_GRID_PRELOAD_DISTANCE,
+    CONFIG_COLLISION_CACHE_SIZE,
     CONFIG_LOGDB_CLEARINTERVAL,
     CONFIG_LOGDB_CLEARTIME,
     CONFIG_CLIENTCACHE_VERSION,
@@ -632,6 +639,8 @@ class World
         uint32 GetUptime() const { return uint32(m_gameTime - m_startTime); }
         /// Update time
         uint32 GetUpdateTime() const { return m_updateTime; }
+        /// Tick time distribution and per subsystem update times, see RecordTimeDiff
+        WorldTickStats& GetTickStats() { return m_tickStats; }
         void SetRecordDiffInterval(int32 t) { if (t >= 0) m_int_configs[CONFIG_INTERVAL_LOG_UPDATE] = (uint32)t; }
 
         /// Next daily quests and random bg reset time
@@ -754,6 +763,8 @@ class World
         char const* GetDBVersion() const { return m_DBVersion.c_str(); }
 
         void RecordTimeDiff(const char * text, ...);
+        /// Writes a summary of the tick statistics to the server.tickstats logger
+        void LogTickStats();
 
         void LoadAutobroadcasts();
 
@@ -814,6 +825,7 @@ class World
         uint32 m_updateTime, m_updateTimeSum;
         uint32 m_updateTimeCount;
         uint32 m_currentTime;
+        WorldTickStats m_tickStats;
 
         SessionMap m_sessions;
         typedef UNORDERED_MAP<uint32, time_t> DisconnectMap;
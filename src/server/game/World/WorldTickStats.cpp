@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WorldTickStats.h"
+#include "Timer.h"
+#include "WorldSocket.h"
+
+WorldTickStats::WorldTickStats()
+{
+    Reset();
+}
+
+void WorldTickStats::Reset()
+{
+    memset(_histogram, 0, sizeof(_histogram));
+    _ticks = 0;
+    _totalTime = 0;
+    _maxTime = 0;
+    _startTime = getMSTime();
+    _receivedPacketsAtStart = WorldSocket::GetReceivedPacketCount();
+    _sentPacketsAtStart = WorldSocket::GetSentPacketCount();
+
+    // Keep the subsystems and their order, only the first tick after startup has to add them
+    for (std::vector<WorldSubsystemTime>::iterator itr = _subsystems.begin(); itr != _subsystems.end(); ++itr)
+        *itr = WorldSubsystemTime(itr->name);
+}
+
+void WorldTickStats::AddTick(uint32 tickTime)
+{
+    ++_histogram[std::min<uint32>(tickTime, HISTOGRAM_BUCKETS - 1)];
+    ++_ticks;
+    _totalTime += tickTime;
+    _maxTime = std::max(_maxTime, tickTime);
+}
+
+void WorldTickStats::AddSubsystemTime(char const* name, uint32 time)
+{
+    // A handful of subsystems, compared by address as they are string literals
+    std::vector<WorldSubsystemTime>::iterator itr = _subsystems.begin();
+    for (; itr != _subsystems.end(); ++itr)
+        if (itr->name == name)
+            break;
+
+    if (itr == _subsystems.end())
+        itr = _subsystems.insert(_subsystems.end(), WorldSubsystemTime(name));
+
+    itr->totalTime += time;
+    itr->maxTime = std::max(itr->maxTime, time);
+    ++itr->samples;
+}
+
+uint32 WorldTickStats::GetPercentileTickTime(float percentile) const
+{
+    if (!_ticks)
+        return 0;
+
+    uint32 rank = uint32(ceil(_ticks * percentile / 100.0f));
+    uint32 count = 0;
+    for (uint32 i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    {
+        count += _histogram[i];
+        if (count >= rank)
+            return i;
+    }
+
+    return HISTOGRAM_BUCKETS - 1;
+}
+
+uint32 WorldTickStats::GetWindowTime() const
+{
+    return GetMSTimeDiffToNow(_startTime);
+}
+
+float WorldTickStats::GetReceivedPacketRate() const
+{
+    uint32 window = GetWindowTime();
+    return window ? float(WorldSocket::GetReceivedPacketCount() - _receivedPacketsAtStart) * IN_MILLISECONDS / window : 0.0f;
+}
+
+float WorldTickStats::GetSentPacketRate() const
+{
+    uint32 window = GetWindowTime();
+    return window ? float(WorldSocket::GetSentPacketCount() - _sentPacketsAtStart) * IN_MILLISECONDS / window : 0.0f;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WORLDTICKSTATS_H
+#define WORLDTICKSTATS_H
+
+#include "Define.h"
+
+#include <vector>
+
+//! Time spent in one part of World::Update, as recorded by World::RecordTimeDiff
+struct WorldSubsystemTime
+{
+    WorldSubsystemTime(char const* _name) : name(_name), totalTime(0), maxTime(0), samples(0) { }
+
+    char const* name;
+    uint64 totalTime;
+    uint32 maxTime;
+    uint32 samples;
+};
+
+//! Distribution of world tick times and of the time spent per subsystem since the last reset.
+//! Only updated and read by the world thread.
+class WorldTickStats
+{
+    public:
+        enum
+        {
+            HISTOGRAM_BUCKETS = 1000    //! One bucket per millisecond, the last one also collects all longer ticks
+        };
+
+        WorldTickStats();
+
+        void Reset();
+
+        void AddTick(uint32 tickTime);
+        //! name has to stay valid, string literals are expected
+        void AddSubsystemTime(char const* name, uint32 time);
+
+        uint32 GetTickCount() const { return _ticks; }
+        uint32 GetAverageTickTime() const { return _ticks ? uint32(_totalTime / _ticks) : 0; }
+        uint32 GetMaxTickTime() const { return _maxTime; }
+        //! Tick time that percentile percent of the ticks did not exceed
+        uint32 GetPercentileTickTime(float percentile) const;
+        //! Milliseconds since the last reset
+        uint32 GetWindowTime() const;
+        //! Packets received from and sent to clients per second since the last reset
+        float GetReceivedPacketRate() const;
+        float GetSentPacketRate() const;
+        std::vector<WorldSubsystemTime> const& GetSubsystemTimes() const { return _subsystems; }
+
+    private:
+        uint32 _histogram[HISTOGRAM_BUCKETS];
+        uint32 _ticks;
+        uint64 _totalTime;
+        uint32 _maxTime;
+        uint32 _startTime;
+        long _receivedPacketsAtStart;
+        long _sentPacketsAtStart;
+        std::vector<WorldSubsystemTime> _subsystems;
+};
+
+#endif
@@ -25,6 +25,7 @@ EndScriptData */
 #include "ScriptMgr.h"
 #include "ObjectMgr.h"
 #include "BattlegroundMgr.h"
+#include "BattlegroundQueueSimulation.h"
 #include "Chat.h"
 #include "Cell.h"
 #include "CellImpl.h"
@@ -33,6 +34,8 @@ EndScriptData */
 #include "GossipDef.h"
 #include "Transport.h"
 #include "Language.h"
+#include "PacketLog.h"
+#include "WorldPacket.h"
 
 #include <fstream>
 
@@ -65,6 +68,12 @@ public:
             { "spellfail",     rbac::RBAC_PERM_COMMAND_DEBUG_SEND_SPELLFAIL,     false, &HandleDebugSendSpellFailCommand,       "", NULL },
             { NULL,            0,                                          false, NULL,                                   "", NULL }
         };
+        static ChatCommand debugPacketLogCommandTable[] =
+        {
+            { "flush",         rbac::RBAC_PERM_COMMAND_DEBUG_PACKETLOG_FLUSH,  true,  &HandleDebugPacketLogFlushCommand,  "", NULL },
+            { "replay",        rbac::RBAC_PERM_COMMAND_DEBUG_PACKETLOG_REPLAY, false, &HandleDebugPacketLogReplayCommand, "", NULL },
+            { NULL,            0,                                              false, NULL,                               "", NULL }
+        };
         static ChatCommand debugCommandTable[] =
         {
             { "setbit",        rbac::RBAC_PERM_COMMAND_DEBUG_SETBIT,        false, &HandleDebugSet32BitCommand,         "", NULL },
@@ -73,6 +82,7 @@ public:
             { "anim",          rbac::RBAC_PERM_COMMAND_DEBUG_ANIM,          false, &HandleDebugAnimCommand,             "", NULL },
             { "arena",         rbac::RBAC_PERM_COMMAND_DEBUG_ARENA,         false, &HandleDebugArenaCommand,            "", NULL },
             { "bg",            rbac::RBAC_PERM_COMMAND_DEBUG_BG,            false, &HandleDebugBattlegroundCommand,     "", NULL },
+            { "bgqueuesim",    rbac::RBAC_PERM_COMMAND_DEBUG_BGQUEUESIM,    true,  &HandleDebugBattlegroundQueueSimulationCommand, "", NULL },
             { "getitemstate",  rbac::RBAC_PERM_COMMAND_DEBUG_GETITEMSTATE,  false, &HandleDebugGetItemStateCommand,     "", NULL },
             { "lootrecipient", rbac::RBAC_PERM_COMMAND_DEBUG_LOOTRECIPIENT, false, &HandleDebugGetLootRecipientCommand, "", NULL },
             { "getvalue",      rbac::RBAC_PERM_COMMAND_DEBUG_GETVALUE,      false, &HandleDebugGetValueCommand,         "", NULL },
@@ -94,6 +104,7 @@ public:
             { "moveflags",     rbac::RBAC_PERM_COMMAND_DEBUG_MOVEFLAGS,     false, &HandleDebugMoveflagsCommand,        "", NULL },
             { "transport",     rbac::RBAC_PERM_COMMAND_DEBUG_TRANSPORT,     false, &HandleDebugTransportCommand,        "", NULL },
             { "phase",         rbac::RBAC_PERM_COMMAND_DEBUG_PHASE,         false, &HandleDebugPhaseCommand,            "", NULL },
+            { "packetlog",     rbac::RBAC_PERM_COMMAND_DEBUG_PACKETLOG,     true,  NULL,                                "", debugPacketLogCommandTable },
             { NULL,            0,                                     false, NULL,                                "", NULL }
         };
         static ChatCommand commandTable[] =
@@ -837,6 +848,42 @@ public:
         return true;
     }
 
+    static bool HandleDebugBattlegroundQueueSimulationCommand(ChatHandler* handler, char const* args)
+    {
+        // USAGE: .debug bgqueuesim [#groups] [#seed]
+        char* groupsStr = strtok((char*)args, " ");
+        char* seedStr = strtok(NULL, " ");
+
+        uint32 groups = groupsStr ? uint32(atoi(groupsStr)) : 20000;
+        groups = std::min<uint32>(std::max<uint32>(groups, BattlegroundQueueSimulation::ROUNDS), 200000);
+        uint32 seed = seedStr ? uint32(atoi(seedStr)) : 1;
+
+        Battleground* bgTemplate = sBattlegroundMgr->GetBattlegroundTemplate(BATTLEGROUND_WS);
+        if (!bgTemplate)
+        {
+            handler->SendSysMessage("Battleground template of Warsong Gulch not found.");
+            handler->SetSentErrorMessage(true);
+            return false;
+        }
+
+        BattlegroundQueueSimulation simulation(groups, seed);
+        simulation.Run(bgTemplate, RATED_TYPE_3v3);
+
+        BattlegroundQueueSimulationTime const& oldBattleground = simulation.GetOldBattlegroundTime();
+        BattlegroundQueueSimulationTime const& newBattleground = simulation.GetNewBattlegroundTime();
+        BattlegroundQueueSimulationTime const& oldArena = simulation.GetOldArenaTime();
+        BattlegroundQueueSimulationTime const& newArena = simulation.GetNewArenaTime();
+
+        handler->PSendSysMessage("Queued %u battleground and %u rated arena groups, started %u battlegrounds and %u arenas.",
+            simulation.GetBattlegroundGroupCount(), simulation.GetArenaGroupCount(), simulation.GetStartedBattlegroundCount(), simulation.GetStartedArenaCount());
+        handler->PSendSysMessage("Battleground matching: %u updates, old avg %.2f us max %u us, indexed avg %.2f us max %u us.",
+            newBattleground.samples, oldBattleground.GetAverageTime(), oldBattleground.maxTime, newBattleground.GetAverageTime(), newBattleground.maxTime);
+        handler->PSendSysMessage("Rated arena matching: %u updates, old avg %.2f us max %u us, indexed avg %.2f us max %u us.",
+            newArena.samples, oldArena.GetAverageTime(), oldArena.maxTime, newArena.GetAverageTime(), newArena.maxTime);
+        handler->PSendSysMessage("%u selections differ from the old algorithm.", simulation.GetMismatchCount());
+        return true;
+    }
+
     static bool HandleDebugThreatListCommand(ChatHandler* handler, char const* /*args*/)
     {
         Creature* target = handler->getSelectedCreature();
@@ -1436,6 +1483,83 @@ public:
         player->GetPhaseMgr().SendDebugReportToPlayer(handler->GetSession()->GetPlayer());
         return true;
     }
+
+    static bool HandleDebugPacketLogFlushCommand(ChatHandler* handler, char const* args)
+    {
+        // USAGE: .debug packetlog flush [#accountId]
+        if (!sPacketLog->IsCapturing())
+        {
+            handler->SendSysMessage("Packet capture is disabled, set PacketLog.Ring.Size to enable it.");
+            handler->SetSentErrorMessage(true);
+            return false;
+        }
+
+        uint32 accountId = *args ? uint32(atoi(args)) : 0;
+
+        std::string fileName;
+        uint32 count = sPacketLog->FlushRings(accountId, fileName);
+        if (!count)
+        {
+            handler->SendSysMessage("No captured packets to write.");
+            return true;
+        }
+
+        handler->PSendSysMessage("Wrote %u captured packets to %s.", count, fileName.c_str());
+        return true;
+    }
+
+    static bool HandleDebugPacketLogReplayCommand(ChatHandler* handler, char const* args)
+    {
+        // USAGE: .debug packetlog replay $fileName [#accountId]
+        if (!sPacketLog->IsReplayAllowed())
+        {
+            handler->SendSysMessage("Packet replay is disabled, set PacketLog.Replay.Enable to enable it.");
+            handler->SetSentErrorMessage(true);
+            return false;
+        }
+
+        char* fileName = strtok((char*)args, " ");
+        if (!fileName)
+            return false;
+
+        char* accountStr = strtok(NULL, " ");
+        uint32 accountId = accountStr ? uint32(atoi(accountStr)) : 0;
+
+        std::list<CapturedPacket> packets;
+        if (!sPacketLog->LoadCapture(fileName, accountId, packets))
+        {
+            handler->PSendSysMessage("Could not read packet capture %s.", fileName);
+            handler->SetSentErrorMessage(true);
+            return false;
+        }
+
+        // The packets go through the normal handlers of this session, as if its own client had sent them
+        WorldSession* session = handler->GetSession();
+        uint32 queued = 0;
+        for (std::list<CapturedPacket>::const_iterator itr = packets.begin(); itr != packets.end(); ++itr)
+        {
+            if (itr->opcode >= NUM_OPCODE_HANDLERS)
+                continue;
+
+            Opcodes opcode = clientOpcodeTable.GetOpcodeByNumber(itr->opcode);
+            if (opcode >= NUM_OPCODES)
+                continue;
+
+            OpcodeHandler const* opcodeHandler = clientOpcodeTable[opcode];
+            if (!opcodeHandler || opcodeHandler->Status == STATUS_UNHANDLED)
+                continue;
+
+            WorldPacket* packet = new WorldPacket(opcode, itr->data.size());
+            if (!itr->data.empty())
+                packet->append(&itr->data[0], itr->data.size());
+            packet->SetReceivedOpcode(itr->opcode);
+            session->QueuePacket(packet);
+            ++queued;
+        }
+
+        handler->PSendSysMessage("Queued %u of %u captured client packets from %s.", queued, uint32(packets.size()), fileName);
+        return true;
+    }
 };
 
 void AddSC_debug_commandscript()
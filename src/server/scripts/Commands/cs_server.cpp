@@ -28,6 +28,7 @@ EndScriptData */
 #include "ObjectAccessor.h"
 #include "Player.h"
 #include "ScriptMgr.h"
+#include "SlabAllocator.h"
 #include "SystemConfig.h"
 
 class server_commandscript : public CommandScript
@@ -86,6 +87,8 @@ public:
             { "restart",      rbac::RBAC_PERM_COMMAND_SERVER_RESTART,      true, NULL,                        "", serverRestartCommandTable },
             { "shutdown",     rbac::RBAC_PERM_COMMAND_SERVER_SHUTDOWN,     true, NULL,                        "", serverShutdownCommandTable },
             { "set",          rbac::RBAC_PERM_COMMAND_SERVER_SET,          true, NULL,                        "", serverSetCommandTable },
+            { "slabs",        rbac::RBAC_PERM_COMMAND_SERVER_SLABS,        true, &HandleServerSlabsCommand,   "", NULL },
+            { "tickstats",    rbac::RBAC_PERM_COMMAND_SERVER_TICKSTATS,    true, &HandleServerTickStatsCommand, "", NULL },
             { NULL,           0,                                    false, NULL,                        "", NULL }
         };
 
@@ -135,6 +138,56 @@ public:
         return true;
     }
 
+    // Display the per class slab allocators used for frequently created objects
+    static bool HandleServerSlabsCommand(ChatHandler* handler, char const* /*args*/)
+    {
+        std::vector<SlabAllocatorStats> allocators;
+        SlabAllocator::GetAllStats(allocators);
+
+        uint64 totalReserved = 0;
+        for (std::vector<SlabAllocatorStats>::const_iterator itr = allocators.begin(); itr != allocators.end(); ++itr)
+        {
+            handler->PSendSysMessage("%s: %u live, %u peak, %u bytes each, " UI64FMTD " KB reserved, %u oversized",
+                itr->name, itr->liveObjects, itr->peakObjects, itr->blockSize, itr->reservedBytes / 1024, itr->fallbacks);
+            totalReserved += itr->reservedBytes;
+        }
+
+        handler->PSendSysMessage("Total: " UI64FMTD " KB reserved in slabs.", totalReserved / 1024);
+        return true;
+    }
+
+    // Display the world tick time distribution since the last reset, optionally restarting it
+    static bool HandleServerTickStatsCommand(ChatHandler* handler, char const* args)
+    {
+        WorldTickStats& stats = sWorld->GetTickStats();
+
+        handler->PSendSysMessage("Last %u s: %u ticks, avg %u ms, p50 %u ms, p95 %u ms, p99 %u ms, max %u ms.",
+            stats.GetWindowTime() / IN_MILLISECONDS, stats.GetTickCount(), stats.GetAverageTickTime(), stats.GetPercentileTickTime(50.0f),
+            stats.GetPercentileTickTime(95.0f), stats.GetPercentileTickTime(99.0f), stats.GetMaxTickTime());
+        handler->PSendSysMessage("Sessions: %u active. Packets: %.1f/s received, %.1f/s sent.",
+            sWorld->GetActiveSessionCount(), stats.GetReceivedPacketRate(), stats.GetSentPacketRate());
+
+        std::vector<WorldSubsystemTime> const& times = stats.GetSubsystemTimes();
+        for (std::vector<WorldSubsystemTime>::const_iterator itr = times.begin(); itr != times.end(); ++itr)
+            if (itr->samples)
+                handler->PSendSysMessage("%s: avg %u ms, max %u ms.", itr->name, uint32(itr->totalTime / itr->samples), itr->maxTime);
+
+        std::vector<SlabAllocatorStats> allocators;
+        SlabAllocator::GetAllStats(allocators);
+        uint64 totalReserved = 0;
+        for (std::vector<SlabAllocatorStats>::const_iterator itr = allocators.begin(); itr != allocators.end(); ++itr)
+            totalReserved += itr->reservedBytes;
+        handler->PSendSysMessage("Memory: " UI64FMTD " KB reserved in slabs.", totalReserved / 1024);
+
+        if (*args && !stricmp(args, "reset"))
+        {
+            stats.Reset();
+            handler->SendSysMessage("Tick statistics restarted.");
+        }
+
+        return true;
+    }
+
     static bool HandleServerPLimitCommand(ChatHandler* handler, char const* args)
     {
         if (*args)
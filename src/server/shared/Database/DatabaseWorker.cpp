@@ -17,11 +17,13 @@
 
 #include "DatabaseEnv.h"
 #include "DatabaseWorker.h"
+#include "DatabaseWorkerQueue.h"
 #include "SQLOperation.h"
 #include "MySQLConnection.h"
 #include "MySQLThreading.h"
+#include "Log.h"
 
-DatabaseWorker::DatabaseWorker(ACE_Activation_Queue* new_queue, MySQLConnection* con) :
+DatabaseWorker::DatabaseWorker(DatabaseWorkerQueue* new_queue, MySQLConnection* con) :
 m_queue(new_queue),
 m_conn(con)
 {
@@ -34,18 +36,60 @@ int DatabaseWorker::svc()
     if (!m_queue)
         return -1;
 
-    SQLOperation *request = NULL;
+    std::vector<SQLOperation*> requests;
     while (1)
     {
-        request = (SQLOperation*)(m_queue->dequeue());
-        if (!request)
+        requests.clear();
+        if (!m_queue->Dequeue(requests))
             break;
 
-        request->SetConnection(m_conn);
-        request->call();
+        if (requests.size() == 1)
+        {
+            requests[0]->SetConnection(m_conn);
+            requests[0]->call();
+        }
+        else
+            ExecuteBatch(requests);
 
-        delete request;
+        for (size_t i = 0; i < requests.size(); ++i)
+            delete requests[i];
     }
 
     return 0;
 }
+
+void DatabaseWorker::ExecuteBatch(std::vector<SQLOperation*> const& batch)
+{
+    //! Batches only hold one-way statements, a failing statement is skipped just like it would be in autocommit mode
+    m_conn->BeginTransaction();
+    uint32 reconnects = m_conn->GetReconnectCount();
+
+    for (size_t i = 0; i < batch.size(); ++i)
+    {
+        batch[i]->SetConnection(m_conn);
+        bool success = batch[i]->Execute();
+
+        if (m_conn->GetReconnectCount() != reconnects)
+        {
+            //! The open transaction died with the old session. Statement i was retried on the new session
+            //! in autocommit mode, so only the statements before it have to be executed again.
+            TC_LOG_WARN("sql.sql", "Connection lost during a batch of %u statements, re-executing %u of them.", uint32(batch.size()), uint32(i));
+            for (size_t j = 0; j < i; ++j)
+                batch[j]->Execute();
+            for (size_t j = i + 1; j < batch.size(); ++j)
+                batch[j]->Execute();
+            return;
+        }
+
+        //! MySQL Errno 1213 rolls back the whole transaction, fall back to executing the batch statement by statement
+        if (!success && m_conn->GetLastError() == 1213)
+        {
+            m_conn->RollbackTransaction();
+            for (size_t j = 0; j < batch.size(); ++j)
+                batch[j]->Execute();
+            return;
+        }
+    }
+
+    m_conn->CommitTransaction();
+}
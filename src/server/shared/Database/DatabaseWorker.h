@@ -19,14 +19,16 @@
 #define _WORKERTHREAD_H
 
 #include <ace/Task.h>
-#include <ace/Activation_Queue.h>
+#include <vector>
 
 class MySQLConnection;
+class DatabaseWorkerQueue;
+class SQLOperation;
 
 class DatabaseWorker : protected ACE_Task_Base
 {
     public:
-        DatabaseWorker(ACE_Activation_Queue* new_queue, MySQLConnection* con);
+        DatabaseWorker(DatabaseWorkerQueue* new_queue, MySQLConnection* con);
 
         ///- Inherited from ACE_Task_Base
         int svc();
@@ -34,7 +36,9 @@ class DatabaseWorker : protected ACE_Task_Base
 
     private:
         DatabaseWorker() : ACE_Task_Base() { }
-        ACE_Activation_Queue* m_queue;
+        void ExecuteBatch(std::vector<SQLOperation*> const& batch);
+
+        DatabaseWorkerQueue* m_queue;
         MySQLConnection* m_conn;
 };
 
@@ -25,6 +25,7 @@
 #include "MySQLConnection.h"
 #include "Transaction.h"
 #include "DatabaseWorker.h"
+#include "DatabaseWorkerQueue.h"
 #include "PreparedStatement.h"
 #include "Log.h"
 #include "QueryResult.h"
@@ -34,6 +35,10 @@
 #define MIN_MYSQL_SERVER_VERSION 50100u
 #define MIN_MYSQL_CLIENT_VERSION 50100u
 
+//! Minimum number of queries a query holder slice has to contain before
+//! DelayQueryHolder spreads the holder over several asynchronous connections.
+#define MIN_QUERY_HOLDER_SLICE_SIZE 8u
+
 class PingOperation : public SQLOperation
 {
     //! Operation for idle delaythreads
@@ -50,7 +55,7 @@ class DatabaseWorkerPool
     public:
         /* Activity state */
         DatabaseWorkerPool() :
-        _queue(new ACE_Activation_Queue())
+        _queue(new DatabaseWorkerQueue())
         {
             memset(_connectionCount, 0, sizeof(_connectionCount));
             _connections.resize(IDX_SIZE);
@@ -63,7 +68,7 @@ class DatabaseWorkerPool
         {
         }
 
-        bool Open(const std::string& infoString, uint8 async_threads, uint8 synch_threads)
+        bool Open(const std::string& infoString, uint8 async_threads, uint8 synch_threads, PrepareMode prepareMode = PREPARE_ALL)
         {
             bool res = true;
             _connectionInfo = MySQLConnectionInfo(infoString);
@@ -76,6 +81,7 @@ class DatabaseWorkerPool
             for (uint8 i = 0; i < async_threads; ++i)
             {
                 T* t = new T(_queue, _connectionInfo);
+                t->SetPrepareMode(prepareMode);
                 res &= t->Open();
                 if (res) // only check mysql version if connection is valid
                     WPFatal(mysql_get_server_version(t->GetHandle()) >= MIN_MYSQL_SERVER_VERSION, "TrinityCore does not support MySQL versions below 5.1");
@@ -88,6 +94,7 @@ class DatabaseWorkerPool
             for (uint8 i = 0; i < synch_threads; ++i)
             {
                 T* t = new T(_connectionInfo);
+                t->SetPrepareMode(prepareMode);
                 res &= t->Open();
                 _connections[IDX_SYNCH][i] = t;
                 ++_connectionCount[IDX_SYNCH];
@@ -106,10 +113,10 @@ class DatabaseWorkerPool
         {
             TC_LOG_INFO("sql.driver", "Closing down DatabasePool '%s'.", GetDatabaseName());
 
-            //! Shuts down delaythreads for this connection pool by underlying deactivate().
-            //! The next dequeue attempt in the worker thread tasks will result in an error,
-            //! ultimately ending the worker thread task.
-            _queue->queue()->close();
+            //! Shuts down delaythreads for this connection pool.
+            //! Workers drain whatever is still queued, after that the next dequeue attempt
+            //! returns NULL, ultimately ending the worker thread task.
+            _queue->Close();
 
             for (uint8 i = 0; i < _connectionCount[IDX_ASYNC]; ++i)
             {
@@ -130,7 +137,7 @@ class DatabaseWorkerPool
             for (uint8 i = 0; i < _connectionCount[IDX_SYNCH]; ++i)
                 _connections[IDX_SYNCH][i]->Close();
 
-            //! Deletes the ACE_Activation_Queue object and its underlying ACE_Message_Queue
+            //! Deletes the DatabaseWorkerQueue object
             delete _queue;
 
             TC_LOG_INFO("sql.driver", "All connections on DatabasePool '%s' closed.", GetDatabaseName());
@@ -142,13 +149,13 @@ class DatabaseWorkerPool
 
         //! Enqueues a one-way SQL operation in string format that will be executed asynchronously.
         //! This method should only be used for queries that are only executed once, e.g during startup.
-        void Execute(const char* sql)
+        void Execute(const char* sql, SQLOperationPriority priority = SQL_PRIORITY_NORMAL)
         {
             if (!sql)
                 return;
 
             BasicStatementTask* task = new BasicStatementTask(sql);
-            Enqueue(task);
+            Enqueue(task, priority);
         }
 
         //! Enqueues a one-way SQL operation in string format -with variable args- that will be executed asynchronously.
@@ -169,10 +176,11 @@ class DatabaseWorkerPool
 
         //! Enqueues a one-way SQL operation in prepared statement format that will be executed asynchronously.
         //! Statement must be prepared with CONNECTION_ASYNC flag.
-        void Execute(PreparedStatement* stmt)
+        //! Only use SQL_PRIORITY_BULK for writes no later operation depends on, lanes are not ordered relative to each other.
+        void Execute(PreparedStatement* stmt, SQLOperationPriority priority = SQL_PRIORITY_NORMAL)
         {
             PreparedStatementTask* task = new PreparedStatementTask(stmt);
-            Enqueue(task);
+            Enqueue(task, priority);
         }
 
         /**
@@ -325,11 +333,11 @@ class DatabaseWorkerPool
         //! Enqueues a query in prepared format that will set the value of the PreparedQueryResultFuture return object as soon as the query is executed.
         //! The return value is then processed in ProcessQueryCallback methods.
         //! Statement must be prepared with CONNECTION_ASYNC flag.
-        PreparedQueryResultFuture AsyncQuery(PreparedStatement* stmt)
+        PreparedQueryResultFuture AsyncQuery(PreparedStatement* stmt, SQLOperationPriority priority = SQL_PRIORITY_NORMAL)
         {
             PreparedQueryResultFuture res;
             PreparedStatementTask* task = new PreparedStatementTask(stmt, res);
-            Enqueue(task);
+            Enqueue(task, priority);
             return res;
         }
 
@@ -337,12 +345,32 @@ class DatabaseWorkerPool
         //! return object as soon as the query is executed.
         //! The return value is then processed in ProcessQueryCallback methods.
         //! Any prepared statements added to this holder need to be prepared with the CONNECTION_ASYNC flag.
+        //! Large holders (e.g. LoginQueryHolder) are split into contiguous slices that are executed in parallel
+        //! by the asynchronous connections, so the holder costs roughly size / connections round trips instead of size.
         QueryResultHolderFuture DelayQueryHolder(SQLQueryHolder* holder)
         {
             QueryResultHolderFuture res;
-            SQLQueryHolderTask* task = new SQLQueryHolderTask(holder, res);
-            Enqueue(task);
-            return res;     //! Fool compiler, has no use yet
+
+            size_t size = holder->GetSize();
+            uint32 slices = std::min<uint32>(_connectionCount[IDX_ASYNC], uint32(size / MIN_QUERY_HOLDER_SLICE_SIZE));
+            if (slices <= 1)
+            {
+                SQLQueryHolderTask* task = new SQLQueryHolderTask(holder, res);
+                Enqueue(task);
+                return res;     //! Fool compiler, has no use yet
+            }
+
+            //! Deleted by the slice that finishes last, see SQLQueryHolderTask::Execute
+            SQLQueryHolderSliceCounter* pendingSlices = new SQLQueryHolderSliceCounter(slices);
+            size_t sliceSize = (size + slices - 1) / slices;
+            for (uint32 i = 0; i < slices; ++i)
+            {
+                size_t begin = i * sliceSize;
+                size_t end = std::min(begin + sliceSize, size);
+                Enqueue(new SQLQueryHolderTask(holder, res, begin, end, pendingSlices));
+            }
+
+            return res;
         }
 
         /**
@@ -357,7 +385,7 @@ class DatabaseWorkerPool
 
         //! Enqueues a collection of one-way SQL operations (can be both adhoc and prepared). The order in which these operations
         //! were appended to the transaction will be respected during execution.
-        void CommitTransaction(SQLTransaction transaction)
+        void CommitTransaction(SQLTransaction transaction, SQLOperationPriority priority = SQL_PRIORITY_NORMAL)
         {
             #ifdef TRINITY_DEBUG
             //! Only analyze transaction weaknesses in Debug mode.
@@ -376,7 +404,7 @@ class DatabaseWorkerPool
             }
             #endif // TRINITY_DEBUG
 
-            Enqueue(new TransactionTask(transaction));
+            Enqueue(new TransactionTask(transaction), priority);
         }
 
         //! Directly executes a collection of one-way SQL operations (can be both adhoc and prepared). The order in which these operations
@@ -471,6 +499,41 @@ class DatabaseWorkerPool
             //! as the sole purpose is to prevent connections from idling.
             for (size_t i = 0; i < _connections[IDX_ASYNC].size(); ++i)
                 Enqueue(new PingOperation);
+
+            LogQueueStats();
+            if (sLog->ShouldLog("sql.driver", LOG_LEVEL_DEBUG))
+                LogStatementStats(10);
+        }
+
+        //! Sums up the per statement execution statistics of all connections, indexed by statement id.
+        void GetStatementStats(std::vector<PreparedStatementStats>& stats)
+        {
+            stats.clear();
+            for (uint8 i = 0; i < IDX_SIZE; ++i)
+                for (uint32 j = 0; j < _connectionCount[i]; ++j)
+                    _connections[i][j]->AddStatementStats(stats);
+        }
+
+        //! Configures the weighted round robin between the queue lanes and the back-pressure applied to bulk producers.
+        void SetQueuePolicy(uint32 interactiveWeight, uint32 normalWeight, uint32 bulkWeight, uint32 bulkQueueLimit, uint32 bulkMaxDelay)
+        {
+            _queue->SetWeight(SQL_PRIORITY_INTERACTIVE, interactiveWeight);
+            _queue->SetWeight(SQL_PRIORITY_NORMAL, normalWeight);
+            _queue->SetWeight(SQL_PRIORITY_BULK, bulkWeight);
+            _queue->SetBulkBackPressure(bulkQueueLimit, bulkMaxDelay);
+        }
+
+        //! Lets the asynchronous workers group up to maxSize consecutive one-way prepared statements into one transaction,
+        //! waiting up to window ms for a batch to fill. maxSize 1 disables batching.
+        void SetBatching(uint32 maxSize, uint32 window)
+        {
+            _queue->SetBatching(maxSize, window);
+        }
+
+        //! Returns depth and wait time statistics of one queue lane.
+        DatabaseWorkerQueueStats GetQueueStats(SQLOperationPriority priority, bool reset = false)
+        {
+            return _queue->GetStats(priority, reset);
         }
 
     private:
@@ -482,9 +545,49 @@ class DatabaseWorkerPool
             return mysql_real_escape_string(_connections[IDX_SYNCH][0]->GetHandle(), to, from, length);
         }
 
-        void Enqueue(SQLOperation* op)
+        void Enqueue(SQLOperation* op, SQLOperationPriority priority = SQL_PRIORITY_NORMAL)
+        {
+            _queue->Enqueue(op, priority);
+        }
+
+        //! Logs the prepared statements that took the most time in total since startup.
+        void LogStatementStats(uint32 count)
+        {
+            std::vector<PreparedStatementStats> stats;
+            GetStatementStats(stats);
+
+            std::vector<std::pair<uint64, uint32> > byTime;
+            for (uint32 i = 0; i < stats.size(); ++i)
+                if (stats[i].executions)
+                    byTime.push_back(std::make_pair(stats[i].totalTime, i));
+
+            std::sort(byTime.rbegin(), byTime.rend());
+            if (byTime.size() > count)
+                byTime.resize(count);
+
+            for (size_t i = 0; i < byTime.size(); ++i)
+            {
+                uint32 index = byTime[i].second;
+                PreparedStatementStats const& s = stats[index];
+                std::string query = _connections[IDX_SYNCH][0]->GetStatementQuery(index);
+                TC_LOG_DEBUG("sql.driver", "DatabasePool '%s' statement %u: " UI64FMTD " executions, " UI64FMTD " us total, " UI64FMTD " us avg, " UI64FMTD " us max: %s",
+                    GetDatabaseName(), index, s.executions, s.totalTime, s.totalTime / s.executions, s.maxTime,
+                    !query.empty() ? query.c_str() : "<unknown>");
+            }
+        }
+
+        //! Dumps and restarts the per lane queue statistics, called on every keep alive interval.
+        void LogQueueStats()
         {
-            _queue->enqueue(op);
+            static char const* const laneNames[MAX_SQL_PRIORITY] = { "interactive", "normal", "bulk" };
+
+            for (uint8 i = 0; i < MAX_SQL_PRIORITY; ++i)
+            {
+                DatabaseWorkerQueueStats stats = _queue->GetStats(SQLOperationPriority(i), true);
+                TC_LOG_DEBUG("sql.driver", "DatabasePool '%s' %s queue: depth %u, dequeued " UI64FMTD ", avg wait %u ms, max wait %u ms, throttled " UI64FMTD
+                    ", batches " UI64FMTD " (" UI64FMTD " statements)", GetDatabaseName(), laneNames[i], stats.depth, stats.dequeued,
+                    stats.dequeued ? uint32(stats.totalWaitTime / stats.dequeued) : 0, stats.maxWaitTime, stats.throttled, stats.batches, stats.batched);
+            }
         }
 
         //! Gets a free connection in the synchronous connection pool.
@@ -519,7 +622,7 @@ class DatabaseWorkerPool
             IDX_SIZE
         };
 
-        ACE_Activation_Queue*           _queue;             //! Queue shared by async worker threads.
+        DatabaseWorkerQueue*            _queue;             //! Queue shared by async worker threads.
         std::vector< std::vector<T*> >  _connections;
         uint32                          _connectionCount[2];       //! Counter of MySQL connections;
         MySQLConnectionInfo             _connectionInfo;
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ace/Guard_T.h>
+#include <ace/OS_NS_sys_time.h>
+
+#include "Common.h"
+#include "DatabaseWorkerQueue.h"
+#include "SQLOperation.h"
+#include "Timer.h"
+
+DatabaseWorkerQueue::DatabaseWorkerQueue() :
+_mutex(), _notEmpty(_mutex), _bulkDrained(_mutex), _size(0), _bulkQueueLimit(0), _bulkMaxDelay(0),
+_batchMaxSize(1), _batchWindow(0), _closed(false)
+{
+    _weights[SQL_PRIORITY_INTERACTIVE] = 8;
+    _weights[SQL_PRIORITY_NORMAL] = 4;
+    _weights[SQL_PRIORITY_BULK] = 1;
+
+    for (uint8 i = 0; i < MAX_SQL_PRIORITY; ++i)
+        _credits[i] = _weights[i];
+}
+
+DatabaseWorkerQueue::~DatabaseWorkerQueue()
+{
+    //! Operations still queued at this point were never executed
+    for (uint8 i = 0; i < MAX_SQL_PRIORITY; ++i)
+        for (OperationLane::iterator itr = _lanes[i].begin(); itr != _lanes[i].end(); ++itr)
+            delete itr->op;
+}
+
+void DatabaseWorkerQueue::Enqueue(SQLOperation* op, SQLOperationPriority priority)
+{
+    //! No logging in here, AppenderDB enqueues through this very method
+    TRINITY_GUARD(ACE_Thread_Mutex, _mutex);
+
+    if (priority == SQL_PRIORITY_BULK && _bulkQueueLimit && _lanes[SQL_PRIORITY_BULK].size() >= _bulkQueueLimit && !_closed)
+    {
+        ++_stats[SQL_PRIORITY_BULK].throttled;
+
+        //! Slow the producer down instead of dropping its write; give up waiting after _bulkMaxDelay
+        ACE_Time_Value deadline = ACE_OS::gettimeofday() + ACE_Time_Value(_bulkMaxDelay / IN_MILLISECONDS, (_bulkMaxDelay % IN_MILLISECONDS) * 1000);
+        while (_lanes[SQL_PRIORITY_BULK].size() >= _bulkQueueLimit && !_closed)
+            if (_bulkDrained.wait(&deadline) == -1)
+                break;
+    }
+
+    _lanes[priority].push_back(QueuedOperation(op, getMSTime()));
+    ++_size;
+    _notEmpty.signal();
+}
+
+bool DatabaseWorkerQueue::Dequeue(std::vector<SQLOperation*>& ops)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _mutex);
+
+    //! Pending operations are still handed out after Close, so queued writes are not lost on shutdown
+    while (!_size)
+    {
+        if (_closed)
+            return false;
+
+        _notEmpty.wait();
+    }
+
+    uint8 lane = SelectLane();
+    SQLOperation* op = PopFront(lane);
+    ops.push_back(op);
+
+    if (_batchMaxSize <= 1 || !op->IsBatchable())
+        return true;
+
+    //! Only take operations directly following in the same lane, so the lane order is kept
+    ACE_Time_Value deadline = ACE_OS::gettimeofday() + ACE_Time_Value(_batchWindow / IN_MILLISECONDS, (_batchWindow % IN_MILLISECONDS) * 1000);
+    while (ops.size() < _batchMaxSize)
+    {
+        if (_lanes[lane].empty())
+        {
+            //! Stop waiting as soon as other lanes have work, the wake up may have been meant for another worker
+            if (!_batchWindow || _closed || _size || _notEmpty.wait(&deadline) == -1)
+                break;
+
+            continue;
+        }
+
+        if (!_lanes[lane].front().op->IsBatchable())
+            break;
+
+        ops.push_back(PopFront(lane));
+    }
+
+    //! Another worker may have been woken up for an operation that is now part of this batch
+    if (_size)
+        _notEmpty.signal();
+
+    if (ops.size() > 1)
+    {
+        ++_stats[lane].batches;
+        _stats[lane].batched += ops.size();
+    }
+
+    return true;
+}
+
+SQLOperation* DatabaseWorkerQueue::PopFront(uint8 lane)
+{
+    QueuedOperation queued = _lanes[lane].front();
+    _lanes[lane].pop_front();
+    --_size;
+
+    DatabaseWorkerQueueStats& stats = _stats[lane];
+    uint32 waitTime = GetMSTimeDiffToNow(queued.enqueueTime);
+    ++stats.dequeued;
+    stats.totalWaitTime += waitTime;
+    if (waitTime > stats.maxWaitTime)
+        stats.maxWaitTime = waitTime;
+
+    if (lane == SQL_PRIORITY_BULK && _lanes[SQL_PRIORITY_BULK].size() < _bulkQueueLimit)
+        _bulkDrained.broadcast();
+
+    return queued.op;
+}
+
+void DatabaseWorkerQueue::Close()
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _mutex);
+
+    _closed = true;
+    _notEmpty.broadcast();
+    _bulkDrained.broadcast();
+}
+
+void DatabaseWorkerQueue::SetWeight(SQLOperationPriority priority, uint32 weight)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _mutex);
+
+    //! A lane with weight 0 would never be served
+    _weights[priority] = std::max<uint32>(weight, 1);
+    _credits[priority] = std::min(_credits[priority], _weights[priority]);
+}
+
+void DatabaseWorkerQueue::SetBulkBackPressure(uint32 queueLimit, uint32 maxDelay)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _mutex);
+
+    _bulkQueueLimit = queueLimit;
+    _bulkMaxDelay = maxDelay;
+    _bulkDrained.broadcast();
+}
+
+void DatabaseWorkerQueue::SetBatching(uint32 maxSize, uint32 window)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _mutex);
+
+    _batchMaxSize = std::max<uint32>(maxSize, 1);
+    _batchWindow = window;
+}
+
+DatabaseWorkerQueueStats DatabaseWorkerQueue::GetStats(SQLOperationPriority priority, bool reset /*= false*/)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _mutex);
+
+    DatabaseWorkerQueueStats stats = _stats[priority];
+    stats.depth = uint32(_lanes[priority].size());
+
+    if (reset)
+        _stats[priority] = DatabaseWorkerQueueStats();
+
+    return stats;
+}
+
+uint8 DatabaseWorkerQueue::SelectLane()
+{
+    //! Serve lanes in priority order while they have credits left, then start a new cycle
+    for (uint8 pass = 0; pass < 2; ++pass)
+    {
+        for (uint8 i = 0; i < MAX_SQL_PRIORITY; ++i)
+        {
+            if (_lanes[i].empty() || !_credits[i])
+                continue;
+
+            --_credits[i];
+            return i;
+        }
+
+        for (uint8 i = 0; i < MAX_SQL_PRIORITY; ++i)
+            _credits[i] = _weights[i];
+    }
+
+    ASSERT(false);
+    return SQL_PRIORITY_NORMAL;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DATABASEWORKERQUEUE_H
+#define _DATABASEWORKERQUEUE_H
+
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+#include <deque>
+#include <vector>
+
+#include "Define.h"
+
+class SQLOperation;
+
+//! Lanes of the asynchronous database queue.
+//! Operations are only ordered relative to other operations of the same lane,
+//! so anything that depends on a previously queued write must stay in that write's lane.
+enum SQLOperationPriority
+{
+    SQL_PRIORITY_INTERACTIVE,   //! A player is waiting on the result (login, character list, ...)
+    SQL_PRIORITY_NORMAL,        //! Default lane, keeps the historical FIFO behaviour
+    SQL_PRIORITY_BULK,          //! Independent background writes (log appends, ...), subject to back-pressure
+    MAX_SQL_PRIORITY
+};
+
+struct DatabaseWorkerQueueStats
+{
+    DatabaseWorkerQueueStats() : depth(0), dequeued(0), totalWaitTime(0), maxWaitTime(0), throttled(0), batches(0), batched(0) { }
+
+    uint32 depth;           //! Operations currently waiting in the lane
+    uint64 dequeued;        //! Operations handed to a worker since the last reset
+    uint64 totalWaitTime;   //! Sum of queue wait times in ms since the last reset
+    uint32 maxWaitTime;     //! Longest queue wait time in ms since the last reset
+    uint64 throttled;       //! Producers delayed by back-pressure since the last reset
+    uint64 batches;         //! Batches of more than one operation handed out since the last reset
+    uint64 batched;         //! Operations handed out as part of such batches since the last reset
+};
+
+//! Queue shared by the asynchronous connections of a DatabaseWorkerPool.
+//! Every lane is a FIFO; workers pick lanes by weighted round robin so that
+//! lower lanes still drain while higher lanes are busy.
+class DatabaseWorkerQueue
+{
+    public:
+        DatabaseWorkerQueue();
+        ~DatabaseWorkerQueue();
+
+        //! Adds an operation to the given lane. Bulk producers may be delayed here,
+        //! see SetBulkBackPressure.
+        void Enqueue(SQLOperation* op, SQLOperationPriority priority);
+
+        //! Blocks until an operation is available and appends it to ops. If it can be batched, directly following
+        //! batchable operations of the same lane are appended as well, see SetBatching.
+        //! Returns false once the queue is closed and drained.
+        bool Dequeue(std::vector<SQLOperation*>& ops);
+
+        //! Wakes up every waiting worker and producer. Dequeue returns false once the remaining operations are handed out.
+        void Close();
+
+        //! Number of operations handed out from a lane per round robin cycle.
+        void SetWeight(SQLOperationPriority priority, uint32 weight);
+
+        //! Once the bulk lane holds queueLimit operations, bulk producers wait up to maxDelay ms
+        //! for it to drain before their operation is queued anyway. 0 disables back-pressure.
+        void SetBulkBackPressure(uint32 queueLimit, uint32 maxDelay);
+
+        //! Up to maxSize consecutive batchable operations are handed to a worker at once. If fewer are queued,
+        //! the worker waits up to window ms for more to arrive. maxSize 1 disables batching.
+        void SetBatching(uint32 maxSize, uint32 window);
+
+        //! Copies the statistics of a lane and optionally restarts the counters.
+        DatabaseWorkerQueueStats GetStats(SQLOperationPriority priority, bool reset = false);
+
+    private:
+        struct QueuedOperation
+        {
+            QueuedOperation(SQLOperation* o, uint32 t) : op(o), enqueueTime(t) { }
+
+            SQLOperation* op;
+            uint32 enqueueTime;
+        };
+
+        typedef std::deque<QueuedOperation> OperationLane;
+
+        //! Picks the lane to serve next. Must be called with _mutex held and at least one operation queued.
+        uint8 SelectLane();
+
+        //! Removes the front operation of a lane and accounts its wait time. Must be called with _mutex held.
+        SQLOperation* PopFront(uint8 lane);
+
+        ACE_Thread_Mutex _mutex;
+        ACE_Condition_Thread_Mutex _notEmpty;       //! Signaled when an operation is queued
+        ACE_Condition_Thread_Mutex _bulkDrained;    //! Signaled when the bulk lane drops below its limit
+        OperationLane _lanes[MAX_SQL_PRIORITY];
+        uint32 _weights[MAX_SQL_PRIORITY];
+        uint32 _credits[MAX_SQL_PRIORITY];          //! Remaining dequeues of the current round robin cycle
+        DatabaseWorkerQueueStats _stats[MAX_SQL_PRIORITY];
+        uint32 _size;
+        uint32 _bulkQueueLimit;
+        uint32 _bulkMaxDelay;
+        uint32 _batchMaxSize;
+        uint32 _batchWindow;
+        bool _closed;
+};
+
+#endif
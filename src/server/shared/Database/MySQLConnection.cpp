@@ -36,19 +36,23 @@
 MySQLConnection::MySQLConnection(MySQLConnectionInfo& connInfo) :
 m_reconnecting(false),
 m_prepareError(false),
+m_reconnectCount(0),
 m_queue(NULL),
 m_worker(NULL),
 m_Mysql(NULL),
 m_connectionInfo(connInfo),
-m_connectionFlags(CONNECTION_SYNCH) { }
+m_connectionFlags(CONNECTION_SYNCH),
+m_prepareMode(PREPARE_ALL) { }
 
-MySQLConnection::MySQLConnection(ACE_Activation_Queue* queue, MySQLConnectionInfo& connInfo) :
+MySQLConnection::MySQLConnection(DatabaseWorkerQueue* queue, MySQLConnectionInfo& connInfo) :
 m_reconnecting(false),
 m_prepareError(false),
+m_reconnectCount(0),
 m_queue(queue),
 m_Mysql(NULL),
 m_connectionInfo(connInfo),
-m_connectionFlags(CONNECTION_ASYNC)
+m_connectionFlags(CONNECTION_ASYNC),
+m_prepareMode(PREPARE_ALL)
 {
     m_worker = new DatabaseWorker(m_queue, this);
 }
@@ -147,6 +151,11 @@ bool MySQLConnection::Open()
 bool MySQLConnection::PrepareStatements()
 {
     DoPrepareStatements();
+
+    TRINITY_GUARD(ACE_Thread_Mutex, m_statsLock);
+    if (m_stmtStats.size() != m_stmts.size())
+        m_stmtStats.resize(m_stmts.size());
+
     return !m_prepareError;
 }
 
@@ -195,6 +204,7 @@ bool MySQLConnection::Execute(PreparedStatement* stmt)
         MYSQL_BIND* msql_BIND = m_mStmt->GetBind();
 
         uint32 _s = getMSTime();
+        ACE_Time_Value start = ACE_OS::gettimeofday();
 
         if (mysql_stmt_bind_param(msql_STMT, msql_BIND))
         {
@@ -220,6 +230,7 @@ bool MySQLConnection::Execute(PreparedStatement* stmt)
             return false;
         }
 
+        _RecordStatementExecution(index, start);
         TC_LOG_DEBUG("sql.sql", "[%u ms] SQL(p): %s", getMSTimeDiff(_s, getMSTime()), m_mStmt->getQueryString(m_queries[index].first).c_str());
 
         m_mStmt->ClearParameters();
@@ -245,6 +256,7 @@ bool MySQLConnection::_Query(PreparedStatement* stmt, MYSQL_RES **pResult, uint6
         MYSQL_BIND* msql_BIND = m_mStmt->GetBind();
 
         uint32 _s = getMSTime();
+        ACE_Time_Value start = ACE_OS::gettimeofday();
 
         if (mysql_stmt_bind_param(msql_STMT, msql_BIND))
         {
@@ -271,6 +283,7 @@ bool MySQLConnection::_Query(PreparedStatement* stmt, MYSQL_RES **pResult, uint6
             return false;
         }
 
+        _RecordStatementExecution(index, start);
         TC_LOG_DEBUG("sql.sql", "[%u ms] SQL(p): %s", getMSTimeDiff(_s, getMSTime()), m_mStmt->getQueryString(m_queries[index].first).c_str());
 
         m_mStmt->ClearParameters();
@@ -410,6 +423,14 @@ MySQLPreparedStatement* MySQLConnection::GetPreparedStatement(uint32 index)
 {
     ASSERT(index < m_stmts.size());
     MySQLPreparedStatement* ret = m_stmts[index];
+    if (!ret && m_prepareMode != PREPARE_ALL)
+    {
+        //! Not prepared yet, do it now if the statement belongs on this connection type
+        PreparedStatementMap::const_iterator itr = m_queries.find(index);
+        if (itr != m_queries.end() && (m_connectionFlags & itr->second.second))
+            ret = m_stmts[index] = _PrepareStatement(index, itr->second.first.c_str());
+    }
+
     if (!ret)
         TC_LOG_ERROR("sql.sql", "Could not fetch prepared statement %u on database `%s`, connection type: %s.",
             index, m_connectionInfo.database.c_str(), (m_connectionFlags & CONNECTION_ASYNC) ? "asynchronous" : "synchronous");
@@ -419,7 +440,10 @@ MySQLPreparedStatement* MySQLConnection::GetPreparedStatement(uint32 index)
 
 void MySQLConnection::PrepareStatement(uint32 index, const char* sql, ConnectionFlags flags)
 {
-    m_queries.insert(PreparedStatementMap::value_type(index, std::make_pair(sql, flags)));
+    {
+        TRINITY_GUARD(ACE_Thread_Mutex, m_statsLock);
+        m_queries.insert(PreparedStatementMap::value_type(index, std::make_pair(sql, flags)));
+    }
 
     // For reconnection case
     if (m_reconnecting)
@@ -434,28 +458,74 @@ void MySQLConnection::PrepareStatement(uint32 index, const char* sql, Connection
         return;
     }
 
+    // Cold statements are prepared by GetPreparedStatement on first use
+    if (m_prepareMode == PREPARE_LAZY || (m_prepareMode == PREPARE_HOT && !(flags & CONNECTION_ASYNC)))
+    {
+        m_stmts[index] = NULL;
+        return;
+    }
+
+    m_stmts[index] = _PrepareStatement(index, sql);
+    if (!m_stmts[index])
+        m_prepareError = true;
+}
+
+MySQLPreparedStatement* MySQLConnection::_PrepareStatement(uint32 index, const char* sql)
+{
     MYSQL_STMT* stmt = mysql_stmt_init(m_Mysql);
     if (!stmt)
     {
         TC_LOG_ERROR("sql.sql", "In mysql_stmt_init() id: %u, sql: \"%s\"", index, sql);
         TC_LOG_ERROR("sql.sql", "%s", mysql_error(m_Mysql));
-        m_prepareError = true;
+        return NULL;
     }
-    else
+
+    if (mysql_stmt_prepare(stmt, sql, static_cast<unsigned long>(strlen(sql))))
     {
-        if (mysql_stmt_prepare(stmt, sql, static_cast<unsigned long>(strlen(sql))))
-        {
-            TC_LOG_ERROR("sql.sql", "In mysql_stmt_prepare() id: %u, sql: \"%s\"", index, sql);
-            TC_LOG_ERROR("sql.sql", "%s", mysql_stmt_error(stmt));
-            mysql_stmt_close(stmt);
-            m_prepareError = true;
-        }
-        else
-        {
-            MySQLPreparedStatement* mStmt = new MySQLPreparedStatement(stmt);
-            m_stmts[index] = mStmt;
-        }
+        TC_LOG_ERROR("sql.sql", "In mysql_stmt_prepare() id: %u, sql: \"%s\"", index, sql);
+        TC_LOG_ERROR("sql.sql", "%s", mysql_stmt_error(stmt));
+        mysql_stmt_close(stmt);
+        return NULL;
     }
+
+    return new MySQLPreparedStatement(stmt);
+}
+
+void MySQLConnection::_RecordStatementExecution(uint32 index, ACE_Time_Value const& start)
+{
+    ACE_UINT64 elapsed;
+    (ACE_OS::gettimeofday() - start).to_usec(elapsed);
+
+    TRINITY_GUARD(ACE_Thread_Mutex, m_statsLock);
+    if (index >= m_stmtStats.size())
+        return;
+
+    PreparedStatementStats& stats = m_stmtStats[index];
+    ++stats.executions;
+    stats.totalTime += elapsed;
+    if (elapsed > stats.maxTime)
+        stats.maxTime = elapsed;
+}
+
+void MySQLConnection::AddStatementStats(std::vector<PreparedStatementStats>& stats)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_statsLock);
+    if (stats.size() < m_stmtStats.size())
+        stats.resize(m_stmtStats.size());
+
+    for (size_t i = 0; i < m_stmtStats.size(); ++i)
+    {
+        stats[i].executions += m_stmtStats[i].executions;
+        stats[i].totalTime += m_stmtStats[i].totalTime;
+        stats[i].maxTime = std::max(stats[i].maxTime, m_stmtStats[i].maxTime);
+    }
+}
+
+std::string MySQLConnection::GetStatementQuery(uint32 index)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, m_statsLock);
+    PreparedStatementMap::const_iterator itr = m_queries.find(index);
+    return itr != m_queries.end() ? itr->second.first : std::string();
 }
 
 PreparedResultSet* MySQLConnection::Query(PreparedStatement* stmt)
@@ -495,6 +565,7 @@ bool MySQLConnection::_HandleMySQLErrno(uint32 errNo)
                             (m_connectionFlags & CONNECTION_ASYNC) ? "asynchronous" : "synchronous");
 
                 m_reconnecting = false;
+                ++m_reconnectCount;
                 return true;
             }
 
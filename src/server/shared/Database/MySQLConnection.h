@@ -15,8 +15,6 @@
  * with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <ace/Activation_Queue.h>
-
 #include "DatabaseWorkerPool.h"
 #include "Transaction.h"
 #include "Util.h"
@@ -25,6 +23,7 @@
 #define _MYSQLCONNECTION_H
 
 class DatabaseWorker;
+class DatabaseWorkerQueue;
 class PreparedStatement;
 class MySQLPreparedStatement;
 class PingOperation;
@@ -36,6 +35,24 @@ enum ConnectionFlags
     CONNECTION_BOTH = CONNECTION_ASYNC | CONNECTION_SYNCH
 };
 
+enum PrepareMode
+{
+    PREPARE_ALL,    //! Prepare every statement of the connection type when connecting
+    PREPARE_LAZY,   //! Prepare statements on first use
+    PREPARE_HOT,    //! Prepare asynchronous statements (the save path) when connecting, everything else on first use
+    MAX_PREPARE_MODE
+};
+
+//! Execution statistics of one prepared statement on one connection
+struct PreparedStatementStats
+{
+    PreparedStatementStats() : executions(0), totalTime(0), maxTime(0) { }
+
+    uint64 executions;
+    uint64 totalTime;   //! Microseconds spent in mysql_stmt_execute
+    uint64 maxTime;     //! Slowest single execution in microseconds
+};
+
 struct MySQLConnectionInfo
 {
     MySQLConnectionInfo() { }
@@ -71,7 +88,7 @@ class MySQLConnection
 
     public:
         MySQLConnection(MySQLConnectionInfo& connInfo);                               //! Constructor for synchronous connections.
-        MySQLConnection(ACE_Activation_Queue* queue, MySQLConnectionInfo& connInfo);  //! Constructor for asynchronous connections.
+        MySQLConnection(DatabaseWorkerQueue* queue, MySQLConnectionInfo& connInfo);   //! Constructor for asynchronous connections.
         virtual ~MySQLConnection();
 
         virtual bool Open();
@@ -94,6 +111,12 @@ class MySQLConnection
         void Ping() { mysql_ping(m_Mysql); }
 
         uint32 GetLastError() { return mysql_errno(m_Mysql); }
+        uint32 GetReconnectCount() const { return m_reconnectCount; }
+
+        //! Adds this connection's per statement statistics to stats, which is indexed by statement id.
+        void AddStatementStats(std::vector<PreparedStatementStats>& stats);
+        //! Returns the SQL of a prepared statement, or an empty string if it is not registered. Safe to call from any thread.
+        std::string GetStatementQuery(uint32 index);
 
     protected:
         bool LockIfReady()
@@ -112,6 +135,7 @@ class MySQLConnection
         MYSQL* GetHandle()  { return m_Mysql; }
         MySQLPreparedStatement* GetPreparedStatement(uint32 index);
         void PrepareStatement(uint32 index, const char* sql, ConnectionFlags flags);
+        void SetPrepareMode(PrepareMode mode) { m_prepareMode = mode; }
 
         bool PrepareStatements();
         virtual void DoPrepareStatements() = 0;
@@ -121,17 +145,23 @@ class MySQLConnection
         PreparedStatementMap                 m_queries;       //! Query storage
         bool                                 m_reconnecting;  //! Are we reconnecting?
         bool                                 m_prepareError;  //! Was there any error while preparing statements?
+        uint32                               m_reconnectCount; //! Successful reconnects, lets callers notice a lost session
 
     private:
         bool _HandleMySQLErrno(uint32 errNo);
+        MySQLPreparedStatement* _PrepareStatement(uint32 index, const char* sql);
+        void _RecordStatementExecution(uint32 index, ACE_Time_Value const& start);
 
     private:
-        ACE_Activation_Queue* m_queue;                      //! Queue shared with other asynchronous connections.
+        DatabaseWorkerQueue*  m_queue;                      //! Queue shared with other asynchronous connections.
         DatabaseWorker*       m_worker;                     //! Core worker task.
         MYSQL *               m_Mysql;                      //! MySQL Handle.
         MySQLConnectionInfo&  m_connectionInfo;             //! Connection info (used for logging)
         ConnectionFlags       m_connectionFlags;            //! Connection flags (for preparing relevant statements)
         ACE_Thread_Mutex      m_Mutex;
+        PrepareMode           m_prepareMode;                //! When statements are prepared on the MySQL server
+        std::vector<PreparedStatementStats> m_stmtStats;    //! Indexed by statement id
+        ACE_Thread_Mutex      m_statsLock;                  //! Guards m_stmtStats and inserts into m_queries against concurrent readers
 };
 
 #endif
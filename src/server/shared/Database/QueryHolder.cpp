@@ -178,7 +178,8 @@ bool SQLQueryHolderTask::Execute()
     /// we can do this, we are friends
     std::vector<SQLQueryHolder::SQLResultPair> &queries = m_holder->m_queries;
 
-    for (size_t i = 0; i < queries.size(); i++)
+    /// every slice owns a disjoint index range, so no locking is needed on the result slots
+    for (size_t i = m_begin; i < m_end && i < queries.size(); i++)
     {
         /// execute all queries in the holder and pass the results
         if (SQLElementData* data = &queries[i].first)
@@ -203,6 +204,16 @@ bool SQLQueryHolderTask::Execute()
         }
     }
 
+    /// split holder: only the last slice to finish may hand the holder back
+    if (m_pendingSlices)
+    {
+        if (--(*m_pendingSlices) != 0)
+            return true;
+
+        delete m_pendingSlices;
+        m_pendingSlices = NULL;
+    }
+
     m_result.set(m_holder);
     return true;
 }
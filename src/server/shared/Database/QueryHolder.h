@@ -19,6 +19,7 @@
 #define _QUERYHOLDER_H
 
 #include <ace/Future.h>
+#include <ace/Atomic_Op.h>
 
 class SQLQueryHolder
 {
@@ -33,6 +34,7 @@ class SQLQueryHolder
         bool SetPQuery(size_t index, const char *format, ...) ATTR_PRINTF(3, 4);
         bool SetPreparedQuery(size_t index, PreparedStatement* stmt);
         void SetSize(size_t size);
+        size_t GetSize() const { return m_queries.size(); }
         QueryResult GetResult(size_t index);
         PreparedQueryResult GetPreparedResult(size_t index);
         void SetResult(size_t index, ResultSet* result);
@@ -41,15 +43,23 @@ class SQLQueryHolder
 
 typedef ACE_Future<SQLQueryHolder*> QueryResultHolderFuture;
 
+typedef ACE_Atomic_Op<ACE_Thread_Mutex, uint32> SQLQueryHolderSliceCounter;
+
 class SQLQueryHolderTask : public SQLOperation
 {
     private:
         SQLQueryHolder * m_holder;
         QueryResultHolderFuture m_result;
+        size_t m_begin;                                 //! First query index executed by this task
+        size_t m_end;                                   //! One past the last query index executed by this task
+        SQLQueryHolderSliceCounter* m_pendingSlices;    //! Shared by all slices of a split holder, NULL if not split
 
     public:
         SQLQueryHolderTask(SQLQueryHolder *holder, QueryResultHolderFuture res)
-            : m_holder(holder), m_result(res){ };
+            : m_holder(holder), m_result(res), m_begin(0), m_end(holder ? holder->GetSize() : 0), m_pendingSlices(NULL) { };
+        //! Executes only queries [begin, end) of the holder. The last slice to finish publishes the holder to the future.
+        SQLQueryHolderTask(SQLQueryHolder *holder, QueryResultHolderFuture res, size_t begin, size_t end, SQLQueryHolderSliceCounter* pendingSlices)
+            : m_holder(holder), m_result(res), m_begin(begin), m_end(end), m_pendingSlices(pendingSlices) { };
         bool Execute();
 
 };
@@ -67,6 +67,8 @@ class SQLOperation : public ACE_Method_Request
         }
         virtual bool Execute() = 0;
         virtual void SetConnection(MySQLConnection* con) { m_conn = con; }
+        //! One-way operations that may be grouped with their neighbours into a single transaction by the worker
+        virtual bool IsBatchable() const { return false; }
 
         MySQLConnection* m_conn;
 };
@@ -23,11 +23,30 @@
 
 namespace Trinity {
 
+static CrashHandler crashHandler = NULL;
+static volatile bool crashHandled = false;
+
+void SetCrashHandler(CrashHandler handler)
+{
+    crashHandler = handler;
+}
+
+void OnCrash()
+{
+    if (crashHandled)
+        return;
+
+    crashHandled = true;
+    if (crashHandler)
+        crashHandler();
+}
+
 void Assert(char const* file, int line, char const* function, char const* message)
 {
     ACE_Stack_Trace st;
     fprintf(stderr, "\n%s:%i in %s ASSERTION FAILED:\n  %s\n%s\n",
             file, line, function, message, st.c_str());
+    OnCrash();
     *((volatile int*)NULL) = 0;
     exit(1);
 }
@@ -37,6 +56,7 @@ void Fatal(char const* file, int line, char const* function, char const* message
     fprintf(stderr, "\n%s:%i in %s FATAL ERROR:\n  %s\n",
                    file, line, function, message);
     ACE_OS::sleep(10);
+    OnCrash();
     *((volatile int*)NULL) = 0;
     exit(1);
 }
@@ -45,6 +65,7 @@ void Error(char const* file, int line, char const* function, char const* message
 {
     fprintf(stderr, "\n%s:%i in %s ERROR:\n  %s\n",
                    file, line, function, message);
+    OnCrash();
     *((volatile int*)NULL) = 0;
     exit(1);
 }
@@ -31,6 +31,12 @@ namespace Trinity
 
     void Warning(char const* file, int line, char const* function, char const* message);
 
+    typedef void (*CrashHandler)();
+
+    // Registers a function that is called once when the process crashes, before it terminates
+    void SetCrashHandler(CrashHandler handler);
+    void OnCrash();
+
 } // namespace Trinity
 
 #define WPAssert(cond) do { if (!(cond)) Trinity::Assert(__FILE__, __LINE__, __FUNCTION__, #cond); } while (0)
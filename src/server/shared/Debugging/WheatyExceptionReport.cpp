@@ -20,6 +20,7 @@
 #include "WheatyExceptionReport.h"
 
 #include "Common.h"
+#include "Errors.h"
 #include "SystemConfig.h"
 #include "revision.h"
 
@@ -95,6 +96,8 @@ WheatyExceptionReport::~WheatyExceptionReport()
 LONG WINAPI WheatyExceptionReport::WheatyUnhandledExceptionFilter(
 PEXCEPTION_POINTERS pExceptionInfo)
 {
+    Trinity::OnCrash();
+
     TCHAR module_folder_name[MAX_PATH];
     GetModuleFileName(0, module_folder_name, MAX_PATH);
     TCHAR* pos = _tcsrchr(module_folder_name, '\\');
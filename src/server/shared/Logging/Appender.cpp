@@ -33,7 +33,7 @@ std::string LogMessage::getTimeStr()
 }
 
 Appender::Appender(uint8 _id, std::string const& _name, AppenderType _type /* = APPENDER_NONE*/, LogLevel _level /* = LOG_LEVEL_DISABLED */, AppenderFlags _flags /* = APPENDER_FLAGS_NONE */):
-id(_id), name(_name), type(_type), level(_level), flags(_flags) { }
+id(_id), name(_name), type(_type), level(_level), flags(_flags), buffered(false) { }
 
 Appender::~Appender() { }
 
@@ -67,6 +67,16 @@ void Appender::setLogLevel(LogLevel _level)
     level = _level;
 }
 
+void Appender::setBuffered(bool _buffered)
+{
+    buffered = _buffered;
+}
+
+bool Appender::isBuffered() const
+{
+    return buffered;
+}
+
 void Appender::write(LogMessage& message)
 {
     if (!level || level > message.level)
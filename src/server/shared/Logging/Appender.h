@@ -93,6 +93,11 @@ class Appender
 
         void setLogLevel(LogLevel);
         void write(LogMessage& message);
+        //! Writes out anything the appender buffered, called by the asynchronous log worker once per batch
+        virtual void flush() { }
+        //! Buffered appenders rely on flush instead of writing out every message right away
+        void setBuffered(bool buffered);
+        bool isBuffered() const;
         static const char* getLogLevelString(LogLevel level);
 
     private:
@@ -103,6 +108,7 @@ class Appender
         AppenderType type;
         LogLevel level;
         AppenderFlags flags;
+        bool buffered;
 };
 
 typedef UNORDERED_MAP<uint8, Appender*> AppenderMap;
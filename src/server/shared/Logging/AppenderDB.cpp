@@ -35,7 +35,8 @@ void AppenderDB::_write(LogMessage const& message)
     stmt->setString(2, message.type);
     stmt->setUInt8(3, uint8(message.level));
     stmt->setString(4, message.text);
-    LoginDatabase.Execute(stmt);
+    // Nothing reads the log table back, so it can yield to gameplay traffic
+    LoginDatabase.Execute(stmt, SQL_PRIORITY_BULK);
 }
 
 void AppenderDB::setRealmId(uint32 _realmId)
@@ -55,13 +55,21 @@ void AppenderFile::_write(LogMessage const& message)
         return;
 
     fprintf(logfile, "%s%s", message.prefix.c_str(), message.text.c_str());
-    fflush(logfile);
+    if (!isBuffered())
+        fflush(logfile);
     fileSize += uint64(message.Size());
 
     if (dynamicName)
         CloseFile();
 }
 
+void AppenderFile::flush()
+{
+    // Dynamic name files are closed, and so flushed, after every message
+    if (logfile)
+        fflush(logfile);
+}
+
 FILE* AppenderFile::OpenFile(std::string const &filename, std::string const &mode, bool backup)
 {
     std::string fullName(logDir + filename);
@@ -27,6 +27,7 @@ class AppenderFile: public Appender
         AppenderFile(uint8 _id, std::string const& _name, LogLevel level, const char* filename, const char* logDir, const char* mode, AppenderFlags flags, uint64 maxSize);
         ~AppenderFile();
         FILE* OpenFile(std::string const& _name, std::string const& _mode, bool _backup);
+        void flush();
 
     private:
         void CloseFile();
@@ -22,7 +22,6 @@
 #include "AppenderConsole.h"
 #include "AppenderFile.h"
 #include "AppenderDB.h"
-#include "LogOperation.h"
 
 #include <cstdarg>
 #include <cstdio>
@@ -260,7 +259,22 @@ void Log::ReadLoggersFromConfig()
 void Log::vlog(std::string const& filter, LogLevel level, char const* str, va_list argptr)
 {
     char text[MAX_QUERY_LEN];
-    vsnprintf(text, MAX_QUERY_LEN, str, argptr);
+    int length = vsnprintf(text, MAX_QUERY_LEN, str, argptr);
+
+    // Formatted here and not on the writer thread: argptr is only valid until we return and %s arguments
+    // are mostly c_str() of temporaries, keeping them would mean copying every string argument, which
+    // needs the format parsed anyway. The text is copied into the calling thread's ring, no message is allocated.
+    if (worker)
+    {
+        if (length < 0)
+            length = 0;
+        else if (length >= MAX_QUERY_LEN)
+            length = MAX_QUERY_LEN - 1;
+
+        worker->enqueue(GetLoggerByType(filter), level, filter, text, length);
+        return;
+    }
+
     write(new LogMessage(level, filter, text));
 }
 
@@ -270,7 +284,7 @@ void Log::write(LogMessage* msg) const
     msg->text.append("\n");
 
     if (worker)
-        worker->enqueue(new LogOperation(logger, msg));
+        worker->enqueue(logger, msg);
     else
     {
         logger->write(*msg);
@@ -444,9 +458,6 @@ void Log::LoadFromConfig()
 {
     Close();
 
-    if (sConfigMgr->GetBoolDefault("Log.Async.Enable", false))
-        worker = new LogWorker();
-
     AppenderId = 0;
     m_logsDir = sConfigMgr->GetStringDefault("LogsDir", "");
     if (!m_logsDir.empty())
@@ -454,4 +465,18 @@ void Log::LoadFromConfig()
             m_logsDir.push_back('/');
     ReadAppendersFromConfig();
     ReadLoggersFromConfig();
+
+    // Started once the loggers exist, drop reports are written straight to the server logger
+    if (sConfigMgr->GetBoolDefault("Log.Async.Enable", false))
+    {
+        uint32 ringSize = sConfigMgr->GetIntDefault("Log.Async.RingSize", 65536);
+        uint32 policy = sConfigMgr->GetIntDefault("Log.Async.OverflowPolicy", LOG_OVERFLOW_BLOCK);
+        if (policy >= MAX_LOG_OVERFLOW_POLICY)
+            policy = LOG_OVERFLOW_BLOCK;
+
+        for (AppenderMap::iterator it = appenders.begin(); it != appenders.end(); ++it)
+            it->second->setBuffered(true);
+
+        worker = new LogWorker(GetLoggerByType("server"), ringSize, LogOverflowPolicy(policy), sConfigMgr->GetIntDefault("Log.Async.SampleRate", 10));
+    }
 }
@@ -16,35 +16,365 @@
  */
 
 #include "LogWorker.h"
+#include "Logger.h"
+#include "Common.h"
+#include "Timer.h"
 
-LogWorker::LogWorker()
-    : m_queue(HIGH_WATERMARK, LOW_WATERMARK)
+#include <ace/Guard_T.h>
+#include <ace/TSS_T.h>
+#include <ace/OS_NS_unistd.h>
+#include <algorithm>
+
+enum
+{
+    LOG_RING_MIN_SIZE        = 4 * 1024,
+    LOG_DROP_REPORT_INTERVAL = 10 * IN_MILLISECONDS
+};
+
+typedef ACE_Atomic_Op<ACE_Thread_Mutex, long> LogRingIndex;
+
+//! Start of every record in a ring, followed by the type and the text without terminators.
+//! A record without logger and message only pads the rest of the buffer so the next record starts at its beginning.
+struct LogRecordHeader
+{
+    Logger const* logger;
+    LogMessage* message;                //! Set instead of inline type and text for messages that do not fit
+    time_t mtime;
+    uint32 size;                        //! Whole record including header and alignment
+    uint32 textLength;
+    uint16 typeLength;
+    uint8 level;
+};
+
+//! Records start at multiples of this, so a header can always be read in place
+#define LOG_RECORD_ALIGN 8
+#define LOG_RECORD_HEADER_SIZE ((sizeof(LogRecordHeader) + LOG_RECORD_ALIGN - 1) & ~size_t(LOG_RECORD_ALIGN - 1))
+
+//! Single producer single consumer ring of variable length records. head is only advanced by the owning
+//! thread and tail only by the writer, both after the record itself was written or read. The indexes
+//! count bytes, only grow and wrap around as unsigned values, size is a power of two so the buffer
+//! offset stays continuous across the wrap. A record never wraps, if less than a header fits before
+//! the end of the buffer both sides skip to its beginning, otherwise the writer leaves a padding record.
+struct LogRing
+{
+    LogRing(uint32 _size) : buffer(new char[_size]), size(_size), head(0), tail(0), closed(0), reserved(0), sampleCounter(0), next(NULL) { }
+    ~LogRing() { delete[] buffer; }
+
+    LogRecordHeader* At(unsigned long index) { return reinterpret_cast<LogRecordHeader*>(buffer + (index & (size - 1))); }
+    //! Bytes left before the end of the buffer at index
+    uint32 Contiguous(unsigned long index) const { return size - uint32(index & (size - 1)); }
+
+    char* buffer;
+    uint32 size;
+    LogRingIndex head;
+    LogRingIndex tail;
+    LogRingIndex closed;                //! 1 once the owning thread exited, 2 once the writer drained it and may delete it
+    unsigned long reserved;             //! End of the record handed out by the last Reserve, only used by the owning thread
+    uint32 sampleCounter;               //! Only used by the owning thread
+    LogRing* next;
+};
+
+struct LogRingHolder
+{
+    LogRingHolder() : ring(NULL) { }
+    ~LogRingHolder()
+    {
+        if (ring)
+            ring->closed = 1;
+    }
+
+    LogRing* ring;
+};
+
+//! Rings outlive the worker, a thread keeps its ring across log reloads.
+//! LogRingLock only guards the list itself, rings are only ever unlinked and deleted by the writer.
+static ACE_Thread_Mutex LogRingLock;
+static LogRing* LogRings = NULL;
+static ACE_TSS<LogRingHolder> LogRingHolders;
+
+static LogRingIndex LogDropped(0);
+static LogRingIndex LogSampledOut(0);
+
+static uint32 RoundUpToPowerOfTwo(uint32 value)
+{
+    uint32 result = LOG_RING_MIN_SIZE;
+    while (result < value && result < 0x40000000)
+        result <<= 1;
+    return result;
+}
+
+static uint32 AlignRecord(size_t size)
+{
+    return uint32((size + LOG_RECORD_ALIGN - 1) & ~size_t(LOG_RECORD_ALIGN - 1));
+}
+
+LogWorker::LogWorker(Logger const* reportLogger, uint32 ringSize, LogOverflowPolicy policy, uint32 sampleRate) :
+_reportLogger(reportLogger), _ringSize(RoundUpToPowerOfTwo(ringSize)), _policy(policy), _sampleRate(std::max<uint32>(sampleRate, 1)),
+_stop(0), _reportedDropped(LogDropped.value()), _reportedSampledOut(LogSampledOut.value()), _lastReportTime(getMSTime()),
+_message(LOG_LEVEL_DISABLED, "", "")
 {
     ACE_Task_Base::activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, 1);
 }
 
 LogWorker::~LogWorker()
 {
-    m_queue.deactivate();
+    //! svc drains every ring once more after seeing the stop flag
+    _stop = 1;
     wait();
 }
 
-int LogWorker::enqueue(LogOperation* op)
+void LogWorker::enqueue(Logger const* logger, LogLevel level, std::string const& type, char const* text, size_t length)
 {
-    return m_queue.enqueue(op);
+    //! Anything above a quarter of the calling thread's ring goes through the heap, so a record always fits once the
+    //! ring is drained. Rings keep the size they were created with, a reload only affects threads that start logging later.
+    size_t size = LOG_RECORD_HEADER_SIZE + type.size() + length;
+    if (type.size() > 0xFFFF || size > GetRing()->size / 4)
+    {
+        LogMessage* msg = new LogMessage(level, type, std::string(text, length));
+        msg->text.append("\n");
+        enqueue(logger, msg);
+        return;
+    }
+
+    LogRecordHeader* record = Reserve(level, AlignRecord(size));
+    if (!record)
+        return;
+
+    record->logger = logger;
+    record->message = NULL;
+    record->mtime = time(NULL);
+    record->textLength = uint32(length);
+    record->typeLength = uint16(type.size());
+    record->level = uint8(level);
+
+    char* data = reinterpret_cast<char*>(record) + LOG_RECORD_HEADER_SIZE;
+    memcpy(data, type.c_str(), type.size());
+    memcpy(data + type.size(), text, length);
+    Commit();
+}
+
+void LogWorker::enqueue(Logger const* logger, LogMessage* msg)
+{
+    LogRecordHeader* record = Reserve(msg->level, AlignRecord(LOG_RECORD_HEADER_SIZE));
+    if (!record)
+    {
+        delete msg;
+        return;
+    }
+
+    record->logger = logger;
+    record->message = msg;
+    Commit();
+}
+
+LogRing* LogWorker::GetRing()
+{
+    LogRing* ring = LogRingHolders->ring;
+    if (!ring)
+    {
+        ring = new LogRing(_ringSize);
+        LogRingHolders->ring = ring;
+
+        TRINITY_GUARD(ACE_Thread_Mutex, LogRingLock);
+        ring->next = LogRings;
+        LogRings = ring;
+    }
+
+    return ring;
+}
+
+LogRecordHeader* LogWorker::Reserve(LogLevel level, uint32 size)
+{
+    LogRing* ring = GetRing();
+
+    unsigned long head = ring->head.value();
+    if (_policy == LOG_OVERFLOW_SAMPLE && level < LOG_LEVEL_ERROR && head - (unsigned long)ring->tail.value() >= ring->size / 4 * 3)
+    {
+        if (++ring->sampleCounter % _sampleRate)
+        {
+            ++LogSampledOut;
+            return NULL;
+        }
+    }
+
+    //! A record that does not fit before the end of the buffer also needs the bytes skipped there
+    uint32 contiguous = ring->Contiguous(head);
+    uint32 needed = contiguous < size ? contiguous + size : size;
+
+    //! No logging in here, the writer may be busy with the very appender this thread would end up in
+    while (ring->size - (head - (unsigned long)ring->tail.value()) < needed)
+    {
+        if (_policy == LOG_OVERFLOW_DROP || (_policy == LOG_OVERFLOW_SAMPLE && level < LOG_LEVEL_ERROR) || _stop.value())
+        {
+            ++LogDropped;
+            return NULL;
+        }
+
+        ACE_OS::sleep(ACE_Time_Value(0, 1000));
+    }
+
+    if (contiguous < size)
+    {
+        //! The writer skips anything shorter than a header on its own, longer gaps get a padding record
+        if (contiguous >= LOG_RECORD_HEADER_SIZE)
+        {
+            LogRecordHeader* padding = ring->At(head);
+            padding->logger = NULL;
+            padding->message = NULL;
+            padding->size = contiguous;
+        }
+
+        //! Published together with the record itself by Commit
+        head += contiguous;
+    }
+
+    LogRecordHeader* record = ring->At(head);
+    record->size = size;
+    ring->reserved = head + size;
+    return record;
 }
 
+void LogWorker::Commit()
+{
+    //! The store is a full barrier, the writer never sees the new head before the record contents
+    LogRing* ring = LogRingHolders->ring;
+    ring->head = long(ring->reserved);
+}
 int LogWorker::svc()
 {
-    while (1)
+    while (!_stop.value())
     {
-        LogOperation* request;
-        if (m_queue.dequeue(request) == -1)
-            break;
+        if (!Drain())
+            ACE_OS::sleep(ACE_Time_Value(0, 5000));
 
-        request->call();
-        delete request;
+        if (GetMSTimeDiffToNow(_lastReportTime) >= LOG_DROP_REPORT_INTERVAL)
+            ReportDrops();
     }
 
+    Drain();
+    ReportDrops();
     return 0;
 }
+
+uint32 LogWorker::Drain()
+{
+    uint32 written = 0;
+
+    //! The lock is only held to copy the list, new rings are only ever prepended and only this thread removes any,
+    //! so appenders are written to without blocking threads that log for the first time
+    {
+        TRINITY_GUARD(ACE_Thread_Mutex, LogRingLock);
+        for (LogRing* ring = LogRings; ring; ring = ring->next)
+            _batchRings.push_back(ring);
+    }
+
+    bool finishedRings = false;
+    for (std::vector<LogRing*>::const_iterator itr = _batchRings.begin(); itr != _batchRings.end(); ++itr)
+    {
+        LogRing* ring = *itr;
+
+        //! Read closed before head, a thread that exited has published its last record by then
+        bool closed = ring->closed.value() != 0;
+        unsigned long head = ring->head.value();
+        unsigned long tail = ring->tail.value();
+
+        while (tail != head)
+        {
+            uint32 contiguous = ring->Contiguous(tail);
+            if (contiguous < LOG_RECORD_HEADER_SIZE)
+            {
+                tail += contiguous;
+                continue;
+            }
+
+            LogRecordHeader* record = ring->At(tail);
+            tail += record->size;
+
+            if (!record->logger)
+            {
+                delete record->message;
+                continue;
+            }
+
+            if (record->message)
+            {
+                record->logger->write(*record->message);
+                delete record->message;
+            }
+            else
+            {
+                char const* data = reinterpret_cast<char const*>(record) + LOG_RECORD_HEADER_SIZE;
+                _message.level = LogLevel(record->level);
+                _message.type.assign(data, record->typeLength);
+                _message.text.assign(data + record->typeLength, record->textLength);
+                _message.text.append("\n");
+                _message.mtime = record->mtime;
+                record->logger->write(_message);
+            }
+
+            if (std::find(_batchLoggers.begin(), _batchLoggers.end(), record->logger) == _batchLoggers.end())
+                _batchLoggers.push_back(record->logger);
+
+            ++written;
+        }
+
+        ring->tail = long(tail);
+
+        if (closed)
+        {
+            ring->closed = 2;
+            finishedRings = true;
+        }
+    }
+
+    _batchRings.clear();
+
+    if (finishedRings)
+    {
+        TRINITY_GUARD(ACE_Thread_Mutex, LogRingLock);
+
+        LogRing** link = &LogRings;
+        while (LogRing* ring = *link)
+        {
+            if (ring->closed.value() == 2)
+            {
+                *link = ring->next;
+                delete ring;
+            }
+            else
+                link = &ring->next;
+        }
+    }
+
+    //! One flush per logger and batch instead of one per message
+    for (std::vector<Logger const*>::const_iterator itr = _batchLoggers.begin(); itr != _batchLoggers.end(); ++itr)
+        (*itr)->flush();
+    _batchLoggers.clear();
+
+    return written;
+}
+
+void LogWorker::ReportDrops()
+{
+    _lastReportTime = getMSTime();
+
+    long dropped = LogDropped.value();
+    long sampledOut = LogSampledOut.value();
+    if (dropped == _reportedDropped && sampledOut == _reportedSampledOut)
+        return;
+
+    if (_reportLogger)
+    {
+        char text[256];
+        snprintf(text, sizeof(text), "Asynchronous logging could not keep up: %ld messages dropped and %ld messages sampled out since the last report\n",
+            dropped - _reportedDropped, sampledOut - _reportedSampledOut);
+
+        //! Written directly, going through a ring here could block on the writer itself
+        LogMessage msg(LOG_LEVEL_ERROR, "server", text);
+        _reportLogger->write(msg);
+        _reportLogger->flush();
+    }
+
+    _reportedDropped = dropped;
+    _reportedSampledOut = sampledOut;
+}
@@ -18,30 +18,68 @@
 #ifndef LOGWORKER_H
 #define LOGWORKER_H
 
-#include "LogOperation.h"
+#include "Appender.h"
 
 #include <ace/Task.h>
-#include <ace/Activation_Queue.h>
+#include <ace/Atomic_Op.h>
+#include <vector>
 
-class LogWorker: protected ACE_Task_Base
+class Logger;
+struct LogRecordHeader;
+struct LogRing;
+
+//! What a logging thread does when its ring is full
+enum LogOverflowPolicy
+{
+    LOG_OVERFLOW_DROP       = 0,    //! Discard the message
+    LOG_OVERFLOW_BLOCK      = 1,    //! Wait until the writer made room
+    LOG_OVERFLOW_SAMPLE     = 2,    //! Once the ring is three quarters full keep only one of every N messages
+                                    //! below error level, errors wait for room
+    MAX_LOG_OVERFLOW_POLICY
+};
+
+//! Single writer thread of asynchronous logging.
+//! Every logging thread owns a byte ring of variable length records that only it writes to and only
+//! the writer reads from, so logging never takes a lock. The writer drains all rings in batches and
+//! flushes the appenders once per batch instead of once per message.
+class LogWorker : protected ACE_Task_Base
 {
     public:
-        LogWorker();
+        LogWorker(Logger const* reportLogger, uint32 ringSize, LogOverflowPolicy policy, uint32 sampleRate);
+        //! Writes everything still queued before the writer thread stops
         ~LogWorker();
 
-        typedef ACE_Message_Queue_Ex<LogOperation, ACE_MT_SYNCH> LogMessageQueueType;
-
-        enum
-        {
-            HIGH_WATERMARK = 8 * 1024 * 1024,
-            LOW_WATERMARK  = 8 * 1024 * 1024
-        };
-
-        int enqueue(LogOperation *op);
+        //! Queues an already formatted message of the calling thread, text is copied
+        void enqueue(Logger const* logger, LogLevel level, std::string const& type, char const* text, size_t length);
+        //! Queues a complete message, for messages with parameters or too long for a ring record. Takes ownership of msg.
+        void enqueue(Logger const* logger, LogMessage* msg);
 
     private:
         virtual int svc();
-        LogMessageQueueType m_queue;
+
+        //! Returns the calling thread's ring, created with the current ring size on first use
+        LogRing* GetRing();
+        //! Returns room for a record of size bytes in the calling thread's ring, NULL if the message has to be discarded
+        LogRecordHeader* Reserve(LogLevel level, uint32 size);
+        //! Hands the record returned by the last Reserve of the calling thread to the writer
+        void Commit();
+
+        //! Writes all queued messages, returns how many were written
+        uint32 Drain();
+        //! Logs how many messages were discarded since the last report, directly through the report logger
+        void ReportDrops();
+
+        Logger const* _reportLogger;
+        uint32 _ringSize;                           //! Bytes per ring of threads that start logging
+        LogOverflowPolicy _policy;
+        uint32 _sampleRate;
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> _stop;
+        long _reportedDropped;
+        long _reportedSampledOut;
+        uint32 _lastReportTime;
+        LogMessage _message;                        //! Reused for every ring record, keeps its string buffers between batches
+        std::vector<LogRing*> _batchRings;          //! Rings drained in the current batch, copied from the list under LogRingLock
+        std::vector<Logger const*> _batchLoggers;   //! Loggers written to during the current batch, flushed at its end
 };
 
 #endif
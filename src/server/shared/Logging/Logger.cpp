@@ -74,3 +74,10 @@ void Logger::write(LogMessage& message) const
         if (it->second)
             it->second->write(message);
 }
+
+void Logger::flush() const
+{
+    for (AppenderMap::const_iterator it = appenders.begin(); it != appenders.end(); ++it)
+        if (it->second)
+            it->second->flush();
+}
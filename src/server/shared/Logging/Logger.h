@@ -34,6 +34,7 @@ class Logger
         LogLevel getLogLevel() const;
         void setLogLevel(LogLevel level);
         void write(LogMessage& message) const;
+        void flush() const;
 
     private:
         std::string name;
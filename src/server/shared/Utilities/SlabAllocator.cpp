@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Common.h"
+#include "SlabAllocator.h"
+
+enum SlabAllocatorLimits
+{
+    SLAB_ALIGNMENT      = 16,           // Matches what the global allocator guarantees
+    SLAB_TARGET_SIZE    = 64 * 1024,
+    SLAB_MIN_BLOCKS     = 16,
+    SLAB_CACHE_BATCH    = 32            // Blocks moved between a thread cache and the depot at once
+};
+
+SlabAllocator* SlabAllocator::_firstAllocator = NULL;
+
+SlabAllocator::SlabAllocator(char const* name, size_t objectSize) : _name(name), _objectSize(objectSize),
+_depot(NULL), _caches(NULL), _retiredLive(0), _retiredFallbacks(0), _peakObjects(0)
+{
+    _blockSize = (std::max(objectSize, sizeof(Block)) + SLAB_ALIGNMENT - 1) & ~size_t(SLAB_ALIGNMENT - 1);
+    _blocksPerSlab = std::max<size_t>(SLAB_TARGET_SIZE / _blockSize, SLAB_MIN_BLOCKS);
+
+    // Allocators are only created during static initialization, no other thread is running yet
+    _nextAllocator = _firstAllocator;
+    _firstAllocator = this;
+}
+
+SlabAllocator::ThreadCache::~ThreadCache()
+{
+    if (!allocator)
+        return;
+
+    TRINITY_GUARD(ACE_Thread_Mutex, allocator->_lock);
+
+    allocator->Trim(this, freeCount);
+    allocator->_retiredLive += allocated - released;
+    allocator->_retiredFallbacks += fallbacks;
+
+    for (ThreadCache** itr = &allocator->_caches; *itr; itr = &(*itr)->next)
+    {
+        if (*itr == this)
+        {
+            *itr = next;
+            break;
+        }
+    }
+}
+
+SlabAllocator::ThreadCache* SlabAllocator::GetCache()
+{
+    ThreadCache* cache = _threadCaches;
+    if (!cache->allocator)
+    {
+        TRINITY_GUARD(ACE_Thread_Mutex, _lock);
+        cache->allocator = this;
+        cache->next = _caches;
+        _caches = cache;
+    }
+
+    return cache;
+}
+
+void* SlabAllocator::Allocate(size_t size)
+{
+    ThreadCache* cache = GetCache();
+    if (size > _objectSize)
+    {
+        ++cache->fallbacks;
+        return ::operator new(size);
+    }
+
+    if (!cache->freeList)
+    {
+        TRINITY_GUARD(ACE_Thread_Mutex, _lock);
+        Refill(cache);
+    }
+
+    Block* block = cache->freeList;
+    cache->freeList = block->next;
+    --cache->freeCount;
+    ++cache->allocated;
+    return block;
+}
+
+void SlabAllocator::Deallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    if (size > _objectSize)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    ThreadCache* cache = GetCache();
+    Block* block = static_cast<Block*>(ptr);
+    block->next = cache->freeList;
+    cache->freeList = block;
+    ++cache->freeCount;
+    ++cache->released;
+
+    // Keep one batch cached so that alternating new/delete does not bounce blocks through the depot
+    if (cache->freeCount >= 2 * SLAB_CACHE_BATCH)
+    {
+        TRINITY_GUARD(ACE_Thread_Mutex, _lock);
+        Trim(cache, SLAB_CACHE_BATCH);
+    }
+}
+
+void SlabAllocator::Refill(ThreadCache* cache)
+{
+    for (uint32 i = 0; i < SLAB_CACHE_BATCH; ++i)
+    {
+        if (!_depot)
+            Grow();
+
+        Block* block = _depot;
+        _depot = block->next;
+        block->next = cache->freeList;
+        cache->freeList = block;
+        ++cache->freeCount;
+    }
+
+    _peakObjects = std::max(_peakObjects, CountLiveObjects());
+}
+
+void SlabAllocator::Trim(ThreadCache* cache, uint32 count)
+{
+    for (uint32 i = 0; i < count && cache->freeList; ++i)
+    {
+        Block* block = cache->freeList;
+        cache->freeList = block->next;
+        --cache->freeCount;
+        block->next = _depot;
+        _depot = block;
+    }
+
+    _peakObjects = std::max(_peakObjects, CountLiveObjects());
+}
+
+void SlabAllocator::Grow()
+{
+    // Make room first, so that a failing allocation cannot leak the slab
+    if (_slabs.size() == _slabs.capacity())
+        _slabs.reserve(_slabs.size() * 2 + 8);
+
+    char* slab = static_cast<char*>(::operator new(_blockSize * _blocksPerSlab));
+    _slabs.push_back(slab);
+
+    // Link backwards so that blocks are handed out in address order
+    for (size_t i = _blocksPerSlab; i > 0; --i)
+    {
+        Block* block = reinterpret_cast<Block*>(slab + (i - 1) * _blockSize);
+        block->next = _depot;
+        _depot = block;
+    }
+}
+
+bool SlabAllocator::Owns(void const* ptr)
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _lock);
+
+    char const* block = static_cast<char const*>(ptr);
+    size_t const slabSize = _blockSize * _blocksPerSlab;
+    for (std::vector<char*>::const_iterator itr = _slabs.begin(); itr != _slabs.end(); ++itr)
+        if (block >= *itr && block < *itr + slabSize)
+            return true;
+
+    return false;
+}
+
+uint32 SlabAllocator::CountLiveObjects() const
+{
+    uint32 live = _retiredLive;
+    for (ThreadCache const* cache = _caches; cache; cache = cache->next)
+        live += cache->allocated - cache->released;
+
+    return live;
+}
+
+SlabAllocatorStats SlabAllocator::GetStats()
+{
+    TRINITY_GUARD(ACE_Thread_Mutex, _lock);
+
+    SlabAllocatorStats stats;
+    stats.name = _name;
+    stats.blockSize = uint32(_blockSize);
+    stats.liveObjects = CountLiveObjects();
+    stats.peakObjects = _peakObjects = std::max(_peakObjects, stats.liveObjects);
+    stats.reservedBytes = uint64(_slabs.size()) * _blocksPerSlab * _blockSize;
+    stats.fallbacks = _retiredFallbacks;
+    for (ThreadCache const* cache = _caches; cache; cache = cache->next)
+        stats.fallbacks += cache->fallbacks;
+
+    return stats;
+}
+
+void SlabAllocator::GetAllStats(std::vector<SlabAllocatorStats>& stats)
+{
+    for (SlabAllocator* allocator = _firstAllocator; allocator; allocator = allocator->_nextAllocator)
+        stats.push_back(allocator->GetStats());
+}
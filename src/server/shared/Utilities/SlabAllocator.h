@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SLABALLOCATOR_H
+#define _SLABALLOCATOR_H
+
+#include <ace/Thread_Mutex.h>
+#include <ace/TSS_T.h>
+#include <new>
+#include <vector>
+
+#include "Define.h"
+
+struct SlabAllocatorStats
+{
+    SlabAllocatorStats() : name(NULL), blockSize(0), liveObjects(0), peakObjects(0), reservedBytes(0), fallbacks(0) { }
+
+    char const* name;
+    uint32 blockSize;       //! Bytes per object, after alignment
+    uint32 liveObjects;     //! Objects currently allocated from the slabs
+    uint32 peakObjects;     //! Highest live object count seen, sampled whenever a thread refills or trims its cache
+    uint64 reservedBytes;   //! Bytes held in slabs, free or in use
+    uint32 fallbacks;       //! Allocations of larger derived classes that were passed to the global allocator
+};
+
+//! Fixed size block allocator for the objects of one class.
+//! Every thread allocates from and frees into its own cache of blocks, so only refilling or
+//! trimming a cache takes the lock shared by all threads. A block freed by another thread than
+//! the one that allocated it simply moves to the freeing thread's cache.
+//! Slabs are never released; their blocks are only ever reused for the same class, which keeps
+//! short lived objects from fragmenting the heap of long running processes.
+class SlabAllocator
+{
+    public:
+        SlabAllocator(char const* name, size_t objectSize);
+
+        void* Allocate(size_t size);
+        void Deallocate(void* ptr, size_t size);
+
+        //! Whether the block lies in one of the slabs. Takes the lock and walks all slabs,
+        //! only meant for the rare frees that do not know the size of the object.
+        bool Owns(void const* ptr);
+
+        SlabAllocatorStats GetStats();
+
+        //! Appends the statistics of every allocator of the process.
+        static void GetAllStats(std::vector<SlabAllocatorStats>& stats);
+
+    private:
+        struct Block
+        {
+            Block* next;
+        };
+
+        struct ThreadCache
+        {
+            ThreadCache() : allocator(NULL), next(NULL), freeList(NULL), freeCount(0), allocated(0), released(0), fallbacks(0) { }
+            ~ThreadCache();
+
+            SlabAllocator* allocator;
+            ThreadCache* next;          //! Next cache of the same allocator
+            Block* freeList;
+            uint32 freeCount;
+            //! Only written by the owning thread, GetStats reads them without synchronization.
+            //! Objects freed by another thread make the difference negative for one cache, the sum over all caches stays exact.
+            uint32 allocated;
+            uint32 released;
+            uint32 fallbacks;
+        };
+
+        SlabAllocator(SlabAllocator const&);
+        SlabAllocator& operator=(SlabAllocator const&);
+
+        ThreadCache* GetCache();
+
+        //! The following must be called with _lock held
+        void Refill(ThreadCache* cache);
+        void Trim(ThreadCache* cache, uint32 count);
+        void Grow();
+        uint32 CountLiveObjects() const;
+
+        char const* _name;
+        size_t _objectSize;
+        size_t _blockSize;
+        size_t _blocksPerSlab;
+        ACE_TSS<ThreadCache> _threadCaches;
+
+        ACE_Thread_Mutex _lock;
+        Block* _depot;                  //! Free blocks shared by all threads
+        std::vector<char*> _slabs;
+        ThreadCache* _caches;           //! Caches of all threads that used this allocator
+        uint32 _retiredLive;            //! allocated - released of caches whose thread has exited
+        uint32 _retiredFallbacks;
+        uint32 _peakObjects;
+
+        SlabAllocator* _nextAllocator;
+        static SlabAllocator* _firstAllocator;
+};
+
+//! Routes new and delete of a class through its own slab allocator.
+//! Derived classes larger than the class itself fall back to the global allocator,
+//! the class needs a virtual destructor if such objects are deleted through a base pointer.
+#define DECLARE_SLAB_ALLOCATOR() \
+    static void* operator new(size_t size); \
+    static void* operator new(size_t size, std::nothrow_t const&) throw(); \
+    static void operator delete(void* ptr, size_t size); \
+    static void operator delete(void* ptr, std::nothrow_t const&) throw()
+
+//! Allocators are created during static initialization and intentionally never destroyed,
+//! objects may still be freed while the process exits.
+//! The nothrow delete is only called when a constructor throws and gets no size, so it asks the
+//! allocator whether the block came from a slab or from the global allocator (larger derived classes).
+#define DEFINE_SLAB_ALLOCATOR(CLASS) \
+    static SlabAllocator& CLASS##SlabAllocator = *new SlabAllocator(#CLASS, sizeof(CLASS)); \
+    void* CLASS::operator new(size_t size) { return CLASS##SlabAllocator.Allocate(size); } \
+    void* CLASS::operator new(size_t size, std::nothrow_t const&) throw() \
+    { \
+        try { return CLASS##SlabAllocator.Allocate(size); } \
+        catch (std::bad_alloc const&) { return NULL; } \
+    } \
+    void CLASS::operator delete(void* ptr, size_t size) { CLASS##SlabAllocator.Deallocate(ptr, size); } \
+    void CLASS::operator delete(void* ptr, std::nothrow_t const&) throw() \
+    { \
+        if (CLASS##SlabAllocator.Owns(ptr)) \
+            CLASS##SlabAllocator.Deallocate(ptr, sizeof(CLASS)); \
+        else \
+            ::operator delete(ptr); \
+    }
+
+#endif
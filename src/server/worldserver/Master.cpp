@@ -35,6 +35,7 @@
 #include "CliRunnable.h"
 #include "Log.h"
 #include "Master.h"
+#include "PacketLog.h"
 #include "RARunnable.h"
 #include "TCSoap.h"
 #include "Timer.h"
@@ -78,6 +79,16 @@ class WorldServerSignalHandler : public Trinity::SignalHandler
         }
 };
 
+#ifndef _WIN32
+/// Gives crash handlers a chance to run before the default action (core dump) of fatal signals
+static void CrashSignalHandler(int sigNum)
+{
+    Trinity::OnCrash();
+    signal(sigNum, SIG_DFL);
+    raise(sigNum);
+}
+#endif
+
 class FreezeDetectorRunnable : public ACE_Based::Runnable
 {
 private:
@@ -185,6 +196,19 @@ int Master::Run()
     handle.register_handler(SIGBREAK, &signalBREAK);
 #endif
 
+    ///- Write out captured packets when crashing
+    if (sPacketLog->IsCapturing())
+    {
+        sPacketLog->PrepareCrashFlush();
+        Trinity::SetCrashHandler(&PacketLog::FlushRingsOnCrash);
+#ifndef _WIN32
+        signal(SIGSEGV, &CrashSignalHandler);
+        signal(SIGABRT, &CrashSignalHandler);
+        signal(SIGFPE, &CrashSignalHandler);
+        signal(SIGBUS, &CrashSignalHandler);
+#endif
+    }
+
     ///- Launch WorldRunnable thread
     ACE_Based::Thread worldThread(new WorldRunnable);
     worldThread.setPriority(ACE_Based::Highest);
@@ -394,6 +418,13 @@ bool Master::_StartDB()
     std::string dbString;
     uint8 asyncThreads, synchThreads;
 
+    uint32 prepareMode = sConfigMgr->GetIntDefault("Database.PrepareMode", PREPARE_ALL);
+    if (prepareMode >= MAX_PREPARE_MODE)
+    {
+        TC_LOG_ERROR("server.worldserver", "Invalid Database.PrepareMode %u specified, preparing all statements at startup.", prepareMode);
+        prepareMode = PREPARE_ALL;
+    }
+
     dbString = sConfigMgr->GetStringDefault("WorldDatabaseInfo", "");
     if (dbString.empty())
     {
@@ -411,7 +442,7 @@ bool Master::_StartDB()
 
     synchThreads = uint8(sConfigMgr->GetIntDefault("WorldDatabase.SynchThreads", 1));
     ///- Initialize the world database
-    if (!WorldDatabase.Open(dbString, asyncThreads, synchThreads))
+    if (!WorldDatabase.Open(dbString, asyncThreads, synchThreads, PrepareMode(prepareMode)))
     {
         TC_LOG_ERROR("server.worldserver", "Cannot connect to world database %s", dbString.c_str());
         return false;
@@ -436,7 +467,7 @@ bool Master::_StartDB()
     synchThreads = uint8(sConfigMgr->GetIntDefault("CharacterDatabase.SynchThreads", 2));
 
     ///- Initialize the Character database
-    if (!CharacterDatabase.Open(dbString, asyncThreads, synchThreads))
+    if (!CharacterDatabase.Open(dbString, asyncThreads, synchThreads, PrepareMode(prepareMode)))
     {
         TC_LOG_ERROR("server.worldserver", "Cannot connect to Character database %s", dbString.c_str());
         return false;
@@ -460,12 +491,28 @@ bool Master::_StartDB()
 
     synchThreads = uint8(sConfigMgr->GetIntDefault("LoginDatabase.SynchThreads", 1));
     ///- Initialise the login database
-    if (!LoginDatabase.Open(dbString, asyncThreads, synchThreads))
+    if (!LoginDatabase.Open(dbString, asyncThreads, synchThreads, PrepareMode(prepareMode)))
     {
         TC_LOG_ERROR("server.worldserver", "Cannot connect to login database %s", dbString.c_str());
         return false;
     }
 
+    ///- Apply the asynchronous queue lane policy to all pools
+    uint32 interactiveWeight = sConfigMgr->GetIntDefault("Database.Queue.InteractiveWeight", 8);
+    uint32 normalWeight = sConfigMgr->GetIntDefault("Database.Queue.NormalWeight", 4);
+    uint32 bulkWeight = sConfigMgr->GetIntDefault("Database.Queue.BulkWeight", 1);
+    uint32 bulkQueueLimit = sConfigMgr->GetIntDefault("Database.Queue.BulkLimit", 5000);
+    uint32 bulkMaxDelay = sConfigMgr->GetIntDefault("Database.Queue.BulkMaxDelay", 50);
+    WorldDatabase.SetQueuePolicy(interactiveWeight, normalWeight, bulkWeight, bulkQueueLimit, bulkMaxDelay);
+    CharacterDatabase.SetQueuePolicy(interactiveWeight, normalWeight, bulkWeight, bulkQueueLimit, bulkMaxDelay);
+    LoginDatabase.SetQueuePolicy(interactiveWeight, normalWeight, bulkWeight, bulkQueueLimit, bulkMaxDelay);
+
+    ///- One-way statement batching, only the write heavy pools benefit from it
+    uint32 batchMaxSize = sConfigMgr->GetIntDefault("Database.Batch.MaxSize", 50);
+    uint32 batchWindow = sConfigMgr->GetIntDefault("Database.Batch.Window", 0);
+    CharacterDatabase.SetBatching(batchMaxSize, batchWindow);
+    LoginDatabase.SetBatching(batchMaxSize, batchWindow);
+
     ///- Get the realm Id from the configuration file
     realmID = sConfigMgr->GetIntDefault("RealmID", 0);
     if (!realmID)
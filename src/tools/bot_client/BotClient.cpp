@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// \addtogroup botclient
+/// @{
+/// \file
+/// Headless load generator: logs a range of bot accounts into a worldserver and keeps them in the world.
+/// Authentication is stubbed, every bot writes a fresh session key to its account in the LoginDatabase
+/// and proves it to the worldserver directly, the authserver is not involved. Bots connect in a fixed
+/// order at a fixed rate and send the same packets at the same intervals on every run.
+
+#include "BotSession.h"
+#include "DatabaseEnv.h"
+#include "Timer.h"
+
+#include <ace/Reactor.h>
+#include <ace/TP_Reactor.h>
+#include <ace/Dev_Poll_Reactor.h>
+#include <openssl/crypto.h>
+#include <signal.h>
+#include <sstream>
+#include <algorithm>
+
+LoginDatabaseWorkerPool LoginDatabase;
+CharacterDatabaseWorkerPool CharacterDatabase;
+
+static volatile bool stopEvent = false;
+
+static void OnSignal(int)
+{
+    stopEvent = true;
+}
+
+void printUsage(char const* prg)
+{
+    printf("Usage: %s --login-db <info> --char-db <info> [options]\n", prg);
+    printf("    --login-db <info>       LoginDatabaseInfo style string \"host;port;user;password;database\"\n");
+    printf("    --char-db <info>        CharacterDatabaseInfo style string\n");
+    printf("    --host <address>        Worldserver address, default 127.0.0.1\n");
+    printf("    --port <port>           Worldserver port, default 8085\n");
+    printf("    --prefix <name>         Bot accounts are <prefix><number>, default BOT\n");
+    printf("    --first <number>        Number of the first bot account, default 1\n");
+    printf("    --count <number>        Number of bots, default 10\n");
+    printf("    --rate <number>         Connections per second, default 20\n");
+    printf("    --duration <seconds>    Run time, 0 until interrupted, default 300\n");
+    printf("    --ping <seconds>        Ping interval, at least 30, default 30\n");
+    printf("    --chat <seconds>        Say interval, 0 to stay silent, default 0\n");
+    printf("    --stats <seconds>       Report interval, default 10\n");
+    printf("Every bot account needs at least one character, the one with the lowest guid is used.\n");
+    printf("Only run this against a test realm, the session keys of the bot accounts are overwritten.\n");
+}
+
+struct BotClientArgs
+{
+    BotClientArgs() : host("127.0.0.1"), port(8085), prefix("BOT"), first(1), count(10), rate(20), duration(300), statsInterval(10) { }
+
+    std::string loginDatabase;
+    std::string characterDatabase;
+    std::string host;
+    uint16 port;
+    std::string prefix;
+    uint32 first;
+    uint32 count;
+    uint32 rate;
+    uint32 duration;
+    uint32 statsInterval;
+};
+
+bool handleArgs(int argc, char** argv, BotClientArgs& args, BotSettings& settings)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        char const* param = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!param)
+            return false;
+
+        if (strcmp(argv[i], "--login-db") == 0)
+            args.loginDatabase = param;
+        else if (strcmp(argv[i], "--char-db") == 0)
+            args.characterDatabase = param;
+        else if (strcmp(argv[i], "--host") == 0)
+            args.host = param;
+        else if (strcmp(argv[i], "--port") == 0)
+            args.port = uint16(atoi(param));
+        else if (strcmp(argv[i], "--prefix") == 0)
+            args.prefix = param;
+        else if (strcmp(argv[i], "--first") == 0)
+            args.first = atoi(param);
+        else if (strcmp(argv[i], "--count") == 0)
+            args.count = atoi(param);
+        else if (strcmp(argv[i], "--rate") == 0)
+            args.rate = std::max(atoi(param), 1);
+        else if (strcmp(argv[i], "--duration") == 0)
+            args.duration = atoi(param);
+        else if (strcmp(argv[i], "--ping") == 0)
+            settings.pingInterval = std::max(atoi(param), 30) * IN_MILLISECONDS;   // the server kicks for faster pings
+        else if (strcmp(argv[i], "--chat") == 0)
+            settings.chatInterval = atoi(param) * IN_MILLISECONDS;
+        else if (strcmp(argv[i], "--stats") == 0)
+            args.statsInterval = std::max(atoi(param), 1);
+        else
+            return false;
+
+        ++i;
+    }
+
+    return !args.loginDatabase.empty() && !args.characterDatabase.empty();
+}
+
+/// Writes a fresh session key to every bot account and looks up its character, accounts without one are skipped
+bool createBots(BotClientArgs const& args, BotSettings const& settings, BotStats& stats, std::vector<BotSession*>& bots)
+{
+    for (uint32 i = args.first; i < args.first + args.count; ++i)
+    {
+        std::ostringstream ss;
+        ss << args.prefix << i;
+        std::string account = ss.str();
+        std::transform(account.begin(), account.end(), account.begin(), ::toupper);
+
+        std::string escapedAccount = account;
+        LoginDatabase.EscapeString(escapedAccount);
+
+        QueryResult result = LoginDatabase.PQuery("SELECT id FROM account WHERE username = '%s'", escapedAccount.c_str());
+        if (!result)
+        {
+            printf("Account %s does not exist, skipped\n", account.c_str());
+            continue;
+        }
+
+        uint32 accountId = result->Fetch()[0].GetUInt32();
+
+        result = CharacterDatabase.PQuery("SELECT guid FROM characters WHERE account = %u ORDER BY guid LIMIT 1", accountId);
+        if (!result)
+        {
+            printf("Account %s has no character, skipped\n", account.c_str());
+            continue;
+        }
+
+        uint32 characterGuid = result->Fetch()[0].GetUInt32();
+
+        BigNumber sessionKey;
+        sessionKey.SetRand(40 * 8);
+        char const* sessionKeyHex = sessionKey.AsHexStr();
+        std::string sessionKeyStr = sessionKeyHex;
+        OPENSSL_free((void*)sessionKeyHex);
+
+        LoginDatabase.DirectPExecute("UPDATE account SET sessionkey = '%s' WHERE id = %u", sessionKeyStr.c_str(), accountId);
+
+        bots.push_back(new BotSession(account, sessionKeyStr, characterGuid, settings, stats));
+    }
+
+    return !bots.empty();
+}
+
+void printStats(BotStats const& stats, BotStats& last, uint32 elapsed)
+{
+    float seconds = std::max(elapsed, 1u) / 1000.0f;
+    printf("%u connected, %u authenticated, %u in world, %u failed, %u disconnected | in %.0f packets/s %.1f KB/s | out %.0f packets/s %.1f KB/s | ping avg %u ms max %u ms\n",
+        stats.connected, stats.authenticated, stats.inWorld, stats.failed, stats.disconnected,
+        (stats.packetsReceived - last.packetsReceived) / seconds, (stats.bytesReceived - last.bytesReceived) / 1024.0f / seconds,
+        (stats.packetsSent - last.packetsSent) / seconds, (stats.bytesSent - last.bytesSent) / 1024.0f / seconds,
+        stats.pings ? uint32(stats.pingTotal / stats.pings) : 0, stats.pingMax);
+    last = stats;
+}
+
+int main(int argc, char** argv)
+{
+    BotClientArgs args;
+    BotSettings settings;
+    settings.pingInterval = 30 * IN_MILLISECONDS;
+    settings.chatInterval = 0;
+    settings.chatText = "Load test message";
+
+    if (!handleArgs(argc, argv, args, settings))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    MySQL::Library_Init();
+
+    // Only ad hoc queries are used, nothing needs to be prepared
+    if (!LoginDatabase.Open(args.loginDatabase, 1, 1, PREPARE_LAZY) || !CharacterDatabase.Open(args.characterDatabase, 1, 1, PREPARE_LAZY))
+    {
+        printf("Cannot connect to the databases\n");
+        return 1;
+    }
+
+    BotStats stats;
+    std::vector<BotSession*> bots;
+    bool created = createBots(args, settings, stats, bots);
+
+    CharacterDatabase.Close();
+    LoginDatabase.Close();
+    MySQL::Library_End();
+
+    if (!created)
+    {
+        printf("No usable bot accounts\n");
+        return 1;
+    }
+
+    ACE_INET_Addr address(args.port, args.host.c_str());
+
+    // Same reactor the worldserver uses for its sockets
+    ACE_Reactor_Impl* imp;
+#if defined (ACE_HAS_EVENT_POLL) || defined (ACE_HAS_DEV_POLL)
+    imp = new ACE_Dev_Poll_Reactor();
+#else
+    imp = new ACE_TP_Reactor();
+#endif
+    ACE_Reactor reactor(imp, 1);
+
+    signal(SIGINT, &OnSignal);
+    signal(SIGTERM, &OnSignal);
+
+    printf("Starting %u bots against %s:%u\n", uint32(bots.size()), args.host.c_str(), args.port);
+
+    uint32 startTime = getMSTime();
+    uint32 lastStatsTime = startTime;
+    uint32 connectInterval = IN_MILLISECONDS / args.rate;
+    uint32 nextConnectTime = startTime;
+    size_t nextBot = 0;
+    BotStats lastStats;
+
+    while (!stopEvent && (!args.duration || GetMSTimeDiffToNow(startTime) < args.duration * IN_MILLISECONDS))
+    {
+        uint32 now = getMSTime();
+
+        while (nextBot < bots.size() && now >= nextConnectTime)
+        {
+            bots[nextBot++]->Connect(address, &reactor);
+            nextConnectTime += connectInterval;
+        }
+
+        ACE_Time_Value timeout(0, 10000);
+        reactor.handle_events(timeout);
+
+        now = getMSTime();
+        for (std::vector<BotSession*>::const_iterator itr = bots.begin(); itr != bots.end(); ++itr)
+            (*itr)->Update(now);
+
+        if (getMSTimeDiff(lastStatsTime, now) >= args.statsInterval * IN_MILLISECONDS)
+        {
+            printStats(stats, lastStats, getMSTimeDiff(lastStatsTime, now));
+            lastStatsTime = now;
+        }
+    }
+
+    printStats(stats, lastStats, GetMSTimeDiffToNow(lastStatsTime));
+
+    for (std::vector<BotSession*>::const_iterator itr = bots.begin(); itr != bots.end(); ++itr)
+    {
+        (*itr)->Disconnect();
+        delete *itr;
+    }
+
+    return 0;
+}
+
+/// @}
@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BotSession.h"
+#include "HMACSHA1.h"
+#include "SHA1.h"
+#include "Timer.h"
+#include "Util.h"
+
+#include <ace/Reactor.h>
+#include <ace/SOCK_Connector.h>
+#include <ace/os_include/netinet/os_tcp.h>
+
+enum BotSessionConstants
+{
+    BOT_CLIENT_BUILD        = 18414,
+    BOT_CRYPT_SEED_SIZE     = 16,
+    BOT_CRYPT_DROP          = 1024,
+    BOT_CONNECT_TIMEOUT     = 5,        // seconds
+    BOT_RECV_CHUNK          = 4096
+};
+
+static char const* BotConnectionString = "WORLD OF WARCRAFT CONNECTION - CLIENT TO SERVER";
+
+BotSession::BotSession(std::string const& account, std::string const& sessionKey, uint32 characterGuid, BotSettings const& settings, BotStats& stats) :
+    _account(account), _characterGuid(characterGuid), _settings(settings), _stats(stats), _state(BOT_STATE_NOT_CONNECTED),
+    _headerRead(false), _packetOpcode(0), _packetSize(0), _encrypted(false), _encrypt(SHA_DIGEST_LENGTH), _decrypt(SHA_DIGEST_LENGTH),
+    _nextPing(0), _pingSerial(0), _pingSent(0), _latency(0), _nextChat(0)
+{
+    _sessionKey.SetHexStr(sessionKey.c_str());
+}
+
+bool BotSession::Connect(ACE_INET_Addr const& address, ACE_Reactor* reactor)
+{
+    ACE_SOCK_Connector connector;
+    ACE_Time_Value timeout(BOT_CONNECT_TIMEOUT);
+    if (connector.connect(_socket, address, &timeout) == -1)
+    {
+        _state = BOT_STATE_DISCONNECTED;
+        ++_stats.failed;
+        return false;
+    }
+
+    int nodelay = 1;
+    _socket.set_option(ACE_IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    _state = BOT_STATE_CONNECTED;
+
+    if (reactor->register_handler(this, ACE_Event_Handler::READ_MASK) == -1)
+    {
+        _socket.close();
+        _state = BOT_STATE_DISCONNECTED;
+        ++_stats.failed;
+        return false;
+    }
+
+    ++_stats.connected;
+    return true;
+}
+
+void BotSession::Disconnect()
+{
+    if (_state == BOT_STATE_NOT_CONNECTED || _state == BOT_STATE_DISCONNECTED)
+        return;
+
+    // handle_close does the rest
+    reactor()->remove_handler(this, ACE_Event_Handler::READ_MASK);
+}
+
+int BotSession::handle_close(ACE_HANDLE, ACE_Reactor_Mask)
+{
+    if (_state == BOT_STATE_DISCONNECTED)
+        return 0;
+
+    _socket.close();
+
+    if (_state != BOT_STATE_IN_WORLD)
+        ++_stats.failed;
+    else
+        --_stats.inWorld;
+
+    ++_stats.disconnected;
+    --_stats.connected;
+    _state = BOT_STATE_DISCONNECTED;
+    return 0;
+}
+
+void BotSession::Update(uint32 now)
+{
+    if (_state != BOT_STATE_IN_WORLD)
+        return;
+
+    if (now >= _nextPing)
+    {
+        ByteBuffer packet(8);
+        packet << uint32(++_pingSerial);
+        packet << uint32(_latency);
+        _pingSent = now;
+        _nextPing = now + _settings.pingInterval;
+        if (!SendPacket(BOT_CMSG_PING, packet))
+        {
+            Disconnect();
+            return;
+        }
+    }
+
+    if (_settings.chatInterval && now >= _nextChat)
+    {
+        ByteBuffer packet(5 + _settings.chatText.size());
+        packet << uint32(0);                            // LANG_UNIVERSAL
+        packet.WriteBits(_settings.chatText.size(), 8);
+        packet.FlushBits();
+        packet.append(_settings.chatText.c_str(), _settings.chatText.size());
+        _nextChat = now + _settings.chatInterval;
+        if (!SendPacket(BOT_CMSG_MESSAGECHAT_SAY, packet))
+            Disconnect();
+    }
+}
+
+int BotSession::handle_input(ACE_HANDLE)
+{
+    uint8 chunk[BOT_RECV_CHUNK];
+    ssize_t received = _socket.recv(chunk, sizeof(chunk));
+    if (received == 0)
+        return -1;
+
+    if (received < 0)
+        return (errno == EWOULDBLOCK || errno == EAGAIN) ? 0 : -1;
+
+    _stats.bytesReceived += received;
+    _recvBuffer.insert(_recvBuffer.end(), chunk, chunk + received);
+
+    size_t offset = 0;
+    try
+    {
+        while (true)
+        {
+            if (!_headerRead)
+            {
+                if (_recvBuffer.size() - offset < 4)
+                    break;
+
+                uint8* header = &_recvBuffer[offset];
+                if (_encrypted)
+                {
+                    // Decrypted exactly once, the payload may arrive with a later read
+                    _decrypt.UpdateData(4, header);
+                    uint32 value;
+                    memcpy(&value, header, 4);
+                    EndianConvert(value);
+                    _packetOpcode = value & 0x1FFF;
+                    _packetSize = value >> 13;
+                }
+                else
+                {
+                    // Size includes the opcode
+                    uint16 size, opcode;
+                    memcpy(&size, header, 2);
+                    memcpy(&opcode, header + 2, 2);
+                    EndianConvert(size);
+                    EndianConvert(opcode);
+                    if (size < 2)
+                        return -1;
+
+                    _packetOpcode = opcode;
+                    _packetSize = size - 2;
+                }
+
+                offset += 4;
+                _headerRead = true;
+            }
+
+            if (_recvBuffer.size() - offset < _packetSize)
+                break;
+
+            ByteBuffer packet(_packetSize);
+            if (_packetSize)
+                packet.append(&_recvBuffer[offset], _packetSize);
+
+            offset += _packetSize;
+            _headerRead = false;
+            ++_stats.packetsReceived;
+
+            if (!HandlePacket(_packetOpcode, packet))
+                return -1;
+        }
+    }
+    catch (ByteBufferException const&)
+    {
+        printf("%s: malformed packet 0x%04X\n", _account.c_str(), _packetOpcode);
+        return -1;
+    }
+
+    _recvBuffer.erase(_recvBuffer.begin(), _recvBuffer.begin() + offset);
+    return 0;
+}
+
+bool BotSession::HandlePacket(uint16 opcode, ByteBuffer& packet)
+{
+    switch (opcode)
+    {
+        case BOT_MSG_VERIFY_CONNECTIVITY:
+        {
+            if (_state != BOT_STATE_CONNECTED)
+                return false;
+
+            // Not a packet, the length prefixed string without opcode. The server reads "WORL" as opcode.
+            uint16 size = uint16(strlen(BotConnectionString) + 1);
+            EndianConvert(size);
+            _state = BOT_STATE_CHALLENGE;
+            return Send((uint8 const*)&size, 2) && Send((uint8 const*)BotConnectionString, strlen(BotConnectionString) + 1);
+        }
+        case BOT_SMSG_AUTH_CHALLENGE:
+            return _state == BOT_STATE_CHALLENGE && HandleAuthChallenge(packet);
+        case BOT_SMSG_AUTH_RESPONSE:
+        {
+            // A rejection is sent before the server enables encryption and followed by a disconnect,
+            // whatever decrypts from it is never acted on
+            if (_state != BOT_STATE_AUTHENTICATING)
+                return true;
+
+            ++_stats.authenticated;
+            _state = BOT_STATE_CHAR_ENUM;
+
+            // The server only lets characters of the last listing log in
+            ByteBuffer request;
+            return SendPacket(BOT_CMSG_CHAR_ENUM, request);
+        }
+        case BOT_SMSG_CHAR_ENUM:
+        {
+            if (_state != BOT_STATE_CHAR_ENUM)
+                return true;
+
+            ObjectGuid guid = uint64(_characterGuid);
+            ByteBuffer request(13);
+            request << float(0.0f);
+            request.WriteGuidMask(guid, 1, 4, 7, 3, 2, 6, 5, 0);
+            request.WriteGuidBytes(guid, 5, 1, 0, 6, 2, 4, 7, 3);
+            _state = BOT_STATE_LOADING;
+            return SendPacket(BOT_CMSG_PLAYER_LOGIN, request);
+        }
+        case BOT_SMSG_LOGIN_VERIFY_WORLD:
+        {
+            if (_state != BOT_STATE_LOADING)
+                return true;
+
+            uint32 now = getMSTime();
+            _state = BOT_STATE_IN_WORLD;
+            _nextPing = now;
+            _nextChat = now + _settings.chatInterval;
+            ++_stats.inWorld;
+            return true;
+        }
+        case BOT_SMSG_TIME_SYNC_REQ:
+        {
+            uint32 counter;
+            packet >> counter;
+
+            ByteBuffer response(8);
+            response << uint32(counter);
+            response << uint32(getMSTime());
+            return SendPacket(BOT_CMSG_TIME_SYNC_RESP, response);
+        }
+        case BOT_SMSG_PONG:
+        {
+            uint32 serial;
+            packet >> serial;
+            if (serial != _pingSerial)
+                return true;
+
+            _latency = getMSTimeDiff(_pingSent, getMSTime());
+            ++_stats.pings;
+            _stats.pingTotal += _latency;
+            _stats.pingMax = std::max(_stats.pingMax, _latency);
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+bool BotSession::HandleAuthChallenge(ByteBuffer& packet)
+{
+    uint32 serverSeed;
+    packet.read_skip<uint16>();
+    packet.read_skip(8 * 4);
+    packet.read_skip<uint8>();
+    packet >> serverSeed;
+
+    uint32 clientSeed = urand(0, 0xFFFFFFFF);
+    uint32 t = 0;
+
+    // Same proof as WorldSocket::HandleAuthSessionChecks computes from the account's session key
+    SHA1Hash sha;
+    sha.UpdateData(_account);
+    sha.UpdateData((uint8*)&t, 4);
+    sha.UpdateData((uint8*)&clientSeed, 4);
+    sha.UpdateData((uint8*)&serverSeed, 4);
+    sha.UpdateBigNumbers(&_sessionKey, NULL);
+    sha.Finalize();
+    uint8 const* digest = sha.GetDigest();
+
+    // Field order of WorldSocket::HandleAuthSession
+    ByteBuffer request(128);
+    request << uint32(0);
+    request << uint32(0);
+    request << digest[18];
+    request << digest[14];
+    request << digest[3];
+    request << digest[4];
+    request << digest[0];
+    request << uint32(0);
+    request << digest[11];
+    request << uint32(clientSeed);
+    request << digest[19];
+    request << uint8(0);
+    request << uint8(0);
+    request << digest[2];
+    request << digest[9];
+    request << digest[12];
+    request << uint64(0);
+    request << uint32(0);
+    request << digest[16];
+    request << digest[5];
+    request << digest[6];
+    request << digest[8];
+    request << uint16(BOT_CLIENT_BUILD);
+    request << digest[17];
+    request << digest[7];
+    request << digest[13];
+    request << digest[15];
+    request << digest[1];
+    request << digest[10];
+    request << uint32(0);                               // no addon data
+    request.WriteBit(0);
+    request.WriteBits(_account.size(), 11);
+    request.FlushBits();
+    request.append(_account.c_str(), _account.size());
+
+    if (!SendPacket(BOT_CMSG_AUTH_SESSION, request))
+        return false;
+
+    // Everything after a successful CMSG_AUTH_SESSION has encrypted headers
+    InitCrypt();
+    _state = BOT_STATE_AUTHENTICATING;
+    return true;
+}
+
+void BotSession::InitCrypt()
+{
+    // The server decrypts with the HMAC of this seed and encrypts with the other one, see AuthCrypt::Init
+    uint8 serverDecryptionSeed[BOT_CRYPT_SEED_SIZE] = { 0x40, 0xAA, 0xD3, 0x92, 0x26, 0x71, 0x43, 0x47, 0x3A, 0x31, 0x08, 0xA6, 0xE7, 0xDC, 0x98, 0x2A };
+    HmacHash encryptHmac(BOT_CRYPT_SEED_SIZE, serverDecryptionSeed);
+    _encrypt.Init(encryptHmac.ComputeHash(&_sessionKey));
+
+    uint8 serverEncryptionSeed[BOT_CRYPT_SEED_SIZE] = { 0x08, 0xF1, 0x95, 0x9F, 0x47, 0xE5, 0xD2, 0xDB, 0xA1, 0x3D, 0x77, 0x8F, 0x3F, 0x3E, 0xE7, 0x00 };
+    HmacHash decryptHmac(BOT_CRYPT_SEED_SIZE, serverEncryptionSeed);
+    _decrypt.Init(decryptHmac.ComputeHash(&_sessionKey));
+
+    // ARC4-drop1024
+    uint8 syncBuf[BOT_CRYPT_DROP];
+    memset(syncBuf, 0, BOT_CRYPT_DROP);
+    _encrypt.UpdateData(BOT_CRYPT_DROP, syncBuf);
+    memset(syncBuf, 0, BOT_CRYPT_DROP);
+    _decrypt.UpdateData(BOT_CRYPT_DROP, syncBuf);
+
+    _encrypted = true;
+}
+
+bool BotSession::SendPacket(uint16 opcode, ByteBuffer const& packet)
+{
+    uint8 header[6];
+    size_t headerSize;
+
+    if (_encrypted)
+    {
+        uint32 value = (uint32(packet.size()) << 13) | (opcode & 0x1FFF);
+        EndianConvert(value);
+        memcpy(header, &value, 4);
+        _encrypt.UpdateData(4, header);
+        headerSize = 4;
+    }
+    else
+    {
+        // Size includes the opcode
+        uint16 size = uint16(packet.size() + 4);
+        uint32 cmd = opcode;
+        EndianConvert(size);
+        EndianConvert(cmd);
+        memcpy(header, &size, 2);
+        memcpy(header + 2, &cmd, 4);
+        headerSize = 6;
+    }
+
+    ++_stats.packetsSent;
+    return Send(header, headerSize) && (packet.empty() || Send(packet.contents(), packet.size()));
+}
+
+bool BotSession::Send(uint8 const* data, size_t size)
+{
+    if (_socket.send_n(data, size) != ssize_t(size))
+        return false;
+
+    _stats.bytesSent += size;
+    return true;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2016 DeathCore <http://www.noffearrdeathproject.org/>
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOTSESSION_H
+#define BOTSESSION_H
+
+#include "Common.h"
+#include "ByteBuffer.h"
+#include "BigNumber.h"
+#include "ARC4.h"
+
+#include <ace/Event_Handler.h>
+#include <ace/SOCK_Stream.h>
+#include <ace/INET_Addr.h>
+
+//! Opcode numbers of the 5.4.8 18414 client used by the bots, as in Opcodes.cpp
+enum BotOpcodes
+{
+    BOT_MSG_VERIFY_CONNECTIVITY     = 0x4F57,
+    BOT_SMSG_AUTH_CHALLENGE         = 0x0949,
+    BOT_SMSG_AUTH_RESPONSE          = 0x0ABA,
+    BOT_SMSG_CHAR_ENUM              = 0x11C3,
+    BOT_SMSG_LOGIN_VERIFY_WORLD     = 0x1C0F,
+    BOT_SMSG_PONG                   = 0x1969,
+    BOT_SMSG_TIME_SYNC_REQ          = 0x1A8F,
+    BOT_CMSG_AUTH_SESSION           = 0x00B2,
+    BOT_CMSG_CHAR_ENUM              = 0x00E0,
+    BOT_CMSG_PLAYER_LOGIN           = 0x158F,
+    BOT_CMSG_PING                   = 0x0012,
+    BOT_CMSG_TIME_SYNC_RESP         = 0x01DB,
+    BOT_CMSG_MESSAGECHAT_SAY        = 0x0A9A
+};
+
+enum BotState
+{
+    BOT_STATE_NOT_CONNECTED,
+    BOT_STATE_CONNECTED,            //! Waiting for the connection string of the server
+    BOT_STATE_CHALLENGE,            //! Waiting for SMSG_AUTH_CHALLENGE
+    BOT_STATE_AUTHENTICATING,       //! Sent CMSG_AUTH_SESSION, waiting for SMSG_AUTH_RESPONSE
+    BOT_STATE_CHAR_ENUM,            //! Waiting for the character list
+    BOT_STATE_LOADING,              //! Sent CMSG_PLAYER_LOGIN, waiting for SMSG_LOGIN_VERIFY_WORLD
+    BOT_STATE_IN_WORLD,
+    BOT_STATE_DISCONNECTED
+};
+
+struct BotSettings
+{
+    uint32 pingInterval;            //! In milliseconds
+    uint32 chatInterval;            //! In milliseconds, 0 to stay silent
+    std::string chatText;
+};
+
+//! Totals over all bots, only touched by the thread running the reactor
+struct BotStats
+{
+    BotStats() : connected(0), authenticated(0), inWorld(0), disconnected(0), failed(0),
+        packetsSent(0), packetsReceived(0), bytesSent(0), bytesReceived(0), pings(0), pingTotal(0), pingMax(0) { }
+
+    uint32 connected;
+    uint32 authenticated;
+    uint32 inWorld;
+    uint32 disconnected;
+    uint32 failed;                  //! Disconnected before entering the world
+    uint64 packetsSent;
+    uint64 packetsReceived;
+    uint64 bytesSent;
+    uint64 bytesReceived;
+    uint32 pings;
+    uint64 pingTotal;
+    uint32 pingMax;
+};
+
+//! One headless client. Logs into the worldserver with a session key that was written to the account
+//! beforehand instead of going through the authserver, enters the world with a fixed character and then
+//! pings and chats at fixed intervals.
+class BotSession : public ACE_Event_Handler
+{
+    public:
+        BotSession(std::string const& account, std::string const& sessionKey, uint32 characterGuid, BotSettings const& settings, BotStats& stats);
+
+        std::string const& GetAccount() const { return _account; }
+        BotState GetState() const { return _state; }
+
+        //! Connects and registers with the reactor, the login runs from handle_input from then on
+        bool Connect(ACE_INET_Addr const& address, ACE_Reactor* reactor);
+        void Disconnect();
+        //! Sends the periodic packets that are due
+        void Update(uint32 now);
+
+        ACE_HANDLE get_handle() const { return _socket.get_handle(); }
+        int handle_input(ACE_HANDLE);
+        int handle_close(ACE_HANDLE, ACE_Reactor_Mask);
+
+    private:
+        bool HandlePacket(uint16 opcode, ByteBuffer& packet);
+        bool HandleAuthChallenge(ByteBuffer& packet);
+
+        bool SendPacket(uint16 opcode, ByteBuffer const& packet);
+        bool Send(uint8 const* data, size_t size);
+        //! Sets up header encryption the same way AuthCrypt does on the server, with the directions swapped
+        void InitCrypt();
+
+        std::string _account;
+        BigNumber _sessionKey;
+        uint32 _characterGuid;
+        BotSettings const& _settings;
+        BotStats& _stats;
+
+        ACE_SOCK_Stream _socket;
+        BotState _state;
+        std::vector<uint8> _recvBuffer;
+        bool _headerRead;
+        uint16 _packetOpcode;
+        uint32 _packetSize;
+
+        bool _encrypted;
+        ARC4 _encrypt;
+        ARC4 _decrypt;
+
+        uint32 _nextPing;
+        uint32 _pingSerial;
+        uint32 _pingSent;
+        uint32 _latency;
+        uint32 _nextChat;
+};
+
+#endif
@@ -22,6 +22,9 @@
 #include <list>
 #include <cstdlib>
 #include <cstring>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 #ifdef _WIN32
 #include "direct.h"
@@ -95,6 +98,9 @@ float CONF_flat_liquid_delta_limit = 0.001f; // If max - min less this value - l
 
 uint32 CONF_TargetBuild = 18273;              // 5.4.8 18273 -- current build is 18414, but Blizz didnt rename the MPQ files
 
+// ADT files converted in parallel, 0 uses every core
+uint32 CONF_threads = 0;
+
 // List MPQ for extract maps from
 char const* CONF_mpq_list[] =
 {
@@ -173,6 +179,7 @@ void Usage(char const* prg)
         "-e extract only MAP(1)/DBC(2) - standard: both(3)\n"\
         "-f height stored as int (less map size but lost some accuracy) 1 by default\n"\
         "-b target build (default %u)\n"\
+        "-j number of threads converting maps (default: one per core)\n"\
         "Example: %s -f 0 -i \"c:\\games\\game\"", prg, CONF_TargetBuild, prg);
     exit(1);
 }
@@ -187,6 +194,7 @@ void HandleArgs(int argc, char* arg[])
         // f - use float to int conversion
         // h - limit minimum height
         // b - target client build
+        // j - threads
         if (arg[c][0] != '-')
             Usage(arg[0]);
 
@@ -226,6 +234,12 @@ void HandleArgs(int argc, char* arg[])
                 else
                     Usage(arg[0]);
                 break;
+            case 'j':
+                if (c + 1 < argc)                            // all ok
+                    CONF_threads = atoi(arg[c++ + 1]);
+                else
+                    Usage(arg[0]);
+                break;
             default:
                 break;
         }
@@ -446,21 +460,27 @@ float selectUInt16StepStore(float maxDiff)
 {
     return 65535 / maxDiff;
 }
-// Temporary grid data store
-uint16 area_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
-
-float V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
-float V9[ADT_GRID_SIZE+1][ADT_GRID_SIZE+1];
-uint16 uint16_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
-uint16 uint16_V9[ADT_GRID_SIZE+1][ADT_GRID_SIZE+1];
-uint8  uint8_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
-uint8  uint8_V9[ADT_GRID_SIZE+1][ADT_GRID_SIZE+1];
-
-uint16 liquid_entry[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
-uint8 liquid_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
-bool  liquid_show[ADT_GRID_SIZE][ADT_GRID_SIZE];
-float liquid_height[ADT_GRID_SIZE+1][ADT_GRID_SIZE+1];
-uint16 holes[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
+// Temporary grid data store, one per thread converting ADT files
+#if defined(_MSC_VER) && _MSC_VER < 1900
+    #define GRID_DATA_STORE __declspec(thread)
+#else
+    #define GRID_DATA_STORE thread_local
+#endif
+
+GRID_DATA_STORE uint16 area_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
+
+GRID_DATA_STORE float V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
+GRID_DATA_STORE float V9[ADT_GRID_SIZE+1][ADT_GRID_SIZE+1];
+GRID_DATA_STORE uint16 uint16_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
+GRID_DATA_STORE uint16 uint16_V9[ADT_GRID_SIZE+1][ADT_GRID_SIZE+1];
+GRID_DATA_STORE uint8  uint8_V8[ADT_GRID_SIZE][ADT_GRID_SIZE];
+GRID_DATA_STORE uint8  uint8_V9[ADT_GRID_SIZE+1][ADT_GRID_SIZE+1];
+
+GRID_DATA_STORE uint16 liquid_entry[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
+GRID_DATA_STORE uint8 liquid_flags[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
+GRID_DATA_STORE bool  liquid_show[ADT_GRID_SIZE][ADT_GRID_SIZE];
+GRID_DATA_STORE float liquid_height[ADT_GRID_SIZE+1][ADT_GRID_SIZE+1];
+GRID_DATA_STORE uint16 holes[ADT_CELLS_PER_GRID][ADT_CELLS_PER_GRID];
 
 bool ConvertADT(char *filename, char *filename2, int /*cell_y*/, int /*cell_x*/, uint32 build)
 {
@@ -984,10 +1004,15 @@ bool ConvertADT(char *filename, char *filename2, int /*cell_y*/, int /*cell_x*/,
     return true;
 }
 
+struct ADTConversion
+{
+    uint32 map;     // index in map_ids
+    uint32 x;
+    uint32 y;
+};
+
 void ExtractMapsFromMpq(uint32 build)
 {
-    char mpq_filename[1024];
-    char output_filename[1024];
     char mpq_map_name[1024];
 
     printf("Extracting maps...\n");
@@ -1001,10 +1026,10 @@ void ExtractMapsFromMpq(uint32 build)
     path += "/maps/";
     CreateDir(path);
 
-    printf("Convert map files\n");
+    // collect the ADT files of every map first, they are converted independently of each other
+    std::vector<ADTConversion> conversions;
     for (uint32 z = 0; z < map_count; ++z)
     {
-        printf("Extract %s (%d/%u)                  \n", map_ids[z].name, z+1, map_count);
         // Loadup map grid data
         sprintf(mpq_map_name, "World\\Maps\\%s\\%s.wdt", map_ids[z].name, map_ids[z].name);
         ChunkedFile wdt;
@@ -1019,15 +1044,47 @@ void ExtractMapsFromMpq(uint32 build)
                 if (!(chunk->As<wdt_MAIN>()->adt_list[y][x].flag & 0x1))
                     continue;
 
-                sprintf(mpq_filename, "World\\Maps\\%s\\%s_%u_%u.adt", map_ids[z].name, map_ids[z].name, x, y);
-                sprintf(output_filename, "%s/maps/%03u%02u%02u.map", output_path, map_ids[z].id, y, x);
-                ConvertADT(mpq_filename, output_filename, y, x, build);
+                ADTConversion conversion;
+                conversion.map = z;
+                conversion.x = x;
+                conversion.y = y;
+                conversions.push_back(conversion);
             }
+        }
+    }
+
+    uint32 threadCount = CONF_threads ? CONF_threads : std::max(std::thread::hardware_concurrency(), 1u);
+    printf("Convert %u map files using %u threads\n", uint32(conversions.size()), threadCount);
+
+    std::atomic<uint32> next(0);
+    std::atomic<uint32> done(0);
+    auto convert = [&]()
+    {
+        char mpq_filename[1024];
+        char output_filename[1024];
+        for (uint32 i = next++; i < conversions.size(); i = next++)
+        {
+            ADTConversion const& conversion = conversions[i];
+            map_id const& map = map_ids[conversion.map];
+            sprintf(mpq_filename, "World\\Maps\\%s\\%s_%u_%u.adt", map.name, map.name, conversion.x, conversion.y);
+            sprintf(output_filename, "%s/maps/%03u%02u%02u.map", output_path, map.id, conversion.y, conversion.x);
+            ConvertADT(mpq_filename, output_filename, conversion.y, conversion.x, build);
 
             // draw progress bar
-            printf("Processing........................%d%%\r", (100 * (y+1)) / WDT_MAP_SIZE);
+            uint32 converted = ++done;
+            if (converted % 64 == 0 || converted == conversions.size())
+                printf("Processing........................%u%%\r", (100 * converted) / uint32(conversions.size()));
         }
-    }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32 i = 1; i < threadCount; ++i)
+        threads.push_back(std::thread(convert));
+
+    convert();
+
+    for (std::vector<std::thread>::iterator itr = threads.begin(); itr != threads.end(); ++itr)
+        itr->join();
 
     printf("\n");
     delete [] areas;
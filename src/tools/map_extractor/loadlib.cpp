@@ -19,6 +19,10 @@
 
 #include "loadlib.h"
 #include <cstdio>
+#include <mutex>
+
+// StormLib archive handles must not be used by several threads at once
+static std::mutex MpqReadLock;
 
 u_map_fcc MverMagic = { {'R','E','V','M'} };
 
@@ -36,26 +40,30 @@ ChunkedFile::~ChunkedFile()
 bool ChunkedFile::loadFile(HANDLE mpq, char* filename, bool log)
 {
     free();
-    HANDLE file;
-    if (!SFileOpenFileEx(mpq, filename, SFILE_OPEN_PATCHED_FILE, &file))
+
     {
-        if (log)
-            printf("No such file %s\n", filename);
-        return false;
+        // only the read itself is serialized, parsing runs in parallel
+        std::lock_guard<std::mutex> lock(MpqReadLock);
+
+        HANDLE file;
+        if (!SFileOpenFileEx(mpq, filename, SFILE_OPEN_PATCHED_FILE, &file))
+        {
+            if (log)
+                printf("No such file %s\n", filename);
+            return false;
+        }
+
+        data_size = SFileGetFileSize(file, NULL);
+        data = new uint8[data_size];
+        SFileReadFile(file, data, data_size, NULL/*bytesRead*/, NULL);
+        SFileCloseFile(file);
     }
 
-    data_size = SFileGetFileSize(file, NULL);
-    data = new uint8[data_size];
-    SFileReadFile(file, data, data_size, NULL/*bytesRead*/, NULL);
     parseChunks();
     if (prepareLoadedData())
-    {
-        SFileCloseFile(file);
         return true;
-    }
 
     printf("Error loading %s\n", filename);
-    SFileCloseFile(file);
     free();
     return false;
 }
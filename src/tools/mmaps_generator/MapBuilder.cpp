@@ -27,6 +27,9 @@
 
 #include "DisableMgr.h"
 #include <ace/OS_NS_unistd.h>
+#include <ace/Guard_T.h>
+
+#include <algorithm>
 
 uint32 GetLiquidFlags(uint32 /*liquidType*/) { return 0; }
 namespace DisableMgr
@@ -37,6 +40,10 @@ namespace DisableMgr
 #define MMAP_MAGIC 0x4d4d4150   // 'MMAP'
 #define MMAP_VERSION 4
 
+#define MANIFEST_FILE "mmaps/build.manifest"
+#define MANIFEST_COMPLETE "complete\n"
+#define REPORT_FILE "mmaps/build.report"
+
 struct MmapTileHeader
 {
     uint32 mmapMagic;
@@ -62,7 +69,9 @@ namespace MMAP
         m_skipBattlegrounds  (skipBattlegrounds),
         m_maxWalkableAngle   (maxWalkableAngle),
         m_bigBaseUnit        (bigBaseUnit),
-        m_rcContext          (NULL)
+        m_rcContext          (NULL),
+        m_trustExistingTiles (true),
+        m_manifest           (NULL)
     {
         m_terrainBuilder = new TerrainBuilder(skipLiquid);
 
@@ -170,33 +179,322 @@ namespace MMAP
     /**************************************************************************/
     void MapBuilder::buildAllMaps(int threads)
     {
-        std::vector<BuilderThread*> _threads;
+        uint32 start = getMSTime();
 
-        BuilderThreadPool* pool = threads > 0 ? new BuilderThreadPool() : NULL;
+        loadManifest();
 
+        // set up every map before the workers start, they only read tile lists and navmesh params
+        std::vector<std::pair<uint32, uint32> > maps;   // tile count, map id
         for (TileList::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
         {
             uint32 mapID = it->first;
-            if (!shouldSkipMap(mapID))
+            if (shouldSkipMap(mapID))
+                continue;
+
+            std::set<uint32>* tiles = it->second;
+            if (tiles->empty())
+                addTilesInGridBounds(mapID, tiles);
+
+            if (tiles->empty())
+                continue;
+
+            dtNavMesh* navMesh = NULL;
+            buildNavMesh(mapID, navMesh);
+            if (!navMesh)
+            {
+                printf("[Map %03i] Failed creating navmesh!\n", mapID);
+                continue;
+            }
+
+            m_navMeshParams[mapID] = *navMesh->getParams();
+            dtFreeNavMesh(navMesh);
+
+            maps.push_back(std::make_pair(uint32(tiles->size()), mapID));
+        }
+
+        // biggest maps first, so the last tiles to finish are the cheap ones of small maps
+        std::sort(maps.rbegin(), maps.rend());
+
+        std::vector<std::pair<uint32, uint32> > queue;  // map id, packed tile coords
+        uint32 skipped = 0;
+        for (std::vector<std::pair<uint32, uint32> >::iterator itr = maps.begin(); itr != maps.end(); ++itr)
+        {
+            std::set<uint32>* tiles = getTileList(itr->second);
+            for (std::set<uint32>::iterator it = tiles->begin(); it != tiles->end(); ++it)
+            {
+                uint32 tileX, tileY;
+                StaticMapTree::unpackTileID((*it), tileX, tileY);
+
+                if (shouldSkipTile(itr->second, tileX, tileY))
+                {
+                    ++skipped;
+                    continue;
+                }
+
+                queue.push_back(std::make_pair(itr->second, *it));
+            }
+        }
+
+        printf("Building %u tiles of %u maps, %u tiles are already done.\n\n", uint32(queue.size()), uint32(maps.size()), skipped);
+
+        if (threads > 0)
+        {
+            BuilderThreadPool* pool = new BuilderThreadPool(queue.size());
+            for (std::vector<std::pair<uint32, uint32> >::iterator itr = queue.begin(); itr != queue.end(); ++itr)
+            {
+                uint32 tileX, tileY;
+                StaticMapTree::unpackTileID(itr->second, tileX, tileY);
+                pool->Enqueue(new TileBuildRequest(this, itr->first, tileX, tileY));
+            }
+
+            std::vector<BuilderThread*> _threads;
+            for (int i = 0; i < threads; ++i)
+                _threads.push_back(new BuilderThread(pool->Queue()));
+
+            // Free memory
+            for (std::vector<BuilderThread*>::iterator _th = _threads.begin(); _th != _threads.end(); ++_th)
+            {
+                (*_th)->wait();
+                delete *_th;
+            }
+
+            delete pool;
+        }
+        else
+        {
+            for (std::vector<std::pair<uint32, uint32> >::iterator itr = queue.begin(); itr != queue.end(); ++itr)
             {
-                if (threads > 0)
-                    pool->Enqueue(new MapBuildRequest(mapID));
-                else
-                    buildMap(mapID);
+                uint32 tileX, tileY;
+                StaticMapTree::unpackTileID(itr->second, tileX, tileY);
+                buildQueuedTile(itr->first, tileX, tileY);
             }
         }
 
-        for (int i = 0; i < threads; ++i)
-            _threads.push_back(new BuilderThread(this, pool->Queue()));
+        finalizeManifest();
+
+        writeReport(GetMSTimeDiffToNow(start));
+    }
+
+    /**************************************************************************/
+    void MapBuilder::buildQueuedTile(uint32 mapID, uint32 tileX, uint32 tileY)
+    {
+        TileBuildRecord record;
+        record.mapID = mapID;
+        record.tileX = tileX;
+        record.tileY = tileY;
+        record.result = TILE_BUILD_FAILED;
+
+        uint32 start = getMSTime();
+
+        // dtNavMesh is not thread safe, every tile is added to a navmesh of its own made from the map's params
+        std::map<uint32, dtNavMeshParams>::const_iterator params = m_navMeshParams.find(mapID);
+        dtNavMesh* navMesh = dtAllocNavMesh();
+        if (params != m_navMeshParams.end() && navMesh && dtStatusSucceed(navMesh->init(&params->second)))
+            record.result = buildTile(mapID, tileX, tileY, navMesh);
+        else
+            printf("[Map %03i] Failed creating navmesh for tile [%02u,%02u]!\n", mapID, tileX, tileY);
+
+        dtFreeNavMesh(navMesh);
+
+        record.buildTime = GetMSTimeDiffToNow(start);
+        recordTile(record);
+    }
 
-        // Free memory
-        for (std::vector<BuilderThread*>::iterator _th = _threads.begin(); _th != _threads.end(); ++_th)
+    /**************************************************************************/
+    std::string MapBuilder::getManifestHeader() const
+    {
+        // tiles built with other settings do not count as done
+        char header[512];
+        snprintf(header, sizeof(header), "mmaps build manifest %u %u, maxAngle %.2f, liquids %u, bigBaseUnit %u, offMesh %s\n",
+            MMAP_VERSION, uint32(DT_NAVMESH_VERSION), m_maxWalkableAngle, uint32(m_terrainBuilder->usesLiquids()), uint32(m_bigBaseUnit),
+            m_offMeshFilePath ? m_offMeshFilePath : "none");
+        return header;
+    }
+
+    /**************************************************************************/
+    bool MapBuilder::readManifest()
+    {
+        m_finishedTiles.clear();
+
+        FILE* file = fopen(MANIFEST_FILE, "r");
+        if (!file)
         {
-            (*_th)->wait();
-            delete *_th;
+            // no record of the settings the existing tiles were made with, trust them as before
+            m_trustExistingTiles = true;
+            return false;
         }
 
-        delete pool;
+        m_trustExistingTiles = false;
+
+        char line[512];
+        if (!fgets(line, sizeof(line), file) || getManifestHeader() != line)
+        {
+            printf("%s was made with other settings, building all tiles again.\n", MANIFEST_FILE);
+            fclose(file);
+            return false;
+        }
+
+        while (fgets(line, sizeof(line), file))
+        {
+            // a finished build lists no tiles, every tile file left of it was made with these settings
+            if (!strcmp(line, MANIFEST_COMPLETE))
+            {
+                m_trustExistingTiles = true;
+                continue;
+            }
+
+            // mapID tileX tileY result buildTime
+            uint32 mapID, tileX, tileY, result, buildTime;
+            if (sscanf(line, "%u %u %u %u %u", &mapID, &tileX, &tileY, &result, &buildTime) != 5)
+                continue;
+
+            // empty tiles write no file, written ones must still be there
+            if (result == TILE_BUILD_EMPTY || (result == TILE_BUILD_WRITTEN && hasValidTileFile(mapID, tileX, tileY)))
+                m_finishedTiles.insert(manifestKey(mapID, tileX, tileY));
+        }
+
+        fclose(file);
+        return true;
+    }
+
+    /**************************************************************************/
+    void MapBuilder::loadManifest()
+    {
+        if (readManifest())
+        {
+            if (!m_finishedTiles.empty())
+                printf("Resuming build, %u tiles are listed in %s.\n", uint32(m_finishedTiles.size()), MANIFEST_FILE);
+
+            // the last line may have been cut off by an interrupted run
+            m_manifest = fopen(MANIFEST_FILE, "a");
+            if (m_manifest)
+                fputs("\n", m_manifest);
+        }
+        else
+        {
+            m_manifest = fopen(MANIFEST_FILE, "w");
+            if (m_manifest)
+                fputs(getManifestHeader().c_str(), m_manifest);
+        }
+
+        if (!m_manifest)
+            perror("Failed to open " MANIFEST_FILE " for writing, the build can not be resumed");
+        else
+            fflush(m_manifest);
+    }
+
+    /**************************************************************************/
+    void MapBuilder::finalizeManifest()
+    {
+        if (!m_manifest)
+            return;
+
+        fclose(m_manifest);
+        m_manifest = NULL;
+
+        for (std::vector<TileBuildRecord>::const_iterator itr = m_buildRecords.begin(); itr != m_buildRecords.end(); ++itr)
+            if (itr->result == TILE_BUILD_FAILED)
+                return;                                 // keep the tile list, the next run retries the failed tiles
+
+        // every tile is built, only the settings are kept so later runs know what the tile files were made with
+        if (FILE* file = fopen(MANIFEST_FILE, "w"))
+        {
+            fputs(getManifestHeader().c_str(), file);
+            fputs(MANIFEST_COMPLETE, file);
+            fclose(file);
+        }
+        else
+            perror("Failed to finalize " MANIFEST_FILE);
+    }
+
+    /**************************************************************************/
+    uint64 MapBuilder::manifestKey(uint32 mapID, uint32 tileX, uint32 tileY)
+    {
+        return uint64(mapID) << 32 | StaticMapTree::packTileID(tileX, tileY);
+    }
+
+    /**************************************************************************/
+    void MapBuilder::recordTile(TileBuildRecord const& record)
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_manifestLock);
+
+        m_buildRecords.push_back(record);
+
+        if (m_manifest)
+        {
+            // flushed right away, whatever is listed is skipped when an interrupted build is started again
+            fprintf(m_manifest, "%u %u %u %u %u\n", record.mapID, record.tileX, record.tileY, uint32(record.result), record.buildTime);
+            fflush(m_manifest);
+        }
+    }
+
+    static bool SortTilesByBuildTime(TileBuildRecord const& left, TileBuildRecord const& right)
+    {
+        return left.buildTime > right.buildTime;
+    }
+
+    /**************************************************************************/
+    void MapBuilder::writeReport(uint32 totalTime)
+    {
+        struct MapSummary
+        {
+            MapSummary() : tiles(0), written(0), failed(0), buildTime(0), slowest(NULL) { }
+
+            uint32 tiles;
+            uint32 written;
+            uint32 failed;
+            uint64 buildTime;
+            TileBuildRecord const* slowest;
+        };
+
+        std::sort(m_buildRecords.begin(), m_buildRecords.end(), SortTilesByBuildTime);
+
+        std::map<uint32, MapSummary> summaries;
+        uint64 buildTime = 0;
+        uint32 failed = 0;
+        for (std::vector<TileBuildRecord>::const_iterator itr = m_buildRecords.begin(); itr != m_buildRecords.end(); ++itr)
+        {
+            MapSummary& summary = summaries[itr->mapID];
+            ++summary.tiles;
+            summary.buildTime += itr->buildTime;
+            if (!summary.slowest)
+                summary.slowest = &*itr;
+            if (itr->result == TILE_BUILD_WRITTEN)
+                ++summary.written;
+            else if (itr->result == TILE_BUILD_FAILED)
+            {
+                ++summary.failed;
+                ++failed;
+            }
+
+            buildTime += itr->buildTime;
+        }
+
+        // sum of tile build times over wall time, ideally the thread count
+        float parallelism = totalTime ? float(buildTime) / totalTime : 0.0f;
+        printf("Built %u tiles in %u ms, %u failed, %.2f tiles built in parallel on average. See %s for details.\n",
+            uint32(m_buildRecords.size()), totalTime, failed, parallelism, REPORT_FILE);
+
+        FILE* file = fopen(REPORT_FILE, "w");
+        if (!file)
+        {
+            perror("Failed to open " REPORT_FILE " for writing");
+            return;
+        }
+
+        fprintf(file, "%u tiles built in %u ms, %u failed, %.2f tiles built in parallel on average\n\n", uint32(m_buildRecords.size()), totalTime, failed, parallelism);
+
+        fprintf(file, "map     tiles  written  failed   total ms    slowest tile\n");
+        for (std::map<uint32, MapSummary>::const_iterator itr = summaries.begin(); itr != summaries.end(); ++itr)
+            fprintf(file, "%03u  %8u %8u %7u %10u    [%02u,%02u] %u ms\n", itr->first, itr->second.tiles, itr->second.written, itr->second.failed,
+                uint32(itr->second.buildTime), itr->second.slowest->tileX, itr->second.slowest->tileY, itr->second.slowest->buildTime);
+
+        static char const* const resultNames[] = { "written", "empty", "failed" };
+        fprintf(file, "\nmap  tile       ms  result\n");
+        for (std::vector<TileBuildRecord>::const_iterator itr = m_buildRecords.begin(); itr != m_buildRecords.end(); ++itr)
+            fprintf(file, "%03u  [%02u,%02u] %8u  %s\n", itr->mapID, itr->tileX, itr->tileY, itr->buildTime, resultNames[itr->result]);
+
+        fclose(file);
     }
 
     /**************************************************************************/
@@ -239,6 +537,19 @@ namespace MMAP
         minY = 32 - bmax[2] / GRID_SIZE;
     }
 
+    /**************************************************************************/
+    void MapBuilder::addTilesInGridBounds(uint32 mapID, std::set<uint32>* tiles)
+    {
+        // convert coord bounds to grid bounds
+        uint32 minX, minY, maxX, maxY;
+        getGridBounds(mapID, minX, minY, maxX, maxY);
+
+        // add all tiles within bounds to tile list.
+        for (uint32 i = minX; i <= maxX; ++i)
+            for (uint32 j = minY; j <= maxY; ++j)
+                tiles->insert(StaticMapTree::packTileID(i, j));
+    }
+
     void MapBuilder::buildMeshFromFile(char* name)
     {
         FILE* file = fopen(name, "rb");
@@ -317,18 +628,11 @@ namespace MMAP
 
         std::set<uint32>* tiles = getTileList(mapID);
 
+        readManifest();
+
         // make sure we process maps which don't have tiles
         if (!tiles->size())
-        {
-            // convert coord bounds to grid bounds
-            uint32 minX, minY, maxX, maxY;
-            getGridBounds(mapID, minX, minY, maxX, maxY);
-
-            // add all tiles within bounds to tile list.
-            for (uint32 i = minX; i <= maxX; ++i)
-                for (uint32 j = minY; j <= maxY; ++j)
-                    tiles->insert(StaticMapTree::packTileID(i, j));
-        }
+            addTilesInGridBounds(mapID, tiles);
 
         if (!tiles->empty())
         {
@@ -363,7 +667,7 @@ namespace MMAP
     }
 
     /**************************************************************************/
-    void MapBuilder::buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh)
+    TileBuildResult MapBuilder::buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh)
     {
         printf("[Map %03i] Building tile [%02u,%02u]\n", mapID, tileX, tileY);
 
@@ -377,7 +681,7 @@ namespace MMAP
 
         // if there is no data, give up now
         if (!meshData.solidVerts.size() && !meshData.liquidVerts.size())
-            return;
+            return TILE_BUILD_EMPTY;
 
         // remove unused vertices
         TerrainBuilder::cleanVertices(meshData.solidVerts, meshData.solidTris);
@@ -389,7 +693,7 @@ namespace MMAP
         allVerts.append(meshData.solidVerts);
 
         if (!allVerts.size())
-            return;
+            return TILE_BUILD_EMPTY;
 
         // get bounds of current tile
         float bmin[3], bmax[3];
@@ -398,7 +702,7 @@ namespace MMAP
         m_terrainBuilder->loadOffMeshConnections(mapID, tileX, tileY, meshData, m_offMeshFilePath);
 
         // build navmesh tile
-        buildMoveMapTile(mapID, tileX, tileY, meshData, bmin, bmax, navMesh);
+        return buildMoveMapTile(mapID, tileX, tileY, meshData, bmin, bmax, navMesh);
     }
 
     /**************************************************************************/
@@ -477,7 +781,7 @@ namespace MMAP
     }
 
     /**************************************************************************/
-    void MapBuilder::buildMoveMapTile(uint32 mapID, uint32 tileX, uint32 tileY,
+    TileBuildResult MapBuilder::buildMoveMapTile(uint32 mapID, uint32 tileX, uint32 tileY,
         MeshData &meshData, float bmin[3], float bmax[3],
         dtNavMesh* navMesh)
     {
@@ -549,14 +853,14 @@ namespace MMAP
         if (!pmmerge)
         {
             printf("%s alloc pmmerge FIALED!\n", tileString);
-            return;
+            return TILE_BUILD_FAILED;
         }
 
         rcPolyMeshDetail** dmmerge = new rcPolyMeshDetail*[TILES_PER_MAP * TILES_PER_MAP];
         if (!dmmerge)
         {
             printf("%s alloc dmmerge FIALED!\n", tileString);
-            return;
+            return TILE_BUILD_FAILED;
         }
 
         int nmerge = 0;
@@ -666,7 +970,7 @@ namespace MMAP
         if (!iv.polyMesh)
         {
             printf("%s alloc iv.polyMesh FIALED!\n", tileString);
-            return;
+            return TILE_BUILD_FAILED;
         }
         rcMergePolyMeshes(m_rcContext, pmmerge, nmerge, *iv.polyMesh);
 
@@ -674,7 +978,7 @@ namespace MMAP
         if (!iv.polyMeshDetail)
         {
             printf("%s alloc m_dmesh FIALED!\n", tileString);
-            return;
+            return TILE_BUILD_FAILED;
         }
         rcMergePolyMeshDetails(m_rcContext, dmmerge, nmerge, *iv.polyMeshDetail);
 
@@ -729,6 +1033,8 @@ namespace MMAP
         unsigned char* navData = NULL;
         int navDataSize = 0;
 
+        TileBuildResult result = TILE_BUILD_EMPTY;
+
         do
         {
             // these values are checked within dtCreateNavMeshData - handle them here
@@ -771,6 +1077,7 @@ namespace MMAP
             if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
             {
                 printf("%s Failed building navmesh tile!           \n", tileString);
+                result = TILE_BUILD_FAILED;
                 continue;
             }
 
@@ -782,19 +1089,23 @@ namespace MMAP
             if (!tileRef || dtResult != DT_SUCCESS)
             {
                 printf("%s Failed adding tile to navmesh!           \n", tileString);
+                result = TILE_BUILD_FAILED;
                 continue;
             }
 
-            // file output
+            // file output, written under a temporary name so an interrupted build never leaves a cut off tile behind
             char fileName[255];
+            char tempFileName[255];
             sprintf(fileName, "mmaps/%03u%02i%02i.mmtile", mapID, tileY, tileX);
-            FILE* file = fopen(fileName, "wb");
+            sprintf(tempFileName, "%s.tmp", fileName);
+            FILE* file = fopen(tempFileName, "wb");
             if (!file)
             {
                 char message[1024];
-                sprintf(message, "[Map %03i] Failed to open %s for writing!\n", mapID, fileName);
+                sprintf(message, "[Map %03i] Failed to open %s for writing!\n", mapID, tempFileName);
                 perror(message);
                 navMesh->removeTile(tileRef, NULL, NULL);
+                result = TILE_BUILD_FAILED;
                 continue;
             }
 
@@ -807,11 +1118,25 @@ namespace MMAP
             fwrite(&header, sizeof(MmapTileHeader), 1, file);
 
             // write data
-            fwrite(navData, sizeof(unsigned char), navDataSize, file);
-            fclose(file);
+            bool written = fwrite(navData, sizeof(unsigned char), navDataSize, file) == size_t(navDataSize);
+            written = fclose(file) == 0 && written;
 
             // now that tile is written to disk, we can unload it
             navMesh->removeTile(tileRef, NULL, NULL);
+
+            // rename does not replace existing files everywhere
+            remove(fileName);
+            if (!written || rename(tempFileName, fileName) != 0)
+            {
+                char message[1024];
+                sprintf(message, "[Map %03i] Failed to write %s!\n", mapID, fileName);
+                perror(message);
+                remove(tempFileName);
+                result = TILE_BUILD_FAILED;
+                continue;
+            }
+
+            result = TILE_BUILD_WRITTEN;
         }
         while (0);
 
@@ -828,6 +1153,8 @@ namespace MMAP
             iv.generateObjFile(mapID, tileX, tileY, meshData);
             iv.writeIV(mapID, tileX, tileY);
         }
+
+        return result;
     }
 
     /**************************************************************************/
@@ -982,6 +1309,19 @@ namespace MMAP
 
     /**************************************************************************/
     bool MapBuilder::shouldSkipTile(uint32 mapID, uint32 tileX, uint32 tileY)
+    {
+        if (m_finishedTiles.count(manifestKey(mapID, tileX, tileY)))
+            return true;
+
+        // tiles of a build with other or unfinished settings are made again
+        if (!m_trustExistingTiles)
+            return false;
+
+        return hasValidTileFile(mapID, tileX, tileY);
+    }
+
+    /**************************************************************************/
+    bool MapBuilder::hasValidTileFile(uint32 mapID, uint32 tileX, uint32 tileY)
     {
         char fileName[255];
         sprintf(fileName, "mmaps/%03u%02i%02i.mmtile", mapID, tileY, tileX);
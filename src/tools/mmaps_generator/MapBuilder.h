@@ -21,6 +21,7 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <algorithm>
 
 #include "TerrainBuilder.h"
 #include "IntermediateValues.h"
@@ -31,6 +32,7 @@
 #include <ace/Task.h>
 #include <ace/Activation_Queue.h>
 #include <ace/Method_Request.h>
+#include <ace/Thread_Mutex.h>
 
 using namespace VMAP;
 
@@ -57,6 +59,22 @@ namespace MMAP
         rcPolyMeshDetail* dmesh;
     };
 
+    enum TileBuildResult
+    {
+        TILE_BUILD_WRITTEN, // .mmtile written
+        TILE_BUILD_EMPTY,   // nothing to navigate on, no file written
+        TILE_BUILD_FAILED   // could not be built or written, retried on the next run
+    };
+
+    struct TileBuildRecord
+    {
+        uint32 mapID;
+        uint32 tileX;
+        uint32 tileY;
+        TileBuildResult result;
+        uint32 buildTime;   // ms
+    };
+
     class MapBuilder
     {
         public:
@@ -79,8 +97,13 @@ namespace MMAP
             void buildSingleTile(uint32 mapID, uint32 tileX, uint32 tileY);
 
             // builds list of maps, then builds all of mmap tiles (based on the skip settings)
+            // tiles of all maps are spread over the threads, progress is kept in mmaps/build.manifest
+            // so an interrupted run continues where it stopped
             void buildAllMaps(int threads);
 
+            // builds one tile queued by buildAllMaps and records it in the manifest
+            void buildQueuedTile(uint32 mapID, uint32 tileX, uint32 tileY);
+
         private:
             // detect maps and tiles
             void discoverTiles();
@@ -88,10 +111,10 @@ namespace MMAP
 
             void buildNavMesh(uint32 mapID, dtNavMesh* &navMesh);
 
-            void buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh);
+            TileBuildResult buildTile(uint32 mapID, uint32 tileX, uint32 tileY, dtNavMesh* navMesh);
 
             // move map building
-            void buildMoveMapTile(uint32 mapID,
+            TileBuildResult buildMoveMapTile(uint32 mapID,
                 uint32 tileX,
                 uint32 tileY,
                 MeshData &meshData,
@@ -103,10 +126,21 @@ namespace MMAP
                 float* verts, int vertCount,
                 float* bmin, float* bmax);
             void getGridBounds(uint32 mapID, uint32 &minX, uint32 &minY, uint32 &maxX, uint32 &maxY);
+            void addTilesInGridBounds(uint32 mapID, std::set<uint32>* tiles);
 
             bool shouldSkipMap(uint32 mapID);
             bool isTransportMap(uint32 mapID);
             bool shouldSkipTile(uint32 mapID, uint32 tileX, uint32 tileY);
+            static bool hasValidTileFile(uint32 mapID, uint32 tileX, uint32 tileY);
+
+            // build manifest and timing report of buildAllMaps
+            std::string getManifestHeader() const;
+            bool readManifest();                        // false when there is no manifest of the current settings
+            void loadManifest();
+            void finalizeManifest();
+            void recordTile(TileBuildRecord const& record);
+            void writeReport(uint32 totalTime);
+            static uint64 manifestKey(uint32 mapID, uint32 tileX, uint32 tileY);
 
             TerrainBuilder* m_terrainBuilder;
             TileList m_tiles;
@@ -123,31 +157,43 @@ namespace MMAP
 
             // build performance - not really used for now
             rcContext* m_rcContext;
+
+            // navmesh params of the maps queued by buildAllMaps, every tile builds against its own navmesh
+            std::map<uint32, dtNavMeshParams> m_navMeshParams;
+
+            std::set<uint64> m_finishedTiles;           // tiles the manifest already lists
+            bool m_trustExistingTiles;                  // tile files not in the manifest were made with the current settings
+            std::vector<TileBuildRecord> m_buildRecords; // tiles built by this run
+            FILE* m_manifest;
+            ACE_Thread_Mutex m_manifestLock;
     };
 
-    class MapBuildRequest : public ACE_Method_Request
+    class TileBuildRequest : public ACE_Method_Request
     {
         public:
-            MapBuildRequest(uint32 mapId) : _mapId(mapId) {}
+            TileBuildRequest(MapBuilder* builder, uint32 mapId, uint32 tileX, uint32 tileY) :
+                _builder(builder), _mapId(mapId), _tileX(tileX), _tileY(tileY) {}
 
             virtual int call()
             {
-                /// @ Actually a creative way of unabstracting the class and returning a member variable
-                return (int)_mapId;
+                _builder->buildQueuedTile(_mapId, _tileX, _tileY);
+                return 0;
             }
 
         private:
+            MapBuilder* _builder;
             uint32 _mapId;
+            uint32 _tileX;
+            uint32 _tileY;
     };
 
     class BuilderThread : public ACE_Task_Base
     {
     private:
-        MapBuilder* _builder;
         ACE_Activation_Queue* _queue;
 
     public:
-        BuilderThread(MapBuilder* builder, ACE_Activation_Queue* queue) : _builder(builder), _queue(queue) { activate(); }
+        BuilderThread(ACE_Activation_Queue* queue) : _queue(queue) { activate(); }
 
         int svc()
         {
@@ -156,7 +202,7 @@ namespace MMAP
             ACE_Method_Request* request = NULL;
             while ((request = _queue->dequeue(&timeout)) != NULL)
             {
-                _builder->buildMap(request->call());
+                request->call();
                 delete request;
                 request = NULL;
             }
@@ -168,10 +214,15 @@ namespace MMAP
     class BuilderThreadPool
     {
         public:
-            BuilderThreadPool() : _queue(new ACE_Activation_Queue()) {}
+            //! All requests are queued before the builder threads start, the queue must take them without blocking.
+            //! ACE_Activation_Queue counts sizeof(ACE_Method_Request) per request against the high water mark.
+            BuilderThreadPool(size_t requests) : _queue(new ACE_Activation_Queue())
+            {
+                _queue->queue()->high_water_mark(std::max<size_t>(_queue->queue()->high_water_mark(), (requests + 1) * sizeof(ACE_Method_Request)));
+            }
             ~BuilderThreadPool() { _queue->queue()->close(); delete _queue; }
 
-            void Enqueue(MapBuildRequest* request)
+            void Enqueue(TileBuildRequest* request)
             {
                 _queue->enqueue(request);
             }
@@ -18,6 +18,8 @@
 #include "PathCommon.h"
 #include "MapBuilder.h"
 
+#include <ace/OS_NS_unistd.h>
+
 using namespace MMAP;
 
 bool checkDirectories(bool debugOutput)
@@ -240,7 +242,8 @@ int finish(const char* message, int returnValue)
 
 int main(int argc, char** argv)
 {
-    int threads = 3, mapnum = -1;
+    // tiles of all maps are built in parallel, so by default use every core
+    int threads = std::max<int>(ACE_OS::num_processors_online(), 1), mapnum = -1;
     float maxAngle = 70.0f;
     int tileX = -1, tileY = -1;
     bool skipLiquid = false,
@@ -120,7 +120,7 @@ public:
     int nMDX;
     std::string* WmoInstanceNames;
     std::string* ModelInstanceNames;
-    bool init(uint32 map_num, uint32 tileX, uint32 tileY);
+    bool init(uint32 map_num, uint32 tileX, uint32 tileY, FILE* dirfile);
     //void LoadMapChunks();
 
     //uint32 wmo_count;
@@ -21,10 +21,16 @@
 #include "vmapexport.h"
 
 #include <algorithm>
+#include <mutex>
 #include <stdio.h>
 
+// held until the model is completely written, other threads read its vertex count right after this returns
+static std::mutex ExtractModelLock;
+
 bool ExtractSingleModel(std::string& fname)
 {
+    std::lock_guard<std::mutex> lock(ExtractModelLock);
+
     if (fname.substr(fname.length() - 4, 4) == ".mdx")
     {
         fname.erase(fname.length() - 2, 2);
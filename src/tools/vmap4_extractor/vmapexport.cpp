@@ -20,6 +20,10 @@
 #include <iostream>
 #include <vector>
 #include <list>
+#include <set>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <errno.h>
 
 #ifdef WIN32
@@ -60,6 +64,7 @@ HANDLE WorldMpq = NULL;
 HANDLE LocaleMpq = NULL;
 
 uint32 CONF_TargetBuild = 18273;              // 5.4.8.18273
+uint32 CONF_threads = 0;                      // 0 - one thread per core
 
 // List MPQ for extract maps from
 char const* CONF_mpq_list[]=
@@ -300,12 +305,39 @@ void ReadLiquidTypeTableDBC()
     printf("Done! (%lu LiqTypes loaded)\n", LiqType_count);
 }
 
-bool ExtractWmo()
+uint32 GetThreadCount()
 {
-    bool success = false;
+    return CONF_threads ? CONF_threads : std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+// Calls work(index, worker) for every index in [0, count) from GetThreadCount() threads, worker being in [0, GetThreadCount())
+template<class Work>
+void ParallelFor(uint32 count, Work work)
+{
+    std::atomic<uint32> next(0);
+    auto run = [&](uint32 worker)
+    {
+        for (uint32 i = next++; i < count; i = next++)
+            work(i, worker);
+    };
 
+    std::vector<std::thread> threads;
+    for (uint32 i = 1; i < GetThreadCount(); ++i)
+        threads.push_back(std::thread(run, i));
+
+    run(0);
+
+    for (std::vector<std::thread>::iterator itr = threads.begin(); itr != threads.end(); ++itr)
+        itr->join();
+}
+
+bool ExtractWmo()
+{
     //const char* ParsArchiveNames[] = {"patch-2.MPQ", "patch.MPQ", "common.MPQ", "expansion.MPQ"};
 
+    // the archive search is not thread safe, collect the names first and convert them in parallel afterwards
+    std::vector<std::string> names;
+    std::set<std::string> found;
     SFILE_FIND_DATA data;
     HANDLE find = SFileFindFirstFile(WorldMpq, "*.wmo", &data, NULL);
     if (find != NULL)
@@ -313,13 +345,21 @@ bool ExtractWmo()
         do
         {
             std::string str = data.cFileName;
-            //printf("Extracting wmo %s\n", str.c_str());
-            success |= ExtractSingleWmo(str);
+            if (found.insert(str).second)
+                names.push_back(str);
         }
         while (SFileFindNextFile(find, &data));
     }
     SFileFindClose(find);
 
+    std::atomic<bool> success(false);
+    ParallelFor(uint32(names.size()), [&](uint32 index, uint32 /*worker*/)
+    {
+        //printf("Extracting wmo %s\n", names[index].c_str());
+        if (ExtractSingleWmo(names[index]))
+            success = true;
+    });
+
     if (success)
         printf("\nExtract wmo complete (No (fatal) errors)\n");
 
@@ -407,11 +447,23 @@ bool ExtractSingleWmo(std::string& fname)
     return true;
 }
 
+// Part of a worker output file holding the dir_bin entries of one tile
+struct TileSegment
+{
+    TileSegment() : worker(0), begin(0), end(0) { }
+
+    uint32 worker;
+    long begin;
+    long end;
+};
+
 void ParsMapFiles()
 {
     char fn[512];
     //char id_filename[64];
     char id[10];
+    std::string dirname = std::string(szWorkDirWmo) + "/dir_bin";
+    uint32 threadCount = GetThreadCount();
     for (unsigned int i=0; i<map_count; ++i)
     {
         sprintf(id,"%03u",map_ids[i].id);
@@ -420,20 +472,83 @@ void ParsMapFiles()
         if(WDT.init(id, map_ids[i].id))
         {
             printf("Processing Map %u\n[", map_ids[i].id);
-            for (int x=0; x<64; ++x)
+
+            // every worker appends the spawns of its tiles to an own file, they are merged into dir_bin in tile order
+            // afterwards so the output does not depend on which thread converted which tile
+            std::vector<FILE*> workerFiles(threadCount, NULL);
+            std::vector<std::string> workerFileNames(threadCount);
+            bool opened = true;
+            for (uint32 w = 0; w < threadCount; ++w)
+            {
+                char name[512];
+                sprintf(name, "%s/dir_bin.%u.tmp", szWorkDirWmo, w);
+                workerFileNames[w] = name;
+                workerFiles[w] = fopen(name, "w+b");
+                if (!workerFiles[w])
+                {
+                    printf("Can't open dirfile!'%s'\n", name);
+                    opened = false;
+                }
+            }
+
+            std::vector<TileSegment> segments(64 * 64);
+            std::atomic<uint32> done(0);
+            if (opened)
             {
-                for (int y=0; y<64; ++y)
+                ParallelFor(64 * 64, [&](uint32 tile, uint32 worker)
                 {
+                    int x = tile / 64;
+                    int y = tile % 64;
                     if (ADTFile *ADT = WDT.GetMap(x,y))
                     {
+                        TileSegment& segment = segments[tile];
+                        segment.worker = worker;
+                        segment.begin = ftell(workerFiles[worker]);
                         //sprintf(id_filename,"%02u %02u %03u",x,y,map_ids[i].id);//!!!!!!!!!
-                        ADT->init(map_ids[i].id, x, y);
+                        ADT->init(map_ids[i].id, x, y, workerFiles[worker]);
+                        segment.end = ftell(workerFiles[worker]);
                         delete ADT;
                     }
+
+                    if (++done % 64 == 0)
+                    {
+                        printf("#");
+                        fflush(stdout);
+                    }
+                });
+
+                if (FILE* dirfile = fopen(dirname.c_str(), "ab"))
+                {
+                    std::vector<char> buffer;
+                    for (std::vector<TileSegment>::const_iterator itr = segments.begin(); itr != segments.end(); ++itr)
+                    {
+                        if (itr->end <= itr->begin)
+                            continue;
+
+                        buffer.resize(itr->end - itr->begin);
+                        fseek(workerFiles[itr->worker], itr->begin, SEEK_SET);
+                        if (fread(&buffer[0], 1, buffer.size(), workerFiles[itr->worker]) != buffer.size())
+                        {
+                            printf("Can't read dirfile!'%s'\n", workerFileNames[itr->worker].c_str());
+                            continue;
+                        }
+
+                        fwrite(&buffer[0], 1, buffer.size(), dirfile);
+                    }
+
+                    fclose(dirfile);
                 }
-                printf("#");
-                fflush(stdout);
+                else
+                    printf("Can't open dirfile!'%s'\n", dirname.c_str());
+            }
+
+            for (uint32 w = 0; w < threadCount; ++w)
+            {
+                if (workerFiles[w])
+                    fclose(workerFiles[w]);
+                remove(workerFileNames[w].c_str());
             }
+
             printf("]\n");
         }
     }
@@ -488,6 +603,11 @@ bool processArgv(int argc, char ** argv, const char *versionString)
             if (i + 1 < argc)                            // all ok
                 CONF_TargetBuild = atoi(argv[i++ + 1]);
         }
+        else if(strcmp("-j",argv[i]) == 0)
+        {
+            if (i + 1 < argc)                            // all ok
+                CONF_threads = atoi(argv[i++ + 1]);
+        }
         else
         {
             result = false;
@@ -498,11 +618,12 @@ bool processArgv(int argc, char ** argv, const char *versionString)
     if(!result)
     {
         printf("Extract %s.\n",versionString);
-        printf("%s [-?][-s][-l][-d <path>]\n", argv[0]);
+        printf("%s [-?][-s][-l][-d <path>][-b <build>][-j <threads>]\n", argv[0]);
         printf("   -s : (default) small size (data size optimization), ~500MB less vmap data.\n");
         printf("   -l : large size, ~500MB more vmap data. (might contain more details)\n");
         printf("   -d <path>: Path to the vector data source folder.\n");
         printf("   -b : target build (default %u)\n", CONF_TargetBuild);
+        printf("   -j : number of extraction threads (default one per core)\n");
         printf("   -? : This message.\n");
     }
 